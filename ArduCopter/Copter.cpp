@@ -805,6 +805,12 @@ bool Copter::get_wp_crosstrack_error_m(float &xtrack_error) const
     return true;
 }
 
+// vehicle specific waypoint info helpers
+bool Copter::get_wp_time_remaining_s(float &time_s) const
+{
+    return flightmode->wp_time_remaining_s(time_s);
+}
+
 // get the target earth-frame angular velocities in rad/s (Z-axis component used by some gimbals)
 bool Copter::get_rate_ef_targets(Vector3f& rate_ef_targets) const
 {
@@ -705,6 +705,7 @@ private:
     bool get_wp_distance_m(float &distance) const override;
     bool get_wp_bearing_deg(float &bearing) const override;
     bool get_wp_crosstrack_error_m(float &xtrack_error) const override;
+    bool get_wp_time_remaining_s(float &time_s) const override;
     bool get_rate_ef_targets(Vector3f& rate_ef_targets) const override;
 
     // Attitude.cpp
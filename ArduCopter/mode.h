@@ -151,6 +151,7 @@ public:
     virtual int32_t wp_bearing() const { return 0; }
     virtual uint32_t wp_distance() const { return 0; }
     virtual float crosstrack_error() const { return 0.0f;}
+    virtual bool wp_time_remaining_s(float &time_s) const { return false; }
 
     // functions to support MAV_CMD_DO_CHANGE_SPEED
     virtual bool set_speed_xy(float speed_xy_cms) {return false;}
@@ -585,6 +586,7 @@ protected:
     uint32_t wp_distance() const override;
     int32_t wp_bearing() const override;
     float crosstrack_error() const override { return wp_nav->crosstrack_error();}
+    bool wp_time_remaining_s(float &time_s) const override;
     bool get_wp(Location &loc) const override;
 
 private:
@@ -624,6 +626,9 @@ private:
     void do_takeoff(const AP_Mission::Mission_Command& cmd);
     void do_nav_wp(const AP_Mission::Mission_Command& cmd);
     bool set_next_wp(const AP_Mission::Mission_Command& current_cmd, const Location &default_loc);
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    void add_wp_lookahead(const AP_Mission::Mission_Command& next_cmd, const Location &next_dest_loc);
+#endif
     void do_land(const AP_Mission::Mission_Command& cmd);
     void do_loiter_unlimited(const AP_Mission::Mission_Command& cmd);
     void do_circle(const AP_Mission::Mission_Command& cmd);
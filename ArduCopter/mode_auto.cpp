@@ -888,6 +888,18 @@ int32_t ModeAuto::wp_bearing() const
     }
 }
 
+bool ModeAuto::wp_time_remaining_s(float &time_s) const
+{
+    switch (_mode) {
+    case SubMode::WP:
+    case SubMode::CIRCLE_MOVE_TO_EDGE:
+        time_s = wp_nav->get_wp_time_remaining_s();
+        return true;
+    default:
+        return false;
+    }
+}
+
 bool ModeAuto::get_wp(Location& destination) const
 {
     switch (_mode) {
@@ -1589,7 +1601,13 @@ bool ModeAuto::set_next_wp(const AP_Mission::Mission_Command& current_cmd, const
     case MAV_CMD_NAV_LOITER_TIME: {
         const Location dest_loc = loc_from_cmd(current_cmd, default_loc);
         const Location next_dest_loc = loc_from_cmd(next_cmd, dest_loc);
-        return wp_nav->set_wp_destination_next_loc(next_dest_loc);
+        if (!wp_nav->set_wp_destination_next_loc(next_dest_loc)) {
+            return false;
+        }
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+        add_wp_lookahead(next_cmd, next_dest_loc);
+#endif
+        return true;
     }
     case MAV_CMD_NAV_SPLINE_WAYPOINT: {
         // get spline's location and next location from command and send to wp_nav
@@ -1614,6 +1632,34 @@ bool ModeAuto::set_next_wp(const AP_Mission::Mission_Command& current_cmd, const
     return true;
 }
 
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+// adds the straight line waypoints following next_cmd to wp_nav's lookahead
+// so their paths are calculated before the vehicle reaches them
+// next_dest_loc should be the destination of next_cmd
+void ModeAuto::add_wp_lookahead(const AP_Mission::Mission_Command& next_cmd, const Location &next_dest_loc)
+{
+    AP_Mission::Mission_Command cmd = next_cmd;
+    Location dest_loc = next_dest_loc;
+
+    // vehicle only passes through waypoints without a delay
+    uint8_t index = 0;
+    while ((cmd.id == MAV_CMD_NAV_WAYPOINT) && (cmd.p1 == 0)) {
+        AP_Mission::Mission_Command lookahead_cmd;
+        if (!mission.get_next_nav_cmd(cmd.index+1, lookahead_cmd) || (lookahead_cmd.id != MAV_CMD_NAV_WAYPOINT)) {
+            return;
+        }
+        const Location lookahead_loc = loc_from_cmd(lookahead_cmd, dest_loc);
+        if (!wp_nav->set_wp_destination_lookahead_loc(index, lookahead_loc)) {
+            // lookahead is full or the altitude frame changes
+            return;
+        }
+        cmd = lookahead_cmd;
+        dest_loc = lookahead_loc;
+        index++;
+    }
+}
+#endif
+
 // do_land - initiate landing procedure
 void ModeAuto::do_land(const AP_Mission::Mission_Command& cmd)
 {
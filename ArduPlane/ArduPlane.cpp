@@ -56,6 +56,7 @@ overruns its allotted time
 const AP_Scheduler::Task Plane::scheduler_tasks[] = {
                            // Units:   Hz      us
     FAST_TASK(ahrs_update),
+    FAST_TASK(update_speed_height_loop_rate),
     FAST_TASK(update_control_mode),
     FAST_TASK(stabilize),
     FAST_TASK(set_servos),
@@ -204,20 +205,26 @@ void Plane::ahrs_update()
 }
 
 /*
-  update 50Hz speed/height controller
+  return true if the TECS speed/height estimator should be updated
  */
-void Plane::update_speed_height(void)
+bool Plane::should_update_tecs_estimator(void) const
 {
-    bool should_run_tecs = control_mode->does_auto_throttle();
 #if HAL_QUADPLANE_ENABLED
     if (quadplane.should_disable_TECS()) {
-        should_run_tecs = false;
+        return false;
     }
 #endif
-    if (should_run_tecs) {
-	    // Call TECS 50Hz update. Note that we call this regardless of
-	    // throttle suppressed, as this needs to be running for
-	    // takeoff detection
+    // Note that we update this regardless of throttle suppressed, as
+    // this needs to be running for takeoff detection
+    return control_mode->does_auto_throttle();
+}
+
+/*
+  update 50Hz speed/height controller
+ */
+void Plane::update_speed_height(void)
+{
+    if (!TECS_controller.run_estimator_at_loop_rate() && should_update_tecs_estimator()) {
         TECS_controller.update_50hz();
     }
 
@@ -230,6 +237,18 @@ void Plane::update_speed_height(void)
 }
 
 
+/*
+  update the speed/height estimator at the main loop rate if enabled
+  with TECS_OPTIONS, the speed/height demands are still updated at the
+  slower rate
+ */
+void Plane::update_speed_height_loop_rate(void)
+{
+    if (TECS_controller.run_estimator_at_loop_rate() && should_update_tecs_estimator()) {
+        TECS_controller.update_50hz();
+    }
+}
+
 /*
   read and update compass
  */
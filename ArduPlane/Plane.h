@@ -1025,6 +1025,8 @@ private:
                              uint32_t &log_bit) override;
     void ahrs_update();
     void update_speed_height(void);
+    void update_speed_height_loop_rate(void);
+    bool should_update_tecs_estimator(void) const;
     void update_GPS_50Hz(void);
     void update_GPS_10Hz(void);
     void update_compass(void);
@@ -248,6 +248,13 @@ class Board:
                 AP_SCRIPTING_CHECKS = 1,
                 )
 
+        env.SCRIPTING_PRECOMPILE = cfg.options.scripting_precompile
+        if cfg.options.scripting_precompile:
+            # only bytecode embedded in ROMFS is ever loaded
+            env.DEFINES.update(
+                LUA_SUPPORT_LOAD_BINARY = 1,
+                )
+
         cfg.msg("CXX Compiler", "%s %s"  % (cfg.env.COMPILER_CXX, ".".join(cfg.env.CC_VERSION)))
 
         if cfg.options.assert_cc_version:
@@ -545,15 +552,24 @@ class Board:
     def embed_ROMFS_files(self, ctx):
         '''embed some files using AP_ROMFS'''
         import embed
+        romfs_files = ctx.env.ROMFS_FILES
+        if ctx.env.SCRIPTING_PRECOMPILE:
+            # embed scripts as stripped bytecode
+            import lua_precompile
+            try:
+                romfs_files = lua_precompile.precompile_files(ctx, romfs_files)
+            except Exception as e:
+                ctx.fatal(str(e))
+
         header = ctx.bldnode.make_node('ap_romfs_embedded.h').abspath()
-        if not embed.create_embedded_h(header, ctx.env.ROMFS_FILES, ctx.env.ROMFS_UNCOMPRESSED):
+        if not embed.create_embedded_h(header, romfs_files, ctx.env.ROMFS_UNCOMPRESSED):
             ctx.fatal("Failed to created ap_romfs_embedded.h")
 
         ctx.env.CXXFLAGS += ['-DHAL_HAVE_AP_ROMFS_EMBEDDED_H']
 
         # Allow lua to load from ROMFS if any lua files are added
-        for file in ctx.env.ROMFS_FILES:
-            if file[0].startswith("scripts") and file[0].endswith(".lua"):
+        for file in romfs_files:
+            if file[0].startswith("scripts") and file[0].endswith((".lua", ".luac")):
                 ctx.env.CXXFLAGS += ['-DHAL_HAVE_AP_ROMFS_EMBEDDED_LUA']
                 break
 
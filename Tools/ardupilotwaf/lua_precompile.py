@@ -0,0 +1,68 @@
+#!/usr/bin/env python
+
+'''
+precompile lua scripts embedded in ROMFS to stripped bytecode
+
+A luac is built for the host from the in-tree lua sources with the
+same 32 bit number configuration as boards, so the chunks it produces
+load on the target without parsing at boot.
+'''
+
+import os
+import subprocess
+
+# lua core plus luac itself, leaving out the standard libraries
+LUAC_SOURCES = [
+    'lapi', 'lauxlib', 'lcode', 'lctype', 'ldebug', 'ldo', 'ldump',
+    'lfunc', 'lgc', 'llex', 'lmem', 'lobject', 'lopcodes', 'lparser',
+    'lstate', 'lstring', 'ltable', 'ltm', 'luac', 'lundump', 'lvm', 'lzio',
+]
+
+LUAC_CC = "gcc"
+LUAC_CFLAGS = ['-std=gnu99', '-O2', '-DLUA_32BITS=1', '-DLUA_HOST_TOOL',
+               '-DCONFIG_HAL_BOARD=HAL_BOARD_EMPTY']
+
+def build_luac(ctx):
+    '''build the host luac if it is out of date, returning its path'''
+    libraries = ctx.srcnode.find_dir('libraries').abspath()
+    lua_src = os.path.join(libraries, 'AP_Scripting', 'lua', 'src')
+    sources = [os.path.join(lua_src, s + '.c') for s in LUAC_SOURCES]
+    sources.append(os.path.join(libraries, 'AP_Scripting', 'generator', 'src', 'luac_host.c'))
+    luac = ctx.bldnode.make_node('luac').abspath()
+
+    newest = max(os.path.getmtime(f) for f in sources + [__file__])
+    if os.path.exists(luac) and os.path.getmtime(luac) >= newest:
+        return luac
+
+    cmd = [LUAC_CC] + LUAC_CFLAGS + ['-I' + libraries, '-I' + lua_src, '-o', luac] + sources + ['-lm']
+    if subprocess.call(cmd) != 0:
+        raise Exception("Failed to build host luac")
+    return luac
+
+def precompile_files(ctx, files):
+    '''
+    replace embedded scripts/*.lua with stripped .luac, returning the
+    new list of (name, path) ROMFS files
+    '''
+    def is_script(name):
+        return name.startswith("scripts/") and name.endswith(".lua")
+
+    if not any(is_script(name) for (name, path) in files):
+        return files
+
+    luac = build_luac(ctx)
+    outdir = ctx.bldnode.make_node('romfs_luac')
+    outdir.mkdir()
+
+    ret = []
+    for (name, path) in files:
+        if not is_script(name):
+            ret.append((name, path))
+            continue
+        src = os.path.join(ctx.srcnode.abspath(), path)
+        out = os.path.join(outdir.abspath(), os.path.basename(name) + 'c')
+        if not os.path.exists(out) or os.path.getmtime(out) < max(os.path.getmtime(src), os.path.getmtime(luac)):
+            if subprocess.call([luac, '-s', '-o', out, src]) != 0:
+                raise Exception("Failed to precompile %s" % path)
+        ret.append((name + 'c', out))
+    return ret
@@ -5389,6 +5389,22 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         self.disarm_vehicle(force=True)
         self.reboot_sitl()
 
+    def TECSLoopRateEstimator(self):
+        '''check height and speed tracking with the TECS estimator at the loop rate'''
+        self.set_parameters({
+            "SCHED_LOOP_RATE": 400,
+            "TECS_OPTIONS": 4,
+        })
+        self.reboot_sitl()
+        self.takeoff(alt=50)
+        self.change_mode("RTL")
+        rtl_alt = self.get_parameter("RTL_ALTITUDE")
+        self.wait_altitude(rtl_alt - 5, rtl_alt + 5, relative=True, timeout=90)
+        self.wait_altitude(rtl_alt - 5, rtl_alt + 5, relative=True, minimum_duration=20, timeout=60)
+        cruise = self.get_parameter("AIRSPEED_CRUISE")
+        self.wait_airspeed(cruise - 3, cruise + 3, minimum_duration=10, timeout=60)
+        self.fly_home_land_and_disarm()
+
     def GuidedAttitudeNoGPS(self):
         '''test that guided-attitude still works with no GPS'''
         self.takeoff(50)
@@ -5510,6 +5526,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
             self.MAV_CMD_NAV_RETURN_TO_LAUNCH,
             self.MinThrottle,
             self.ClimbThrottleSaturation,
+            self.TECSLoopRateEstimator,
             self.GuidedAttitudeNoGPS,
         ])
         return ret
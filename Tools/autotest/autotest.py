@@ -516,6 +516,7 @@ def run_step(step):
         "reset_after_every_test": opts.reset_after_every_test,
         "build_opts": copy.copy(build_opts),
         "generate_junit": opts.junit,
+        "sitl_instance": opts.sitl_instance,
     }
     if opts.speedup is not None:
         fly_opts["speedup"] = opts.speedup
@@ -1008,6 +1009,10 @@ if __name__ == "__main__":
     group_sim.add_option("", "--replay",
                          action='store_true',
                          help="enable replay logging for tests")
+    group_sim.add_option("", "--sitl-instance",
+                         type='int',
+                         default=0,
+                         help="SITL instance number; offsets network ports so several autotests may run at once")
     parser.add_option_group(group_sim)
 
     group_completion = optparse.OptionGroup(parser, "Completion helpers")
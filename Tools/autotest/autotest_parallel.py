@@ -0,0 +1,402 @@
+#!/usr/bin/env python3
+
+'''
+Run autotest subtests in parallel across several SITL instances
+
+Each vehicle step (e.g. test.Copter) is expanded into its individual
+subtests, which are then sharded across a pool of workers.  Each
+worker runs autotest.py in its own working directory with its own
+BUILDLOGS directory and its own SITL instance number, so the network
+ports, eeprom and logs of the workers do not collide.
+
+Results for passing tests are cached, keyed on a hash of the vehicle
+binary, the autotest sources, the scripts and data tests install from
+libraries/ and the test name; a passing test is not re-run until one
+of those changes.  Use --no-cache to run everything.
+
+Tests which rebuild binaries, bind fixed host ports or start AP_Periph
+on the host-wide CAN multicast group are listed in serial_steps and
+are run one at a time once the parallel tests are done.
+
+Binaries must already be built, e.g. with
+  ./Tools/autotest/autotest.py build.Copter
+
+Example:
+  ./Tools/autotest/autotest_parallel.py -j 8 test.Copter test.Rover
+
+AP_FLAKE8_CLEAN
+'''
+
+import hashlib
+import json
+import optparse
+import os
+import queue
+import signal
+import subprocess
+import sys
+import threading
+import time
+
+from pysim import util
+
+autotest_dir = os.path.dirname(os.path.realpath(__file__))
+autotest = os.path.join(autotest_dir, "autotest.py")
+
+# these must match the binary names in autotest.py:
+bin_names = {
+    "Copter": ("sitl", "arducopter"),
+    "Plane": ("sitl", "arduplane"),
+    "Rover": ("sitl", "ardurover"),
+    "Tracker": ("sitl", "antennatracker"),
+    "Helicopter": ("sitl", "arducopter-heli"),
+    "QuadPlane": ("sitl", "arduplane"),
+    "Sub": ("sitl", "ardusub"),
+    "Blimp": ("sitl", "blimp"),
+    "BalanceBot": ("sitl", "ardurover"),
+    "Sailboat": ("sitl", "ardurover"),
+}
+
+# files git knows about under these directories (relative to the top
+# of the tree) are hashed into the cache key; tests install Lua scripts
+# and data from the libraries/ entries
+cache_source_dirs = [
+    "Tools/autotest",
+    "libraries/AP_Scripting/applets",
+    "libraries/AP_Scripting/drivers",
+    "libraries/AP_Scripting/examples",
+    "libraries/AP_Scripting/modules",
+    "libraries/AP_Scripting/tests",
+    "libraries/AP_MSP/Tools",
+]
+
+# tests which cannot share the machine with other instances; a
+# vehicle entry like test.CAN covers all of its subtests:
+serial_steps = {
+    # AP_Periph is started with fixed instance numbers and the CAN
+    # multicast group is shared by everything on the host
+    "test.CAN",
+    "test.BattCAN",
+    # rebuilds the rover binary and binds 127.0.0.1:5765 for pppd
+    "test.Rover.NetworkingWebServerPPP",
+    # binds the web server to host port 8081
+    "test.Rover.NetworkingWebServer",
+    # builds the Replay tool
+    "test.Copter.Replay",
+    # MAVProxy connects to fixed host ports
+    "test.Sub.TestLogDownloadMAVProxyNetwork",
+    "test.Copter.TestLogDownloadMAVProxyCAN",
+}
+
+
+class ParallelAutoTest(object):
+    def __init__(self,
+                 steps,
+                 jobs=4,
+                 first_instance=1,
+                 use_cache=True,
+                 cache_dir=None,
+                 work_dir=None,
+                 timeout=None,
+                 extra_args=[]):
+        self.steps = steps
+        self.jobs = jobs
+        self.first_instance = first_instance
+        self.use_cache = use_cache
+        if cache_dir is None:
+            cache_dir = util.reltopdir("../buildlogs/autotest-cache")
+        self.cache_dir = cache_dir
+        if work_dir is None:
+            work_dir = util.reltopdir("../buildlogs/autotest-parallel")
+        self.work_dir = work_dir
+        self.timeout = timeout
+        self.extra_args = extra_args
+        self.source_hash = None
+        self.binary_hashes = {}
+        self.results = {}
+        self.results_lock = threading.Lock()
+
+    def progress(self, message):
+        print("PARALLEL: %s" % (message,))
+        sys.stdout.flush()
+
+    def vehicle_for_step(self, step):
+        '''returns vehicle name from a step like test.Copter'''
+        bits = step.split(".")
+        if len(bits) < 2 or bits[0] != "test":
+            raise ValueError("Bad step (%s); expected e.g. test.Copter" % step)
+        return bits[1]
+
+    def is_serial(self, step):
+        '''true if step must be run with no other tests running'''
+        if step in serial_steps:
+            return True
+        return "test.%s" % self.vehicle_for_step(step) in serial_steps
+
+    def list_subtests(self, vehicle):
+        '''ask autotest.py for the names of the subtests for vehicle'''
+        output = subprocess.check_output(
+            [autotest, "--list-subtests-for-vehicle", vehicle],
+            cwd=util.topdir()
+        )
+        if isinstance(output, bytes):
+            output = output.decode('utf-8')
+        return output.split()
+
+    def expand_steps(self):
+        '''expand steps like test.Copter into test.Copter.SubTest'''
+        ret = []
+        for step in self.steps:
+            vehicle = self.vehicle_for_step(step)
+            if step.count(".") > 1:
+                ret.append(step)
+                continue
+            for subtest in self.list_subtests(vehicle):
+                ret.append("test.%s.%s" % (vehicle, subtest))
+        return ret
+
+    def hash_file(self, h, filepath):
+        with open(filepath, "rb") as f:
+            while True:
+                chunk = f.read(1 << 20)
+                if not chunk:
+                    break
+                h.update(chunk)
+
+    def autotest_source_hash(self):
+        '''hash of everything under cache_source_dirs which git knows about'''
+        if self.source_hash is not None:
+            return self.source_hash
+        topdir = util.topdir()
+        files = subprocess.check_output(
+            ["git", "ls-files", "-z", "--"] + cache_source_dirs,
+            cwd=topdir
+        ).split(b'\0')
+        h = hashlib.sha256()
+        for filename in sorted(files):
+            if len(filename) == 0:
+                continue
+            filepath = os.path.join(topdir, filename.decode('utf-8'))
+            if not os.path.isfile(filepath):
+                continue
+            h.update(filename)
+            self.hash_file(h, filepath)
+        self.source_hash = h.hexdigest()
+        return self.source_hash
+
+    def binary_hash(self, vehicle):
+        '''hash of the SITL binary a vehicle is tested with'''
+        if vehicle in self.binary_hashes:
+            return self.binary_hashes[vehicle]
+        (config_name, binary_name) = bin_names.get(vehicle, (None, None))
+        if binary_name is None:
+            return None
+        binary = util.reltopdir(os.path.join('build', config_name, 'bin', binary_name))
+        if not os.path.exists(binary):
+            raise ValueError("Binary (%s) does not exist" % (binary,))
+        h = hashlib.sha256()
+        self.hash_file(h, binary)
+        self.binary_hashes[vehicle] = h.hexdigest()
+        return self.binary_hashes[vehicle]
+
+    def cache_key(self, step):
+        binary_hash = self.binary_hash(self.vehicle_for_step(step))
+        if binary_hash is None:
+            # we do not know what this is tested against
+            return None
+        h = hashlib.sha256()
+        h.update(binary_hash.encode('utf-8'))
+        h.update(self.autotest_source_hash().encode('utf-8'))
+        h.update(step.encode('utf-8'))
+        h.update(" ".join(self.extra_args).encode('utf-8'))
+        return h.hexdigest()
+
+    def cache_filepath(self, key):
+        return os.path.join(self.cache_dir, key[:2], key + ".json")
+
+    def cache_lookup(self, step):
+        if not self.use_cache:
+            return None
+        key = self.cache_key(step)
+        if key is None:
+            return None
+        try:
+            with open(self.cache_filepath(key)) as f:
+                return json.load(f)
+        except (IOError, ValueError):
+            return None
+
+    def cache_store(self, step, result):
+        key = self.cache_key(step)
+        if key is None:
+            return
+        filepath = self.cache_filepath(key)
+        util.mkdir_p(os.path.dirname(filepath))
+        # write-then-rename so a concurrent reader never sees a partial file:
+        tmp = filepath + ".tmp%u" % os.getpid()
+        with open(tmp, "w") as f:
+            json.dump(result, f)
+        os.rename(tmp, filepath)
+
+    def run_one(self, step, instance):
+        '''run a single subtest on SITL instance instance'''
+        workdir = os.path.join(self.work_dir, "instance%u" % instance)
+        logdir = os.path.join(workdir, "buildlogs")
+        util.mkdir_p(logdir)
+        env = dict(os.environ)
+        env["BUILDLOGS"] = logdir
+        cmd = [
+            autotest,
+            "--sitl-instance", str(instance),
+            "--no-clean",
+            "--no-configure",
+        ]
+        cmd.extend(self.extra_args)
+        cmd.append(step)
+        logfile = os.path.join(workdir, "%s.txt" % step)
+        start = time.time()
+        with open(logfile, "w") as f:
+            # own session, so on timeout the SITL and MAVProxy
+            # processes autotest.py started are killed along with it
+            # and do not keep holding this instance's ports
+            p = subprocess.Popen(cmd,
+                                 cwd=workdir,
+                                 env=env,
+                                 stdin=subprocess.DEVNULL,
+                                 stdout=f,
+                                 stderr=subprocess.STDOUT,
+                                 start_new_session=True)
+            try:
+                returncode = p.wait(timeout=self.timeout)
+            except subprocess.TimeoutExpired:
+                self.progress("instance %u: %s timed out" % (instance, step))
+                self.kill_process_group(p)
+                returncode = None
+        return {
+            "passed": returncode == 0,
+            "returncode": returncode,
+            "time": time.time() - start,
+            "log": logfile,
+        }
+
+    def kill_process_group(self, p):
+        '''terminate a process started in its own session and all its children'''
+        for sig in signal.SIGTERM, signal.SIGKILL:
+            try:
+                os.killpg(p.pid, sig)
+            except ProcessLookupError:
+                break
+            try:
+                p.wait(timeout=10)
+                # the leader has gone, but children may linger
+            except subprocess.TimeoutExpired:
+                pass
+        p.wait()
+
+    def worker(self, instance, work):
+        while True:
+            try:
+                step = work.get_nowait()
+            except queue.Empty:
+                return
+            self.progress("instance %u: starting %s" % (instance, step))
+            result = self.run_one(step, instance)
+            if result["passed"]:
+                self.progress("instance %u: %s passed (%.1fs)" %
+                              (instance, step, result["time"]))
+                self.cache_store(step, result)
+            else:
+                self.progress("instance %u: %s FAILED (%.1fs); see %s" %
+                              (instance, step, result["time"], result["log"]))
+            with self.results_lock:
+                self.results[step] = result
+
+    def run(self):
+        steps = self.expand_steps()
+        work = queue.Queue()
+        serial_work = queue.Queue()
+        cached = 0
+        for step in steps:
+            result = self.cache_lookup(step)
+            if result is not None:
+                self.results[step] = result
+                cached += 1
+                continue
+            if self.is_serial(step):
+                serial_work.put(step)
+            else:
+                work.put(step)
+        self.progress("%u tests, %u cached, %u to run on %u instances, %u to run serially" %
+                      (len(steps), cached, work.qsize(), self.jobs, serial_work.qsize()))
+
+        threads = []
+        for i in range(self.jobs):
+            t = threading.Thread(target=self.worker,
+                                 args=(self.first_instance + i, work))
+            t.start()
+            threads.append(t)
+        for t in threads:
+            t.join()
+
+        # nothing else is running now
+        self.worker(self.first_instance, serial_work)
+
+        missing = sorted([step for step in steps if step not in self.results])
+        failed = sorted([step for step in steps
+                         if not self.results.get(step, {"passed": False})["passed"]])
+        self.progress("%u passed, %u failed" % (len(steps) - len(failed), len(failed)))
+        for step in failed:
+            if step in missing:
+                self.progress("FAILED: %s (no result; worker died)" % (step,))
+                continue
+            self.progress("FAILED: %s (%s)" % (step, self.results[step]["log"]))
+        return len(failed) == 0
+
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser(
+        "autotest_parallel.py [options] test.Vehicle[.SubTest] ...",
+        epilog="Options after -- are passed through to autotest.py")
+    parser.add_option("-j", "--jobs",
+                      type='int',
+                      default=os.cpu_count() // 2 or 1,
+                      help="number of SITL instances to run at once")
+    parser.add_option("--first-instance",
+                      type='int',
+                      default=1,
+                      help="SITL instance number used by the first worker")
+    parser.add_option("--no-cache",
+                      action='store_true',
+                      default=False,
+                      help="run all tests, ignoring cached results")
+    parser.add_option("--cache-dir",
+                      default=None,
+                      help="directory in which to cache test results")
+    parser.add_option("--work-dir",
+                      default=None,
+                      help="directory in which workers run and keep their logs")
+    parser.add_option("--timeout",
+                      type='int',
+                      default=None,
+                      help="per-test timeout in seconds")
+
+    argv = sys.argv[1:]
+    extra_args = []
+    if "--" in argv:
+        extra_args = argv[argv.index("--")+1:]
+        argv = argv[:argv.index("--")]
+    opts, args = parser.parse_args(argv)
+    if len(args) == 0:
+        parser.error("no steps given")
+
+    p = ParallelAutoTest(args,
+                         jobs=opts.jobs,
+                         first_instance=opts.first_instance,
+                         use_cache=not opts.no_cache,
+                         cache_dir=opts.cache_dir,
+                         work_dir=opts.work_dir,
+                         timeout=opts.timeout,
+                         extra_args=extra_args)
+    if not p.run():
+        sys.exit(1)
+    sys.exit(0)
@@ -1708,6 +1708,7 @@ class TestSuite(ABC):
                  num_aux_imus=0,
                  dronecan_tests=False,
                  generate_junit=False,
+                 sitl_instance=0,
                  build_opts={}):
 
         self.start_time = time.time()
@@ -1737,6 +1738,9 @@ class TestSuite(ABC):
         self.build_opts = build_opts
         self.num_aux_imus = num_aux_imus
         self.generate_junit = generate_junit
+        # SITL instance number (-I); moves all network ports so that
+        # several test suites can run side-by-side on one machine:
+        self.sitl_instance = int(sitl_instance)
         if generate_junit:
             try:
                 spec = importlib.util.find_spec("junitparser")
@@ -1870,13 +1874,13 @@ class TestSuite(ABC):
 
     def adjust_ardupilot_port(self, port):
         '''adjust port in case we do not wish to use the default range (5760 and 5501 etc)'''
-        return port
+        return port + 10 * self.sitl_instance
 
     def spare_network_port(self, offset=0):
         '''returns a network port which should be able to be bound'''
         if offset > 2:
             raise ValueError("offset too large")
-        return 8000 + offset
+        return self.adjust_ardupilot_port(8000 + offset)
 
     def autotest_connection_string_to_ardupilot(self):
         return "tcp:127.0.0.1:%u" % self.adjust_ardupilot_port(5760)
@@ -1884,7 +1888,7 @@ class TestSuite(ABC):
     def sitl_rcin_port(self, offset=0):
         if offset > 2:
             raise ValueError("offset too large")
-        return 5501 + offset
+        return self.adjust_ardupilot_port(5501 + offset)
 
     def mavproxy_options(self):
         """Returns options to be passed to MAVProxy."""
@@ -8669,6 +8673,10 @@ Also, ignores heartbeats not from our target system'''
 
         if "model" not in start_sitl_args or start_sitl_args["model"] is None:
             start_sitl_args["model"] = self.frame
+        if self.sitl_instance != 0:
+            customisations = list(start_sitl_args.get("customisations", []))
+            customisations.extend(["-I", str(self.sitl_instance)])
+            start_sitl_args["customisations"] = customisations
         self.progress("Starting SITL", send_statustext=False)
         if binary is None:
             binary = self.binary
@@ -529,9 +529,7 @@ void AC_PosControl::init_xy_controller()
     }
 
     // limit acceleration using maximum lean angles
-    float angle_max = MIN(_attitude_control.get_althold_lean_angle_max_cd(), get_lean_angle_max_cd());
-    float accel_max = angle_to_accel(angle_max * 0.01) * 100.0;
-    _accel_target.xy().limit_length(accel_max);
+    _accel_target.xy().limit_length(get_lean_angle_accel_max_cmss());
 
     // initialise I terms from lean angles
     _pid_vel_xy.reset_filter();
@@ -673,24 +671,30 @@ void AC_PosControl::update_xy_controller()
     // Acceleration Controller
 
     // limit acceleration using maximum lean angles
-    float angle_max = MIN(_attitude_control.get_althold_lean_angle_max_cd(), get_lean_angle_max_cd());
-    float accel_max = angle_to_accel(angle_max * 0.01) * 100;
+    const float accel_max = get_lean_angle_accel_max_cmss();
     // Define the limit vector before we constrain _accel_target 
     _limit_vector.xy() = _accel_target.xy();
-    if (!limit_accel_xy(_vel_desired.xy(), _accel_target.xy(), accel_max)) {
+    const bool accel_limited = limit_accel_xy(_vel_desired.xy(), _accel_target.xy(), accel_max);
+
+    // rotate accelerations into body forward-right frame once for both the lean angle targets and the forward pitch limit check
+    const float cos_yaw = _ahrs.cos_yaw();
+    const float sin_yaw = _ahrs.sin_yaw();
+    const float accel_forward = _accel_target.x * cos_yaw + _accel_target.y * sin_yaw;
+    const float accel_right = -_accel_target.x * sin_yaw + _accel_target.y * cos_yaw;
+
+    // update angle targets that will be passed to stabilize controller
+    accel_fr_to_lean_angles(accel_forward, accel_right, _roll_target, _pitch_target);
+
+    if (!accel_limited) {
         // _accel_target was not limited so we can zero the xy limit vector
         _limit_vector.xy().zero();
     } else {
         // Check for pitch limiting in the forward direction
-        const float accel_fwd_unlimited = _limit_vector.x * _ahrs.cos_yaw() + _limit_vector.y * _ahrs.sin_yaw();
+        const float accel_fwd_unlimited = _limit_vector.x * cos_yaw + _limit_vector.y * sin_yaw;
         const float pitch_target_unlimited = accel_to_angle(- MIN(accel_fwd_unlimited, accel_max) * 0.01f) * 100;
-        const float accel_fwd_limited = _accel_target.x * _ahrs.cos_yaw() + _accel_target.y * _ahrs.sin_yaw();
-        const float pitch_target_limited = accel_to_angle(- accel_fwd_limited * 0.01f) * 100;
-        _fwd_pitch_is_limited = is_negative(pitch_target_unlimited) && pitch_target_unlimited < pitch_target_limited;
+        _fwd_pitch_is_limited = is_negative(pitch_target_unlimited) && pitch_target_unlimited < _pitch_target;
     }
 
-    // update angle targets that will be passed to stabilize controller
-    accel_to_lean_angles(_accel_target.x, _accel_target.y, _roll_target, _pitch_target);
     calculate_yaw_and_rate_yaw();
 
     _disturb_pos.zero();
@@ -1220,10 +1224,30 @@ void AC_PosControl::accel_to_lean_angles(float accel_x_cmss, float accel_y_cmss,
     const float accel_forward = accel_x_cmss * _ahrs.cos_yaw() + accel_y_cmss * _ahrs.sin_yaw();
     const float accel_right = -accel_x_cmss * _ahrs.sin_yaw() + accel_y_cmss * _ahrs.cos_yaw();
 
+    accel_fr_to_lean_angles(accel_forward, accel_right, roll_target, pitch_target);
+}
+
+// accel_fr_to_lean_angles - convert body frame forward and right accelerations in cm/s/s to roll, pitch lean angles in centi-degrees
+void AC_PosControl::accel_fr_to_lean_angles(float accel_forward_cmss, float accel_right_cmss, float& roll_target, float& pitch_target) const
+{
     // update angle targets that will be passed to stabilize controller
-    pitch_target = accel_to_angle(-accel_forward * 0.01) * 100;
-    float cos_pitch_target = cosf(pitch_target * M_PI / 18000.0f);
-    roll_target = accel_to_angle((accel_right * cos_pitch_target)*0.01) * 100;
+    const float pitch_tan = -accel_forward_cmss * 0.01f / GRAVITY_MSS;
+    pitch_target = degrees(atanf(pitch_tan)) * 100;
+    // cos(atan(x)) = 1/sqrt(1+x^2) avoids a cosf of the pitch target
+    const float cos_pitch_target = 1.0f / sqrtf(1.0f + sq(pitch_tan));
+    roll_target = accel_to_angle((accel_right_cmss * cos_pitch_target)*0.01) * 100;
+}
+
+// get_lean_angle_accel_max_cmss - returns the maximum horizontal acceleration allowed by the lean angle limits in cm/s/s
+// the tangent is only recalculated when the lean angle limit changes
+float AC_PosControl::get_lean_angle_accel_max_cmss()
+{
+    const float angle_max_cd = MIN(_attitude_control.get_althold_lean_angle_max_cd(), get_lean_angle_max_cd());
+    if (!is_equal(angle_max_cd, _accel_max_angle_cd)) {
+        _accel_max_angle_cd = angle_max_cd;
+        _accel_max_from_angle_cmss = angle_to_accel(angle_max_cd * 0.01) * 100.0;
+    }
+    return _accel_max_from_angle_cmss;
 }
 
 // lean_angles_to_accel_xy - convert roll, pitch lean target angles to NE frame accelerations in cm/s/s
@@ -419,6 +419,12 @@ protected:
     // lean_angles_to_accel - convert roll, pitch lean angles to lat/lon frame accelerations in cm/s/s
     void accel_to_lean_angles(float accel_x_cmss, float accel_y_cmss, float& roll_target, float& pitch_target) const;
 
+    // accel_fr_to_lean_angles - convert body frame forward and right accelerations in cm/s/s to roll, pitch lean angles
+    void accel_fr_to_lean_angles(float accel_forward_cmss, float accel_right_cmss, float& roll_target, float& pitch_target) const;
+
+    // get_lean_angle_accel_max_cmss - returns the maximum horizontal acceleration allowed by the lean angle limits in cm/s/s
+    float get_lean_angle_accel_max_cmss();
+
     // lean_angles_to_accel - convert roll, pitch lean angles to lat/lon frame accelerations in cm/s/s
     void lean_angles_to_accel_xy(float& accel_x_cmss, float& accel_y_cmss) const;
 
@@ -496,6 +502,10 @@ protected:
     // angle max override, if zero then use ANGLE_MAX parameter
     float       _angle_max_override_cd;
 
+    // horizontal acceleration limit calculated from the lean angle limit, only recalculated when the lean angle limit changes
+    float       _accel_max_angle_cd;        // lean angle limit used to calculate _accel_max_from_angle_cmss
+    float       _accel_max_from_angle_cmss; // horizontal acceleration limit in cm/s/s
+
     // return true if on a real vehicle or SITL with lock-step scheduling
     bool has_good_timing(void) const;
 
@@ -0,0 +1,149 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_AHRS/AP_AHRS_View.h>
+#include <AP_InertialNav/AP_InertialNav.h>
+#include <AP_Motors/AP_MotorsMatrix.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <AC_AttitudeControl/AC_AttitudeControl_Multi.h>
+#include <AC_AttitudeControl/AC_PosControl.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+/*
+  position controller with a copy of update_xy_controller() as it was
+  before the lean angle acceleration limit was cached and the
+  acceleration target rotated once
+ */
+class BenchPosControl : public AC_PosControl {
+public:
+    using AC_PosControl::AC_PosControl;
+    void update_xy_controller_old();
+};
+
+void BenchPosControl::update_xy_controller_old()
+{
+    handle_ekf_xy_reset();
+    if (!is_active_xy()) {
+        init_xy_controller();
+    }
+    _last_update_xy_ticks = AP::scheduler().ticks32();
+
+    float ahrsGndSpdLimit, ahrsControlScaleXY;
+    AP::ahrs().getControlLimits(ahrsGndSpdLimit, ahrsControlScaleXY);
+
+    // Position Controller
+
+    const Vector3f &curr_pos = _inav.get_position_neu_cm();
+    Vector3f comb_pos = curr_pos;
+    comb_pos.xy() += _disturb_pos;
+    Vector2f vel_target = _p_pos_xy.update_all(_pos_target.x, _pos_target.y, comb_pos);
+
+    vel_target *= ahrsControlScaleXY;
+    _vel_target.xy() = vel_target;
+    _vel_target.xy() += _vel_desired.xy();
+
+    // Velocity Controller
+
+    const Vector2f &curr_vel = _inav.get_velocity_xy_cms();
+    Vector2f comb_vel = curr_vel;
+    comb_vel += _disturb_vel;
+    Vector2f accel_target = _pid_vel_xy.update_all(_vel_target.xy(), comb_vel, _dt, _limit_vector.xy());
+
+    accel_target *= ahrsControlScaleXY;
+    _accel_target.xy() = accel_target;
+    _accel_target.xy() += _accel_desired.xy();
+
+    // Acceleration Controller
+
+    float angle_max = MIN(_attitude_control.get_althold_lean_angle_max_cd(), get_lean_angle_max_cd());
+    float accel_max = angle_to_accel(angle_max * 0.01) * 100;
+    _limit_vector.xy() = _accel_target.xy();
+    if (!limit_accel_xy(_vel_desired.xy(), _accel_target.xy(), accel_max)) {
+        _limit_vector.xy().zero();
+    } else {
+        const float accel_fwd_unlimited = _limit_vector.x * _ahrs.cos_yaw() + _limit_vector.y * _ahrs.sin_yaw();
+        const float pitch_target_unlimited = accel_to_angle(- MIN(accel_fwd_unlimited, accel_max) * 0.01f) * 100;
+        const float accel_fwd_limited = _accel_target.x * _ahrs.cos_yaw() + _accel_target.y * _ahrs.sin_yaw();
+        const float pitch_target_limited = accel_to_angle(- accel_fwd_limited * 0.01f) * 100;
+        _fwd_pitch_is_limited = is_negative(pitch_target_unlimited) && pitch_target_unlimited < pitch_target_limited;
+    }
+
+    const float accel_forward = _accel_target.x * _ahrs.cos_yaw() + _accel_target.y * _ahrs.sin_yaw();
+    const float accel_right = -_accel_target.x * _ahrs.sin_yaw() + _accel_target.y * _ahrs.cos_yaw();
+    _pitch_target = accel_to_angle(-accel_forward * 0.01) * 100;
+    float cos_pitch_target = cosf(_pitch_target * M_PI / 18000.0f);
+    _roll_target = accel_to_angle((accel_right * cos_pitch_target)*0.01) * 100;
+
+    calculate_yaw_and_rate_yaw();
+
+    _disturb_pos.zero();
+    _disturb_vel.zero();
+}
+
+class DummyVehicle {
+public:
+    AP_Scheduler scheduler;
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+    AP_AHRS_View ahrs_view{ahrs, ROTATION_NONE};
+    AP_InertialNav inertial_nav{ahrs};
+    AP_MotorsMatrix motors{400};
+    AP_MultiCopter aparm;
+    AC_AttitudeControl_Multi attitude_control{ahrs_view, aparm, motors};
+    BenchPosControl pos_control{ahrs_view, inertial_nav, motors, attitude_control};
+};
+
+static DummyVehicle vehicle;
+
+/*
+  move the position target around a circle with the radius in cm
+  given by the benchmark argument. A small circle keeps the
+  acceleration within the lean angle limit, a large one is limited
+  on every loop
+ */
+static void move_target(BenchPosControl &pos_control, float radius_cm, float &angle)
+{
+    pos_control.set_pos_target_xy_cm(radius_cm * cosf(angle), radius_cm * sinf(angle));
+    angle = wrap_2PI(angle + 0.001f);
+}
+
+static void BM_UpdateXYControllerOld(benchmark::State& state)
+{
+    BenchPosControl &pos_control = vehicle.pos_control;
+    const float radius_cm = state.range(0);
+    float angle = 0;
+
+    pos_control.init_xy_controller();
+    while (state.KeepRunning()) {
+        move_target(pos_control, radius_cm, angle);
+        pos_control.update_xy_controller_old();
+        float roll = pos_control.get_roll_cd();
+        gbenchmark_escape(&roll);
+    }
+}
+
+static void BM_UpdateXYController(benchmark::State& state)
+{
+    BenchPosControl &pos_control = vehicle.pos_control;
+    const float radius_cm = state.range(0);
+    float angle = 0;
+
+    pos_control.init_xy_controller();
+    while (state.KeepRunning()) {
+        move_target(pos_control, radius_cm, angle);
+        pos_control.update_xy_controller();
+        float roll = pos_control.get_roll_cd();
+        gbenchmark_escape(&roll);
+    }
+}
+
+BENCHMARK(BM_UpdateXYControllerOld)->Arg(100)->Arg(5000);
+BENCHMARK(BM_UpdateXYController)->Arg(100)->Arg(5000);
+
+BENCHMARK_MAIN();
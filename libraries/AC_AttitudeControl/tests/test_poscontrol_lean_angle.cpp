@@ -0,0 +1,121 @@
+#include <AP_gtest.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_AHRS/AP_AHRS_View.h>
+#include <AP_InertialNav/AP_InertialNav.h>
+#include <AP_Motors/AP_MotorsMatrix.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <AC_AttitudeControl/AC_AttitudeControl_Multi.h>
+#include <AC_AttitudeControl/AC_PosControl.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+// motors with the maximum throttle thrust set directly instead of by spooling up
+class TestMotors : public AP_MotorsMatrix {
+public:
+    TestMotors() : AP_MotorsMatrix(400) {}
+    void set_throttle_thrust_max(float thr_max) { _throttle_thrust_max = thr_max; }
+};
+
+// attitude controller with the althold lean angle filter disabled
+class TestAttitudeControl : public AC_AttitudeControl_Multi {
+public:
+    using AC_AttitudeControl_Multi::AC_AttitudeControl_Multi;
+    void disable_angle_limit_filter() { _angle_limit_tc.set(0); }
+};
+
+// expose the cached lean angle acceleration limit and the lean angle conversion
+class TestPosControl : public AC_PosControl {
+public:
+    using AC_PosControl::AC_PosControl;
+    using AC_PosControl::get_lean_angle_accel_max_cmss;
+    using AC_PosControl::accel_fr_to_lean_angles;
+};
+
+class DummyVehicle {
+public:
+    AP_Scheduler scheduler;
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+    AP_AHRS_View ahrs_view{ahrs, ROTATION_NONE};
+    AP_InertialNav inertial_nav{ahrs};
+    TestMotors motors;
+    AP_MultiCopter aparm;
+    TestAttitudeControl attitude_control{ahrs_view, aparm, motors};
+    TestPosControl pos_control{ahrs_view, inertial_nav, motors, attitude_control};
+};
+
+static DummyVehicle vehicle;
+
+// the althold lean angle limit in centi-degrees as calculated by AC_AttitudeControl_Multi
+static float althold_lean_angle_max_cd(float throttle, float thr_max, float limit_min_cd)
+{
+    if (is_zero(thr_max)) {
+        return limit_min_cd;
+    }
+    const float angle_rad = acosf(constrain_float(throttle / (AC_ATTITUDE_CONTROL_ANGLE_LIMIT_THROTTLE_MAX * thr_max), 0.0f, 1.0f));
+    return MAX(degrees(angle_rad) * 100.0f, limit_min_cd);
+}
+
+// the cached acceleration limit must follow every change of throttle, ANGLE_MAX and the lean angle override
+TEST(AC_PosControl, lean_angle_accel_max)
+{
+    TestAttitudeControl &attitude_control = vehicle.attitude_control;
+    TestPosControl &pos_control = vehicle.pos_control;
+
+    attitude_control.disable_angle_limit_filter();
+    attitude_control.set_dt(0.0025f);
+
+    // the lowest althold lean angle limit, reached at or above the throttle limit
+    vehicle.motors.set_throttle_thrust_max(1.0f);
+    attitude_control.set_throttle_out(1.0f, false, 0.0f);
+    const float limit_min_cd = attitude_control.get_althold_lean_angle_max_cd();
+
+    const float thr_maxes[] { 0.0f, 0.5f, 1.0f };
+    const float overrides_cd[] { 0.0f, 1500.0f, 4500.0f };
+    for (const float thr_max : thr_maxes) {
+        vehicle.motors.set_throttle_thrust_max(thr_max);
+        for (const float override_cd : overrides_cd) {
+            pos_control.set_lean_angle_max_cd(override_cd);
+            for (int16_t angle_max_cd = 1000; angle_max_cd <= 8000; angle_max_cd += 500) {
+                vehicle.aparm.angle_max.set(angle_max_cd);
+                for (float throttle = 0.0f; throttle <= 1.0f; throttle += 0.02f) {
+                    attitude_control.set_throttle_out(throttle, false, 0.0f);
+
+                    const float lean_angle_max_cd = is_positive(override_cd) ? override_cd : angle_max_cd;
+                    const float angle_cd = MIN(althold_lean_angle_max_cd(throttle, thr_max, limit_min_cd), lean_angle_max_cd);
+                    const float expected_cmss = angle_to_accel(angle_cd * 0.01) * 100.0;
+
+                    // twice so both a recalculation and a cached read are checked
+                    EXPECT_FLOAT_EQ(expected_cmss, pos_control.get_lean_angle_accel_max_cmss());
+                    EXPECT_FLOAT_EQ(expected_cmss, pos_control.get_lean_angle_accel_max_cmss());
+                }
+            }
+        }
+    }
+    pos_control.set_lean_angle_max_cd(0.0f);
+}
+
+// the 1/sqrt(1+tan^2) identity must match the lean angles from cosf of the pitch target
+TEST(AC_PosControl, accel_fr_to_lean_angles)
+{
+    for (float accel_forward = -3000.0f; accel_forward <= 3000.0f; accel_forward += 125.0f) {
+        for (float accel_right = -3000.0f; accel_right <= 3000.0f; accel_right += 125.0f) {
+            const float pitch_expected = accel_to_angle(-accel_forward * 0.01f) * 100;
+            const float cos_pitch = cosf(pitch_expected * M_PI / 18000.0f);
+            const float roll_expected = accel_to_angle((accel_right * cos_pitch) * 0.01f) * 100;
+
+            float roll, pitch;
+            vehicle.pos_control.accel_fr_to_lean_angles(accel_forward, accel_right, roll, pitch);
+            EXPECT_NEAR(pitch_expected, pitch, 0.005f);
+            EXPECT_NEAR(roll_expected, roll, 0.005f);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
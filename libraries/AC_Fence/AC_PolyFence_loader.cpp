@@ -241,7 +241,7 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
         const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (boundary.index_lla.outside(pos)) {
             num_inclusion_outside++;
         }
     }
@@ -249,17 +249,24 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     // check we are outside each exclusion zone:
     for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
         const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (!boundary.index_lla.outside(pos)) {
             return true;
         }
     }
 
+    // distances to circle centers are all measured from loc, the
+    // projection only pays for its setup with two or more circles
+    const bool use_proj = _num_loaded_circle_exclusion_boundaries + _num_loaded_circle_inclusion_boundaries >= 2;
+    LocationProjection proj;
+    if (use_proj) {
+        proj.set_origin(loc);
+    }
     for (uint8_t i=0; i<_num_loaded_circle_exclusion_boundaries; i++) {
         const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[i];
         Location circle_center;
         circle_center.lat = circle.point.x;
         circle_center.lng = circle.point.y;
-        const float diff_cm = loc.get_distance(circle_center)*100.0f;
+        const float diff_cm = (use_proj ? proj.get_distance(circle_center) : loc.get_distance(circle_center))*100.0f;
         if (diff_cm < circle.radius * 100.0f) {
             return true;
         }
@@ -270,7 +277,7 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
         Location circle_center;
         circle_center.lat = circle.point.x;
         circle_center.lng = circle.point.y;
-        const float diff_cm = loc.get_distance(circle_center)*100.0f;
+        const float diff_cm = (use_proj ? proj.get_distance(circle_center) : loc.get_distance(circle_center))*100.0f;
         if (diff_cm > circle.radius * 100.0f) {
             num_inclusion_outside++;
         }
@@ -321,30 +328,30 @@ bool AC_PolyFence_loader::format()
     return write_eos_to_storage(offset);
 }
 
-bool AC_PolyFence_loader::scale_latlon_from_origin(const Location &origin, const Vector2l &point, Vector2f &pos_cm)
+bool AC_PolyFence_loader::scale_latlon_from_origin(const LocationProjection &origin, const Vector2l &point, Vector2f &pos_cm)
 {
-    Location tmp_loc;
-    tmp_loc.lat = point.x;
-    tmp_loc.lng = point.y;
-    pos_cm = origin.get_distance_NE(tmp_loc) * 100.0f;
+    origin.get_distance_NE(&point, &pos_cm, 1);
+    pos_cm *= 100.0f;
     return true;
 }
 
-bool AC_PolyFence_loader::read_polygon_from_storage(const Location &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla)
+bool AC_PolyFence_loader::read_polygon_from_storage(const LocationProjection &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla)
 {
     for (uint8_t i=0; i<vertex_count; i++) {
         // read from storage to lat/lon
-        if (!read_latlon_from_storage(read_offset, *next_storage_point_lla)) {
-            return false;
-        }
-        // convert lat/lon to position in cm from origin
-        if (!scale_latlon_from_origin(origin, *next_storage_point_lla, *next_storage_point)) {
+        if (!read_latlon_from_storage(read_offset, next_storage_point_lla[i])) {
             return false;
         }
-        
-        next_storage_point_lla++;
-        next_storage_point++;
     }
+
+    // convert the lat/lons to positions in cm from origin
+    origin.get_distance_NE(next_storage_point_lla, next_storage_point, vertex_count);
+    for (uint8_t i=0; i<vertex_count; i++) {
+        next_storage_point[i] *= 100.0f;
+    }
+
+    next_storage_point_lla += vertex_count;
+    next_storage_point += vertex_count;
     return true;
 }
 
@@ -632,6 +639,9 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return true;
     }
 
+    // every loaded point is converted to an offset from the EKF origin
+    const LocationProjection origin_proj { ekf_origin };
+
     { // allocate array to hold offsets-from-origin
         const uint16_t count = sum_of_polygon_point_counts_and_returnpoint();
         Debug("Fence: Allocating %u bytes for points",
@@ -728,11 +738,13 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(ekf_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
+            if (!read_polygon_from_storage(origin_proj, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index_lla.init(boundary.points_lla, boundary.count);
+            boundary.index.init(boundary.points, boundary.count);
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -747,11 +759,13 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(ekf_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
+            if (!read_polygon_from_storage(origin_proj, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index_lla.init(boundary.points_lla, boundary.count);
+            boundary.index.init(boundary.points, boundary.count);
             _num_loaded_exclusion_boundaries++;
             break;
         }
@@ -763,7 +777,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
-            if (!scale_latlon_from_origin(ekf_origin, circle.point, circle.pos_cm)) {
+            if (!scale_latlon_from_origin(origin_proj, circle.point, circle.pos_cm)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: latlon read failed");
                 storage_valid = false;
                 break;
@@ -790,7 +804,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
-            if (!scale_latlon_from_origin(ekf_origin, circle.point, circle.pos_cm)){
+            if (!scale_latlon_from_origin(origin_proj, circle.point, circle.pos_cm)){
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: latlon read failed");
                 storage_valid = false;
                 break;
@@ -828,7 +842,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "PolyFence: latlon read failed");
                 break;
             }
-            if (!scale_latlon_from_origin(ekf_origin, *next_storage_point_lla, *next_storage_point)) {
+            if (!scale_latlon_from_origin(origin_proj, *next_storage_point_lla, *next_storage_point)) {
                 storage_valid = false;
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "PolyFence: latlon read failed");
                 break;
@@ -879,6 +893,23 @@ Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &n
     return boundary.points;
 }
 
+/// returns true if the line segment from p1 to p2 crosses an edge of
+/// any inclusion or exclusion polygon
+bool AC_PolyFence_loader::polygon_edges_intersect(const Vector2f &p1, const Vector2f &p2) const
+{
+    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
+        if (_loaded_inclusion_boundary[i].index.intersects(p1, p2)) {
+            return true;
+        }
+    }
+    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
+        if (_loaded_exclusion_boundary[i].index.intersects(p1, p2)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /// returns the specified exclusion circle
 /// circle center offsets in cm from EKF origin in NE frame, radius is in meters
 bool AC_PolyFence_loader::get_exclusion_circle(uint8_t index, Vector2f &center_pos_cm, float &radius) const
@@ -1648,6 +1679,7 @@ bool AC_PolyFence_loader::get_item(const uint16_t seq, AC_PolyFenceItem &item) {
 
 Vector2f* AC_PolyFence_loader::get_exclusion_polygon(uint16_t index, uint16_t &num_points) const { return nullptr; }
 Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &num_points) const { return nullptr; }
+bool AC_PolyFence_loader::polygon_edges_intersect(const Vector2f &p1, const Vector2f &p2) const { return false; }
 
 bool AC_PolyFence_loader::get_exclusion_circle(uint8_t index, Vector2f &center_pos_cm, float &radius) const { return false; }
 bool AC_PolyFence_loader::get_inclusion_circle(uint8_t index, Vector2f &center_pos_cm, float &radius) const { return false; }
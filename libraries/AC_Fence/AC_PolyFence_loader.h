@@ -92,6 +92,11 @@ public:
         return _load_time_ms;
     }
 
+    /// returns true if the line segment from p1 to p2 crosses an edge of
+    /// any inclusion or exclusion polygon
+    /// points are offsets in cm from EKF origin in NE frame
+    bool polygon_edges_intersect(const Vector2f &p1, const Vector2f &p2) const WARN_IF_UNUSED;
+
     ///
     /// exclusion circles
     ///
@@ -287,6 +292,8 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla array
         uint8_t count; // count of points in the boundary
+        PolygonIndex<int32_t> index_lla; // speeds up breached() on large polygons
+        PolygonIndex<float> index; // speeds up polygon_edges_intersect()
     };
     InclusionBoundary *_loaded_inclusion_boundary;
 
@@ -297,6 +304,8 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla_lla array
         uint8_t count; // count of points in the boundary
+        PolygonIndex<int32_t> index_lla; // speeds up breached() on large polygons
+        PolygonIndex<float> index; // speeds up polygon_edges_intersect()
     };
     ExclusionBoundary *_loaded_exclusion_boundary;
 
@@ -341,7 +350,7 @@ private:
     // scale_latlon_from_origin - given a latitude/longitude
     // transforms the point to an offset-from-origin and deposits
     // the result into pos_cm.
-    bool scale_latlon_from_origin(const Location &origin,
+    bool scale_latlon_from_origin(const LocationProjection &origin,
                                   const Vector2l &point,
                                   Vector2f &pos_cm) WARN_IF_UNUSED;
    
@@ -349,7 +358,7 @@ private:
     // latitude/longitude points from offset in permanent storage,
     // transforms them into an offset-from-origin and deposits the
     // results into next_storage_point.
-    bool read_polygon_from_storage(const Location &origin,
+    bool read_polygon_from_storage(const LocationProjection &origin,
                                    uint16_t &read_offset,
                                    const uint8_t vertex_count,
                                    Vector2f *&next_storage_point,
@@ -185,6 +185,9 @@ void AC_WPNav::wp_and_spline_init(float speed_cms, Vector3f stopping_point)
     _scurve_prev_leg.init();
     _scurve_this_leg.init();
     _scurve_next_leg.init();
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    clear_wp_destination_lookahead();
+#endif
     _track_scalar_dt = 1.0f;
 
     _flags.reached_destination = true;
@@ -338,10 +341,7 @@ bool AC_WPNav::set_wp_destination(const Vector3f& destination, bool terrain_alt)
     if (_flags.fast_waypoint && !_this_leg_is_spline && !_next_leg_is_spline && !_scurve_next_leg.finished()) {
         _scurve_this_leg = _scurve_next_leg;
     } else {
-        _scurve_this_leg.calculate_track(_origin, _destination,
-                                         _pos_control.get_max_speed_xy_cms(), _pos_control.get_max_speed_up_cms(), _pos_control.get_max_speed_down_cms(),
-                                         get_wp_acceleration(), _wp_accel_z_cmss,
-                                         _scurve_snap * 100.0f, _scurve_jerk * 100.0f);
+        calculate_scurve_leg(_scurve_this_leg, _origin, _destination);
         if (!is_zero(origin_speed)) {
             // rebuild start of scurve if we have a non-zero origin speed
             _scurve_this_leg.set_origin_speed_max(origin_speed);
@@ -367,10 +367,14 @@ bool AC_WPNav::set_wp_destination_next(const Vector3f& destination, bool terrain
         return true;
     }
 
-    _scurve_next_leg.calculate_track(_destination, destination,
-                                     _pos_control.get_max_speed_xy_cms(), _pos_control.get_max_speed_up_cms(), _pos_control.get_max_speed_down_cms(),
-                                     get_wp_acceleration(), _wp_accel_z_cmss,
-                                     _scurve_snap * 100.0f, _scurve_jerk * 100.0);
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    // use the lookahead leg if it has already been calculated
+    if (!pop_lookahead(_scurve_next_leg, _destination, destination, terrain_alt)) {
+        calculate_scurve_leg(_scurve_next_leg, _destination, destination);
+    }
+#else
+    calculate_scurve_leg(_scurve_next_leg, _destination, destination);
+#endif
     if (_this_leg_is_spline) {
         const float this_leg_dest_speed_max = _spline_this_leg.get_destination_speed_max();
         const float next_leg_origin_speed_max = _scurve_next_leg.set_origin_speed_max(this_leg_dest_speed_max);
@@ -387,6 +391,62 @@ bool AC_WPNav::set_wp_destination_next(const Vector3f& destination, bool terrain
     return true;
 }
 
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+/// set a straight line destination to be flown after the next destination using location class
+///     returns false if conversion from location to vector from ekf origin cannot be calculated or the lookahead is full
+bool AC_WPNav::set_wp_destination_lookahead_loc(uint8_t index, const Location& destination)
+{
+    bool terr_alt;
+    Vector3f dest_neu;
+
+    // convert destination location to vector
+    if (!get_vector_NEU(destination, dest_neu, terr_alt)) {
+        return false;
+    }
+
+    return set_wp_destination_lookahead(index, dest_neu, terr_alt);
+}
+
+/// set a straight line destination to be flown after the next destination using position vector (distance from ekf origin in cm)
+///     index 0 is the destination after the next destination
+///     terrain_alt should be true if destination.z is a desired altitude above terrain
+///     the leg's scurve is calculated later from update_wpnav
+bool AC_WPNav::set_wp_destination_lookahead(uint8_t index, const Vector3f& destination, bool terrain_alt)
+{
+    // lookahead legs must follow a straight line next leg in the same altitude frame
+    if (!_flags.fast_waypoint || _next_leg_is_spline || (terrain_alt != _terrain_alt)) {
+        return false;
+    }
+    if ((index > _lookahead_count) || (index >= ARRAY_SIZE(_lookahead))) {
+        return false;
+    }
+
+    // new leg starts at the previous lookahead destination or the next destination
+    Vector3f origin = _next_destination;
+    if (index > 0) {
+        origin = _lookahead[(_lookahead_head + index - 1) % ARRAY_SIZE(_lookahead)].destination;
+    }
+
+    LookaheadLeg &leg = _lookahead[(_lookahead_head + index) % ARRAY_SIZE(_lookahead)];
+    if (index < _lookahead_count) {
+        if ((leg.terrain_alt == terrain_alt) && (leg.origin == origin) && (leg.destination == destination)) {
+            // leg is unchanged
+            return true;
+        }
+        // path has changed, discard this and all later legs
+        _lookahead_count = index;
+    }
+
+    leg.origin = origin;
+    leg.destination = destination;
+    leg.terrain_alt = terrain_alt;
+    leg.calculated = false;
+    _lookahead_count++;
+
+    return true;
+}
+#endif  // AC_WPNAV_LOOKAHEAD_LEGS > 0
+
 /// set waypoint destination using NED position vector from ekf origin in meters
 bool AC_WPNav::set_wp_destination_NED(const Vector3f& destination_NED)
 {
@@ -574,6 +634,13 @@ void AC_WPNav::update_track_with_speed_accel_limits()
     } else {
         _scurve_next_leg.set_speed_max(_pos_control.get_max_speed_xy_cms(), _pos_control.get_max_speed_up_cms(), _pos_control.get_max_speed_down_cms());
     }
+
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    // lookahead legs are recalculated with the new limits from update_wpnav
+    for (uint8_t i = 0; i < _lookahead_count; i++) {
+        _lookahead[(_lookahead_head + i) % ARRAY_SIZE(_lookahead)].calculated = false;
+    }
+#endif
 }
 
 /// get_wp_distance_to_destination - get horizontal distance to destination in cm
@@ -588,6 +655,15 @@ int32_t AC_WPNav::get_wp_bearing_to_destination() const
     return get_bearing_cd(_inav.get_position_xy_cm(), _destination.xy());
 }
 
+/// get_wp_time_remaining_s - estimate the time in seconds to reach the destination along the current leg
+float AC_WPNav::get_wp_time_remaining_s() const
+{
+    if (_this_leg_is_spline) {
+        return _spline_this_leg.get_time_remaining(_pos_control.get_vel_desired_cms().length());
+    }
+    return _scurve_this_leg.get_time_remaining();
+}
+
 /// update_wpnav - run the wp controller - should be called at 100hz or higher
 bool AC_WPNav::update_wpnav()
 {
@@ -616,6 +692,11 @@ bool AC_WPNav::update_wpnav()
 
     _pos_control.update_xy_controller();
 
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    // calculate upcoming legs ahead of time
+    update_lookahead();
+#endif
+
     _wp_last_update = AP_HAL::millis();
 
     return ret;
@@ -924,3 +1005,55 @@ void AC_WPNav::calc_scurve_jerk_and_snap()
     // reduce maximum snap by a factor of two from what the aircraft is capable of
     _scurve_snap *= 0.5;
 }
+
+// calculate a single straight line scurve between origin and destination using the current speed and acceleration limits
+void AC_WPNav::calculate_scurve_leg(SCurve &scurve, const Vector3f &origin, const Vector3f &destination)
+{
+    scurve.calculate_track(origin, destination,
+                           _pos_control.get_max_speed_xy_cms(), _pos_control.get_max_speed_up_cms(), _pos_control.get_max_speed_down_cms(),
+                           get_wp_acceleration(), _wp_accel_z_cmss,
+                           _scurve_snap * 100.0f, _scurve_jerk * 100.0f);
+}
+
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+// calculate the scurve of at most one lookahead leg
+// called from update_wpnav so that the cost of calculating upcoming legs is spread over many loops
+// instead of occurring when the vehicle reaches a waypoint
+void AC_WPNav::update_lookahead()
+{
+    for (uint8_t i = 0; i < _lookahead_count; i++) {
+        LookaheadLeg &leg = _lookahead[(_lookahead_head + i) % ARRAY_SIZE(_lookahead)];
+        if (!leg.calculated) {
+            calculate_scurve_leg(leg.scurve, leg.origin, leg.destination);
+            leg.calculated = true;
+            return;
+        }
+    }
+}
+
+// pop the first lookahead leg into scurve if it runs from origin to destination
+// returns false and clears the lookahead if the first leg does not match (e.g. the mission or object avoidance changed the path)
+bool AC_WPNav::pop_lookahead(SCurve &scurve, const Vector3f &origin, const Vector3f &destination, bool terrain_alt)
+{
+    if (_lookahead_count == 0) {
+        return false;
+    }
+
+    LookaheadLeg &leg = _lookahead[_lookahead_head];
+    if ((leg.terrain_alt != terrain_alt) || (leg.origin != origin) || (leg.destination != destination)) {
+        clear_wp_destination_lookahead();
+        return false;
+    }
+
+    // calculate now if update_wpnav has not yet had a chance to
+    if (leg.calculated) {
+        scurve = leg.scurve;
+    } else {
+        calculate_scurve_leg(scurve, origin, destination);
+    }
+    _lookahead_head = (_lookahead_head + 1) % ARRAY_SIZE(_lookahead);
+    _lookahead_count--;
+
+    return true;
+}
+#endif  // AC_WPNAV_LOOKAHEAD_LEGS > 0
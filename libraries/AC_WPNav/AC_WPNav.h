@@ -11,6 +11,7 @@
 #include <AC_AttitudeControl/AC_AttitudeControl.h> // Attitude control library
 #include <AP_Terrain/AP_Terrain.h>
 #include <AC_Avoidance/AC_Avoid.h>                 // Stop at fence library
+#include "AC_WPNav_config.h"
 
 // maximum velocities and accelerations
 #define WPNAV_ACCELERATION              250.0f      // maximum horizontal acceleration in cm/s/s that wp navigation will request
@@ -120,6 +121,20 @@ public:
     virtual bool set_wp_destination(const Vector3f& destination, bool terrain_alt = false);
     bool set_wp_destination_next(const Vector3f& destination, bool terrain_alt = false);
 
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    /// set a straight line destination to be flown after the next destination
+    ///     index 0 is the destination after the next destination, index 1 the one after that, etc
+    ///     the leg's scurve is calculated ahead of time from update_wpnav so no calculation is required when the vehicle reaches it
+    ///     setting an index that already holds the same destination keeps the calculated leg, otherwise later legs are discarded
+    ///     destinations must later be provided in the same order using set_wp_destination_next
+    ///     returns false if the index is beyond the end of the lookahead, the next leg is not a straight line or the altitude frame does not match
+    bool set_wp_destination_lookahead_loc(uint8_t index, const Location& destination);
+    bool set_wp_destination_lookahead(uint8_t index, const Vector3f& destination, bool terrain_alt = false);
+
+    /// clear all lookahead destinations
+    void clear_wp_destination_lookahead() { _lookahead_count = 0; }
+#endif
+
     /// set waypoint destination using NED position vector from ekf origin in meters
     ///     provide next_destination_NED if known
     bool set_wp_destination_NED(const Vector3f& destination_NED);
@@ -146,6 +161,9 @@ public:
     /// get_bearing_to_destination - get bearing to next waypoint in centi-degrees
     virtual int32_t get_wp_bearing_to_destination() const;
 
+    /// get_wp_time_remaining_s - estimate the time in seconds to reach the destination along the current leg
+    float get_wp_time_remaining_s() const;
+
     /// reached_destination - true when we have come within RADIUS cm of the waypoint
     virtual bool reached_wp_destination() const { return _flags.reached_destination; }
 
@@ -235,6 +253,18 @@ protected:
     // updates _scurve_jerk and _scurve_snap
     void calc_scurve_jerk_and_snap();
 
+    // calculate a single straight line scurve between origin and destination using the current speed and acceleration limits
+    void calculate_scurve_leg(SCurve &scurve, const Vector3f &origin, const Vector3f &destination);
+
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    // calculate the scurve of at most one lookahead leg.  called from update_wpnav to spread the calculation over many loops
+    void update_lookahead();
+
+    // pop the first lookahead leg into scurve if it runs from origin to destination
+    //     returns false and clears the lookahead if the first leg does not match
+    bool pop_lookahead(SCurve &scurve, const Vector3f &origin, const Vector3f &destination, bool terrain_alt);
+#endif
+
     // references and pointers to external libraries
     const AP_InertialNav&   _inav;
     const AP_AHRS_View&     _ahrs;
@@ -265,6 +295,19 @@ protected:
     float _scurve_jerk;                 // scurve jerk max in m/s/s/s
     float _scurve_snap;                 // scurve snap in m/s/s/s/s
 
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+    // straight line legs beyond the next leg held in a ring buffer
+    struct LookaheadLeg {
+        SCurve scurve;                  // scurve trajectory, only valid if calculated is true
+        Vector3f origin;                // leg origin in cm from ekf origin
+        Vector3f destination;           // leg destination in cm from ekf origin
+        bool terrain_alt;               // true if origin.z and destination.z are alt-above-terrain
+        bool calculated;                // true once scurve has been calculated with the current speed and acceleration limits
+    } _lookahead[AC_WPNAV_LOOKAHEAD_LEGS];
+    uint8_t _lookahead_head;            // index of the first lookahead leg
+    uint8_t _lookahead_count;           // number of lookahead legs
+#endif
+
     // spline curves
     SplineCurve _spline_this_leg;      // spline curve for current segment
     SplineCurve _spline_next_leg;      // spline curve for next segment
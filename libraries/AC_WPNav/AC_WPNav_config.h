@@ -5,3 +5,13 @@
 #ifndef AC_WPNAV_OA_ENABLED
 #define AC_WPNAV_OA_ENABLED AP_OAPATHPLANNER_ENABLED
 #endif
+
+// number of straight line legs beyond the next leg whose scurves are calculated ahead of time
+// each leg costs about 630 bytes of RAM, zero disables the lookahead
+#ifndef AC_WPNAV_LOOKAHEAD_LEGS
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AC_WPNAV_LOOKAHEAD_LEGS 3
+#else
+#define AC_WPNAV_LOOKAHEAD_LEGS 0
+#endif
+#endif
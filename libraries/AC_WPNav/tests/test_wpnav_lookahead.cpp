@@ -0,0 +1,166 @@
+#include <AP_gtest.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_AHRS/AP_AHRS_View.h>
+#include <AP_InertialNav/AP_InertialNav.h>
+#include <AP_Motors/AP_MotorsMatrix.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <AC_AttitudeControl/AC_AttitudeControl_Multi.h>
+#include <AC_AttitudeControl/AC_PosControl.h>
+#include <AC_WPNav/AC_WPNav.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+#if AC_WPNAV_LOOKAHEAD_LEGS > 0
+
+// expose the next leg and the scurve calculation
+class TestWPNav : public AC_WPNav {
+public:
+    using AC_WPNav::AC_WPNav;
+    using AC_WPNav::update_lookahead;
+    using AC_WPNav::calculate_scurve_leg;
+    const SCurve &next_leg() const { return _scurve_next_leg; }
+};
+
+class DummyVehicle {
+public:
+    AP_Scheduler scheduler;
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+    AP_AHRS_View ahrs_view{ahrs, ROTATION_NONE};
+    AP_InertialNav inertial_nav{ahrs};
+    AP_MotorsMatrix motors{400};
+    AP_MultiCopter aparm;
+    AC_AttitudeControl_Multi attitude_control{ahrs_view, aparm, motors};
+    AC_PosControl pos_control{ahrs_view, inertial_nav, motors, attitude_control};
+    TestWPNav wp_nav{inertial_nav, ahrs_view, pos_control, attitude_control};
+};
+
+static DummyVehicle vehicle;
+
+// straight line waypoints the vehicle passes through without stopping, in cm from the ekf origin
+static const Vector3f waypoints[] {
+    {0, 0, 1000},
+    {5000, 0, 1000},
+    {5000, 8000, 1500},
+    {-2000, 8000, 1500},
+    {-2000, -3000, 800},
+    {1000, -1000, 2000},
+};
+static const uint8_t num_waypoints = ARRAY_SIZE(waypoints);
+
+// both paths must give the same position, velocity and acceleration along their length
+static void expect_scurve_eq(const SCurve &expected, const SCurve &scurve)
+{
+    const uint16_t num_samples = 50;
+    EXPECT_FLOAT_EQ(expected.time_end(), scurve.time_end());
+
+    // move_from_time_pos_vel_accel() is not const so sample copies
+    SCurve expected_copy = expected;
+    SCurve scurve_copy = scurve;
+    for (uint16_t i = 0; i < num_samples; i++) {
+        const float time = expected.time_end() * i / (num_samples - 1);
+        Vector3f pos_expected, vel_expected, accel_expected;
+        Vector3f pos, vel, accel;
+        expected_copy.move_from_time_pos_vel_accel(time, pos_expected, vel_expected, accel_expected);
+        scurve_copy.move_from_time_pos_vel_accel(time, pos, vel, accel);
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            EXPECT_FLOAT_EQ(pos_expected[axis], pos[axis]);
+            EXPECT_FLOAT_EQ(vel_expected[axis], vel[axis]);
+            EXPECT_FLOAT_EQ(accel_expected[axis], accel[axis]);
+        }
+    }
+}
+
+// start a mission at the first waypoint with the second as the next destination
+static void start(TestWPNav &wp_nav)
+{
+    wp_nav.wp_and_spline_init(0.0f, waypoints[0]);
+    EXPECT_TRUE(wp_nav.set_wp_destination(waypoints[1]));
+    EXPECT_TRUE(wp_nav.set_wp_destination_next(waypoints[2]));
+}
+
+// the vehicle reaches waypoint i, which makes waypoint i+1 the next destination
+static void advance(TestWPNav &wp_nav, uint8_t i)
+{
+    EXPECT_TRUE(wp_nav.set_wp_destination(waypoints[i]));
+    EXPECT_TRUE(wp_nav.set_wp_destination_next(waypoints[i+1]));
+}
+
+// the scurve calculated when the vehicle reaches a waypoint
+static void expect_next_leg(TestWPNav &wp_nav, uint8_t i)
+{
+    SCurve expected;
+    wp_nav.calculate_scurve_leg(expected, waypoints[i], waypoints[i+1]);
+    expect_scurve_eq(expected, wp_nav.next_leg());
+}
+
+// legs calculated ahead of time match the legs calculated on demand
+TEST(AC_WPNav, lookahead_matches_on_demand)
+{
+    TestWPNav &wp_nav = vehicle.wp_nav;
+
+    start(wp_nav);
+    for (uint8_t i = 0; i < AC_WPNAV_LOOKAHEAD_LEGS && i+3 < num_waypoints; i++) {
+        EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(i, waypoints[i+3]));
+    }
+    for (uint8_t i = 0; i < AC_WPNAV_LOOKAHEAD_LEGS; i++) {
+        wp_nav.update_lookahead();
+    }
+
+    for (uint8_t i = 2; i+1 < num_waypoints; i++) {
+        advance(wp_nav, i);
+        expect_next_leg(wp_nav, i);
+    }
+}
+
+// legs not yet calculated, or invalidated by a speed change, are calculated when popped
+TEST(AC_WPNav, lookahead_not_calculated)
+{
+    TestWPNav &wp_nav = vehicle.wp_nav;
+
+    start(wp_nav);
+    EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(0, waypoints[3]));
+    EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(1, waypoints[4]));
+    wp_nav.update_lookahead();
+    wp_nav.update_lookahead();
+    wp_nav.set_speed_xy(750.0f);
+
+    // first leg recalculated with the new speed, second leg left to the pop
+    wp_nav.update_lookahead();
+    advance(wp_nav, 2);
+    expect_next_leg(wp_nav, 2);
+    advance(wp_nav, 3);
+    expect_next_leg(wp_nav, 3);
+}
+
+// a change of path discards the lookahead and the leg is calculated on demand
+TEST(AC_WPNav, lookahead_path_change)
+{
+    TestWPNav &wp_nav = vehicle.wp_nav;
+
+    start(wp_nav);
+    EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(0, waypoints[4]));
+    wp_nav.update_lookahead();
+
+    advance(wp_nav, 2);
+    expect_next_leg(wp_nav, 2);
+
+    // a replaced leg no longer matches the mission when the vehicle gets there
+    EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(0, waypoints[4]));
+    EXPECT_TRUE(wp_nav.set_wp_destination_lookahead(0, waypoints[5]));
+    EXPECT_FALSE(wp_nav.set_wp_destination_lookahead(2, waypoints[5]));
+    wp_nav.update_lookahead();
+    EXPECT_TRUE(wp_nav.set_wp_destination(waypoints[3]));
+    EXPECT_TRUE(wp_nav.set_wp_destination_next(waypoints[4]));
+    expect_next_leg(wp_nav, 3);
+}
+
+#endif  // AC_WPNAV_LOOKAHEAD_LEGS > 0
+
+AP_GTEST_MAIN()
@@ -447,11 +447,19 @@ void AP_ADSB::determine_furthest_aircraft(void)
     float max_distance = 0;
     uint16_t max_distance_index = 0;
 
+    // the projection only pays for its setup with two or more vehicles
+    const bool use_proj = in_state.vehicle_count >= 2;
+    LocationProjection proj;
+    if (use_proj) {
+        proj.set_origin(_my_loc);
+    }
+
     for (uint16_t index = 0; index < in_state.vehicle_count; index++) {
         if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
             continue;
         }
-        const float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
+        const Location loc = get_location(in_state.vehicle_list[index]);
+        const float distance = use_proj ? proj.get_distance(loc) : _my_loc.get_distance(loc);
         if (max_distance < distance || index == 0) {
             max_distance = distance;
             max_distance_index = index;
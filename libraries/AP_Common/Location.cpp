@@ -550,4 +550,79 @@ void Location::linearly_interpolate_alt(const Location &point1, const Location &
     set_alt_cm(point1.alt + (point2.alt - point1.alt) * constrain_float(line_path_proportion(point1, point2), 0.0f, 1.0f), point2.get_alt_frame());
 }
 
+void LocationProjection::set_origin(const Location &origin)
+{
+    _origin = origin;
+    const ftype lat_rad = origin.lat * (1.0e-7 * DEG_TO_RAD);
+    _cos_lat = cosF(lat_rad);
+    _sin_lat = sinF(lat_rad);
+}
+
+/*
+  longitude scale at the mid latitude between the origin and a point
+  dlat north of it, as used by Location. For nearby points this
+  expands cos() about the origin latitude to third order
+ */
+ftype LocationProjection::longitude_scale(int32_t dlat) const
+{
+    const ftype d = dlat * (0.5e-7 * DEG_TO_RAD);
+    ftype scale;
+    if (fabsF(d) < 0.02) {
+        // error is below 1e-8 of the scale away from the poles
+        const ftype d2 = d * d;
+        scale = _cos_lat * (1 - 0.5 * d2) - _sin_lat * d * (1 - d2 * (1.0/6));
+    } else {
+        scale = cosF(_origin.lat * (1.0e-7 * DEG_TO_RAD) + d);
+    }
+    return MAX(scale, 0.01);
+}
+
+ftype LocationProjection::get_distance(const Location &loc) const
+{
+    const int32_t dlat = loc.lat - _origin.lat;
+    const ftype dlng = Location::diff_longitude(loc.lng, _origin.lng) * longitude_scale(dlat);
+    return norm(ftype(dlat), dlng) * Location::LOCATION_SCALING_FACTOR;
+}
+
+Vector2f LocationProjection::get_distance_NE(int32_t lat, int32_t lng) const
+{
+    const int32_t dlat = lat - _origin.lat;
+    return Vector2f(dlat * Location::LOCATION_SCALING_FACTOR,
+                    Location::diff_longitude(lng, _origin.lng) * Location::LOCATION_SCALING_FACTOR * longitude_scale(dlat));
+}
+
+Vector2f LocationProjection::get_distance_NE(const Location &loc) const
+{
+    return get_distance_NE(loc.lat, loc.lng);
+}
+
+void LocationProjection::get_distance_NE(const Vector2l *latlngs, Vector2f *ne, uint16_t count) const
+{
+    for (uint16_t i=0; i<count; i++) {
+        ne[i] = get_distance_NE(latlngs[i].x, latlngs[i].y);
+    }
+}
+
+ftype LocationProjection::get_bearing(const Location &loc) const
+{
+    const int32_t dlat = loc.lat - _origin.lat;
+    const ftype off_x = Location::diff_longitude(loc.lng, _origin.lng);
+    const ftype off_y = dlat / longitude_scale(dlat);
+    ftype bearing = (M_PI*0.5) + atan2F(-off_y, off_x);
+    if (bearing < 0) {
+        bearing += 2*M_PI;
+    }
+    return bearing;
+}
+
+Location LocationProjection::offset(ftype ofs_north, ftype ofs_east) const
+{
+    Location loc = _origin;
+    const int32_t dlat = ofs_north * Location::LOCATION_SCALING_FACTOR_INV;
+    const int64_t dlng = (ofs_east * Location::LOCATION_SCALING_FACTOR_INV) / longitude_scale(dlat);
+    loc.lat = Location::limit_lattitude(loc.lat + dlat);
+    loc.lng = Location::wrap_longitude(dlng + loc.lng);
+    return loc;
+}
+
 #endif // HAL_BOOTLOADER_BUILD
@@ -168,6 +168,7 @@ public:
     static int32_t diff_longitude(int32_t lon1, int32_t lon2);
 
 private:
+    friend class LocationProjection;
 
     // scaling factor from 1e-7 degrees to meters at equator
     // == 1.0e-7 * DEG_TO_RAD * RADIUS_OF_EARTH
@@ -175,3 +176,54 @@ private:
     // inverse of LOCATION_SCALING_FACTOR
     static constexpr float LOCATION_SCALING_FACTOR_INV = LATLON_TO_M_INV;
 };
+
+/*
+  local tangent plane projection about a fixed origin. The trig of the
+  origin latitude is computed once, so repeated distance and bearing
+  queries from the same point avoid the cos() in
+  Location::longitude_scale(). Results match the Location methods to
+  within a millimetre plus 1e-6 of the distance up to 100km
+ */
+class LocationProjection
+{
+public:
+    LocationProjection() {}
+    explicit LocationProjection(const Location &origin) {
+        set_origin(origin);
+    }
+
+    void set_origin(const Location &origin);
+    const Location &get_origin(void) const { return _origin; }
+
+    // distance in meters from the origin to loc
+    ftype get_distance(const Location &loc) const;
+
+    // N/E vector in meters from the origin to loc
+    Vector2f get_distance_NE(const Location &loc) const;
+
+    // convert count lat/lng points (x=lat, y=lng, in 1e-7 degrees) to
+    // N/E vectors in meters from the origin
+    void get_distance_NE(const Vector2l *latlngs, Vector2f *ne, uint16_t count) const;
+
+    // bearing in radians from the origin to loc, from 0 to 2*Pi
+    ftype get_bearing(const Location &loc) const;
+
+    // bearing in centi-degrees from the origin to loc, 0 to 35999
+    int32_t get_bearing_to(const Location &loc) const {
+        return int32_t(get_bearing(loc) * DEGX100 + 0.5);
+    }
+
+    // the origin moved by distances (in meters) north and east
+    Location offset(ftype ofs_north, ftype ofs_east) const;
+
+private:
+    // longitude scale at the origin latitude plus dlat/2
+    ftype longitude_scale(int32_t dlat) const;
+
+    // N/E vector in meters from the origin to lat/lng
+    Vector2f get_distance_NE(int32_t lat, int32_t lng) const;
+
+    Location _origin;
+    ftype _cos_lat = 1;
+    ftype _sin_lat = 0;
+};
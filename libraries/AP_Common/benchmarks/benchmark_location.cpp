@@ -0,0 +1,120 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+static const Location origin{-353629380, 1491650850, 0, Location::AltFrame::ABSOLUTE};
+
+// points scattered within a few km of the origin, as for rally
+// points, fence circles or ADSB vehicles
+static Location locs[50];
+static Vector2l latlngs[ARRAY_SIZE(locs)];
+static Vector2f ne[ARRAY_SIZE(locs)];
+
+static void fill_locations(void)
+{
+    for (uint16_t i=0; i<ARRAY_SIZE(locs); i++) {
+        locs[i] = origin;
+        locs[i].offset_bearing(i * 37.0, 100.0 + i * 73.0);
+        latlngs[i] = Vector2l(locs[i].lat, locs[i].lng);
+    }
+}
+
+static void BM_LocationDistance(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+    ftype sum = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<count; i++) {
+            sum += origin.get_distance(locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+static void BM_ProjectionDistance(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+    ftype sum = 0;
+
+    while (state.KeepRunning()) {
+        const LocationProjection proj { origin };
+        for (uint16_t i=0; i<count; i++) {
+            sum += proj.get_distance(locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+static void BM_LocationBearing(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+    int32_t sum = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<count; i++) {
+            sum += origin.get_bearing_to(locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+static void BM_ProjectionBearing(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+    int32_t sum = 0;
+
+    while (state.KeepRunning()) {
+        const LocationProjection proj { origin };
+        for (uint16_t i=0; i<count; i++) {
+            sum += proj.get_bearing_to(locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+static void BM_LocationDistanceNE(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<count; i++) {
+            ne[i] = origin.get_distance_NE(locs[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_ProjectionDistanceNE(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    fill_locations();
+
+    while (state.KeepRunning()) {
+        const LocationProjection proj { origin };
+        proj.get_distance_NE(latlngs, ne, count);
+        gbenchmark_escape(ne);
+    }
+}
+
+BENCHMARK(BM_LocationDistance)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_ProjectionDistance)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_LocationBearing)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_ProjectionBearing)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_LocationDistanceNE)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_ProjectionDistanceNE)->Arg(1)->Arg(10)->Arg(50);
+
+BENCHMARK_MAIN();
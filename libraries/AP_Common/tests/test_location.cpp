@@ -390,4 +390,60 @@ TEST(Location, OffsetError)
     }
 }
 
+/*
+  check the cached origin projection against the Location methods
+  over a range of latitudes, across the date line and at distances
+  up to 100km
+ */
+TEST(Location, Projection)
+{
+    const int32_t origin_lat[] { -890000000, -600000000, -353629380, 0, 353629380, 600000000, 890000000 };
+    const int32_t origin_lng[] { 1491650850, 1799990000, -1799990000, 0 };
+    const float ranges[] { 1, 100, 1e3, 1e4, 1e5 };
+    for (const int32_t lat : origin_lat) {
+        for (const int32_t lng : origin_lng) {
+            const Location origin{lat, lng, 0, Location::AltFrame::ABSOLUTE};
+            const LocationProjection proj { origin };
+            for (const float range : ranges) {
+                for (float bearing = 5; bearing < 360; bearing += 40) {
+                    Location loc = origin;
+                    loc.offset_bearing(bearing, range);
+                    const float tol = 1e-3 + range * 1e-6;
+                    EXPECT_NEAR(origin.get_distance(loc), proj.get_distance(loc), tol);
+                    const Vector2f ne = origin.get_distance_NE(loc);
+                    const Vector2f proj_ne = proj.get_distance_NE(loc);
+                    EXPECT_NEAR(ne.x, proj_ne.x, tol);
+                    EXPECT_NEAR(ne.y, proj_ne.y, tol);
+                    if (range >= 100) {
+                        EXPECT_NEAR(origin.get_bearing(loc), proj.get_bearing(loc), 1e-4);
+                        EXPECT_NEAR(origin.get_bearing_to(loc), proj.get_bearing_to(loc), 1);
+                    }
+                    Location loc2 = origin;
+                    loc2.offset(ne.x, ne.y);
+                    const Location proj_loc = proj.offset(ne.x, ne.y);
+                    EXPECT_NEAR(loc2.lat, proj_loc.lat, 1);
+                    EXPECT_LT(loc2.get_distance(proj_loc), tol);
+                }
+            }
+        }
+    }
+
+    // batch conversion matches single conversions
+    const Location origin{-353629380, 1491650850, 0, Location::AltFrame::ABSOLUTE};
+    const LocationProjection proj { origin };
+    Location locs[10];
+    Vector2l latlngs[ARRAY_SIZE(locs)];
+    Vector2f ne[ARRAY_SIZE(locs)];
+    for (uint8_t i=0; i<ARRAY_SIZE(locs); i++) {
+        locs[i] = origin;
+        locs[i].offset(i * 123.4, i * -56.7);
+        latlngs[i] = Vector2l(locs[i].lat, locs[i].lng);
+    }
+    proj.get_distance_NE(latlngs, ne, ARRAY_SIZE(locs));
+    for (uint8_t i=0; i<ARRAY_SIZE(locs); i++) {
+        EXPECT_VECTOR2F_EQ(proj.get_distance_NE(locs[i]), ne[i]);
+    }
+    EXPECT_TRUE(proj.get_origin().same_latlon_as(origin));
+}
+
 AP_GTEST_MAIN()
@@ -565,8 +565,15 @@ private:
         uint32_t    last_update_ms;
         uint32_t    last_update_usec;
 
-        // board specific orientation
-        enum Rotation rotation;
+        // board specific orientation, bound when the backend registers
+        // the sensor
+        RotationTransformf rotation;
+
+        // board orientation for an internal compass or the user
+        // selected orientation for an external one. Rebound by
+        // rotate_field() in the thread publishing the samples when the
+        // selected orientation changes
+        RotationTransformf orientation_transform;
 
         // accumulated samples, protected by _sem, used by AP_Compass_Backend
         Vector3f accum;
@@ -24,7 +24,7 @@ void AP_Compass_Backend::rotate_field(Vector3f &mag, uint8_t instance)
     if (MAG_BOARD_ORIENTATION != ROTATION_NONE) {
         mag.rotate(MAG_BOARD_ORIENTATION);
     }
-    mag.rotate(state.rotation);
+    state.rotation.rotate(mag);
 
 #ifdef HAL_HEATER_MAG_OFFSET
     /*
@@ -50,12 +50,13 @@ void AP_Compass_Backend::rotate_field(Vector3f &mag, uint8_t instance)
     }
 #endif
 
-    if (!state.external) {
-        mag.rotate(_compass._board_orientation);
-    } else {
-        // add user selectable orientation
-        mag.rotate((enum Rotation)state.orientation.get());
+    // board orientation for internal compasses, user selectable
+    // orientation for external ones
+    const enum Rotation orientation = !state.external ? _compass._board_orientation : (enum Rotation)state.orientation.get();
+    if (state.orientation_transform.get_rotation() != orientation) {
+        state.orientation_transform.set(orientation);
     }
+    state.orientation_transform.rotate(mag);
 }
 
 void AP_Compass_Backend::publish_raw_field(const Vector3f &mag, uint8_t instance)
@@ -249,7 +250,7 @@ bool AP_Compass_Backend::is_external(uint8_t instance)
 // set rotation of an instance
 void AP_Compass_Backend::set_rotation(uint8_t instance, enum Rotation rotation)
 {
-    _compass._state[Compass::StateIndex(instance)].rotation = rotation;
+    _compass._state[Compass::StateIndex(instance)].rotation.set(rotation);
 }
 
 static constexpr float FILTER_KOEF = 0.1f;
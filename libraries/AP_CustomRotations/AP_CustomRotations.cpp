@@ -131,6 +131,15 @@ void AP_CustomRotations::rotate(Rotation r, Vector3f& v)
     v = rot->m * v;
 }
 
+const Matrix3f *AP_CustomRotations::get_matrix(Rotation r)
+{
+    AP_CustomRotation* rot = get_rotation(r);
+    if (rot == nullptr) {
+        return nullptr;
+    }
+    return &rot->m;
+}
+
 AP_CustomRotation* AP_CustomRotations::get_rotation(Rotation r)
 {
     if (r < ROTATION_CUSTOM_1 || r >= ROTATION_CUSTOM_END) {
@@ -62,6 +62,9 @@ public:
     void rotate(enum Rotation r, Vector3d& v);
     void rotate(enum Rotation r, Vector3f& v);
 
+    // rotation matrix of a custom rotation, nullptr if not valid
+    const Matrix3f *get_matrix(enum Rotation r);
+
     void convert(Rotation r, float roll, float pitch, float yaw);
     void set(Rotation r, float roll, float pitch, float yaw);
 
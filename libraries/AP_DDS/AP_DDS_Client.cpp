@@ -30,14 +30,6 @@
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = 1000;
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = 5;
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = 1000;
 static constexpr uint16_t DELAY_PING_MS = 500;
 
 // Define the subscriber data members, which are static class scope.
@@ -74,6 +66,70 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
 
 #endif
 
+    // @Param: _TIME_HZ
+    // @DisplayName: DDS time topic rate
+    // @Description: Rate at which the time topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 200
+    // @User: Advanced
+    AP_GROUPINFO("_TIME_HZ", 4, AP_DDS_Client, time_rate_hz, 100),
+
+    // @Param: _BATT_HZ
+    // @DisplayName: DDS battery state topic rate
+    // @Description: Rate at which the battery state topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 50
+    // @User: Advanced
+    AP_GROUPINFO("_BATT_HZ", 5, AP_DDS_Client, battery_state_rate_hz, 1),
+
+    // @Param: _IMU_HZ
+    // @DisplayName: DDS IMU topic rate
+    // @Description: Rate at which the IMU topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_IMU_HZ", 6, AP_DDS_Client, imu_rate_hz, 200),
+
+    // @Param: _POSE_HZ
+    // @DisplayName: DDS local pose topic rate
+    // @Description: Rate at which the local pose topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 200
+    // @User: Advanced
+    AP_GROUPINFO("_POSE_HZ", 7, AP_DDS_Client, local_pose_rate_hz, 30),
+
+    // @Param: _VEL_HZ
+    // @DisplayName: DDS local velocity topic rate
+    // @Description: Rate at which the local velocity topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 200
+    // @User: Advanced
+    AP_GROUPINFO("_VEL_HZ", 8, AP_DDS_Client, local_velocity_rate_hz, 30),
+
+    // @Param: _GEOPOSE_HZ
+    // @DisplayName: DDS geopose topic rate
+    // @Description: Rate at which the geopose topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 200
+    // @User: Advanced
+    AP_GROUPINFO("_GEOPOSE_HZ", 9, AP_DDS_Client, geo_pose_rate_hz, 30),
+
+    // @Param: _CLOCK_HZ
+    // @DisplayName: DDS clock topic rate
+    // @Description: Rate at which the clock topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 200
+    // @User: Advanced
+    AP_GROUPINFO("_CLOCK_HZ", 10, AP_DDS_Client, clock_rate_hz, 100),
+
+    // @Param: _ORIGIN_HZ
+    // @DisplayName: DDS GPS global origin topic rate
+    // @Description: Rate at which the GPS global origin topic is published, 0 to disable
+    // @Units: Hz
+    // @Range: 0 10
+    // @User: Advanced
+    AP_GROUPINFO("_ORIGIN_HZ", 11, AP_DDS_Client, gps_global_origin_rate_hz, 1),
+
     AP_GROUPEND
 };
 
@@ -793,13 +849,15 @@ bool AP_DDS_Client::init_session()
     // setup reliable stream buffers
     input_reliable_stream = NEW_NOTHROW uint8_t[DDS_BUFFER_SIZE];
     output_reliable_stream = NEW_NOTHROW uint8_t[DDS_BUFFER_SIZE];
-    if (input_reliable_stream == nullptr || output_reliable_stream == nullptr) {
+    output_best_effort_stream = NEW_NOTHROW uint8_t[DDS_MTU];
+    if (input_reliable_stream == nullptr || output_reliable_stream == nullptr || output_best_effort_stream == nullptr) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "%s Allocation failed", msg_prefix);
         return false;
     }
 
     reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
     reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
+    best_effort_out = uxr_create_output_best_effort_stream(&session, output_best_effort_stream, DDS_MTU);
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "%s Init complete", msg_prefix);
 
@@ -944,214 +1002,160 @@ bool AP_DDS_Client::create()
     return true;
 }
 
-void AP_DDS_Client::write_time_topic()
+template <typename T>
+void AP_DDS_Client::write_topic(uint8_t topic_index, const T& msg,
+                                uint32_t (*size_of_topic)(const T*, uint32_t),
+                                bool (*serialize_topic)(ucdrBuffer*, const T*))
 {
     WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = builtin_interfaces_msg_Time_size_of_topic(&time_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, &ub, topic_size);
-        const bool success = builtin_interfaces_msg_Time_serialize_topic(&ub, &time_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: XRCE_Client failed to serialize\n");
+    if (!connected) {
+        return;
+    }
+    const Topic_table &topic = topics[topic_index];
+    const bool best_effort = topic.qos.reliability == UXR_RELIABILITY_BEST_EFFORT;
+    const uxrStreamId stream = best_effort ? best_effort_out : reliable_out;
+    const uint32_t topic_size = size_of_topic(&msg, 0);
+    ucdrBuffer ub {};
+    if (uxr_prepare_output_stream(&session, stream, topic.dw_id, &ub, topic_size) == 0) {
+        if (!best_effort) {
+            // the reliable stream history is full, drop this sample
+            return;
+        }
+        // the best effort stream holds a single MTU, so send what is
+        // already in it to make room
+        uxr_flash_output_streams(&session);
+        if (uxr_prepare_output_stream(&session, stream, topic.dw_id, &ub, topic_size) == 0) {
+            return;
         }
     }
+    // the message is serialized directly into the stream buffer
+    const bool success = serialize_topic(&ub, &msg);
+    if (!success) {
+        // TODO sometimes serialization fails on bootup. Determine why.
+        // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
+    }
+}
+
+void AP_DDS_Client::write_time_topic()
+{
+    write_topic(to_underlying(TopicIndex::TIME_PUB), time_topic, builtin_interfaces_msg_Time_size_of_topic, builtin_interfaces_msg_Time_serialize_topic);
 }
 
 void AP_DDS_Client::write_nav_sat_fix_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_NavSatFix_size_of_topic(&nav_sat_fix_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_NavSatFix_serialize_topic(&ub, &nav_sat_fix_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::NAV_SAT_FIX_PUB), nav_sat_fix_topic, sensor_msgs_msg_NavSatFix_size_of_topic, sensor_msgs_msg_NavSatFix_serialize_topic);
 }
 
 void AP_DDS_Client::write_static_transforms()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = tf2_msgs_msg_TFMessage_size_of_topic(&tx_static_transforms_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, &ub, topic_size);
-        const bool success = tf2_msgs_msg_TFMessage_serialize_topic(&ub, &tx_static_transforms_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB), tx_static_transforms_topic, tf2_msgs_msg_TFMessage_size_of_topic, tf2_msgs_msg_TFMessage_serialize_topic);
 }
 
 void AP_DDS_Client::write_battery_state_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_BatteryState_size_of_topic(&battery_state_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_BatteryState_serialize_topic(&ub, &battery_state_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::BATTERY_STATE_PUB), battery_state_topic, sensor_msgs_msg_BatteryState_size_of_topic, sensor_msgs_msg_BatteryState_serialize_topic);
 }
 
 void AP_DDS_Client::write_local_pose_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&local_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, &ub, topic_size);
-        const bool success = geometry_msgs_msg_PoseStamped_serialize_topic(&ub, &local_pose_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::LOCAL_POSE_PUB), local_pose_topic, geometry_msgs_msg_PoseStamped_size_of_topic, geometry_msgs_msg_PoseStamped_serialize_topic);
 }
 
 void AP_DDS_Client::write_tx_local_velocity_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geometry_msgs_msg_TwistStamped_size_of_topic(&tx_local_velocity_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, &ub, topic_size);
-        const bool success = geometry_msgs_msg_TwistStamped_serialize_topic(&ub, &tx_local_velocity_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), tx_local_velocity_topic, geometry_msgs_msg_TwistStamped_size_of_topic, geometry_msgs_msg_TwistStamped_serialize_topic);
 }
 
 void AP_DDS_Client::write_imu_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_Imu_size_of_topic(&imu_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_Imu_serialize_topic(&ub, &imu_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::IMU_PUB), imu_topic, sensor_msgs_msg_Imu_size_of_topic, sensor_msgs_msg_Imu_serialize_topic);
 }
 
 void AP_DDS_Client::write_geo_pose_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geographic_msgs_msg_GeoPoseStamped_size_of_topic(&geo_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, &ub, topic_size);
-        const bool success = geographic_msgs_msg_GeoPoseStamped_serialize_topic(&ub, &geo_pose_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::GEOPOSE_PUB), geo_pose_topic, geographic_msgs_msg_GeoPoseStamped_size_of_topic, geographic_msgs_msg_GeoPoseStamped_serialize_topic);
 }
 
 void AP_DDS_Client::write_clock_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = rosgraph_msgs_msg_Clock_size_of_topic(&clock_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, &ub, topic_size);
-        const bool success = rosgraph_msgs_msg_Clock_serialize_topic(&ub, &clock_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    write_topic(to_underlying(TopicIndex::CLOCK_PUB), clock_topic, rosgraph_msgs_msg_Clock_size_of_topic, rosgraph_msgs_msg_Clock_serialize_topic);
 }
 
 void AP_DDS_Client::write_gps_global_origin_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&gps_global_origin_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, &ub, topic_size);
-        const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &gps_global_origin_topic);
-        if (!success) {
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
+    write_topic(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), gps_global_origin_topic, geographic_msgs_msg_GeoPointStamped_size_of_topic, geographic_msgs_msg_GeoPointStamped_serialize_topic);
+}
+
+// topics published at a rate set by a parameter. If several are due
+// at once they are published in this order
+const AP_DDS_Client::Scheduled_topic AP_DDS_Client::scheduled_topics[] = {
+    { &AP_DDS_Client::imu_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.imu_topic);
+        dds.write_imu_topic();
+    }},
+    { &AP_DDS_Client::time_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.time_topic);
+        dds.write_time_topic();
+    }},
+    { &AP_DDS_Client::clock_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.clock_topic);
+        dds.write_clock_topic();
+    }},
+    { &AP_DDS_Client::local_pose_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.local_pose_topic);
+        dds.write_local_pose_topic();
+    }},
+    { &AP_DDS_Client::local_velocity_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.tx_local_velocity_topic);
+        dds.write_tx_local_velocity_topic();
+    }},
+    { &AP_DDS_Client::geo_pose_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.geo_pose_topic);
+        dds.write_geo_pose_topic();
+    }},
+    { &AP_DDS_Client::battery_state_rate_hz, [](AP_DDS_Client &dds) {
+        constexpr uint8_t battery_instance = 0;
+        update_topic(dds.battery_state_topic, battery_instance);
+        dds.write_battery_state_topic();
+    }},
+    { &AP_DDS_Client::gps_global_origin_rate_hz, [](AP_DDS_Client &dds) {
+        update_topic(dds.gps_global_origin_topic);
+        dds.write_gps_global_origin_topic();
+    }},
+};
+
+void AP_DDS_Client::run_scheduler()
+{
+    static_assert(ARRAY_SIZE(scheduled_topics) == NUM_SCHEDULED_TOPICS, "scheduled_topics size");
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i = 0; i < NUM_SCHEDULED_TOPICS; i++) {
+        const Scheduled_topic &scheduled = scheduled_topics[i];
+        const int16_t rate_hz = (this->*scheduled.rate_hz).get();
+        if (rate_hz <= 0 || now_us < next_publish_us[i]) {
+            continue;
+        }
+        // keep to the requested rate on average, without bursts to
+        // catch up if we have fallen more than a period behind
+        const uint32_t period_us = 1000000U / MIN(rate_hz, 1000);
+        next_publish_us[i] += period_us;
+        if (next_publish_us[i] <= now_us) {
+            next_publish_us[i] = now_us + period_us;
         }
+        scheduled.publish(*this);
     }
 }
 
 void AP_DDS_Client::update()
 {
     WITH_SEMAPHORE(csem);
-    const auto cur_time_ms = AP_HAL::millis64();
 
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
-        update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
-        write_time_topic();
-    }
+    run_scheduler();
 
     constexpr uint8_t gps_instance = 0;
     if (update_topic(nav_sat_fix_topic, gps_instance)) {
         write_nav_sat_fix_topic();
     }
 
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
-        constexpr uint8_t battery_instance = 0;
-        update_topic(battery_state_topic, battery_instance);
-        last_battery_state_time_ms = cur_time_ms;
-        write_battery_state_topic();
-    }
-
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
-        update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
-        write_local_pose_topic();
-    }
-
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
-        update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
-        write_tx_local_velocity_topic();
-    }
-
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
-        update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
-        write_imu_topic();
-    }
-
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
-        update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
-        write_geo_pose_topic();
-    }
-
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
-        update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
-        write_clock_topic();
-    }
-
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
-        update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
-        write_gps_global_origin_topic();
-    }
-
     status_ok = uxr_run_session_time(&session, 1);
 }
 
@@ -44,7 +44,9 @@ extern const AP_HAL::HAL& hal;
 class AP_DDS_Client
 {
 
-private:
+protected:
+    // protected so the publish benchmark can connect the client to a
+    // stand-in agent
 
     AP_Int8 enabled;
 
@@ -57,6 +59,9 @@ private:
     uint8_t *output_reliable_stream;
     uxrStreamId reliable_in;
     uxrStreamId reliable_out;
+    // topics with best effort QoS are sent without waiting for acknowledgement
+    uint8_t *output_best_effort_stream;
+    uxrStreamId best_effort_out;
 
     // Outgoing Sensor and AHRS data
     builtin_interfaces_msg_Time time_topic;
@@ -112,24 +117,37 @@ private:
         .min_pace_period = 0
     };
 
-    // The last ms timestamp AP_DDS wrote a Time message
-    uint64_t last_time_time_ms;
     // The last ms timestamp AP_DDS wrote a NavSatFix message
     uint64_t last_nav_sat_fix_time_ms;
-    // The last ms timestamp AP_DDS wrote a BatteryState message
-    uint64_t last_battery_state_time_ms;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Velocity message
-    uint64_t last_local_velocity_time_ms;
-    // The last ms timestamp AP_DDS wrote a GeoPose message
-    uint64_t last_geo_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Clock message
-    uint64_t last_clock_time_ms;
-    // The last ms timestamp AP_DDS wrote a gps global origin message
-    uint64_t last_gps_global_origin_time_ms;
+
+    // publishing rates of the scheduled topics, 0 to disable
+    AP_Int16 time_rate_hz;
+    AP_Int16 battery_state_rate_hz;
+    AP_Int16 imu_rate_hz;
+    AP_Int16 local_pose_rate_hz;
+    AP_Int16 local_velocity_rate_hz;
+    AP_Int16 geo_pose_rate_hz;
+    AP_Int16 clock_rate_hz;
+    AP_Int16 gps_global_origin_rate_hz;
+
+    //! @brief A topic published by the scheduler at the rate in a parameter
+    struct Scheduled_topic {
+        AP_Int16 AP_DDS_Client::*rate_hz;
+        void (*publish)(AP_DDS_Client &client);
+    };
+    static constexpr uint8_t NUM_SCHEDULED_TOPICS = 8;
+    static const Scheduled_topic scheduled_topics[];
+    // time each scheduled topic is next due
+    uint64_t next_publish_us[NUM_SCHEDULED_TOPICS];
+
+    //! @brief Publish each scheduled topic which is due
+    void run_scheduler();
+
+    //! @brief Serialize a topic straight into its output stream
+    template <typename T>
+    void write_topic(uint8_t topic_index, const T& msg,
+                     uint32_t (*size_of_topic)(const T*, uint32_t),
+                     bool (*serialize_topic)(ucdrBuffer*, const T*));
 
     // functions for serial transport
     bool ddsSerialInit();
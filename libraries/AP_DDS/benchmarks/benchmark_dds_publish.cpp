@@ -0,0 +1,168 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_DDS/AP_DDS_config.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_DDS_ENABLED
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_DDS/AP_DDS_Client.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_RTC/AP_RTC.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+/*
+  stand-in for a micro-ROS agent on the other end of the link. It
+  accepts every datagram and never replies, so the benchmark measures
+  the client side cost of getting a topic onto the wire
+ */
+static size_t agent_bytes;
+static size_t agent_datagrams;
+
+static bool agent_open(uxrCustomTransport *t)
+{
+    return true;
+}
+
+static bool agent_close(uxrCustomTransport *t)
+{
+    return true;
+}
+
+static size_t agent_write(uxrCustomTransport *t, const uint8_t* buf, size_t len, uint8_t* error)
+{
+    gbenchmark_escape((void*)buf);
+    agent_bytes += len;
+    agent_datagrams++;
+    return len;
+}
+
+static size_t agent_read(uxrCustomTransport *t, uint8_t* buf, size_t len, int timeout_ms, uint8_t* error)
+{
+    return 0;
+}
+
+// client connected to the stand-in agent without the session handshake
+class BenchDDSClient : public AP_DDS_Client {
+public:
+    bool connect_to_agent() {
+        // the destructor closes the serial transport. The agent is
+        // not framed, as for UDP
+        is_using_serial = true;
+        uxr_set_custom_transport_callbacks(&serial.transport, false, agent_open, agent_close, agent_write, agent_read);
+        if (!uxr_init_custom_transport(&serial.transport, nullptr)) {
+            return false;
+        }
+        comm = &serial.transport.comm;
+        uxr_init_session(&session, comm, key);
+
+        output_reliable_stream = NEW_NOTHROW uint8_t[DDS_BUFFER_SIZE];
+        output_best_effort_stream = NEW_NOTHROW uint8_t[DDS_MTU];
+        if (output_reliable_stream == nullptr || output_best_effort_stream == nullptr) {
+            return false;
+        }
+        reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
+        best_effort_out = uxr_create_output_best_effort_stream(&session, output_best_effort_stream, DDS_MTU);
+        connected = true;
+        return true;
+    }
+
+    void flush() {
+        uxr_flash_output_streams(&session);
+    }
+
+    using AP_DDS_Client::update_topic;
+    using AP_DDS_Client::imu_topic;
+};
+
+// the singletons read by update_topic()
+class DummyVehicle {
+public:
+    AP_Scheduler scheduler;
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+    AP_InertialSensor ins;
+    AP_RTC rtc;
+    BenchDDSClient dds;
+};
+
+static DummyVehicle vehicle;
+
+static BenchDDSClient *connect(benchmark::State& state)
+{
+    static bool connected;
+    if (!connected) {
+        connected = vehicle.dds.connect_to_agent();
+        if (!connected) {
+            state.SkipWithError("client connection failed");
+            return nullptr;
+        }
+    }
+    agent_bytes = 0;
+    agent_datagrams = 0;
+    return &vehicle.dds;
+}
+
+static void report(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(agent_bytes);
+    state.counters["datagrams"] = agent_datagrams;
+}
+
+/*
+  publish one IMU sample per iteration with write_imu_topic(). With an
+  argument of 1 each sample is sent in its own datagram, otherwise
+  samples are sent as the best effort stream fills
+ */
+static void BM_DDSWriteImu(benchmark::State& state)
+{
+    BenchDDSClient *dds = connect(state);
+    if (dds == nullptr) {
+        return;
+    }
+    // a realistic sample, filled once
+    BenchDDSClient::update_topic(dds->imu_topic);
+    while (state.KeepRunning()) {
+        dds->imu_topic.header.stamp.nanosec++;
+        dds->imu_topic.angular_velocity.x += 0.001;
+        dds->write_imu_topic();
+        if (state.range(0)) {
+            dds->flush();
+        }
+    }
+    dds->flush();
+    report(state);
+}
+
+BENCHMARK(BM_DDSWriteImu)->Arg(0)->Arg(1);
+
+// the scheduled IMU publish, filling the sample from the sensors first
+static void BM_DDSUpdateWriteImu(benchmark::State& state)
+{
+    BenchDDSClient *dds = connect(state);
+    if (dds == nullptr) {
+        return;
+    }
+    while (state.KeepRunning()) {
+        BenchDDSClient::update_topic(dds->imu_topic);
+        dds->write_imu_topic();
+        if (state.range(0)) {
+            dds->flush();
+        }
+    }
+    dds->flush();
+    report(state);
+}
+
+BENCHMARK(BM_DDSUpdateWriteImu)->Arg(0)->Arg(1);
+
+#endif // AP_DDS_ENABLED
+
+BENCHMARK_MAIN();
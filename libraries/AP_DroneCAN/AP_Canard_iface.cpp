@@ -10,6 +10,7 @@ extern const AP_HAL::HAL& hal;
 #define LOG_TAG "DroneCANIface"
 #include <canard.h>
 #include <AP_CANManager/AP_CANSensor.h>
+#include <AP_Common/ExpandingString.h>
 
 #define DEBUG_PKTS 0
 
@@ -24,6 +25,8 @@ DEFINE_TRANSFER_OBJECT_SEMAPHORES();
 #if AP_TEST_DRONECAN_DRIVERS
 CanardInterface* CanardInterface::canard_ifaces[] = {nullptr, nullptr, nullptr};
 CanardInterface CanardInterface::test_iface{2};
+CanardInterface::TestBusTap CanardInterface::test_bus_tap;
+ObjectBuffer<CanardInterface::TestFrame> CanardInterface::test_rx_frames{64};
 uint8_t test_node_mem_area[1024];
 HAL_Semaphore test_iface_sem;
 #endif
@@ -103,11 +106,7 @@ bool CanardInterface::broadcast(const Canard::Transfer &bcast_transfer) {
         test_iface_sem.give();
     }
 #endif
-    if (ret <= 0) {
-        protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
-    }
+    tx_queued(ret);
     return ret > 0;
 }
 
@@ -135,11 +134,7 @@ bool CanardInterface::request(uint8_t destination_node_id, const Canard::Transfe
     };
     // do canard request
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
-    if (ret <= 0) {
-        protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
-    }
+    tx_queued(ret);
     return ret > 0;
 }
 
@@ -167,12 +162,45 @@ bool CanardInterface::respond(uint8_t destination_node_id, const Canard::Transfe
     };
     // do canard respond
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
+    tx_queued(ret);
+    return ret > 0;
+}
+
+CanardInterface::TxClass CanardInterface::tx_class(uint8_t priority)
+{
+    if (priority <= CANARD_TRANSFER_PRIORITY_HIGH) {
+        return TxClass::ACTUATOR;
+    }
+    if (priority < CANARD_TRANSFER_PRIORITY_LOW) {
+        return TxClass::NORMAL;
+    }
+    return TxClass::BULK;
+}
+
+void CanardInterface::tx_queued(int16_t ret)
+{
     if (ret <= 0) {
         protocol_stats.tx_errors++;
-    } else {
-        protocol_stats.tx_frames += ret;
+        return;
     }
-    return ret > 0;
+    protocol_stats.tx_frames += ret;
+
+    auto &stats = tx_class_stats[uint8_t(tx_class(tx_transfer.priority))];
+    stats.frames += ret;
+    if (stats.pending_since_us == 0) {
+        stats.pending_since_us = AP_HAL::micros64();
+    }
+
+#if AP_TEST_DRONECAN_DRIVERS
+    if (this == canard_ifaces[0] && test_bus_tap) {
+        tx_queue_times[tx_queue_times_next] = TxQueueTime{tx_transfer.deadline_usec, AP_HAL::micros64()};
+        tx_queue_times_next = (tx_queue_times_next + 1) % ARRAY_SIZE(tx_queue_times);
+    }
+#endif
+
+    // wake the DroneCAN thread rather than leaving the frames until
+    // its next poll
+    sem_handle.signal();
 }
 
 void CanardInterface::onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer) {
@@ -195,25 +223,52 @@ void CanardInterface::processTestRx() {
         return;
     }
     WITH_SEMAPHORE(test_iface_sem);
+    // frames from the vehicle go first, so that replies made by the
+    // simulated peripherals are delivered in this call
+    TestFrame rxf;
+    while (test_rx_frames.pop(rxf)) {
+        if (test_bus_tap) {
+            test_bus_tap(rxf.frame, false, rxf.queued_us);
+        }
+        canardHandleRxFrame(&test_iface.canard, &rxf.frame, rxf.queued_us);
+    }
     for (const CanardCANFrame* txf = canardPeekTxQueue(&test_iface.canard); txf != NULL; txf = canardPeekTxQueue(&test_iface.canard)) {
         if (canard_ifaces[0]) {
+            if (test_bus_tap) {
+                test_bus_tap(*txf, true, AP_HAL::micros64());
+            }
             canardHandleRxFrame(&canard_ifaces[0]->canard, txf, AP_HAL::micros64());   
         }
         canardPopTxQueue(&test_iface.canard);
     }
 }
+
+uint64_t CanardInterface::tx_queued_us(const CanardCANFrame &txf) const
+{
+    for (const auto &t : tx_queue_times) {
+        if (t.deadline_usec == txf.deadline_usec && t.queued_us != 0) {
+            return t.queued_us;
+        }
+    }
+    return AP_HAL::micros64();
+}
 #endif
 
-void CanardInterface::processTx(bool raw_commands_only = false) {
+void CanardInterface::processTx(TxClass max_class) {
     WITH_SEMAPHORE(_sem_tx);
 
+    // frames with unsent data in each class
+    bool pending[uint8_t(TxClass::NUM_CLASSES)] {};
+    // classes below this have been scanned on every interface
+    TxClass scanned_class = TxClass::NUM_CLASSES;
+
     for (uint8_t iface = 0; iface < num_ifaces; iface++) {
         if (ifaces[iface] == NULL) {
             continue;
         }
         auto txq = canard.tx_queue;
         if (txq == nullptr) {
-            return;
+            break;
         }
         // volatile as the value can change at any time during can interrupt
         // we need to ensure that this is not optimized
@@ -229,18 +284,15 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
             */
             iface_down = false;
         } 
-        // scan through list of pending transfers
+        // scan through list of pending transfers. libcanard keeps the
+        // queue sorted by CAN ID, so all frames of a class come
+        // before any frame of a lower class
         while (true) {
             auto txf = &txq->frame;
-            if (raw_commands_only &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != COM_HOBBYWING_ESC_RAWCOMMAND_ID) {
-                // look at next transfer
-                txq = txq->next;
-                if (txq == nullptr) {
-                    break;
-                }
-                continue;
+            const TxClass txf_class = tx_class((txf->id >> 24) & 0x1F);
+            if (txf_class > max_class) {
+                scanned_class = MIN(scanned_class, txf_class);
+                break;
             }
             AP_HAL::CANFrame txmsg {};
             txmsg.dlc = AP_HAL::CANFrame::dataLengthToDlc(txf->data_len);
@@ -251,12 +303,13 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
 #endif
             bool write = true;
             bool read = false;
+            bool blocked = false;
             ifaces[iface]->select(read, write, &txmsg, 0);
             if (!write) {
                 // if there is no space then we need to start from the
                 // top of the queue, so wait for the next loop
                 if (!iface_down) {
-                    break;
+                    blocked = true;
                 } else {
                     txf->iface_mask &= ~(1U<<iface);
                 }
@@ -264,15 +317,29 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
                 // try sending to interfaces, clearing the mask if we succeed
                 if (ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
                     txf->iface_mask &= ~(1U<<iface);
+#if AP_TEST_DRONECAN_DRIVERS
+                    if (iface == 0 && this == canard_ifaces[0] && test_bus_tap) {
+                        // while a simulated DroneCAN device is attached the
+                        // test interface sees the frame as it goes on the bus
+                        test_rx_frames.push(TestFrame{*txf, tx_queued_us(*txf)});
+                    }
+#endif
                 } else {
                     // if we fail to send then we try sending on next interface
                     if (!iface_down) {
-                        break;
+                        blocked = true;
                     } else {
                         txf->iface_mask &= ~(1U<<iface);
                     }
                 }
             }
+            if ((txf->iface_mask & (1U<<iface)) && (AP_HAL::micros64() < txf->deadline_usec)) {
+                pending[uint8_t(txf_class)] = true;
+            }
+            if (blocked) {
+                scanned_class = MIN(scanned_class, txf_class);
+                break;
+            }
             // look at next transfer
             txq = txq->next;
             if (txq == nullptr) {
@@ -281,6 +348,44 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
         }
     }
 
+    // record the latency of classes which are now empty
+    const uint64_t now = AP_HAL::micros64();
+    for (uint8_t c = 0; c < uint8_t(scanned_class); c++) {
+        auto &stats = tx_class_stats[c];
+        if (pending[c] || stats.pending_since_us == 0) {
+            continue;
+        }
+        const uint32_t latency_us = now - stats.pending_since_us;
+        stats.pending_since_us = 0;
+        stats.drains++;
+        stats.latency_sum_us += latency_us;
+        stats.latency_max_us = MAX(stats.latency_max_us, latency_us);
+    }
+}
+
+void CanardInterface::get_tx_stats(const AP_HAL::CANIface *can_iface, ExpandingString &str)
+{
+    bool found = false;
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        found |= (ifaces[i] == can_iface);
+    }
+    if (!found) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_sem_tx);
+    static const char *class_names[] { "actuator", "normal", "bulk" };
+    static_assert(ARRAY_SIZE(class_names) == uint8_t(TxClass::NUM_CLASSES), "class_names must match TxClass");
+    str.printf("------- DroneCAN TX Queues -------\n");
+    for (uint8_t c = 0; c < uint8_t(TxClass::NUM_CLASSES); c++) {
+        const auto &stats = tx_class_stats[c];
+        str.printf("%-9s frames=%lu drains=%lu avg=%luus max=%luus\n",
+                   class_names[c],
+                   (unsigned long)stats.frames,
+                   (unsigned long)stats.drains,
+                   (unsigned long)(stats.drains > 0 ? stats.latency_sum_us / stats.drains : 0),
+                   (unsigned long)stats.latency_max_us);
+    }
 }
 
 void CanardInterface::update_rx_protocol_stats(int16_t res)
@@ -399,6 +504,9 @@ void CanardInterface::process(uint32_t duration_ms) {
 #else
     const uint64_t deadline = AP_HAL::micros64() + duration_ms*1000;
     while (true) {
+        // actuator commands go out ahead of everything else,
+        // including frames waiting to be received
+        processTx(TxClass::ACTUATOR);
         processRx();
         processTx();
         {
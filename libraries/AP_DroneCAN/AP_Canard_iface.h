@@ -3,9 +3,11 @@
 #if HAL_ENABLE_DRONECAN_DRIVERS
 #include <canard/interface.h>
 #include <dronecan_msgs.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 class AP_DroneCAN;
 class CANSensor;
+class ExpandingString;
 
 class CanardInterface : public Canard::Interface {
     friend class AP_DroneCAN;
@@ -36,7 +38,17 @@ public:
     /// @return true if response was added to the queue
     bool respond(uint8_t destination_node_id, const Canard::Transfer &res_transfer) override;
 
-    void processTx(bool raw_commands_only);
+    // outgoing frames are drained in order of these classes, which
+    // are taken from the transfer priority in the CAN ID
+    enum class TxClass : uint8_t {
+        ACTUATOR = 0,   // CANARD_TRANSFER_PRIORITY_HIGH and above, ESC and servo commands
+        NORMAL,
+        BULK,           // CANARD_TRANSFER_PRIORITY_LOW and below, params, node info and DNA
+        NUM_CLASSES
+    };
+
+    // send queued frames of class max_class and higher
+    void processTx(TxClass max_class = TxClass::BULK);
     void processRx();
 
     void process(uint32_t duration);
@@ -59,10 +71,20 @@ public:
 #if AP_TEST_DRONECAN_DRIVERS
     static CanardInterface& get_test_iface() { return test_iface; }
     static void processTestRx();
+
+    // called for each frame crossing the simulated bus between the
+    // vehicle and the test interface, with the time the frame was
+    // queued by its sender
+    FUNCTOR_TYPEDEF(TestBusTap, void, const CanardCANFrame &, bool, uint64_t);
+    static void set_test_bus_tap(TestBusTap tap) { test_bus_tap = tap; }
 #endif
 
     void update_rx_protocol_stats(int16_t res);
 
+    // report per TX class queue latency if can_iface is one of ours,
+    // for @SYS/canN_stats.txt
+    void get_tx_stats(const AP_HAL::CANIface *can_iface, ExpandingString &str);
+
     uint8_t get_node_id() const override { return canard.node_id; }
 private:
     CanardInstance canard;
@@ -70,6 +92,14 @@ private:
 #if AP_TEST_DRONECAN_DRIVERS
     static CanardInterface* canard_ifaces[3];
     static CanardInterface test_iface;
+    static TestBusTap test_bus_tap;
+
+    // frames sent by the vehicle, waiting to be received by the test interface
+    struct TestFrame {
+        CanardCANFrame frame;
+        uint64_t queued_us;
+    };
+    static ObjectBuffer<TestFrame> test_rx_frames;
 #endif
     uint8_t num_ifaces;
     HAL_BinarySemaphore sem_handle;
@@ -79,6 +109,35 @@ private:
     CanardTxTransfer tx_transfer;
     dronecan_protocol_Stats protocol_stats;
 
+    static TxClass tx_class(uint8_t priority);
+
+    // update stats and wake the DroneCAN thread after queueing tx_transfer
+    void tx_queued(int16_t ret);
+
+    // latency of each TX class, measured from when a frame is queued
+    // with none of its class pending until the class queue is empty
+    struct {
+        uint64_t pending_since_us;
+        uint32_t frames;
+        uint32_t drains;
+        uint64_t latency_sum_us;
+        uint32_t latency_max_us;
+    } tx_class_stats[uint8_t(TxClass::NUM_CLASSES)];
+
+#if AP_TEST_DRONECAN_DRIVERS
+    // time each recently queued transfer was queued, looked up by the
+    // deadline shared by all of its frames. Only kept while the bus is
+    // tapped, for the frames handed to the test interface
+    struct TxQueueTime {
+        uint64_t deadline_usec;
+        uint64_t queued_us;
+    } tx_queue_times[16];
+    uint8_t tx_queue_times_next;
+
+    // time the transfer txf belongs to was queued, or now if it is not known
+    uint64_t tx_queued_us(const CanardCANFrame &txf) const;
+#endif
+
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
 };
@@ -850,7 +850,7 @@ void AP_DroneCAN::SRV_send_esc(void)
             _fail_send_count++;
         }
         // immediately push data to CAN bus
-        canard_iface.processTx(true);
+        canard_iface.processTx(CanardInterface::TxClass::ACTUATOR);
     }
 
     for (uint8_t i = 0; i < DRONECAN_SRV_NUMBER; i++) {
@@ -903,7 +903,7 @@ void AP_DroneCAN::SRV_send_esc_hobbywing(void)
             _fail_send_count++;
         }
         // immediately push data to CAN bus
-        canard_iface.processTx(true);
+        canard_iface.processTx(CanardInterface::TxClass::ACTUATOR);
     }
 }
 #endif // AP_DRONECAN_HOBBYWING_ESC_SUPPORT
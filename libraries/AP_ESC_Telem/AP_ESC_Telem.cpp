@@ -28,6 +28,7 @@
 //#define ESC_TELEM_DEBUG
 
 #define ESC_RPM_CHECK_TIMEOUT_US 210000UL   // timeout for motor running validity
+#define ESC_RPM_READ_RETRIES 3              // attempts to read rpm data while a backend writes it
 
 extern const AP_HAL::HAL& hal;
 
@@ -84,13 +85,16 @@ float AP_ESC_Telem::get_average_motor_rpm(uint32_t servo_channel_mask) const
 uint8_t AP_ESC_Telem::get_motor_frequencies_hz(uint8_t nfreqs, float* freqs) const
 {
     uint8_t valid_escs = 0;
+    const uint32_t now = AP_HAL::micros();
 
     // average the rpm of each motor as reported by BLHeli and convert to Hz
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS && valid_escs < nfreqs; i++) {
+        AP_ESC_Telem_Backend::RpmData rpmdata;
+        read_rpm_data(i, rpmdata);
         float rpm;
-        if (get_rpm(i, rpm)) {
+        if (calc_rpm(i, rpmdata, now, rpm)) {
             freqs[valid_escs++] = rpm * (1.0f / 60.0f);
-        } else if (was_rpm_data_ever_reported(_rpm_data[i])) {
+        } else if (was_rpm_data_ever_reported(rpmdata)) {
             // if we have ever received data on an ESC, mark it as valid but with no data
             // this prevents large frequency shifts when ESCs disappear
             freqs[valid_escs++] = 0.0f;
@@ -107,12 +111,14 @@ uint32_t AP_ESC_Telem::get_active_esc_mask() const {
     const uint32_t now = AP_HAL::millis();
     uint32_t now_us = AP_HAL::micros();
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
-        if (_telem_data[i].last_update_ms == 0 && !was_rpm_data_ever_reported(_rpm_data[i])) {
+        AP_ESC_Telem_Backend::RpmData rpmdata;
+        read_rpm_data(i, rpmdata);
+        if (_telem_data[i].last_update_ms == 0 && !was_rpm_data_ever_reported(rpmdata)) {
             // have never seen telem from this ESC
             continue;
         }
         if (_telem_data[i].stale(now)
-            && !rpm_data_within_timeout(_rpm_data[i], now_us, ESC_RPM_DATA_TIMEOUT_US)) {
+            && !rpm_data_within_timeout(rpmdata, now_us, ESC_RPM_DATA_TIMEOUT_US)) {
             continue;
         }
         ret |= (1U << i);
@@ -133,7 +139,8 @@ bool AP_ESC_Telem::are_motors_running(uint32_t servo_channel_mask, float min_rpm
 
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
         if (BIT_IS_SET(servo_channel_mask, i)) {
-            const volatile AP_ESC_Telem_Backend::RpmData& rpmdata = _rpm_data[i];
+            AP_ESC_Telem_Backend::RpmData rpmdata;
+            read_rpm_data(i, rpmdata);
             // we choose a relatively strict measure of health so that failsafe actions can rely on the results
             if (!rpm_data_within_timeout(rpmdata, now, ESC_RPM_CHECK_TIMEOUT_US)) {
                 return false;
@@ -155,7 +162,9 @@ bool AP_ESC_Telem::is_telemetry_active(uint32_t servo_channel_mask) const
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
         if (BIT_IS_SET(servo_channel_mask, i)) {
             // no data received
-            if (get_last_telem_data_ms(i) == 0 && !was_rpm_data_ever_reported(_rpm_data[i])) {
+            AP_ESC_Telem_Backend::RpmData rpmdata;
+            read_rpm_data(i, rpmdata);
+            if (get_last_telem_data_ms(i) == 0 && !was_rpm_data_ever_reported(rpmdata)) {
                 return false;
             }
         }
@@ -170,15 +179,20 @@ bool AP_ESC_Telem::get_rpm(uint8_t esc_index, float& rpm) const
         return false;
     }
 
-    const volatile AP_ESC_Telem_Backend::RpmData& rpmdata = _rpm_data[esc_index];
+    AP_ESC_Telem_Backend::RpmData rpmdata;
+    read_rpm_data(esc_index, rpmdata);
+
+    return calc_rpm(esc_index, rpmdata, AP_HAL::micros(), rpm);
+}
 
+bool AP_ESC_Telem::calc_rpm(uint8_t esc_index, const AP_ESC_Telem_Backend::RpmData &rpmdata, uint32_t now_us, float &rpm) const
+{
     if (is_zero(rpmdata.update_rate_hz)) {
         return false;
     }
 
-    const uint32_t now = AP_HAL::micros();
-    if (rpm_data_within_timeout(rpmdata, now, ESC_RPM_DATA_TIMEOUT_US)) {
-        const float slew = MIN(1.0f, (now - rpmdata.last_update_us) * rpmdata.update_rate_hz * (1.0f / 1e6f));
+    if (rpm_data_within_timeout(rpmdata, now_us, ESC_RPM_DATA_TIMEOUT_US)) {
+        const float slew = MIN(1.0f, (now_us - rpmdata.last_update_us) * rpmdata.update_rate_hz * (1.0f / 1e6f));
         rpm = (rpmdata.prev_rpm + (rpmdata.rpm - rpmdata.prev_rpm) * slew);
 
 #if AP_SCRIPTING_ENABLED
@@ -192,6 +206,29 @@ bool AP_ESC_Telem::get_rpm(uint8_t esc_index, float& rpm) const
     return false;
 }
 
+// fill in a snapshot of the rpm of all ESCs at the current time
+void AP_ESC_Telem::get_rpm_snapshot(RpmSnapshot &snapshot) const
+{
+    const uint32_t now = AP_HAL::micros();
+    snapshot.timestamp_us = now;
+    snapshot.valid_mask = 0;
+    snapshot.reported_mask = 0;
+
+    for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
+        AP_ESC_Telem_Backend::RpmData rpmdata;
+        read_rpm_data(i, rpmdata);
+        snapshot.last_update_us[i] = rpmdata.last_update_us;
+        if (was_rpm_data_ever_reported(rpmdata)) {
+            snapshot.reported_mask |= (1U << i);
+        }
+        if (calc_rpm(i, rpmdata, now, snapshot.rpm[i])) {
+            snapshot.valid_mask |= (1U << i);
+        } else {
+            snapshot.rpm[i] = 0;
+        }
+    }
+}
+
 // get an individual ESC's raw rpm if available, returns true on success
 bool AP_ESC_Telem::get_raw_rpm(uint8_t esc_index, float& rpm) const
 {
@@ -199,7 +236,8 @@ bool AP_ESC_Telem::get_raw_rpm(uint8_t esc_index, float& rpm) const
         return false;
     }
 
-    const volatile AP_ESC_Telem_Backend::RpmData& rpmdata = _rpm_data[esc_index];
+    AP_ESC_Telem_Backend::RpmData rpmdata;
+    read_rpm_data(esc_index, rpmdata);
 
     const uint32_t now = AP_HAL::micros();
 
@@ -336,9 +374,13 @@ void AP_ESC_Telem::send_esc_telemetry_mavlink(uint8_t mav_chan)
         bool all_stale = true;
         for (uint8_t j=0; j<4; j++) {
             const uint8_t esc_id = (i * 4 + j) + esc_offset;
-            if (esc_id < ESC_TELEM_MAX_ESCS &&
-                (!_telem_data[esc_id].stale(now) ||
-                 rpm_data_within_timeout(_rpm_data[esc_id], now_us, ESC_RPM_DATA_TIMEOUT_US))) {
+            if (esc_id >= ESC_TELEM_MAX_ESCS) {
+                continue;
+            }
+            AP_ESC_Telem_Backend::RpmData rpmdata;
+            read_rpm_data(esc_id, rpmdata);
+            if (!_telem_data[esc_id].stale(now) ||
+                rpm_data_within_timeout(rpmdata, now_us, ESC_RPM_DATA_TIMEOUT_US)) {
                 all_stale = false;
                 break;
             }
@@ -437,6 +479,10 @@ void AP_ESC_Telem::update_telem_data(const uint8_t esc_index, const AP_ESC_Telem
     _have_data = true;
     volatile AP_ESC_Telem_Backend::TelemetryData &telemdata = _telem_data[esc_index];
 
+    // readers of snapshots retry or give up while the sequence is odd
+    _telem_seq[esc_index].fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
 #if AP_TEMPERATURE_SENSOR_ENABLED
     // always allow external data. Block "internal" if external has ever its ever been set externally then ignore normal "internal" updates
     const bool has_temperature = (data_mask & AP_ESC_Telem_Backend::TelemetryType::TEMPERATURE_EXTERNAL) ||
@@ -480,6 +526,30 @@ void AP_ESC_Telem::update_telem_data(const uint8_t esc_index, const AP_ESC_Telem
     telemdata.count++;
     telemdata.types |= data_mask;
     telemdata.last_update_ms = AP_HAL::millis();
+
+    _telem_seq[esc_index].fetch_add(1, std::memory_order_release);
+}
+
+// get a copy of an ESC's telemetry data which was not torn by an update
+bool AP_ESC_Telem::get_telem_data_snapshot(uint8_t esc_index, AP_ESC_Telem_Backend::TelemetryData &telemdata) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS) {
+        return false;
+    }
+    // a backend that has been preempted part way through an update
+    // will not finish while we spin, so only try a few times
+    for (uint8_t tries = 0; tries < 3; tries++) {
+        const uint32_t seq = _telem_seq[esc_index].load(std::memory_order_acquire);
+        if (seq & 1U) {
+            continue;
+        }
+        memcpy(&telemdata, (const void *)&_telem_data[esc_index], sizeof(telemdata));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_telem_seq[esc_index].load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // record an update to the RPM together with timestamp, this allows the notch values to be slewed
@@ -493,7 +563,9 @@ void AP_ESC_Telem::update_rpm(const uint8_t esc_index, const float new_rpm, cons
     _have_data = true;
 
     const uint32_t now = MAX(1U ,AP_HAL::micros()); // don't allow a value of 0 in, as we use this as a flag in places
-    volatile AP_ESC_Telem_Backend::RpmData& rpmdata = _rpm_data[esc_index];
+    // there is only one writer for each ESC, so both copies hold the
+    // latest data between updates
+    AP_ESC_Telem_Backend::RpmData rpmdata = _rpm_data[esc_index][1];
     const auto last_update_us = rpmdata.last_update_us;
 
     rpmdata.prev_rpm = rpmdata.rpm;
@@ -503,6 +575,14 @@ void AP_ESC_Telem::update_rpm(const uint8_t esc_index, const float new_rpm, cons
     rpmdata.error_rate = error_rate;
     rpmdata.data_valid = true;
 
+    // readers use copy 1 while copy 0 is written and then the reverse
+    std::atomic<uint32_t> &seq = _rpm_seq[esc_index];
+    seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _rpm_data[esc_index][0] = rpmdata;
+    seq.fetch_add(1, std::memory_order_release);
+    _rpm_data[esc_index][1] = rpmdata;
+
 #ifdef ESC_TELEM_DEBUG
     hal.console->printf("RPM: rate=%.1fhz, rpm=%f)\n", rpmdata.update_rate_hz, new_rpm);
 #endif
@@ -572,17 +652,25 @@ void AP_ESC_Telem::update()
     const uint64_t now_us64 = AP_HAL::micros64();
 
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
-        const volatile AP_ESC_Telem_Backend::RpmData &rpmdata = _rpm_data[i];
+        AP_ESC_Telem_Backend::RpmData rpmdata;
+        read_rpm_data(i, rpmdata);
         volatile AP_ESC_Telem_Backend::TelemetryData &telemdata = _telem_data[i];
         // Push received telemetry data into the logging system
         if (logger && logger->logging_enabled()) {
-            if (telemdata.last_update_ms != _last_telem_log_ms[i]
-                || rpmdata.last_update_us != _last_rpm_log_us[i]) {
-
+            AP_ESC_Telem_Backend::TelemetryData telem;
+            // if a backend is part way through an update this is
+            // logged on the next call
+            if ((telemdata.last_update_ms != _last_telem_log_ms[i]
+                 || rpmdata.last_update_us != _last_rpm_log_us[i])
+                && get_telem_data_snapshot(i, telem)) {
+
+                const uint32_t now_us = AP_HAL::micros();
                 float rpm = AP::logger().quiet_nanf();
-                get_rpm(i, rpm);
+                calc_rpm(i, rpmdata, now_us, rpm);
                 float raw_rpm = AP::logger().quiet_nanf();
-                get_raw_rpm(i, raw_rpm);
+                if (rpm_data_within_timeout(rpmdata, now_us, ESC_RPM_DATA_TIMEOUT_US)) {
+                    raw_rpm = rpmdata.rpm;
+                }
 
                 // Write ESC status messages
                 //   id starts from 0
@@ -599,15 +687,15 @@ void AP_ESC_Telem::update()
                     instance    : i,
                     rpm         : rpm,
                     raw_rpm     : raw_rpm,
-                    voltage     : telemdata.voltage,
-                    current     : telemdata.current,
-                    esc_temp    : telemdata.temperature_cdeg,
-                    current_tot : telemdata.consumption_mah,
-                    motor_temp  : telemdata.motor_temp_cdeg,
+                    voltage     : telem.voltage,
+                    current     : telem.current,
+                    esc_temp    : telem.temperature_cdeg,
+                    current_tot : telem.consumption_mah,
+                    motor_temp  : telem.motor_temp_cdeg,
                     error_rate  : rpmdata.error_rate
                 };
                 AP::logger().WriteBlock(&pkt, sizeof(pkt));
-                _last_telem_log_ms[i] = telemdata.last_update_ms;
+                _last_telem_log_ms[i] = telem.last_update_ms;
                 _last_rpm_log_us[i] = rpmdata.last_update_us;
             }
 
@@ -661,14 +749,18 @@ void AP_ESC_Telem::update()
 
     const uint32_t now_us = AP_HAL::micros();
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
-        // Invalidate RPM data if not received for too long
-        if ((now_us - _rpm_data[i].last_update_us) > ESC_RPM_DATA_TIMEOUT_US) {
-            _rpm_data[i].data_valid = false;
+        // Remember RPM data which was not received for too long so that
+        // it stays invalid when the time wraps. The data itself belongs
+        // to the backend, readers compare its timestamp with this
+        AP_ESC_Telem_Backend::RpmData rpmdata;
+        read_rpm_data(i, rpmdata);
+        if ((now_us - rpmdata.last_update_us) > ESC_RPM_DATA_TIMEOUT_US) {
+            _rpm_expired_us[i].store(rpmdata.last_update_us, std::memory_order_relaxed);
         }
     }
 }
 
-bool AP_ESC_Telem::rpm_data_within_timeout(const volatile AP_ESC_Telem_Backend::RpmData &instance, const uint32_t now_us, const uint32_t timeout_us)
+bool AP_ESC_Telem::rpm_data_within_timeout(const AP_ESC_Telem_Backend::RpmData &instance, const uint32_t now_us, const uint32_t timeout_us)
 {
     // easy case, has the time window been crossed so it's invalid
     if ((now_us - instance.last_update_us) > timeout_us) {
@@ -682,11 +774,30 @@ bool AP_ESC_Telem::rpm_data_within_timeout(const volatile AP_ESC_Telem_Backend::
     return instance.data_valid;
 }
 
-bool AP_ESC_Telem::was_rpm_data_ever_reported(const volatile AP_ESC_Telem_Backend::RpmData &instance)
+bool AP_ESC_Telem::was_rpm_data_ever_reported(const AP_ESC_Telem_Backend::RpmData &instance)
 {
     return instance.last_update_us > 0;
 }
 
+// copy an ESC's rpm data from whichever copy is not being written
+void AP_ESC_Telem::read_rpm_data(uint8_t esc_index, AP_ESC_Telem_Backend::RpmData &rpmdata) const
+{
+    const std::atomic<uint32_t> &seq = _rpm_seq[esc_index];
+    bool torn = true;
+    // this only fails if we were preempted by the backend, which will
+    // have finished by the time we run again, so a retry is enough
+    for (uint8_t i = 0; i < ESC_RPM_READ_RETRIES && torn; i++) {
+        const uint32_t seq1 = seq.load(std::memory_order_acquire);
+        rpmdata = _rpm_data[esc_index][seq1 & 1U];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        torn = seq.load(std::memory_order_relaxed) != seq1;
+    }
+    // a torn copy is not used, nor data which update() found had timed out
+    if (torn || rpmdata.last_update_us == _rpm_expired_us[esc_index].load(std::memory_order_relaxed)) {
+        rpmdata.data_valid = false;
+    }
+}
+
 #if AP_SCRIPTING_ENABLED
 /*
   set RPM scale factor from script
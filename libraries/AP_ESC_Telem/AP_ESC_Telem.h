@@ -4,6 +4,7 @@
 #include <AP_Param/AP_Param.h>
 #include <SRV_Channel/SRV_Channel_config.h>
 #include "AP_ESC_Telem_Backend.h"
+#include <atomic>
 
 #if HAL_WITH_ESC_TELEM
 
@@ -32,11 +33,28 @@ public:
     // get an individual ESC's raw rpm if available
     bool get_raw_rpm(uint8_t esc_index, float& rpm) const;
 
+    // the rpm of all ESCs at one point in time
+    struct RpmSnapshot {
+        uint32_t timestamp_us;                          // time the snapshot was taken
+        uint32_t valid_mask;                            // ESCs for which get_rpm() would succeed
+        uint32_t reported_mask;                         // ESCs which have ever reported rpm
+        float rpm[ESC_TELEM_MAX_ESCS];                  // slewed rpm as from get_rpm(), zero if not valid
+        uint32_t last_update_us[ESC_TELEM_MAX_ESCS];    // time of the last rpm update, zero if never
+    };
+
+    // fill in a consistent snapshot of the rpm of all ESCs. This
+    // never blocks on the backends, so is safe to call at the gyro rate
+    void get_rpm_snapshot(RpmSnapshot &snapshot) const;
+
     // get raw telemetry data, used by IOMCU
     const volatile AP_ESC_Telem_Backend::TelemetryData& get_telem_data(uint8_t esc_index) const {
         return _telem_data[esc_index];
     }
 
+    // get a copy of an ESC's telemetry data which was not torn by an
+    // update, returns false if the data was being updated
+    bool get_telem_data_snapshot(uint8_t esc_index, AP_ESC_Telem_Backend::TelemetryData &telemdata) const;
+
     // return the average motor RPM
     float get_average_motor_rpm(uint32_t servo_channel_mask) const;
 
@@ -115,8 +133,15 @@ public:
 private:
 
     // helper that validates RPM data
-    static bool rpm_data_within_timeout (const volatile AP_ESC_Telem_Backend::RpmData &instance, const uint32_t now_us, const uint32_t timeout_us);
-    static bool was_rpm_data_ever_reported (const volatile AP_ESC_Telem_Backend::RpmData &instance);
+    static bool rpm_data_within_timeout (const AP_ESC_Telem_Backend::RpmData &instance, const uint32_t now_us, const uint32_t timeout_us);
+    static bool was_rpm_data_ever_reported (const AP_ESC_Telem_Backend::RpmData &instance);
+
+    // copy an ESC's rpm data, without blocking on its backend. The
+    // copy is marked not valid if it was torn by an update
+    void read_rpm_data(uint8_t esc_index, AP_ESC_Telem_Backend::RpmData &rpmdata) const;
+
+    // slewed and scaled rpm from rpmdata at now_us, returns true if the data is valid
+    bool calc_rpm(uint8_t esc_index, const AP_ESC_Telem_Backend::RpmData &rpmdata, uint32_t now_us, float &rpm) const;
 
 #if AP_EXTENDED_DSHOT_TELEM_V2_ENABLED
     // helpers that aggregate data in EDTv2 messages
@@ -124,10 +149,17 @@ private:
     static uint16_t merge_edt2_stress(uint16_t old_stress, uint16_t new_stress);
 #endif
 
-    // rpm data
-    volatile AP_ESC_Telem_Backend::RpmData _rpm_data[ESC_TELEM_MAX_ESCS];
-    // telemetry data
+    // rpm data. Each ESC has two copies so that readers always have
+    // one which is not being written, selected by the low bit of
+    // _rpm_seq, which backends increment before writing each copy
+    AP_ESC_Telem_Backend::RpmData _rpm_data[ESC_TELEM_MAX_ESCS][2];
+    std::atomic<uint32_t> _rpm_seq[ESC_TELEM_MAX_ESCS];
+    // last_update_us of rpm data which update() found had timed out,
+    // readers treat data with this timestamp as invalid
+    std::atomic<uint32_t> _rpm_expired_us[ESC_TELEM_MAX_ESCS];
+    // telemetry data, _telem_seq is odd while a backend is writing it
     volatile AP_ESC_Telem_Backend::TelemetryData _telem_data[ESC_TELEM_MAX_ESCS];
+    std::atomic<uint32_t> _telem_seq[ESC_TELEM_MAX_ESCS];
 
     uint32_t _last_telem_log_ms[ESC_TELEM_MAX_ESCS];
     uint32_t _last_rpm_log_us[ESC_TELEM_MAX_ESCS];
@@ -0,0 +1,140 @@
+#include <AP_gtest.h>
+
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
+
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_ESC_TELEM
+
+static AP_ESC_Telem esc_telem;
+
+// stop the clock so that rpm timestamps are known
+static void set_time_us(uint64_t time_us)
+{
+    hal.scheduler->stop_clock(time_us);
+}
+
+// readers between updates see the prev_rpm and rpm of one update
+TEST(AP_ESC_Telem, interleaved_update_and_read)
+{
+    const uint8_t esc = 0;
+    uint64_t now_us = 1000000;
+    // the first update sets the update rate
+    set_time_us(now_us);
+    esc_telem.update_rpm(esc, 0, 0);
+    for (uint16_t i = 1; i <= 100; i++) {
+        now_us += 1000;
+        set_time_us(now_us);
+        esc_telem.update_rpm(esc, i * 100.0f, 0);
+
+        float rpm;
+        EXPECT_TRUE(esc_telem.get_raw_rpm(esc, rpm));
+        EXPECT_FLOAT_EQ(i * 100.0f, rpm);
+        // slewed rpm starts at the previous value
+        EXPECT_TRUE(esc_telem.get_rpm(esc, rpm));
+        EXPECT_FLOAT_EQ((i - 1) * 100.0f, rpm);
+
+        AP_ESC_Telem::RpmSnapshot snapshot;
+        esc_telem.get_rpm_snapshot(snapshot);
+        EXPECT_EQ(uint32_t(now_us), snapshot.last_update_us[esc]);
+        EXPECT_TRUE(snapshot.valid_mask & (1U << esc));
+        EXPECT_TRUE(snapshot.reported_mask & (1U << esc));
+        EXPECT_FLOAT_EQ((i - 1) * 100.0f, snapshot.rpm[esc]);
+        EXPECT_FALSE(snapshot.reported_mask & (1U << (esc + 1)));
+
+        // and reaches the new value one update interval later
+        set_time_us(now_us + 1000);
+        EXPECT_TRUE(esc_telem.get_rpm(esc, rpm));
+        EXPECT_FLOAT_EQ(i * 100.0f, rpm);
+
+        // the logging thread runs between the updates
+        esc_telem.update();
+    }
+}
+
+TEST(AP_ESC_Telem, timeout)
+{
+    const uint8_t esc = 1;
+    const uint64_t start_us = 5000000;
+    set_time_us(start_us);
+    esc_telem.update_rpm(esc, 1000, 0);
+
+    float rpm;
+    set_time_us(start_us + ESC_RPM_DATA_TIMEOUT_US);
+    EXPECT_TRUE(esc_telem.get_raw_rpm(esc, rpm));
+    set_time_us(start_us + ESC_RPM_DATA_TIMEOUT_US + 1);
+    EXPECT_FALSE(esc_telem.get_raw_rpm(esc, rpm));
+    EXPECT_FALSE(esc_telem.get_rpm(esc, rpm));
+
+    AP_ESC_Telem::RpmSnapshot snapshot;
+    esc_telem.get_rpm_snapshot(snapshot);
+    EXPECT_FALSE(snapshot.valid_mask & (1U << esc));
+    EXPECT_TRUE(snapshot.reported_mask & (1U << esc));
+    EXPECT_EQ(0, snapshot.rpm[esc]);
+}
+
+// data which update() saw time out must not become valid again when
+// micros() wraps, and new data must be valid straight away
+TEST(AP_ESC_Telem, timeout_across_wrap)
+{
+    const uint8_t esc = 2;
+    const uint64_t start_us = 10000000;
+    set_time_us(start_us);
+    esc_telem.update_rpm(esc, 1000, 0);
+
+    set_time_us(start_us + 2 * ESC_RPM_DATA_TIMEOUT_US);
+    esc_telem.update();
+
+    float rpm;
+    set_time_us(start_us + (1ULL << 32) + 100);
+    EXPECT_FALSE(esc_telem.get_raw_rpm(esc, rpm));
+    EXPECT_FALSE(esc_telem.get_rpm(esc, rpm));
+
+    esc_telem.update_rpm(esc, 2000, 0);
+    EXPECT_TRUE(esc_telem.get_raw_rpm(esc, rpm));
+    EXPECT_FLOAT_EQ(2000, rpm);
+}
+
+// a backend thread updating while the main thread reads never gives
+// a reader a stale or mixed copy, or blocks it
+TEST(AP_ESC_Telem, concurrent_update_and_read)
+{
+    const uint8_t esc = 3;
+    const uint32_t n_updates = 200000;
+    set_time_us(20000000);
+    esc_telem.update_rpm(esc, 0, 0);
+
+    std::thread writer([esc, n_updates]() {
+        for (uint32_t i = 1; i <= n_updates; i++) {
+            esc_telem.update_rpm(esc, i, 0);
+        }
+    });
+
+    float last_rpm = 0;
+    uint32_t n_reads = 0;
+    while (last_rpm < n_updates) {
+        AP_ESC_Telem::RpmSnapshot snapshot;
+        esc_telem.get_rpm_snapshot(snapshot);
+        float raw_rpm;
+        if (esc_telem.get_raw_rpm(esc, raw_rpm)) {
+            EXPECT_GE(raw_rpm, last_rpm);
+            EXPECT_LE(raw_rpm, n_updates);
+            last_rpm = raw_rpm;
+        }
+        if (snapshot.valid_mask & (1U << esc)) {
+            // the clock is stopped so slewed rpm is the previous value
+            EXPECT_LE(snapshot.rpm[esc], last_rpm);
+            EXPECT_GE(snapshot.rpm[esc], 0);
+        }
+        n_reads++;
+    }
+    writer.join();
+
+    EXPECT_GT(n_reads, 0U);
+}
+
+#endif // HAL_WITH_ESC_TELEM
+
+AP_GTEST_MAIN()
@@ -63,6 +63,7 @@ struct dirent {
 #endif
 
 #include "AP_Filesystem_backend.h"
+#include "AP_Filesystem_AsyncIO.h"
 
 class AP_Filesystem {
 private:
@@ -141,6 +142,11 @@ public:
     // get_singleton for scripting
     static AP_Filesystem *get_singleton(void);
 
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    // queue for asynchronous reads and writes on open files
+    AP_Filesystem_AsyncIO &async_io(void) { return _async_io; }
+#endif
+
 private:
     struct Backend {
         const char *prefix;
@@ -165,6 +171,10 @@ private:
         struct dirent de;
         uint8_t d_off;
     } virtual_dirent;
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    AP_Filesystem_AsyncIO _async_io;
+#endif
 };
 
 namespace AP {
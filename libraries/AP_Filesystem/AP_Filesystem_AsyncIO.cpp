@@ -0,0 +1,301 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  asynchronous IO queue for AP_Filesystem
+ */
+
+#include "AP_Filesystem_AsyncIO.h"
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+
+#include "AP_Filesystem.h"
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+// maximum number of requests merged into one backend operation
+#define ASYNC_IO_MAX_BATCH 8
+
+static const char *priority_names[] = { "LOGGING", "TERRAIN", "FTP", "SCRIPTING" };
+static_assert(ARRAY_SIZE(priority_names) == uint8_t(AP_Filesystem_AsyncIO::Priority::NUM_PRIORITIES), "priority names");
+
+bool AP_Filesystem_AsyncIO::alloc_queues(void)
+{
+    for (auto &q : queues) {
+        if (q.requests == nullptr) {
+            q.requests = NEW_NOTHROW ObjectArray<Request>(AP_FILESYSTEM_ASYNC_IO_QUEUE_LENGTH);
+        }
+        if (q.requests == nullptr || q.requests->size() == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  allocate the queues and start the IO thread on first use
+ */
+bool AP_Filesystem_AsyncIO::init(void)
+{
+    if (initialised) {
+        return true;
+    }
+    if (init_failed) {
+        return false;
+    }
+    if (!alloc_queues() ||
+        !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Filesystem_AsyncIO::io_thread, void),
+                                      "fs_io",
+                                      AP_FILESYSTEM_ASYNC_IO_STACK_SIZE,
+                                      AP_HAL::Scheduler::PRIORITY_IO, 1)) {
+        init_failed = true;
+        return false;
+    }
+    initialised = true;
+    return true;
+}
+
+bool AP_Filesystem_AsyncIO::push(Priority prio, const Request &req)
+{
+    if (prio >= Priority::NUM_PRIORITIES) {
+        return false;
+    }
+    {
+        WITH_SEMAPHORE(sem);
+        if (!init()) {
+            return false;
+        }
+        Queue &q = queues[uint8_t(prio)];
+        if (!q.requests->push(req)) {
+            q.stats.rejected++;
+            return false;
+        }
+        q.stats.requests++;
+        q.stats.max_depth = MAX(q.stats.max_depth, q.requests->available());
+    }
+    pending_sem.signal();
+    return true;
+}
+
+bool AP_Filesystem_AsyncIO::read(int fd, void *buf, uint32_t count, int32_t offset, Priority prio, Callback cb)
+{
+    const Request req { Op::READ, fd, offset, (uint8_t *)buf, count, cb, AP_HAL::micros() };
+    return push(prio, req);
+}
+
+bool AP_Filesystem_AsyncIO::write(int fd, const void *buf, uint32_t count, int32_t offset, Priority prio, Callback cb)
+{
+    const Request req { Op::WRITE, fd, offset, (uint8_t *)buf, count, cb, AP_HAL::micros() };
+    return push(prio, req);
+}
+
+bool AP_Filesystem_AsyncIO::fsync(int fd, Priority prio, Callback cb)
+{
+    const Request req { Op::FSYNC, fd, -1, nullptr, 0, cb, AP_HAL::micros() };
+    return push(prio, req);
+}
+
+bool AP_Filesystem_AsyncIO::cancel(int fd)
+{
+    WITH_SEMAPHORE(sem);
+    for (auto &q : queues) {
+        if (q.requests == nullptr) {
+            continue;
+        }
+        uint16_t i = 0;
+        while (i < q.requests->available()) {
+            if ((*q.requests)[i]->fd == fd) {
+                q.requests->remove(i);
+                q.stats.cancelled++;
+            } else {
+                i++;
+            }
+        }
+    }
+    return active_fd != fd;
+}
+
+uint16_t AP_Filesystem_AsyncIO::queue_depth(Priority prio)
+{
+    if (prio >= Priority::NUM_PRIORITIES) {
+        return 0;
+    }
+    WITH_SEMAPHORE(sem);
+    const Queue &q = queues[uint8_t(prio)];
+    return q.requests != nullptr ? q.requests->available() : 0;
+}
+
+/*
+  return true if next can be done in the same backend operation as
+  prev, where total is the number of bytes already in the batch
+ */
+bool AP_Filesystem_AsyncIO::can_merge(const Request &prev, const Request &next, uint32_t total) const
+{
+    if (next.op != prev.op || next.fd != prev.fd) {
+        return false;
+    }
+    if (next.op == Op::FSYNC) {
+        // one fsync covers everything written before it
+        return true;
+    }
+    if (total + next.count > AP_FILESYSTEM_ASYNC_IO_MERGE_MAX ||
+        next.buf != prev.buf + prev.count) {
+        return false;
+    }
+    if (next.offset < 0) {
+        return prev.offset < 0;
+    }
+    return prev.offset >= 0 && uint32_t(next.offset) == uint32_t(prev.offset) + prev.count;
+}
+
+/*
+  take the head of the highest priority non-empty queue, plus any
+  following requests in that queue which can be merged with it
+ */
+uint8_t AP_Filesystem_AsyncIO::take_batch(Request *batch, uint8_t max_batch, uint8_t &prio)
+{
+    WITH_SEMAPHORE(sem);
+    for (prio=0; prio<ARRAY_SIZE(queues); prio++) {
+        auto *requests = queues[prio].requests;
+        if (requests == nullptr || !requests->pop(batch[0])) {
+            continue;
+        }
+        uint8_t n = 1;
+        uint32_t total = batch[0].count;
+        while (n < max_batch) {
+            const Request *next = (*requests)[0];
+            if (next == nullptr || !can_merge(batch[n-1], *next, total)) {
+                break;
+            }
+            batch[n] = *next;
+            total += next->count;
+            n++;
+            UNUSED_RESULT(requests->pop());
+        }
+        active_fd = batch[0].fd;
+        return n;
+    }
+    return 0;
+}
+
+/*
+  run a request of total bytes on the backend
+ */
+int32_t AP_Filesystem_AsyncIO::run(const Request &req, uint32_t total)
+{
+    auto &fs = AP::FS();
+    if (req.offset >= 0 && fs.lseek(req.fd, req.offset, SEEK_SET) != req.offset) {
+        return -1;
+    }
+    switch (req.op) {
+    case Op::READ:
+        return fs.read(req.fd, req.buf, total);
+    case Op::WRITE:
+        return fs.write(req.fd, req.buf, total);
+    case Op::FSYNC:
+        return fs.fsync(req.fd);
+    }
+    return -1;
+}
+
+/*
+  run the next batch of requests and hand each request its share of
+  the result, in order
+ */
+bool AP_Filesystem_AsyncIO::service(void)
+{
+    Request batch[ASYNC_IO_MAX_BATCH];
+    uint8_t prio;
+    const uint8_t n = take_batch(batch, ARRAY_SIZE(batch), prio);
+    if (n == 0) {
+        return false;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i=0; i<n; i++) {
+        total += batch[i].count;
+    }
+    const int32_t ret = run(batch[0], total);
+
+    const uint32_t now_us = AP_HAL::micros();
+    uint32_t remaining = ret > 0 ? ret : 0;
+    uint32_t max_latency_us = 0;
+    uint64_t total_latency_us = 0;
+    for (uint8_t i=0; i<n; i++) {
+        const Request &req = batch[i];
+        int32_t result = ret;
+        if (ret >= 0 && req.op != Op::FSYNC) {
+            result = MIN(req.count, remaining);
+            remaining -= result;
+        }
+        const uint32_t latency_us = now_us - req.queued_us;
+        max_latency_us = MAX(max_latency_us, latency_us);
+        total_latency_us += latency_us;
+        if (req.cb) {
+            req.cb(result);
+        }
+    }
+
+    WITH_SEMAPHORE(sem);
+    active_fd = -1;
+    Stats &stats = queues[prio].stats;
+    stats.backend_ops++;
+    stats.completed += n;
+    stats.max_latency_us = MAX(stats.max_latency_us, max_latency_us);
+    stats.total_latency_us += total_latency_us;
+    if (ret > 0) {
+        stats.bytes += ret;
+    }
+    return true;
+}
+
+void AP_Filesystem_AsyncIO::io_thread(void)
+{
+    while (true) {
+        if (!service()) {
+            // the timeout only bounds how long a lost signal can delay us
+            IGNORE_RETURN(pending_sem.wait(100000));
+        }
+    }
+}
+
+/*
+  report queue statistics. REQ/OP shows how well requests are being
+  merged, CAN counts requests dropped by cancel(), latency is from queueing to completion
+ */
+void AP_Filesystem_AsyncIO::io_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("FSIOV1\n");
+    WITH_SEMAPHORE(sem);
+    for (uint8_t i=0; i<ARRAY_SIZE(queues); i++) {
+        const Queue &q = queues[i];
+        const Stats &s = q.stats;
+        str.printf("%-9s DEPTH=%3u MAXDEPTH=%3u REQ=%8u REQ/OP=%5.2f REJ=%5u CAN=%5u KB=%8u AVGLAT=%7.2fms MAXLAT=%7.2fms\n",
+                   priority_names[i],
+                   unsigned(q.requests != nullptr ? q.requests->available() : 0),
+                   unsigned(s.max_depth),
+                   unsigned(s.requests),
+                   s.backend_ops ? float(s.completed) / s.backend_ops : 0.0f,
+                   unsigned(s.rejected),
+                   unsigned(s.cancelled),
+                   unsigned(s.bytes / 1024),
+                   s.completed ? float(s.total_latency_us) * 0.001f / s.completed : 0.0f,
+                   s.max_latency_us * 0.001f);
+    }
+}
+
+#endif // AP_FILESYSTEM_ASYNC_IO_ENABLED
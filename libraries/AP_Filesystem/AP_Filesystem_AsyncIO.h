@@ -0,0 +1,147 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  asynchronous IO queue for AP_Filesystem
+
+  Reads, writes and fsyncs on already open file descriptors are queued
+  and run by a single filesystem IO thread, so subsystems sharing a
+  slow SD card do not each need their own polling thread and do not
+  stall each other. Requests are serviced in priority order (logging,
+  then terrain, then FTP, then scripting) and in order within a
+  priority.
+
+  Writes to the same file which are contiguous both in the file and in
+  memory are merged into a single backend write, and repeated fsyncs
+  of the same file are merged into one.
+
+  The completion callback is called from the filesystem IO thread
+  with the result the equivalent blocking call would have returned.
+  The buffer must remain valid until the callback has been called.
+ */
+#pragma once
+
+#include "AP_Filesystem_config.h"
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+class ExpandingString;
+
+class AP_Filesystem_AsyncIO {
+public:
+    // priority classes, highest priority first
+    enum class Priority : uint8_t {
+        LOGGING = 0,
+        TERRAIN = 1,
+        FTP = 2,
+        SCRIPTING = 3,
+        NUM_PRIORITIES
+    };
+
+    // called with the bytes transferred, or the fsync return value
+    FUNCTOR_TYPEDEF(Callback, void, int32_t);
+
+    /*
+      queue a read of count bytes into buf. If offset is negative the
+      read starts at the current file position, otherwise it seeks to
+      offset first. Returns false if the queue for this priority is full
+     */
+    bool read(int fd, void *buf, uint32_t count, int32_t offset, Priority prio, Callback cb);
+
+    // queue a write, with offset as for read()
+    bool write(int fd, const void *buf, uint32_t count, int32_t offset, Priority prio, Callback cb);
+
+    // queue an fsync, run after all earlier requests at this priority
+    bool fsync(int fd, Priority prio, Callback cb);
+
+    /*
+      drop all requests queued on fd without calling their
+      callbacks. Returns false if a request on fd is being run, in
+      which case its callback is still to come
+     */
+    bool cancel(int fd);
+
+    // number of requests queued at a priority, not counting one in progress
+    uint16_t queue_depth(Priority prio);
+
+    // report queue depth and latency statistics, for @SYS/fsio.txt
+    void io_info(ExpandingString &str);
+
+protected:
+    // allocate the queues, the unit tests use this without the IO thread
+    bool alloc_queues(void);
+
+    // run the next batch of requests and call their callbacks. Returns
+    // false if all queues are empty
+    bool service(void);
+
+    bool initialised;
+
+private:
+    enum class Op : uint8_t {
+        READ,
+        WRITE,
+        FSYNC,
+    };
+
+    struct Request {
+        Op op;
+        int fd;
+        int32_t offset;
+        uint8_t *buf;
+        uint32_t count;
+        Callback cb;
+        uint32_t queued_us;
+    };
+
+    struct Stats {
+        uint32_t requests;
+        uint32_t completed;
+        uint32_t backend_ops;
+        uint32_t rejected;
+        uint32_t cancelled;
+        uint16_t max_depth;
+        uint32_t max_latency_us;
+        uint64_t total_latency_us;
+        uint32_t bytes;
+    };
+
+    struct Queue {
+        ObjectArray<Request> *requests;
+        Stats stats;
+    };
+
+    bool push(Priority prio, const Request &req);
+    bool init(void);
+    void io_thread(void);
+
+    // take the next batch of requests, merged into one backend
+    // operation. Returns the number of requests taken
+    uint8_t take_batch(Request *batch, uint8_t max_batch, uint8_t &prio);
+    bool can_merge(const Request &prev, const Request &next, uint32_t total) const;
+    int32_t run(const Request &req, uint32_t total);
+
+    Queue queues[uint8_t(Priority::NUM_PRIORITIES)] {};
+    HAL_Semaphore sem;
+    HAL_BinarySemaphore pending_sem;
+    bool init_failed;
+
+    // file descriptor of the batch being run, -1 when idle
+    int active_fd = -1;
+};
+
+#endif // AP_FILESYSTEM_ASYNC_IO_ENABLED
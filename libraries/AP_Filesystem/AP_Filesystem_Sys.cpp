@@ -24,8 +24,11 @@
 
 #include <AP_Math/AP_Math.h>
 #include <AP_CANManager/AP_CANManager.h>
+#include <AP_DroneCAN/AP_DroneCAN.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Networking/AP_Networking.h>
+#include <AP_Scripting/AP_Scripting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,6 +43,16 @@ static const SysFileList sysfs_file_list[] = {
     {"memory.txt"},
     {"uarts.txt"},
     {"timers.txt"},
+    {"storage.txt"},
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    {"netports.txt"},
+#endif
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    {"fsio.txt"},
+#endif
+#if AP_SCRIPTING_ENABLED
+    {"scripts.txt"},
+#endif
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
 #endif
@@ -120,6 +133,27 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+    if (strcmp(fname, "storage.txt") == 0) {
+        hal.storage->storage_info(*r.str);
+    }
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    if (strcmp(fname, "netports.txt") == 0) {
+        AP::network().ports_info(*r.str);
+    }
+#endif
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    if (strcmp(fname, "fsio.txt") == 0) {
+        AP::FS().async_io().io_info(*r.str);
+    }
+#endif
+#if AP_SCRIPTING_ENABLED
+    if (strcmp(fname, "scripts.txt") == 0) {
+        AP_Scripting *scripting = AP_Scripting::get_singleton();
+        if (scripting != nullptr) {
+            scripting->scripts_info(*r.str);
+        }
+    }
+#endif
 #if HAL_CANMANAGER_ENABLED
     if (strcmp(fname, "can_log.txt") == 0) {
         AP::can().log_retrieve(*r.str);
@@ -135,6 +169,14 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (can_stats_num != -1 && can_stats_num < HAL_NUM_CAN_IFACES) {
         if (hal.can[can_stats_num] != nullptr) {
             hal.can[can_stats_num]->get_stats(*r.str);
+#if HAL_ENABLE_DRONECAN_DRIVERS
+            for (uint8_t i = 0; i < HAL_MAX_CAN_PROTOCOL_DRIVERS; i++) {
+                AP_DroneCAN *dronecan = AP_DroneCAN::get_dronecan(i);
+                if (dronecan != nullptr) {
+                    dronecan->get_canard_iface().get_tx_stats(hal.can[can_stats_num], *r.str);
+                }
+            }
+#endif
         }
     }
 #endif
@@ -53,3 +53,22 @@
 #ifndef AP_FILESYSTEM_SYS_FLASH_ENABLED
 #define AP_FILESYSTEM_SYS_FLASH_ENABLED CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
 #endif
+
+// asynchronous IO queue, serviced by a single filesystem IO thread,
+// used by terrain and MAVLink FTP
+#ifndef AP_FILESYSTEM_ASYNC_IO_ENABLED
+#define AP_FILESYSTEM_ASYNC_IO_ENABLED (AP_FILESYSTEM_FILE_WRITING_ENABLED && HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+#ifndef AP_FILESYSTEM_ASYNC_IO_QUEUE_LENGTH
+#define AP_FILESYSTEM_ASYNC_IO_QUEUE_LENGTH 16
+#endif
+
+// maximum bytes merged into a single backend read or write
+#ifndef AP_FILESYSTEM_ASYNC_IO_MERGE_MAX
+#define AP_FILESYSTEM_ASYNC_IO_MERGE_MAX 4096
+#endif
+
+#ifndef AP_FILESYSTEM_ASYNC_IO_STACK_SIZE
+#define AP_FILESYSTEM_ASYNC_IO_STACK_SIZE 2048
+#endif
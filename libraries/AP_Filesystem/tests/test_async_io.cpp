@@ -0,0 +1,198 @@
+#include <AP_gtest.h>
+
+#include <AP_Filesystem/AP_Filesystem.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+
+using Priority = AP_Filesystem_AsyncIO::Priority;
+
+// queue with the requests run by the test rather than an IO thread
+class TestAsyncIO : public AP_Filesystem_AsyncIO {
+public:
+    TestAsyncIO() {
+        initialised = alloc_queues();
+    }
+    using AP_Filesystem_AsyncIO::service;
+
+    // run everything queued, returning the number of backend operations
+    uint8_t run_all() {
+        uint8_t ops = 0;
+        while (service()) {
+            ops++;
+        }
+        return ops;
+    }
+};
+
+// the order requests completed in and their results
+static struct {
+    uint8_t ids[16];
+    int32_t results[16];
+    uint8_t count;
+} completions;
+
+class Completion {
+public:
+    Completion(uint8_t _id) : id(_id) {}
+
+    AP_Filesystem_AsyncIO::Callback cb() {
+        return FUNCTOR_BIND_MEMBER(&Completion::done, void, int32_t);
+    }
+
+    // when set, cancel fd from the callback
+    TestAsyncIO *cancel_io = nullptr;
+    int cancel_fd = -1;
+    bool cancel_ret;
+
+private:
+    void done(int32_t result) {
+        if (completions.count < ARRAY_SIZE(completions.ids)) {
+            completions.ids[completions.count] = id;
+            completions.results[completions.count] = result;
+            completions.count++;
+        }
+        if (cancel_io != nullptr) {
+            cancel_ret = cancel_io->cancel(cancel_fd);
+        }
+    }
+
+    uint8_t id;
+};
+
+static int open_test_file(const char *name)
+{
+    memset(&completions, 0, sizeof(completions));
+    return AP::FS().open(name, O_RDWR|O_CREAT|O_TRUNC);
+}
+
+// priority classes are serviced highest first, and in order within a class
+TEST(AP_Filesystem_AsyncIO, ordering)
+{
+    TestAsyncIO io;
+    const int fd = open_test_file("async_io_order.bin");
+    ASSERT_NE(-1, fd);
+
+    const char data[] = "0123456789";
+    Completion scripting{0}, ftp{1}, terrain{2}, log1{3}, log2{4}, log_sync{5};
+    EXPECT_TRUE(io.write(fd, data, 4, 30, Priority::SCRIPTING, scripting.cb()));
+    EXPECT_TRUE(io.write(fd, data, 3, 20, Priority::FTP, ftp.cb()));
+    EXPECT_TRUE(io.write(fd, data, 2, 10, Priority::TERRAIN, terrain.cb()));
+    EXPECT_TRUE(io.write(fd, data, 1, 0, Priority::LOGGING, log1.cb()));
+    // not contiguous with the first logging write, so not merged with it
+    EXPECT_TRUE(io.write(fd, data, 5, 40, Priority::LOGGING, log2.cb()));
+    EXPECT_TRUE(io.fsync(fd, Priority::LOGGING, log_sync.cb()));
+    EXPECT_EQ(3U, io.queue_depth(Priority::LOGGING));
+    EXPECT_EQ(1U, io.queue_depth(Priority::SCRIPTING));
+
+    EXPECT_EQ(6U, io.run_all());
+    EXPECT_EQ(0U, io.queue_depth(Priority::LOGGING));
+
+    const uint8_t expected_ids[] { 3, 4, 5, 2, 1, 0 };
+    const int32_t expected_results[] { 1, 5, 0, 2, 3, 4 };
+    ASSERT_EQ(ARRAY_SIZE(expected_ids), completions.count);
+    for (uint8_t i=0; i<completions.count; i++) {
+        EXPECT_EQ(expected_ids[i], completions.ids[i]);
+        EXPECT_EQ(expected_results[i], completions.results[i]);
+    }
+
+    AP::FS().close(fd);
+    AP::FS().unlink("async_io_order.bin");
+}
+
+// contiguous requests are merged, and each callback gets its share
+TEST(AP_Filesystem_AsyncIO, completion)
+{
+    TestAsyncIO io;
+    const int fd = open_test_file("async_io_completion.bin");
+    ASSERT_NE(-1, fd);
+
+    const char data[] = "0123456789";
+    Completion w1{0}, w2{1};
+    EXPECT_TRUE(io.write(fd, data, 4, 0, Priority::TERRAIN, w1.cb()));
+    EXPECT_TRUE(io.write(fd, &data[4], 6, 4, Priority::TERRAIN, w2.cb()));
+    EXPECT_EQ(1U, io.run_all());
+
+    char buf[10] {};
+    Completion r1{2}, r2{3}, r3{4};
+    EXPECT_TRUE(io.read(fd, buf, sizeof(buf), 0, Priority::FTP, r1.cb()));
+    EXPECT_EQ(1U, io.run_all());
+    EXPECT_EQ(0, memcmp(buf, data, sizeof(buf)));
+
+    // a read past the end of the file is short, as for read()
+    EXPECT_TRUE(io.read(fd, buf, sizeof(buf), 6, Priority::FTP, r2.cb()));
+    EXPECT_EQ(1U, io.run_all());
+
+    // a failure is passed to the callback
+    EXPECT_TRUE(io.read(-1, buf, sizeof(buf), 0, Priority::FTP, r3.cb()));
+    EXPECT_EQ(1U, io.run_all());
+
+    const int32_t expected_results[] { 4, 6, 10, 4, -1 };
+    ASSERT_EQ(ARRAY_SIZE(expected_results), completions.count);
+    for (uint8_t i=0; i<completions.count; i++) {
+        EXPECT_EQ(i, completions.ids[i]);
+        EXPECT_EQ(expected_results[i], completions.results[i]);
+    }
+
+    AP::FS().close(fd);
+    AP::FS().unlink("async_io_completion.bin");
+}
+
+// cancelled requests are dropped without their callbacks being called
+TEST(AP_Filesystem_AsyncIO, cancellation)
+{
+    TestAsyncIO io;
+    const int fd1 = open_test_file("async_io_cancel1.bin");
+    const int fd2 = AP::FS().open("async_io_cancel2.bin", O_RDWR|O_CREAT|O_TRUNC);
+    ASSERT_NE(-1, fd1);
+    ASSERT_NE(-1, fd2);
+
+    const char data[] = "0123456789";
+    Completion w1{0}, w2{1}, w3{2}, w4{3};
+    EXPECT_TRUE(io.write(fd1, data, 4, 0, Priority::LOGGING, w1.cb()));
+    EXPECT_TRUE(io.write(fd2, data, 4, 0, Priority::LOGGING, w2.cb()));
+    EXPECT_TRUE(io.write(fd1, data, 4, 100, Priority::TERRAIN, w3.cb()));
+    EXPECT_TRUE(io.fsync(fd1, Priority::SCRIPTING, w4.cb()));
+
+    // nothing on fd1 is running, so all of it is dropped
+    EXPECT_TRUE(io.cancel(fd1));
+    EXPECT_EQ(1U, io.queue_depth(Priority::LOGGING));
+    EXPECT_EQ(0U, io.queue_depth(Priority::TERRAIN));
+    EXPECT_EQ(0U, io.queue_depth(Priority::SCRIPTING));
+    EXPECT_EQ(1U, io.run_all());
+    ASSERT_EQ(1U, completions.count);
+    EXPECT_EQ(1U, completions.ids[0]);
+
+    // nothing was written to fd1
+    char buf[4];
+    Completion r1{4};
+    EXPECT_TRUE(io.read(fd1, buf, sizeof(buf), 0, Priority::FTP, r1.cb()));
+    EXPECT_EQ(1U, io.run_all());
+    ASSERT_EQ(2U, completions.count);
+    EXPECT_EQ(0, completions.results[1]);
+
+    // a request being run can't be cancelled, but those behind it are
+    Completion w5{5}, w6{6};
+    w5.cancel_io = &io;
+    w5.cancel_fd = fd1;
+    EXPECT_TRUE(io.write(fd1, data, 4, 0, Priority::LOGGING, w5.cb()));
+    EXPECT_TRUE(io.write(fd1, data, 4, 100, Priority::LOGGING, w6.cb()));
+    EXPECT_EQ(1U, io.run_all());
+    EXPECT_FALSE(w5.cancel_ret);
+    ASSERT_EQ(3U, completions.count);
+    EXPECT_EQ(5U, completions.ids[2]);
+    EXPECT_EQ(4, completions.results[2]);
+
+    // once idle again cancel reports nothing in progress
+    EXPECT_TRUE(io.cancel(fd1));
+
+    AP::FS().close(fd1);
+    AP::FS().close(fd2);
+    AP::FS().unlink("async_io_cancel1.bin");
+    AP::FS().unlink("async_io_cancel2.bin");
+}
+
+#endif  // AP_FILESYSTEM_ASYNC_IO_ENABLED
+
+AP_GTEST_MAIN()
@@ -19,6 +19,7 @@
 #include <AP_FlashStorage/AP_FlashStorage.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_InternalError/AP_InternalError.h>
+#include <AP_Common/ExpandingString.h>
 #include <stdio.h>
 
 #define FLASHSTORAGE_DEBUG 0
@@ -128,7 +129,8 @@ bool AP_FlashStorage::init(void)
     }
 
     reserved_space = 0;
-    
+    compact_pending = false;
+
     // ready to use
     return true;
 }
@@ -160,10 +162,17 @@ bool AP_FlashStorage::protected_switch_full_sector(void)
 {
     // clear any write error
     write_error = false;
+
+    // if compact() has already migrated everything then the current
+    // sector holds all live data and only the erase is needed
+    const bool migrated = compact_pending && compact_ofs >= storage_size;
     reserved_space = 0;
-    
-    if (!write_all()) {
-        return false;
+
+    if (!migrated) {
+        wear_stats.full_switches++;
+        if (!write_all()) {
+            return false;
+        }
     }
 
     if (!erase_sector(current_sector ^ 1, true)) {
@@ -240,6 +249,7 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
 #endif
 
         write_offset += sizeof(blk.header) + block_nbytes;
+        wear_stats.bytes_written += block_nbytes;
 
         uint8_t n2 = block_nbytes - (offset % block_size);
         //debug("write_block at %u for %u n2=%u\n", block_ofs, block_nbytes, n2);
@@ -330,6 +340,7 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
     if (!flash_erase(sector)) {
         return false;
     }
+    wear_stats.erases[sector & 1]++;
     if (!mark_available) {
         return true;
     }
@@ -344,6 +355,7 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    compact_pending = false;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
@@ -443,9 +455,84 @@ bool AP_FlashStorage::switch_sectors(void)
     reserved_space = reserve_size;
     
     write_offset = sizeof(header);
+
+    // the old sector holds live data until compact() has migrated it
+    compact_pending = true;
+    compact_ofs = 0;
     return true;    
 }
 
+/*
+  incremental compaction. Live data is copied into the current sector
+  a chunk at a time, after which the old sector only holds stale data
+  and can be erased, freeing it for the next switch_sectors(). The
+  copies come out of normal free space and never use the reserve, so
+  init() can always complete a full write out after a power loss
+ */
+bool AP_FlashStorage::compact(uint16_t max_bytes)
+{
+    if (!compact_pending || write_error) {
+        return false;
+    }
+
+    uint16_t migrated = 0;
+    while (compact_ofs < storage_size && migrated < max_bytes) {
+        // local variable needed to overcome problem with MIN() macro and -O0
+        const uint8_t max_write_local = max_write;
+        const uint8_t n = MIN(max_write_local, storage_size-compact_ofs);
+        if (!all_zero(compact_ofs, n)) {
+            const uint32_t space_available = flash_sector_size - write_offset;
+            const uint32_t space_required = sizeof(struct block_header) + max_write + reserved_space;
+            if (space_available < space_required) {
+                // the sector filled before migration finished, leave
+                // it to switch_full_sector()
+                return false;
+            }
+            if (!write(compact_ofs, n)) {
+                return false;
+            }
+            migrated += n;
+            wear_stats.bytes_migrated += n;
+        }
+        compact_ofs += n;
+    }
+    if (compact_ofs < storage_size) {
+        return true;
+    }
+
+    // all live data is in the current sector. Erasing stalls the CPU
+    // so wait until it is allowed
+    if (!flash_erase_ok()) {
+        return true;
+    }
+    debug("compact: erasing sector %u\n", current_sector ^ 1);
+    if (!erase_sector(current_sector ^ 1, true)) {
+        return false;
+    }
+    reserved_space = 0;
+    compact_pending = false;
+    wear_stats.compactions++;
+    return false;
+}
+
+/*
+  report wear statistics. Counts are since boot
+ */
+void AP_FlashStorage::wear_info(ExpandingString &str) const
+{
+    str.printf("SECTOR=%u OFS=%u/%u ERASES=%u,%u WRITTEN=%u MIGRATED=%u COMPACTIONS=%u FULL=%u COMPACT=%u%%\n",
+               unsigned(current_sector),
+               unsigned(write_offset),
+               unsigned(flash_sector_size),
+               unsigned(wear_stats.erases[0]),
+               unsigned(wear_stats.erases[1]),
+               unsigned(wear_stats.bytes_written),
+               unsigned(wear_stats.bytes_migrated),
+               unsigned(wear_stats.compactions),
+               unsigned(wear_stats.full_switches),
+               compact_pending ? unsigned(compact_ofs * 100U / storage_size) : 100U);
+}
+
 /*
   re-initialise, using current mem_buffer
  */
@@ -34,11 +34,18 @@
     128k flash sectors with 16k storage size.
 
   - assumes two flash sectors are available
+
+  - after switching sectors, compact() can be called regularly from
+    the storage thread to migrate live data into the new sector in
+    bounded steps and then erase the old one, so that the next sector
+    switch does not need a full rewrite of storage
  */
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
 
+class ExpandingString;
+
 /*
   we support 3 different types of flash which have different restrictions
  */
@@ -130,6 +137,25 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // do one step of background compaction, migrating at most
+    // max_bytes of live data, or erasing the old sector once all
+    // data has been migrated and erasing is allowed. Returns true
+    // while there is more compaction work to do
+    bool compact(uint16_t max_bytes);
+
+    // flash wear statistics since boot
+    struct WearStats {
+        uint32_t erases[2];         // erases of each sector
+        uint32_t bytes_written;     // block bytes written, including migration
+        uint32_t bytes_migrated;    // bytes copied by compact()
+        uint32_t compactions;       // sectors freed by compact()
+        uint32_t full_switches;     // blocking rewrites by switch_full_sector()
+    };
+    const WearStats &get_wear_stats(void) const { return wear_stats; }
+
+    // report wear statistics and compaction progress
+    void wear_info(ExpandingString &str) const;
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -146,6 +172,13 @@ private:
     uint32_t reserved_space;
     bool write_error;
 
+    // set when the other sector is full and still holds live data
+    bool compact_pending;
+    // next offset in mem_buffer for compact() to migrate
+    uint16_t compact_ofs;
+
+    WearStats wear_stats;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
     static const uint32_t signature = 0x51685B;
@@ -159,6 +159,11 @@ void FlashTest::loop(void)
         erase_ok = (i % 1000 == 0);
         write(ofs, data, length);
 
+        // background compaction, as done by the HAL storage thread
+        if (i % 16 == 0) {
+            storage.compact(64);
+        }
+
         if (erase_ok) {
             if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
                 AP_HAL::panic("FATAL: data mis-match at i=%u", (unsigned)i);
@@ -174,6 +179,12 @@ void FlashTest::loop(void)
     if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
         AP_HAL::panic("FATAL: data mis-match before re-init");
     }
+
+    const AP_FlashStorage::WearStats &wear = storage.get_wear_stats();
+    printf("erases %u/%u migrated %u compactions %u full switches %u\n",
+           (unsigned)wear.erases[0], (unsigned)wear.erases[1],
+           (unsigned)wear.bytes_migrated, (unsigned)wear.compactions,
+           (unsigned)wear.full_switches);
     
     // re-init
     printf("re-init\n");
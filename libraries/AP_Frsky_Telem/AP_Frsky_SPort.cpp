@@ -213,19 +213,6 @@ void  AP_Frsky_SPort::send_sport_frame(uint8_t frame, uint16_t appid, uint32_t d
     sum = 0xff - ((sum & 0xff) + (sum >> 8));
     buf[7] = (uint8_t)sum;
 
-    // perform byte stuffing per SPort spec
-    uint8_t len = 0;
-    uint8_t buf2[sizeof(buf)*2+1];
-
-    for (uint8_t i=0; i<sizeof(buf); i++) {
-        uint8_t c = buf[i];
-        if (c == FRAME_DLE || buf[i] == FRAME_HEAD) {
-            buf2[len++] = FRAME_DLE;
-            buf2[len++] = c ^ FRAME_XOR;
-        } else {
-            buf2[len++] = c;
-        }
-    }
 #ifndef HAL_BOARD_SITL
     /*
       check that we haven't been too slow in responding to the new
@@ -242,6 +229,33 @@ void  AP_Frsky_SPort::send_sport_frame(uint8_t frame, uint16_t appid, uint32_t d
         return;
     }
 #endif
+
+    // perform byte stuffing per SPort spec, straight into the uart's
+    // transmit buffer when it can give us a contiguous region
+    uint8_t buf2[sizeof(buf)*2];
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = _port->tx_reserve(vec, sizeof(buf2));
+    uint8_t *out = (n_vec == 1) ? vec[0].data : buf2;
+
+    uint8_t len = 0;
+    for (uint8_t i=0; i<sizeof(buf); i++) {
+        uint8_t c = buf[i];
+        if (c == FRAME_DLE || buf[i] == FRAME_HEAD) {
+            out[len++] = FRAME_DLE;
+            out[len++] = c ^ FRAME_XOR;
+        } else {
+            out[len++] = c;
+        }
+    }
+
+    if (n_vec == 1) {
+        _port->tx_commit(len);
+        return;
+    }
+    if (n_vec == 2) {
+        // reservation wrapped around the buffer, give it back
+        _port->tx_commit(0);
+    }
     _port->write(buf2, len);
 }
 
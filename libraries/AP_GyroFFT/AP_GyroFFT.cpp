@@ -169,8 +169,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: OPTIONS
     // @DisplayName: FFT options
-    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference
-    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise
+    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference,4:Use a sliding DFT which only calculates the frequencies between MINHZ and MAXHZ and is updated on every sample. This reduces latency and for narrow frequency ranges uses less CPU than the FFT.
+    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise,2:Use sliding DFT
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("OPTIONS", 15, AP_GyroFFT, _options, 0),
@@ -234,7 +234,9 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
 
     // check that we have enough memory for the window size requested
     // INS: XYZ_AXIS_COUNT * INS_MAX_INSTANCES * _window_size, DSP: 3 * _window_size, FFT: XYZ_AXIS_COUNT + 3 * _window_size
-    const uint32_t allocation_count = (XYZ_AXIS_COUNT * INS_MAX_INSTANCES + 3 + XYZ_AXIS_COUNT + 3 + _num_frames) * sizeof(float);
+    // SDFT: XYZ_AXIS_COUNT * 3 * _window_size
+    const uint32_t allocation_count = (XYZ_AXIS_COUNT * INS_MAX_INSTANCES + 3 + XYZ_AXIS_COUNT + 3 + _num_frames
+        + (using_sliding_dft() ? XYZ_AXIS_COUNT * 3 : 0)) * sizeof(float);
     if (allocation_count * FFT_DEFAULT_WINDOW_SIZE > hal.util->available_memory() / 2) {
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AP_GyroFFT: disabled, required %u bytes", (unsigned int)allocation_count * FFT_DEFAULT_WINDOW_SIZE);
         return;
@@ -245,6 +247,25 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
     // save any changes that were made
     _window_size.save();
 
+    // a sliding DFT does its work as samples arrive rather than per-frame and so frames
+    // can be analysed much more frequently
+    if (using_sliding_dft()) {
+        _sliding_dft_enabled = true;
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            _sdft[axis] = hal.dsp->sdft_init(_window_size);
+            _sliding_dft_enabled = _sliding_dft_enabled && _sdft[axis] != nullptr;
+        }
+        if (_sliding_dft_enabled) {
+            _samples_per_frame = FFT_MIN_SAMPLES_PER_FRAME;
+        } else {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AP_GyroFFT: sliding DFT unavailable, using FFT");
+            for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                delete _sdft[axis];
+                _sdft[axis] = nullptr;
+            }
+        }
+    }
+
     // determine the FFT sample rate based on the gyro rate, loop rate and configuration
     if (_sample_mode == 0) {
         _fft_sampling_rate_hz = _ins->get_raw_gyro_rate_hz();
@@ -442,7 +463,7 @@ uint16_t AP_GyroFFT::run_cycle()
 
     // do we have enough samples for another pass?
     if (!start_analysis()) {
-        uint16_t new_sample_count =  get_available_samples(_update_axis);
+        uint16_t new_sample_count =  get_frame_samples(_update_axis);
         _sem.give();
         return new_sample_count;
     }
@@ -454,18 +475,32 @@ uint16_t AP_GyroFFT::run_cycle()
 
     uint32_t now = AP_HAL::micros();
 
-    // get the appropriate gyro buffer
-    FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
-    // if we have many more samples than the window size then we are struggling to 
-    // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
-    if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
-    }
-    // let's go!
-    hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+    uint16_t bin_max;
+    if (_sliding_dft_enabled) {
+        update_sliding_dft(config);
+        // the bins are not valid until a whole window has been seen
+        if (!_sdft[_update_axis]->primed()) {
+            _thread_state._analysis_started = false;
+            return get_frame_samples(_update_axis);
+        }
+        _sdft_frame_samples[_update_axis] = 0;
 
-    // calculate FFT and update filters outside the semaphore
-    uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+        // calculate peaks from the tracked bins and update filters outside the semaphore
+        bin_max = hal.dsp->sdft_analyse(_state, _sdft[_update_axis], config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    } else {
+        // get the appropriate gyro buffer
+        FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
+        // if we have many more samples than the window size then we are struggling to 
+        // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
+        if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
+            gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+        }
+        // let's go!
+        hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+
+        // calculate FFT and update filters outside the semaphore
+        bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    }
 
     // something has been detected, update the peak frequency and associated metrics
     update_ref_energy(bin_max);
@@ -505,7 +540,23 @@ uint16_t AP_GyroFFT::run_cycle()
     _thread_state._analysis_started = false;
 
     // samples remaining in the next axis
-    return get_available_samples(_update_axis);
+    return get_frame_samples(_update_axis);
+}
+
+// update the sliding DFTs of all axes with the new samples, so that the gyro windows stay empty
+// called from FFT thread
+void AP_GyroFFT::update_sliding_dft(const EngineConfig& config)
+{
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        AP_HAL::DSP::SlidingDFTState* sdft = _sdft[axis];
+        // the detection window has been reconfigured
+        if (sdft->_start_bin != config._fft_start_bin || sdft->_end_bin != config._fft_end_bin) {
+            hal.dsp->sdft_set_bins(sdft, config._fft_start_bin, config._fft_end_bin);
+        }
+        FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(axis) : _downsampled_gyro_data[axis]);
+        const uint32_t samples = uint32_t(_sdft_frame_samples[axis]) + hal.dsp->sdft_update(sdft, gyro_buffer);
+        _sdft_frame_samples[axis] = MIN(samples, uint32_t(UINT16_MAX));
+    }
 }
 
 // whether analysis can be run again or not
@@ -519,7 +570,7 @@ bool AP_GyroFFT::start_analysis() {
         return false;
     }
 
-    if (get_available_samples(_update_axis) >= _state->_window_size) {
+    if (get_frame_samples(_update_axis) >= get_frame_size()) {
         _thread_state._analysis_started = true;
         return true;
     }
@@ -563,7 +614,7 @@ void AP_GyroFFT::update_thread(void)
         // this is to stop us burning CPU while waiting for samples, the reduction by _samples_per_frame is a heuristic to prevent waiting too long
         // and missing frames (easy to see in SITL because the noise will keep calibrating)
         // we always delay by at least 1us to give logging a chance to run at the same priority
-        uint32_t delay = constrain_int32((int16_t)_state->_window_size - (int16_t)remaining_samples, 0, _samples_per_frame)
+        uint32_t delay = constrain_int32((int16_t)get_frame_size() - (int16_t)remaining_samples, 0, _samples_per_frame)
             * 1e6 / _fft_sampling_rate_hz;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         // in SITL the gyros do not run in a different thread
@@ -1424,14 +1475,30 @@ float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window)
 
     _update_axis = 0;
 
-    // if using averaging we need to process _num_frames in order to not bias the result
-    for (uint8_t i = 1; i < _num_frames; i++) {
+    uint16_t max_bin;
+    if (_sliding_dft_enabled) {
+        // test the sliding DFT of the first axis, this will need to see gyro samples again afterwards
+        AP_HAL::DSP::SlidingDFTState* sdft = _sdft[0];
+        hal.dsp->sdft_reset(sdft);
+        hal.dsp->sdft_set_bins(sdft, _config._fft_start_bin, _config._fft_end_bin);
+        hal.dsp->sdft_update(sdft, test_window);
+        // if using averaging we need to process _num_frames in order to not bias the result
+        for (uint8_t i = 1; i < _num_frames; i++) {
+            hal.dsp->sdft_analyse(_state, sdft, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        }
+        // final cycle is the one we want
+        max_bin = hal.dsp->sdft_analyse(_state, sdft, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        hal.dsp->sdft_reset(sdft);
+    } else {
+        // if using averaging we need to process _num_frames in order to not bias the result
+        for (uint8_t i = 1; i < _num_frames; i++) {
+            hal.dsp->fft_start(_state, test_window, 0);
+            hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        }
+        // final cycle is the one we want
         hal.dsp->fft_start(_state, test_window, 0);
-        hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        max_bin = hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
     }
-    // final cycle is the one we want
-    hal.dsp->fft_start(_state, test_window, 0);
-    uint16_t max_bin = hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
 
     if (max_bin == 0) {
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "FFT: self-test failed, failed to find frequency %.1f", frequency);
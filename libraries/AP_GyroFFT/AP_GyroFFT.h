@@ -40,7 +40,8 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        SlidingDFT = 1 << 2
     };
 
     AP_GyroFFT();
@@ -111,6 +112,8 @@ public:
     bool using_post_filter_samples() const { return (_options & uint32_t(Options::FFTPostFilter)) != 0; }
     // post filter mask of IMUs
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
+    // use a sliding DFT of the tracked band rather than a full FFT
+    bool using_sliding_dft() const { return (_options & uint32_t(Options::SlidingDFT)) != 0; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
@@ -224,6 +227,14 @@ private:
     uint16_t get_available_samples(uint8_t axis) {
         return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
     }
+    // return the samples available towards the next frame, a sliding DFT will already have consumed some of these
+    uint16_t get_frame_samples(uint8_t axis) {
+        return _sliding_dft_enabled ? get_available_samples(axis) + _sdft_frame_samples[axis] : get_available_samples(axis);
+    }
+    // number of samples required before a frame can be processed
+    uint16_t get_frame_size() const { return _sliding_dft_enabled ? _samples_per_frame : _state->_window_size; }
+    // update the sliding DFTs of all axes with new samples
+    void update_sliding_dft(const EngineConfig& config);
     void update_parameters(bool force);
     // semaphore for access to shared FFT data
     HAL_Semaphore _sem;
@@ -283,6 +294,12 @@ private:
 
     // state of the FFT engine
     AP_HAL::DSP::FFTWindowState* _state;
+    // state of the sliding DFT engine for each axis
+    AP_HAL::DSP::SlidingDFTState* _sdft[XYZ_AXIS_COUNT];
+    // samples consumed by the sliding DFT since the axis was last analysed
+    uint16_t _sdft_frame_samples[XYZ_AXIS_COUNT];
+    // whether the sliding DFT is in use
+    bool _sliding_dft_enabled;
     // update state machine step information
     uint8_t _update_axis;
     // noise base of the gyros
@@ -0,0 +1,239 @@
+/*
+  Compare the FFT and sliding DFT engines used by AP_GyroFFT on logged raw gyro data
+
+  Raw gyro data is read from /tmp/gyro0.dat, which is written by SITL with SIM_GYR_FILE_RW=2
+  and consists of x,y,z float triplets at the raw gyro rate. If there is no such file a
+  synthetic sweep is used instead. Both engines analyse an identical window of samples at
+  the same points in time, so the detected frequencies should agree to within a fraction of a bin.
+ */
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Empty/AP_HAL_Empty.h>
+#include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#if HAL_WITH_DSP && CONFIG_HAL_BOARD == HAL_BOARD_SITL
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const char* GYRO_FILE = "/tmp/gyro0.dat";
+// these should match the logged data and the FFT parameters under test
+static const uint16_t SAMPLE_RATE_HZ = 1000;        // rate the gyro data was logged at
+static const uint16_t WINDOW_SIZE = 64;             // FFT_WINDOW_SIZE
+static const uint16_t SAMPLES_PER_FRAME = 16;       // samples between analyses
+static const float MIN_HZ = 50;                     // FFT_MINHZ
+static const float MAX_HZ = 450;                    // FFT_MAXHZ
+static const float ATTENUATION_POWER_DB = 15;       // FFT_ATT_REF
+static const uint32_t SYNTHETIC_SAMPLES = SAMPLE_RATE_HZ * 10;
+
+void setup();
+void loop();
+
+static AP_SerialManager serial_manager;
+static AP_BoardConfig board_config;
+
+// create fake gcs object
+GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+class CompareGyroFFT {
+public:
+    bool init();
+    void run();
+
+private:
+    // read the next gyro sample, returns false at the end of the data
+    bool next_sample(Vector3f& gyro);
+    void analyse(uint8_t axis);
+    void report() const;
+
+    struct Engine {
+        AP_HAL::DSP::FFTWindowState* state;
+        uint64_t time_us;
+        float freq_hz;
+    };
+
+    Engine _fft[XYZ_AXIS_COUNT];
+    Engine _sdft[XYZ_AXIS_COUNT];
+    AP_HAL::DSP::SlidingDFTState* _sliding_dft[XYZ_AXIS_COUNT];
+    FloatBuffer _fft_window[XYZ_AXIS_COUNT];
+    FloatBuffer _sdft_samples[XYZ_AXIS_COUNT];
+
+    uint16_t _start_bin;
+    uint16_t _end_bin;
+    float _attenuation_cutoff;
+    int _fd = -1;
+    uint32_t _sample_count;
+    uint32_t _frame_count;
+    // differences between the engines
+    float _sum_diff_hz[XYZ_AXIS_COUNT];
+    float _max_diff_hz[XYZ_AXIS_COUNT];
+};
+
+static CompareGyroFFT compare;
+
+bool CompareGyroFFT::init()
+{
+    _fd = AP::FS().open(GYRO_FILE, O_RDONLY);
+    if (_fd == -1) {
+        hal.console->printf("%s not found, using synthetic data\n", GYRO_FILE);
+    }
+
+    const float bin_resolution = float(SAMPLE_RATE_HZ) / WINDOW_SIZE;
+    _start_bin = MAX(floorf(MIN_HZ / bin_resolution), 1);
+    _end_bin = MIN(ceilf(MAX_HZ / bin_resolution), WINDOW_SIZE / 2);
+    _attenuation_cutoff = powf(10.0f, -ATTENUATION_POWER_DB * 0.1f);
+
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        _fft[axis].state = hal.dsp->fft_init(WINDOW_SIZE, SAMPLE_RATE_HZ);
+        _sdft[axis].state = hal.dsp->fft_init(WINDOW_SIZE, SAMPLE_RATE_HZ);
+        _sliding_dft[axis] = hal.dsp->sdft_init(WINDOW_SIZE);
+        if (_fft[axis].state == nullptr || _sdft[axis].state == nullptr || _sliding_dft[axis] == nullptr
+            || !_fft_window[axis].set_size(WINDOW_SIZE + SAMPLES_PER_FRAME)
+            || !_sdft_samples[axis].set_size(SAMPLES_PER_FRAME)) {
+            hal.console->printf("Failed to allocate DSP state\n");
+            return false;
+        }
+        hal.dsp->sdft_set_bins(_sliding_dft[axis], _start_bin, _end_bin);
+    }
+    return true;
+}
+
+bool CompareGyroFFT::next_sample(Vector3f& gyro)
+{
+    if (_fd != -1) {
+        float buf[3];
+        if (AP::FS().read(_fd, buf, sizeof(buf)) != (int32_t)sizeof(buf)) {
+            return false;
+        }
+        gyro = Vector3f(buf[0], buf[1], buf[2]);
+        return true;
+    }
+
+    if (_sample_count >= SYNTHETIC_SAMPLES) {
+        return false;
+    }
+    // a motor frequency sweeping from 80 to 250Hz with its second harmonic and some noise
+    const float t = float(_sample_count) / SAMPLE_RATE_HZ;
+    const float duration = float(SYNTHETIC_SAMPLES) / SAMPLE_RATE_HZ;
+    const float phase = 2.0f * M_PI * (80.0f * t + 0.5f * (250.0f - 80.0f) * sq(t) / duration);
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyro[axis] = ToRad(20) * (sinf(phase + axis) + 0.5f * sinf(2.0f * phase + axis))
+            + ToRad(2) * (float(get_random16()) / 32768.0f - 1.0f);
+    }
+    return true;
+}
+
+void CompareGyroFFT::analyse(uint8_t axis)
+{
+    Engine& fft = _fft[axis];
+    uint64_t now = AP_HAL::micros64();
+    hal.dsp->fft_start(fft.state, _fft_window[axis], SAMPLES_PER_FRAME);
+    hal.dsp->fft_analyse(fft.state, _start_bin, _end_bin, _attenuation_cutoff);
+    fft.time_us += AP_HAL::micros64() - now;
+    fft.freq_hz = fft.state->_peak_data[AP_HAL::DSP::CENTER]._freq_hz;
+
+    Engine& sdft = _sdft[axis];
+    now = AP_HAL::micros64();
+    hal.dsp->sdft_analyse(sdft.state, _sliding_dft[axis], _start_bin, _end_bin, _attenuation_cutoff);
+    sdft.time_us += AP_HAL::micros64() - now;
+    sdft.freq_hz = sdft.state->_peak_data[AP_HAL::DSP::CENTER]._freq_hz;
+
+    const float diff = fabsf(fft.freq_hz - sdft.freq_hz);
+    _sum_diff_hz[axis] += diff;
+    _max_diff_hz[axis] = MAX(_max_diff_hz[axis], diff);
+}
+
+void CompareGyroFFT::run()
+{
+    Vector3f gyro;
+    while (next_sample(gyro)) {
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            _fft_window[axis].push(gyro[axis]);
+            _sdft_samples[axis].push(gyro[axis]);
+            // the sliding DFT does its work on every sample
+            const uint64_t now = AP_HAL::micros64();
+            hal.dsp->sdft_update(_sliding_dft[axis], _sdft_samples[axis]);
+            _sdft[axis].time_us += AP_HAL::micros64() - now;
+        }
+        _sample_count++;
+
+        if (_sample_count < WINDOW_SIZE || (_sample_count % SAMPLES_PER_FRAME) != 0) {
+            continue;
+        }
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            analyse(axis);
+        }
+        _frame_count++;
+
+        if ((_frame_count % (SAMPLE_RATE_HZ / SAMPLES_PER_FRAME)) == 0) {
+            hal.console->printf("%6.2fs FFT %5.1f/%5.1f/%5.1fHz SDFT %5.1f/%5.1f/%5.1fHz\n",
+                float(_sample_count) / SAMPLE_RATE_HZ,
+                _fft[0].freq_hz, _fft[1].freq_hz, _fft[2].freq_hz,
+                _sdft[0].freq_hz, _sdft[1].freq_hz, _sdft[2].freq_hz);
+        }
+    }
+    report();
+}
+
+void CompareGyroFFT::report() const
+{
+    if (_frame_count == 0) {
+        hal.console->printf("Not enough samples for a single window\n");
+        return;
+    }
+    const float data_time = float(_sample_count) / SAMPLE_RATE_HZ;
+    hal.console->printf("%u samples, %u frames, bins %u-%u of %u\n",
+        unsigned(_sample_count), unsigned(_frame_count), _start_bin, _end_bin, WINDOW_SIZE / 2);
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        hal.console->printf("axis %u: mean diff %.2fHz max diff %.2fHz\n",
+            axis, _sum_diff_hz[axis] / _frame_count, _max_diff_hz[axis]);
+    }
+    uint64_t fft_us = 0, sdft_us = 0;
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fft_us += _fft[axis].time_us;
+        sdft_us += _sdft[axis].time_us;
+    }
+    hal.console->printf("FFT:  %.2fus/frame %.1fus/s\n", float(fft_us) / (_frame_count * XYZ_AXIS_COUNT), fft_us / data_time);
+    hal.console->printf("SDFT: %.2fus/frame %.1fus/s\n", float(sdft_us) / (_frame_count * XYZ_AXIS_COUNT), sdft_us / data_time);
+}
+
+void setup()
+{
+    hal.console->printf("CompareGyroFFT\n");
+    board_config.init();
+    serial_manager.init();
+}
+
+void loop()
+{
+    if (!hal.console->is_initialized()) {
+        return;
+    }
+    if (compare.init()) {
+        compare.run();
+    }
+    exit(0);
+}
+
+AP_HAL_MAIN();
+
+#else
+
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void loop() { }
+static void setup()
+{
+    printf("Board not currently supported\n");
+}
+
+AP_HAL_MAIN();
+
+#endif
@@ -33,6 +33,10 @@ extern const AP_HAL::HAL &hal;
 
 #define SQRT_2_3 0.816496580927726f
 #define SQRT_6   2.449489742783178f
+// attenuation of the oldest sample in a sliding DFT window, this keeps the recursion stable in the face of rounding errors
+#define SDFT_WINDOW_DAMPING 0.999f
+// number of samples a sliding DFT reads from a sample buffer in one go
+#define SDFT_READ_CHUNK     16
 
 DSP::FFTWindowState::FFTWindowState(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
     : _window_size(window_size),
@@ -371,6 +375,185 @@ uint16_t DSP::fft_stop_average(FFTWindowState* fft, uint16_t start_bin, uint16_t
     return numpeaks;
 }
 
+// create an instance of the sliding DFT state machine
+// the tracked band can be anything up to the full spectrum, so allocate for that in order that the band
+// can be changed without reallocating
+DSP::SlidingDFTState::SlidingDFTState(uint16_t window_size)
+    : _window_size(window_size),
+    _bin_count(window_size / 2),
+    _max_tracked_bins(window_size / 2 + 3),
+    _damping_n(SDFT_WINDOW_DAMPING)
+{
+    _bins = (float*)hal.util->malloc_type(sizeof(float) * _max_tracked_bins * 2, DSP_MEM_REGION);
+    _twiddle = (float*)hal.util->malloc_type(sizeof(float) * _max_tracked_bins * 2, DSP_MEM_REGION);
+    _samples = (float*)hal.util->malloc_type(sizeof(float) * _window_size, DSP_MEM_REGION);
+
+    if (_bins == nullptr || _twiddle == nullptr || _samples == nullptr) {
+        free_data_structures();
+    }
+}
+
+DSP::SlidingDFTState::~SlidingDFTState()
+{
+    free_data_structures();
+}
+
+void DSP::SlidingDFTState::free_data_structures()
+{
+    hal.util->free_type(_bins, sizeof(float) * _max_tracked_bins * 2, DSP_MEM_REGION);
+    _bins = nullptr;
+    hal.util->free_type(_twiddle, sizeof(float) * _max_tracked_bins * 2, DSP_MEM_REGION);
+    _twiddle = nullptr;
+    hal.util->free_type(_samples, sizeof(float) * _window_size, DSP_MEM_REGION);
+    _samples = nullptr;
+}
+
+// initialise a sliding DFT instance tracking the full spectrum
+DSP::SlidingDFTState* DSP::sdft_init(uint16_t window_size)
+{
+    // the sample index wraps using a mask
+    if (window_size == 0 || (window_size & (window_size - 1)) != 0) {
+        return nullptr;
+    }
+
+    SlidingDFTState* sdft = NEW_NOTHROW SlidingDFTState(window_size);
+    if (sdft == nullptr || sdft->_bins == nullptr) {
+        delete sdft;
+        return nullptr;
+    }
+
+    sdft_reset(sdft);
+    sdft_set_bins(sdft, 1, sdft->_bin_count);
+    return sdft;
+}
+
+// clear all samples from a sliding DFT
+void DSP::sdft_reset(SlidingDFTState* sdft)
+{
+    memset(sdft->_bins, 0, sizeof(float) * sdft->_max_tracked_bins * 2);
+    memset(sdft->_samples, 0, sizeof(float) * sdft->_window_size);
+    sdft->_sample_index = 0;
+    sdft->_sample_count = 0;
+}
+
+// set the band of bins tracked by a sliding DFT
+// the tracked bins are recalculated from the retained samples so that there is no need to wait for a new window
+void DSP::sdft_set_bins(SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin)
+{
+    start_bin = constrain_int16(start_bin, 1, sdft->_bin_count);
+    end_bin = constrain_int16(end_bin, start_bin, sdft->_bin_count);
+
+    sdft->_start_bin = start_bin;
+    sdft->_end_bin = end_bin;
+    // the analysis looks at one bin below the band and up to three above, and the Hanning window
+    // requires one more on each side of those. Negative bins are the conjugates of their positive counterparts.
+    sdft->_first_bin = int16_t(start_bin) - 2;
+    sdft->_num_bins = MIN(end_bin + 3, sdft->_bin_count) - start_bin + 4;
+
+    // twiddle factors with the per-sample damping that results in _damping_n over a whole window
+    const float damping = powf(sdft->_damping_n, 1.0f / sdft->_window_size);
+    const uint16_t mask = sdft->_window_size - 1;
+
+    for (uint16_t b = 0; b < sdft->_num_bins; b++) {
+        const float angle = 2.0f * M_PI * (sdft->_first_bin + b) / sdft->_window_size;
+        const float tr = damping * cosf(angle);
+        const float ti = damping * sinf(angle);
+        sdft->_twiddle[b * 2] = tr;
+        sdft->_twiddle[b * 2 + 1] = ti;
+
+        // run the retained samples through the recursion from oldest to newest
+        float zr = 0.0f, zi = 0.0f;
+        for (uint16_t i = 0; i < sdft->_window_size; i++) {
+            const float x = sdft->_samples[(sdft->_sample_index + i) & mask];
+            const float r = tr * zr - ti * zi + x;
+            zi = tr * zi + ti * zr;
+            zr = r;
+        }
+        sdft->_bins[b * 2] = zr;
+        sdft->_bins[b * 2 + 1] = zi;
+    }
+}
+
+// update a sliding DFT with all available samples
+// this is O(tracked bins) per sample rather than O(window size * log(window size)) per frame
+uint16_t DSP::sdft_update(SlidingDFTState* sdft, FloatBuffer& samples)
+{
+    const uint16_t mask = sdft->_window_size - 1;
+    float chunk[SDFT_READ_CHUNK];
+    uint16_t count = 0;
+
+    while (true) {
+        const uint32_t n = samples.peek(chunk, SDFT_READ_CHUNK);
+        if (n == 0) {
+            break;
+        }
+        samples.advance(n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            const float x = chunk[i];
+            // Z[k](n) = r * W^-k * Z[k](n-1) + x(n) - r^N * x(n-N)
+            const float delta = x - sdft->_damping_n * sdft->_samples[sdft->_sample_index];
+            sdft->_samples[sdft->_sample_index] = x;
+            sdft->_sample_index = (sdft->_sample_index + 1) & mask;
+
+            float* z = sdft->_bins;
+            const float* t = sdft->_twiddle;
+            for (uint16_t b = 0; b < sdft->_num_bins; b++, z += 2, t += 2) {
+                const float zr = t[0] * z[0] - t[1] * z[1] + delta;
+                z[1] = t[0] * z[1] + t[1] * z[0];
+                z[0] = zr;
+            }
+        }
+        count += n;
+    }
+
+    sdft->_sample_count = MIN(uint32_t(sdft->_sample_count) + count, sdft->_window_size);
+    return count;
+}
+
+// perform remaining steps of an FFT analysis using the bins of a sliding DFT
+// the sliding DFT uses a rectangular window, a Hanning window is applied in the frequency domain
+// by convolving with [-0.25, 0.5, -0.25], after which the analysis is the same as the FFT
+uint16_t DSP::sdft_analyse(FFTWindowState* fft, const SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff)
+{
+    if (sdft->_window_size != fft->_window_size) {
+        return 0;
+    }
+
+    start_bin = MAX(start_bin, sdft->_start_bin);
+    end_bin = MIN(end_bin, sdft->_end_bin);
+
+    // bins outside of the tracked band have no energy
+    memset(fft->_freq_bins, 0, sizeof(float) * fft->_num_stored_freqs);
+
+    // the stored values have the phase of the most recent sample, rotate back to the phase of the
+    // oldest sample in order to get the DFT of the window - otherwise bins cannot be compared or combined
+    float xr[3], xi[3];
+    for (uint16_t b = 0; b < sdft->_num_bins; b++) {
+        const float* z = &sdft->_bins[b * 2];
+        const float* t = &sdft->_twiddle[b * 2];
+        xr[b % 3] = t[0] * z[0] - t[1] * z[1];
+        xi[b % 3] = t[0] * z[1] + t[1] * z[0];
+
+        if (b < 2) {
+            continue;
+        }
+        // windowed output for the previous bin
+        const int16_t k = sdft->_first_bin + b - 1;
+        const float yr = 0.5f * xr[(b - 1) % 3] - 0.25f * (xr[(b - 2) % 3] + xr[b % 3]);
+        const float yi = 0.5f * xi[(b - 1) % 3] - 0.25f * (xi[(b - 2) % 3] + xi[b % 3]);
+        if (k < 0 || k > fft->_bin_count) {
+            continue;
+        }
+        fft->_rfft_data[k * 2] = yr;
+        fft->_rfft_data[k * 2 + 1] = yi;
+        fft->_freq_bins[k] = sq(yr) + sq(yi);
+    }
+
+    step_cmplx_mag(fft, start_bin, end_bin, noise_att_cutoff);
+    return step_calc_frequencies(fft, start_bin, end_bin);
+}
+
 // find all the peaks in the fft window using https://terpconnect.umd.edu/~toh/spectrum/PeakFindingandMeasurement.htm
 // in general peakgrup > 2 is only good for very broad noisy peaks, <= 2 better for spikey peaks, although 1 will miss
 // a true spike 50% of the time
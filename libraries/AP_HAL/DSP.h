@@ -90,6 +90,41 @@ public:
         virtual ~FFTWindowState();
         FFTWindowState(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size);
     };
+    // state for a sliding DFT of a single stream of samples, which only tracks a band of bins
+    class SlidingDFTState {
+    public:
+        // size of the equivalent FFT window
+        const uint16_t _window_size;
+        // number of FFT bins
+        const uint16_t _bin_count;
+        // maximum number of tracked bins
+        const uint16_t _max_tracked_bins;
+        // first and last bins in the configured band
+        uint16_t _start_bin;
+        uint16_t _end_bin;
+        // first tracked bin, including the neighbours needed for windowing, may be negative
+        int16_t _first_bin;
+        // number of tracked bins
+        uint16_t _num_bins;
+        // rectangular window DFT of the tracked bins, interleaved real and imaginary
+        float* _bins;
+        // damped twiddle factors of the tracked bins, interleaved real and imaginary
+        float* _twiddle;
+        // the last _window_size samples
+        float* _samples;
+        // next write position in _samples
+        uint16_t _sample_index;
+        // number of samples seen, saturating at _window_size
+        uint16_t _sample_count;
+        // damping applied to the sample leaving the window
+        float _damping_n;
+        // whether a full window of samples has been seen
+        bool primed() const { return _sample_count >= _window_size; }
+
+        void free_data_structures();
+        ~SlidingDFTState();
+        SlidingDFTState(uint16_t window_size);
+    };
     // initialise an FFT instance
     virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size = 0) = 0;
     // start an FFT analysis with an ObjectBuffer
@@ -100,6 +135,16 @@ public:
     bool fft_start_average(FFTWindowState* fft);
     // finish the averaging process
     uint16_t fft_stop_average(FFTWindowState* fft, uint16_t start_bin, uint16_t end_bin, float* peaks);
+    // initialise a sliding DFT instance
+    SlidingDFTState* sdft_init(uint16_t window_size);
+    // clear all samples from a sliding DFT
+    void sdft_reset(SlidingDFTState* sdft);
+    // set the band of bins tracked by a sliding DFT, recalculating them from the retained samples
+    void sdft_set_bins(SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin);
+    // update a sliding DFT with all available samples, returns the number of samples consumed
+    uint16_t sdft_update(SlidingDFTState* sdft, FloatBuffer& samples);
+    // perform remaining steps of an FFT analysis using the bins of a sliding DFT
+    uint16_t sdft_analyse(FFTWindowState* state, const SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff);
 
 protected:
     // step 3: find the magnitudes of the complex data
@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include "AP_HAL_Namespace.h"
 
+class ExpandingString;
+
 class AP_HAL::Storage {
 public:
     virtual void init() = 0;
@@ -10,6 +12,10 @@ public:
     virtual void read_block(void *dst, uint16_t src, size_t n) = 0;
     virtual void write_block(uint16_t dst, const void* src, size_t n) = 0;
     virtual void _timer_tick(void) {};
+    // write out all pending changes before returning, returns false on failure
+    virtual bool flush(void) { return true; }
     virtual bool healthy(void) { return true; }
     virtual bool get_storage_ptr(void *&ptr, size_t &size) { return false; }
+    // report backend statistics, for @SYS/storage.txt
+    virtual void storage_info(ExpandingString &str) {}
 };
@@ -91,6 +91,75 @@ size_t AP_HAL::UARTDriver::write(const uint8_t *buffer, size_t size)
     return _write(buffer, size);
 }
 
+/*
+  reserve space in the transmit buffer for writing in place
+ */
+uint8_t AP_HAL::UARTDriver::tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (lock_write_key != 0 || len == 0) {
+        return 0;
+    }
+    return _tx_reserve(vec, len);
+}
+
+/*
+  release bytes written in place after a tx_reserve()
+ */
+bool AP_HAL::UARTDriver::tx_commit(uint32_t len)
+{
+    return _tx_commit(len);
+}
+
+/*
+  write a multi-fragment packet. Backends which support reserving
+  transmit buffer space get each fragment copied straight into the
+  buffer, others get one write per fragment after checking the whole
+  packet fits
+ */
+size_t AP_HAL::UARTDriver::writev(const IoVec *iov, uint8_t iovcnt)
+{
+    uint32_t total_len = 0;
+    for (uint8_t i = 0; i < iovcnt; i++) {
+        total_len += iov[i].len;
+    }
+    if (total_len == 0) {
+        return 0;
+    }
+
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = tx_reserve(vec, total_len);
+    if (n_vec > 0) {
+        uint8_t v = 0;
+        uint32_t v_ofs = 0;
+        for (uint8_t i = 0; i < iovcnt; i++) {
+            const uint8_t *data = iov[i].data;
+            uint32_t len = iov[i].len;
+            while (len > 0) {
+                const uint32_t v_space = vec[v].len - v_ofs;
+                const uint32_t n = len < v_space ? len : v_space;
+                memcpy(&vec[v].data[v_ofs], data, n);
+                data += n;
+                len -= n;
+                v_ofs += n;
+                if (v_ofs == vec[v].len && v+1 < n_vec) {
+                    v++;
+                    v_ofs = 0;
+                }
+            }
+        }
+        return tx_commit(total_len) ? total_len : 0;
+    }
+
+    if (lock_write_key != 0 || txspace() < total_len) {
+        return 0;
+    }
+    size_t ret = 0;
+    for (uint8_t i = 0; i < iovcnt; i++) {
+        ret += _write(iov[i].data, iov[i].len);
+    }
+    return ret;
+}
+
 size_t AP_HAL::UARTDriver::write(uint8_t c)
 {
     return write(&c, 1);
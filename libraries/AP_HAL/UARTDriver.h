@@ -4,6 +4,7 @@
 
 #include "AP_HAL_Namespace.h"
 #include "utility/BetterStream.h"
+#include "utility/RingBuffer.h"
 #include <AP_Logger/AP_Logger_config.h>
 
 #ifndef HAL_UART_STATS_ENABLED
@@ -15,7 +16,6 @@
 #endif
 
 class ExpandingString;
-class ByteBuffer;
 
 /* Pure virtual UARTDriver class */
 class AP_HAL::UARTDriver : public AP_HAL::BetterStream {
@@ -49,6 +49,34 @@ public:
     size_t write(const uint8_t *buffer, size_t size) override;
     size_t write(const char *str) override;
 
+    /*
+      reserve len bytes of transmit buffer space so a protocol encoder
+      can serialise directly into the buffer without an intermediate
+      copy. On success vec is filled with one or two regions totalling
+      len bytes and the number of regions is returned. Returns 0 if the
+      port is locked, there is not enough space or the backend does
+      not support reserving. A successful reserve must be followed by
+      tx_commit() before any other write to the port
+     */
+    uint8_t tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len);
+
+    /*
+      release len bytes of the last tx_reserve() for transmission. len
+      may be less than the reserved length, including zero to abandon
+      the reservation
+     */
+    bool tx_commit(uint32_t len);
+
+    /*
+      write a packet made of several fragments. Either the whole
+      packet is written or nothing is. Returns number of bytes written
+     */
+    struct IoVec {
+        const uint8_t *data;
+        uint32_t len;
+    };
+    size_t writev(const IoVec *iov, uint8_t iovcnt);
+
     /*
       single and multi-byte read methods
      */
@@ -231,6 +259,16 @@ protected:
      */
     virtual size_t _write(const uint8_t *buffer, size_t size) = 0;
 
+    /*
+      backend reserve and commit methods for writing directly into the
+      transmit buffer. Backends without a transmit ring buffer do not
+      need to implement these. The backend tracks the reservation
+      itself, under the same lock as its other writers, and must fail
+      a reserve while another is outstanding
+     */
+    virtual uint8_t _tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len) { return 0; }
+    virtual bool _tx_commit(uint32_t len) { return false; }
+
     /*
       backend read method
      */
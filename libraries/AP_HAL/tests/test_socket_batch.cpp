@@ -0,0 +1,104 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL/utility/Socket_native.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <string.h>
+
+// datagram sizes either side of the 300 byte MAVLink limit, up to the
+// largest read of the SITL UARTs
+static const uint16_t sizes[] { 1, 100, 280, 300, 301, 1400, 4000, 10000 };
+static const uint8_t count = ARRAY_SIZE(sizes);
+
+static uint8_t txbuf[count][10000];
+static uint8_t rxbuf[count][10000];
+static SocketAPM_native::packet tx_pkts[count];
+static SocketAPM_native::packet rx_pkts[count];
+
+/*
+  bind rx to an ephemeral port, connect tx to it and fill in the
+  packets to send and receive
+ */
+static bool setup(SocketAPM_native &rx, SocketAPM_native &tx)
+{
+    if (!rx.bind("127.0.0.1", 0)) {
+        return false;
+    }
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(rx.get_read_fd(), (struct sockaddr *)&addr, &len) != 0 ||
+        !tx.connect("127.0.0.1", ntohs(addr.sin_port))) {
+        return false;
+    }
+    for (uint8_t i=0; i<count; i++) {
+        for (uint16_t j=0; j<sizes[i]; j++) {
+            txbuf[i][j] = uint8_t(i + j);
+        }
+        tx_pkts[i].buf = txbuf[i];
+        tx_pkts[i].len = sizes[i];
+        rx_pkts[i].buf = rxbuf[i];
+        rx_pkts[i].len = sizeof(rxbuf[i]);
+    }
+    memset(rxbuf, 0, sizeof(rxbuf));
+    return true;
+}
+
+// check each datagram was received whole and in order
+static void check_received(void)
+{
+    for (uint8_t i=0; i<count; i++) {
+        EXPECT_EQ(sizes[i], rx_pkts[i].len);
+        EXPECT_EQ(0, memcmp(txbuf[i], rxbuf[i], sizes[i]));
+    }
+}
+
+TEST(SocketBatch, batch)
+{
+    SocketAPM_native rx{true}, tx{true};
+    ASSERT_TRUE(setup(rx, tx));
+
+    EXPECT_EQ(count, tx.send_batch(tx_pkts, count));
+    EXPECT_TRUE(rx.pollin(100));
+    EXPECT_EQ(count, rx.recv_batch(rx_pkts, count));
+    check_received();
+
+    // nothing more to receive
+    EXPECT_LE(rx.recv_batch(rx_pkts, count), 0);
+}
+
+// the calls used by the SITL UARTs on sockets they own
+TEST(SocketBatch, batch_fd)
+{
+    SocketAPM_native rx{true}, tx{true};
+    ASSERT_TRUE(setup(rx, tx));
+
+    EXPECT_EQ(count, SocketAPM_native::send_batch_fd(tx.get_read_fd(), tx_pkts, count));
+    EXPECT_TRUE(rx.pollin(100));
+    EXPECT_EQ(count, SocketAPM_native::recv_batch_fd(rx.get_read_fd(), rx_pkts, count));
+    check_received();
+
+    EXPECT_LE(SocketAPM_native::recv_batch_fd(rx.get_read_fd(), rx_pkts, count), 0);
+}
+
+// fewer buffers than datagrams leaves the rest for the next call
+TEST(SocketBatch, partial)
+{
+    SocketAPM_native rx{true}, tx{true};
+    ASSERT_TRUE(setup(rx, tx));
+
+    EXPECT_EQ(count, tx.send_batch(tx_pkts, count));
+    EXPECT_TRUE(rx.pollin(100));
+    const uint8_t first = count / 2;
+    EXPECT_EQ(first, rx.recv_batch(rx_pkts, first));
+    EXPECT_EQ(count - first, SocketAPM_native::recv_batch_fd(rx.get_read_fd(), &rx_pkts[first], count - first));
+    check_received();
+}
+
+#endif // CONFIG_HAL_BOARD
+
+AP_GTEST_MAIN()
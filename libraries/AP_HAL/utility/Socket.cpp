@@ -54,6 +54,15 @@
 #define MSG_NOSIGNAL 0
 #endif
 
+/*
+  sendmmsg() and recvmmsg() are only available with native sockets on Linux
+ */
+#if defined(__linux__) && !(AP_NETWORKING_BACKEND_CHIBIOS || AP_NETWORKING_BACKEND_PPP)
+#define SOCKET_HAVE_MMSG 1
+#else
+#define SOCKET_HAVE_MMSG 0
+#endif
+
 /*
   constructor
  */
@@ -355,6 +364,123 @@ ssize_t SOCKET_CLASS_NAME::recv(void *buf, size_t size, uint32_t timeout_ms)
     return ret;
 }
 
+/*
+  send several datagrams
+ */
+int SOCKET_CLASS_NAME::send_batch(const packet *pkts, uint8_t count) const
+{
+    if (fd == -1) {
+        return -1;
+    }
+    return send_batch_fd(fd, pkts, count);
+}
+
+/*
+  send several datagrams on a connected socket
+ */
+int SOCKET_CLASS_NAME::send_batch_fd(int fd, const packet *pkts, uint8_t count)
+{
+#if SOCKET_HAVE_MMSG
+    struct mmsghdr msgs[count];
+    struct iovec iov[count];
+    memset(msgs, 0, sizeof(msgs));
+    for (uint8_t i=0; i<count; i++) {
+        iov[i].iov_base = pkts[i].buf;
+        iov[i].iov_len = pkts[i].len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return ::sendmmsg(fd, msgs, count, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+    uint8_t i;
+    for (i=0; i<count; i++) {
+        if (CALL_PREFIX(send)(fd, pkts[i].buf, pkts[i].len, MSG_NOSIGNAL | MSG_DONTWAIT) != ssize_t(pkts[i].len)) {
+            break;
+        }
+    }
+    return (i == 0 && count > 0) ? -1 : i;
+#endif
+}
+
+/*
+  receive several datagrams
+ */
+int SOCKET_CLASS_NAME::recv_batch(packet *pkts, uint8_t count)
+{
+#if SOCKET_HAVE_MMSG
+    if (fd_in == -1 && datagram) {
+        if (fd == -1) {
+            return -1;
+        }
+        struct mmsghdr msgs[count];
+        struct iovec iov[count];
+        struct sockaddr_in from[count];
+        memset(msgs, 0, sizeof(msgs));
+        for (uint8_t i=0; i<count; i++) {
+            iov[i].iov_base = pkts[i].buf;
+            iov[i].iov_len = pkts[i].len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+        }
+        const int ret = ::recvmmsg(fd, msgs, count, MSG_DONTWAIT, nullptr);
+        if (ret <= 0) {
+            return ret;
+        }
+        for (uint8_t i=0; i<ret; i++) {
+            pkts[i].len = msgs[i].msg_len;
+        }
+        memcpy(last_in_addr, &from[ret-1], sizeof(from[0]));
+        return ret;
+    }
+#endif
+    // multicast and broadcast sockets need each packet checked to
+    // discard our own, so use recv()
+    uint8_t i;
+    for (i=0; i<count; i++) {
+        const ssize_t ret = recv(pkts[i].buf, pkts[i].len, 0);
+        if (ret <= 0) {
+            break;
+        }
+        pkts[i].len = ret;
+    }
+    return i;
+}
+
+/*
+  receive several datagrams on a connected socket
+ */
+int SOCKET_CLASS_NAME::recv_batch_fd(int fd, packet *pkts, uint8_t count)
+{
+#if SOCKET_HAVE_MMSG
+    struct mmsghdr msgs[count];
+    struct iovec iov[count];
+    memset(msgs, 0, sizeof(msgs));
+    for (uint8_t i=0; i<count; i++) {
+        iov[i].iov_base = pkts[i].buf;
+        iov[i].iov_len = pkts[i].len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int ret = ::recvmmsg(fd, msgs, count, MSG_DONTWAIT, nullptr);
+    for (int i=0; i<ret; i++) {
+        pkts[i].len = msgs[i].msg_len;
+    }
+    return ret;
+#else
+    uint8_t i;
+    for (i=0; i<count; i++) {
+        const ssize_t ret = CALL_PREFIX(recv)(fd, pkts[i].buf, pkts[i].len, MSG_DONTWAIT);
+        if (ret <= 0) {
+            break;
+        }
+        pkts[i].len = ret;
+    }
+    return (i == 0 && count > 0) ? -1 : i;
+#endif
+}
+
 /*
   return the IP address and port of the last received packet
  */
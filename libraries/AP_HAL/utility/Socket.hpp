@@ -45,6 +45,28 @@ public:
     ssize_t sendto(const void *buf, size_t size, const char *address, uint16_t port);
     ssize_t recv(void *pkt, size_t size, uint32_t timeout_ms);
 
+    // a datagram buffer for send_batch() and recv_batch()
+    struct packet {
+        uint8_t *buf;
+        uint16_t len;
+    };
+
+    // send several datagrams, using a single system call where the
+    // OS supports it. Returns the number of datagrams sent, or -1 on
+    // error
+    int send_batch(const packet *pkts, uint8_t count) const;
+
+    // receive up to count datagrams without blocking. On entry len is
+    // the size of each buffer, on return it is the length of each
+    // datagram received. Returns the number of datagrams received, or
+    // -1 on error
+    int recv_batch(packet *pkts, uint8_t count);
+
+    // as send_batch() and recv_batch(), for a connected datagram
+    // socket which is not owned by a SOCKET_CLASS_NAME
+    static int send_batch_fd(int fd, const packet *pkts, uint8_t count);
+    static int recv_batch_fd(int fd, packet *pkts, uint8_t count);
+
     // return the IP address and port of the last received packet
     void last_recv_address(const char *&ip_addr, uint16_t &port) const;
 
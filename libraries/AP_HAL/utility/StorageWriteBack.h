@@ -0,0 +1,158 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  write-back cache for the in-memory copy of storage kept by HAL
+  storage drivers.
+
+  Writes only dirty the lines whose contents actually change, and
+  write_out() hands the backend the first run of consecutive dirty
+  lines as a single range, so a burst of small writes to neighbouring
+  locations becomes one backend write. flush() is a barrier which
+  writes out everything dirty before returning.
+
+  Dirty lines are marked clean before the backend writes them. If a
+  line is changed again while it is being written it is re-dirtied and
+  written again later, so no update can be lost.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <AP_HAL/Semaphores.h>
+#include <AP_Common/Bitmask.h>
+
+template <uint32_t SIZE, uint8_t LINE_SHIFT>
+class StorageWriteBack {
+public:
+    static constexpr uint16_t LINE_SIZE = 1U << LINE_SHIFT;
+    static constexpr uint16_t NUM_LINES = SIZE / LINE_SIZE;
+    static_assert(SIZE % LINE_SIZE == 0, "Storage is not multiple of line size");
+
+    StorageWriteBack(uint8_t *buffer) :
+        _buffer(buffer)
+    {}
+
+    /*
+      copy data into the buffer, marking changed lines dirty. Returns
+      true if anything changed
+     */
+    bool write(uint16_t loc, const void *src, size_t n) {
+        const uint8_t *b = (const uint8_t *)src;
+        bool changed = false;
+        WITH_SEMAPHORE(_sem);
+        while (n > 0) {
+            const uint16_t line = loc >> LINE_SHIFT;
+            const size_t line_remaining = ((line + 1) << LINE_SHIFT) - loc;
+            const uint16_t count = n < line_remaining ? n : line_remaining;
+            if (memcmp(&_buffer[loc], b, count) != 0) {
+                memcpy(&_buffer[loc], b, count);
+                _dirty.set(line);
+                changed = true;
+            }
+            loc += count;
+            b += count;
+            n -= count;
+        }
+        return changed;
+    }
+
+    // mark all lines clean, for when the buffer has just been loaded
+    void clear_dirty(void) {
+        WITH_SEMAPHORE(_sem);
+        _dirty.clearall();
+    }
+
+    // return true if there is nothing to write
+    bool empty(void) const {
+        return _dirty.empty();
+    }
+
+    // semaphore protecting the buffer contents
+    HAL_Semaphore &get_semaphore(void) {
+        return _sem;
+    }
+
+    // semaphore held while the backend is being written
+    HAL_Semaphore &get_write_semaphore(void) {
+        return _write_sem;
+    }
+
+    /*
+      write out the first run of consecutive dirty lines, up to
+      max_length bytes, using writer(offset, length) which returns
+      true on success. Returns false if there was nothing to write or
+      the write failed
+     */
+    template <typename Writer>
+    bool write_out(Writer writer, uint16_t max_length) {
+        WITH_SEMAPHORE(_write_sem);
+        uint16_t offset, length;
+        if (!take_dirty(offset, length, max_length)) {
+            return false;
+        }
+        if (!writer(offset, length)) {
+            // put the lines back so they are retried
+            WITH_SEMAPHORE(_sem);
+            for (uint16_t line = offset >> LINE_SHIFT; line < (offset + length) >> LINE_SHIFT; line++) {
+                _dirty.set(line);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /*
+      flush barrier: write out all dirty lines before returning.
+      Returns false if the backend failed, in which case the lines
+      not yet written remain dirty
+     */
+    template <typename Writer>
+    bool flush(Writer writer, uint16_t max_length) {
+        while (!empty()) {
+            if (!write_out(writer, max_length)) {
+                return empty();
+            }
+        }
+        return true;
+    }
+
+private:
+    /*
+      find the first run of dirty lines and mark them clean
+     */
+    bool take_dirty(uint16_t &offset, uint16_t &length, uint16_t max_length) {
+        WITH_SEMAPHORE(_sem);
+        const int16_t first = _dirty.first_set();
+        if (first < 0) {
+            return false;
+        }
+        const uint16_t max_lines = max_length > LINE_SIZE ? max_length >> LINE_SHIFT : 1;
+        uint16_t n = 0;
+        while (first + n < NUM_LINES && n < max_lines && _dirty.get(first + n)) {
+            _dirty.clear(first + n);
+            n++;
+        }
+        offset = uint16_t(first) << LINE_SHIFT;
+        length = n << LINE_SHIFT;
+        return true;
+    }
+
+    uint8_t *_buffer;
+    Bitmask<NUM_LINES> _dirty;
+    // protects _buffer and _dirty
+    HAL_Semaphore _sem;
+    // serialises write_out() between the storage thread and flush()
+    HAL_Semaphore _write_sem;
+};
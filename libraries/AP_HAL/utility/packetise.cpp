@@ -9,11 +9,13 @@
 #include "packetise.h"
 
 /*
-  return the number of bytes to send for a packetised connection
+  return the number of bytes to send for a packetised connection,
+  using peek(ofs) to look at the pending bytes
  */
-uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
+template <typename Peek>
+static uint16_t packetise(const Peek &peek, uint16_t n)
 {
-    int16_t b = writebuf.peek(0);
+    int16_t b = peek(0);
     if (b != MAVLINK_STX_MAVLINK1 && b != MAVLINK_STX) {
         /*
           we have a non-mavlink packet at the start of the
@@ -23,7 +25,7 @@ uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
         uint16_t limit = n>256?256:n;
         uint16_t i;
         for (i=0; i<limit; i++) {
-            b = writebuf.peek(i);
+            b = peek(i);
             if (b == MAVLINK_STX_MAVLINK1 || b == MAVLINK_STX) {
                 n = i;
                 break;
@@ -47,10 +49,10 @@ uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
     }
 
     // the length of the packet is the 2nd byte
-    int16_t len = writebuf.peek(1);
+    int16_t len = peek(1);
     if (b == MAVLINK_STX) {
         // This is Mavlink2. Check for signed packet with extra 13 bytes
-        int16_t incompat_flags = writebuf.peek(2);
+        int16_t incompat_flags = peek(2);
         if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
             min_length += MAVLINK_SIGNATURE_BLOCK_LEN;
         }
@@ -68,4 +70,21 @@ uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
     return n;
 }
 
+/*
+  return the number of bytes to send for a packetised connection
+ */
+uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
+{
+    return packetise([&writebuf](uint16_t ofs) { return writebuf.peek(ofs); }, n);
+}
+
+/*
+  return the number of bytes to send for a packetised connection from
+  a linear buffer of n bytes
+ */
+uint16_t mavlink_packetise(const uint8_t *buf, uint16_t n)
+{
+    return packetise([buf, n](uint16_t ofs) { return ofs < n ? int16_t(buf[ofs]) : int16_t(-1); }, n);
+}
+
 #endif // HAL_GCS_ENABLED
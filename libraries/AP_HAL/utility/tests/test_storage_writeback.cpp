@@ -0,0 +1,170 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/StorageWriteBack.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// 16 lines of 8 bytes
+static constexpr uint16_t TEST_SIZE = 128;
+static constexpr uint8_t TEST_SHIFT = 3;
+typedef StorageWriteBack<TEST_SIZE, TEST_SHIFT> TestCache;
+
+// records the ranges handed to the backend
+class TestBackend {
+public:
+    bool write(uint16_t offset, uint16_t length) {
+        if (fail) {
+            return false;
+        }
+        offsets[count] = offset;
+        lengths[count] = length;
+        count++;
+        return true;
+    }
+    FUNCTOR_TYPEDEF(writer_fn, bool, uint16_t, uint16_t);
+    writer_fn writer() {
+        return FUNCTOR_BIND_MEMBER(&TestBackend::write, bool, uint16_t, uint16_t);
+    }
+    uint16_t offsets[TEST_SIZE];
+    uint16_t lengths[TEST_SIZE];
+    uint16_t count;
+    bool fail;
+};
+
+TEST(StorageWriteBackTest, OnlyChangedLinesDirty)
+{
+    uint8_t buffer[TEST_SIZE] {};
+    TestCache cache{buffer};
+    TestBackend backend {};
+
+    EXPECT_TRUE(cache.empty());
+
+    // writing what is already there changes nothing
+    const uint8_t zeros[TEST_SIZE] {};
+    EXPECT_FALSE(cache.write(0, zeros, sizeof(zeros)));
+    EXPECT_TRUE(cache.empty());
+
+    // a write spanning three lines which only changes the last byte
+    uint8_t data[20] {};
+    data[19] = 0x55;
+    EXPECT_TRUE(cache.write(4, data, sizeof(data)));
+    EXPECT_EQ(buffer[23], 0x55);
+    EXPECT_FALSE(cache.empty());
+
+    EXPECT_TRUE(cache.write_out(backend.writer(), TEST_SIZE));
+    EXPECT_EQ(backend.count, 1U);
+    EXPECT_EQ(backend.offsets[0], 16U);
+    EXPECT_EQ(backend.lengths[0], 8U);
+    EXPECT_TRUE(cache.empty());
+    EXPECT_FALSE(cache.write_out(backend.writer(), TEST_SIZE));
+}
+
+TEST(StorageWriteBackTest, CoalesceRuns)
+{
+    uint8_t buffer[TEST_SIZE] {};
+    TestCache cache{buffer};
+    TestBackend backend {};
+
+    // many small writes to neighbouring locations, as a parameter
+    // burst does, plus one separate write
+    for (uint8_t i=0; i<24; i++) {
+        const uint8_t v = i + 1;
+        cache.write(8 + i, &v, 1);
+    }
+    const uint8_t v = 0xAA;
+    cache.write(100, &v, 1);
+
+    EXPECT_TRUE(cache.flush(backend.writer(), TEST_SIZE));
+    EXPECT_TRUE(cache.empty());
+    ASSERT_EQ(backend.count, 2U);
+    EXPECT_EQ(backend.offsets[0], 8U);
+    EXPECT_EQ(backend.lengths[0], 24U);
+    EXPECT_EQ(backend.offsets[1], 96U);
+    EXPECT_EQ(backend.lengths[1], 8U);
+}
+
+TEST(StorageWriteBackTest, MaxLength)
+{
+    uint8_t buffer[TEST_SIZE] {};
+    TestCache cache{buffer};
+    TestBackend backend {};
+
+    uint8_t data[TEST_SIZE];
+    memset(data, 0x11, sizeof(data));
+    cache.write(0, data, sizeof(data));
+
+    EXPECT_TRUE(cache.write_out(backend.writer(), 32));
+    EXPECT_EQ(backend.offsets[0], 0U);
+    EXPECT_EQ(backend.lengths[0], 32U);
+
+    // a limit below the line size still makes progress
+    EXPECT_TRUE(cache.write_out(backend.writer(), 1));
+    EXPECT_EQ(backend.offsets[1], 32U);
+    EXPECT_EQ(backend.lengths[1], 8U);
+
+    EXPECT_TRUE(cache.flush(backend.writer(), 32));
+    EXPECT_EQ(backend.count, 5U);
+    EXPECT_EQ(backend.offsets[4], 104U);
+    EXPECT_EQ(backend.lengths[4], 24U);
+}
+
+TEST(StorageWriteBackTest, FailedWriteRetried)
+{
+    uint8_t buffer[TEST_SIZE] {};
+    TestCache cache{buffer};
+    TestBackend backend {};
+
+    uint8_t data[16];
+    memset(data, 0x22, sizeof(data));
+    cache.write(40, data, sizeof(data));
+
+    backend.fail = true;
+    EXPECT_FALSE(cache.write_out(backend.writer(), TEST_SIZE));
+    EXPECT_FALSE(cache.flush(backend.writer(), TEST_SIZE));
+    EXPECT_FALSE(cache.empty());
+
+    backend.fail = false;
+    EXPECT_TRUE(cache.flush(backend.writer(), TEST_SIZE));
+    ASSERT_EQ(backend.count, 1U);
+    EXPECT_EQ(backend.offsets[0], 40U);
+    EXPECT_EQ(backend.lengths[0], 16U);
+}
+
+TEST(StorageWriteBackTest, RedirtiedDuringWrite)
+{
+    static uint8_t buffer[TEST_SIZE];
+    static TestCache cache{buffer};
+    static uint16_t writes;
+
+    const uint8_t v1 = 1;
+    cache.write(0, &v1, 1);
+
+    // the line is changed again while the backend is writing it
+    auto writer = [](uint16_t offset, uint16_t length) {
+        if (writes++ == 0) {
+            const uint8_t v2 = 2;
+            cache.write(0, &v2, 1);
+        }
+        return true;
+    };
+    EXPECT_TRUE(cache.write_out(writer, TEST_SIZE));
+    EXPECT_FALSE(cache.empty());
+    EXPECT_TRUE(cache.flush(writer, TEST_SIZE));
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(writes, 2U);
+    EXPECT_EQ(buffer[0], 2U);
+}
+
+TEST(StorageWriteBackTest, ClearDirty)
+{
+    uint8_t buffer[TEST_SIZE] {};
+    TestCache cache{buffer};
+
+    const uint8_t v = 3;
+    cache.write(64, &v, 1);
+    EXPECT_FALSE(cache.empty());
+    cache.clear_dirty();
+    EXPECT_TRUE(cache.empty());
+}
+
+AP_GTEST_MAIN()
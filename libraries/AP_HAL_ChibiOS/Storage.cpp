@@ -58,7 +58,7 @@ void Storage::_storage_open(void)
         return;
     }
 
-    _dirty_mask.clearall();
+    _cache.clear_dirty();
 
 #if HAL_WITH_RAMTRON
     if (fram.init() && fram.read(0, _buffer, CH_STORAGE_SIZE)) {
@@ -202,26 +202,6 @@ void Storage::_save_backup(void)
 #endif
 }
 
-/*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
-*/
-void Storage::_mark_dirty(uint16_t loc, uint16_t length)
-{
-    if (length == 0) {
-        return;
-    }
-    uint16_t end = loc + length - 1;
-    for (uint16_t line=loc>>CH_STORAGE_LINE_SHIFT;
-         line <= end>>CH_STORAGE_LINE_SHIFT;
-         line++) {
-        _dirty_mask.set(line);
-    }
-}
-
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
 {
     if ((n > sizeof(_buffer)) || (loc > (sizeof(_buffer) - n))) {
@@ -238,88 +218,81 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
-        WITH_SEMAPHORE(sem);
-        memcpy(&_buffer[loc], src, n);
-        _mark_dirty(loc, n);
+        _cache.write(loc, src, n);
     }
 }
 
-void Storage::_timer_tick(void)
+/*
+  write a range of consecutive dirty lines to the storage backend
+ */
+bool Storage::_write_range(uint16_t offset, uint16_t length)
 {
-    if (_initialisedType == StorageBackend::None) {
-        return;
-    }
-    if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
-        return;
-    }
-
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
-    }
-    if (i == CH_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
-        return;
-    }
-
-    {
-        // take a copy of the line we are writing with a semaphore held
-        WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
-    }
-
-    bool write_ok = false;
-
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
-            write_ok = true;
-        }
+        return fram.write(offset, &_buffer[offset], length);
     }
 #endif
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
-            return;
-        }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
-            return;
+            return false;
         }
-        if (AP::FS().fsync(log_fd) != 0) {
-            return;
+        if (AP::FS().write(log_fd, &_buffer[offset], length) != length) {
+            return false;
         }
-        write_ok = true;
+        return AP::FS().fsync(log_fd) == 0;
     }
 #endif
 
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
-        // save to storage backend
-        if (_flash_write(i)) {
-            write_ok = true;
-        }
+        return _flash_write(offset, length);
     }
 #endif
 
-    if (write_ok) {
-        WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
-        // line is different from the original line. If it is
-        // different then someone has re-dirtied the line while we
-        // were writing it, in which case we should not mark it
-        // clean. If it matches then we know we can mark the line as
-        // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+    return false;
+}
+
+/*
+  largest range to write in one go for the current backend
+ */
+uint16_t Storage::_max_write(void) const
+{
+    return _initialisedType == StorageBackend::Flash ? CH_STORAGE_FLASH_MAX_WRITE : CH_STORAGE_MAX_WRITE;
+}
+
+void Storage::_timer_tick(void)
+{
+    if (_initialisedType == StorageBackend::None) {
+        return;
+    }
+    if (_cache.empty()) {
+        _last_empty_ms = AP_HAL::millis();
+#ifdef STORAGE_FLASH_PAGE
+        if (_initialisedType == StorageBackend::Flash) {
+            // use idle time to migrate data out of a full sector
+            WITH_SEMAPHORE(_cache.get_write_semaphore());
+            _flash.compact(CH_STORAGE_FLASH_MAX_WRITE);
         }
+#endif
+        return;
     }
+
+    // write out the first run of dirty lines. We limit the size to
+    // keep the latency of this call down
+    _cache.write_out(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), _max_write());
+}
+
+/*
+  write out everything pending
+ */
+bool Storage::flush(void)
+{
+    if (_initialisedType == StorageBackend::None) {
+        return true;
+    }
+    return _cache.flush(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), _max_write());
 }
 
 /*
@@ -345,13 +318,13 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write a range of storage lines to flash
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t offset, uint16_t length)
 {
 #ifdef STORAGE_FLASH_PAGE
     EXPECT_DELAY_MS(1);
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(offset, length);
 #else
     return false;
 #endif
@@ -505,5 +478,17 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     return true;
 }
 
+/*
+  report flash wear statistics
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+#ifdef STORAGE_FLASH_PAGE
+    if (_initialisedType == StorageBackend::Flash) {
+        _flash.wear_info(str);
+    }
+#endif
+}
+
 
 #endif // HAL_USE_EMPTY_STORAGE
@@ -18,7 +18,7 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include "AP_HAL_ChibiOS_Namespace.h"
-#include <AP_Common/Bitmask.h>
+#include <AP_HAL/utility/StorageWriteBack.h>
 #include <AP_FlashStorage/AP_FlashStorage.h>
 #include "hwdef/common/flash.h"
 #include <AP_RAMTRON/AP_RAMTRON.h>
@@ -47,6 +47,15 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// largest write of consecutive dirty lines made in one storage
+// thread tick. Flash writes stall the MCU, so use a smaller limit
+#ifndef CH_STORAGE_MAX_WRITE
+#define CH_STORAGE_MAX_WRITE 512
+#endif
+#ifndef CH_STORAGE_FLASH_MAX_WRITE
+#define CH_STORAGE_FLASH_MAX_WRITE (4*CH_STORAGE_LINE_SIZE)
+#endif
+
 /*
   on boards with 8k sector sizes we double up to treat pairs of sectors as one
  */
@@ -62,8 +71,10 @@ public:
     void write_block(uint16_t dst, const void* src, size_t n) override;
 
     void _timer_tick(void) override;
+    bool flush(void) override;
     bool healthy(void) override;
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    void storage_info(ExpandingString &str) override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -76,11 +87,10 @@ private:
     void _storage_create(void);
     void _storage_open(void);
     void _save_backup(void);
-    void _mark_dirty(uint16_t loc, uint16_t length);
+    bool _write_range(uint16_t offset, uint16_t length);
+    uint16_t _max_write(void) const;
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
-    Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
-    HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    StorageWriteBack<CH_STORAGE_SIZE, CH_STORAGE_LINE_SHIFT> _cache{_buffer};
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -105,7 +115,7 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t offset, uint16_t length);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
@@ -756,6 +756,10 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
 	}
 
     WITH_SEMAPHORE(_write_mutex);
+    if (_tx_reserved) {
+        // this thread holds a reservation which must be committed first
+        return 0;
+    }
 
     size_t ret = _writebuf.write(buffer, size);
     if (unbuffered_writes) {
@@ -764,6 +768,47 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve len bytes of the write buffer for the caller to write into
+  directly. The write mutex is held until _tx_commit(), and
+  _tx_reserved is only changed while holding it
+ */
+uint8_t UARTDriver::_tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_tx_initialised) {
+        return 0;
+    }
+    if (!_write_mutex.take_nonblocking()) {
+        return 0;
+    }
+    if (_tx_reserved || _writebuf.space() < len) {
+        // the mutex is recursive, so this thread may already hold a reservation
+        _write_mutex.give();
+        return 0;
+    }
+    const uint8_t n_vec = _writebuf.reserve(vec, len);
+    if (n_vec == 0) {
+        _write_mutex.give();
+        return 0;
+    }
+    _tx_reserved = true;
+    return n_vec;
+}
+
+bool UARTDriver::_tx_commit(uint32_t len)
+{
+    if (!_tx_reserved) {
+        return false;
+    }
+    _tx_reserved = false;
+    const bool ret = _writebuf.commit(len);
+    _write_mutex.give();
+    if (ret && unbuffered_writes) {
+        chEvtSignal(uart_thread_ctx, EVT_TRANSMIT_DATA_READY);
+    }
+    return ret;
+}
+
 /*
   wait for data to arrive, or a timeout. Return true if data has
   arrived, false on timeout
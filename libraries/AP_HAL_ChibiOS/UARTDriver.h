@@ -182,7 +182,11 @@ private:
 #endif
     ByteBuffer _readbuf{0};
     ByteBuffer _writebuf{0};
+    // held while accessing _writebuf, and from a successful
+    // _tx_reserve() until _tx_commit()
     HAL_Semaphore _write_mutex;
+    // true between a successful _tx_reserve() and _tx_commit(), protected by _write_mutex
+    bool _tx_reserved;
 #ifndef HAL_UART_NODMA
     const stm32_dma_stream_t* rxdma;
     const stm32_dma_stream_t* txdma;
@@ -273,6 +277,8 @@ protected:
     void _end() override;
     void _flush() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
+    uint8_t _tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    bool _tx_commit(uint32_t len) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override;
     uint32_t _available() override;
     bool _discard_input() override;
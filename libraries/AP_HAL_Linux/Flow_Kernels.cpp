@@ -0,0 +1,234 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "Flow_Kernels.h"
+
+#include <stdlib.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define FLOW_KERNELS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define FLOW_KERNELS_NEON 1
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+using namespace Linux;
+
+/*
+  scalar kernels
+ */
+static uint32_t sad_8x8_scalar(const uint8_t *image1, const uint8_t *image2, uint32_t row_size)
+{
+    uint32_t acc = 0;
+    for (uint8_t j = 0; j < 8; j++) {
+        for (uint8_t i = 0; i < 8; i++) {
+            acc += abs(image1[i] - image2[i]);
+        }
+        image1 += row_size;
+        image2 += row_size;
+    }
+    return acc;
+}
+
+static void sum_rows_scalar(const uint8_t *src, uint32_t row_size, uint32_t rows,
+                            uint32_t width, uint16_t *sums)
+{
+    for (uint32_t i = 0; i < width; i++) {
+        sums[i] = 0;
+    }
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t i = 0; i < width; i++) {
+            sums[i] += src[i];
+        }
+        src += row_size;
+    }
+}
+
+static void yuyv_to_grey_scalar(const uint8_t *src, uint32_t count, uint8_t *dst)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+static const FlowKernels scalar_kernels {
+    "scalar",
+    sad_8x8_scalar,
+    sum_rows_scalar,
+    yuyv_to_grey_scalar,
+};
+
+#if FLOW_KERNELS_SSE2
+/*
+  SSE2 kernels. These are built with the target attribute so 32 bit
+  x86 builds without -msse2 still have them, and are only used when
+  the CPU reports SSE2
+ */
+__attribute__((target("sse2")))
+static uint32_t sad_8x8_sse2(const uint8_t *image1, const uint8_t *image2, uint32_t row_size)
+{
+    __m128i acc = _mm_setzero_si128();
+    for (uint8_t j = 0; j < 8; j += 2) {
+        // two rows of 8 pixels in each register
+        const __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)image1),
+                                             _mm_loadl_epi64((const __m128i *)(image1 + row_size)));
+        const __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)image2),
+                                             _mm_loadl_epi64((const __m128i *)(image2 + row_size)));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+        image1 += 2 * row_size;
+        image2 += 2 * row_size;
+    }
+    return _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+}
+
+__attribute__((target("sse2")))
+static void sum_rows_sse2(const uint8_t *src, uint32_t row_size, uint32_t rows,
+                          uint32_t width, uint16_t *sums)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= width; i += 16) {
+        __m128i lo = zero;
+        __m128i hi = zero;
+        const uint8_t *p = src + i;
+        for (uint32_t r = 0; r < rows; r++) {
+            const __m128i v = _mm_loadu_si128((const __m128i *)p);
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+            p += row_size;
+        }
+        _mm_storeu_si128((__m128i *)&sums[i], lo);
+        _mm_storeu_si128((__m128i *)&sums[i + 8], hi);
+    }
+    if (i < width) {
+        sum_rows_scalar(src + i, row_size, rows, width - i, sums + i);
+    }
+}
+
+__attribute__((target("sse2")))
+static void yuyv_to_grey_sse2(const uint8_t *src, uint32_t count, uint8_t *dst)
+{
+    const __m128i luma_mask = _mm_set1_epi16(0x00ff);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2 * i)), luma_mask);
+        const __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2 * i + 16)), luma_mask);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+    }
+    yuyv_to_grey_scalar(src + 2 * i, count - i, dst + i);
+}
+
+static const FlowKernels simd_kernels {
+    "sse2",
+    sad_8x8_sse2,
+    sum_rows_sse2,
+    yuyv_to_grey_sse2,
+};
+
+static bool simd_supported()
+{
+    return __builtin_cpu_supports("sse2");
+}
+#endif // FLOW_KERNELS_SSE2
+
+#if FLOW_KERNELS_NEON
+/*
+  NEON kernels, for builds which enable NEON
+ */
+static uint32_t sad_8x8_neon(const uint8_t *image1, const uint8_t *image2, uint32_t row_size)
+{
+    uint16x8_t acc = vabdl_u8(vld1_u8(image1), vld1_u8(image2));
+    for (uint8_t j = 1; j < 8; j++) {
+        image1 += row_size;
+        image2 += row_size;
+        acc = vabal_u8(acc, vld1_u8(image1), vld1_u8(image2));
+    }
+    const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(acc));
+    return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+}
+
+static void sum_rows_neon(const uint8_t *src, uint32_t row_size, uint32_t rows,
+                          uint32_t width, uint16_t *sums)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= width; i += 16) {
+        uint16x8_t lo = vdupq_n_u16(0);
+        uint16x8_t hi = vdupq_n_u16(0);
+        const uint8_t *p = src + i;
+        for (uint32_t r = 0; r < rows; r++) {
+            const uint8x16_t v = vld1q_u8(p);
+            lo = vaddw_u8(lo, vget_low_u8(v));
+            hi = vaddw_u8(hi, vget_high_u8(v));
+            p += row_size;
+        }
+        vst1q_u16(&sums[i], lo);
+        vst1q_u16(&sums[i + 8], hi);
+    }
+    if (i < width) {
+        sum_rows_scalar(src + i, row_size, rows, width - i, sums + i);
+    }
+}
+
+static void yuyv_to_grey_neon(const uint8_t *src, uint32_t count, uint8_t *dst)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x2_t v = vld2q_u8(src + 2 * i);
+        vst1q_u8(dst + i, v.val[0]);
+    }
+    yuyv_to_grey_scalar(src + 2 * i, count - i, dst + i);
+}
+
+static const FlowKernels simd_kernels {
+    "neon",
+    sad_8x8_neon,
+    sum_rows_neon,
+    yuyv_to_grey_neon,
+};
+
+static bool simd_supported()
+{
+#if defined(__arm__) && defined(HWCAP_NEON)
+    // 32 bit kernels can run with NEON disabled
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+    return true;
+#endif
+}
+#endif // FLOW_KERNELS_NEON
+
+const FlowKernels &FlowKernels::get()
+{
+#if FLOW_KERNELS_SSE2 || FLOW_KERNELS_NEON
+    static const FlowKernels &kernels = simd_supported() ? simd_kernels : scalar_kernels;
+    return kernels;
+#else
+    return scalar_kernels;
+#endif
+}
+
+const FlowKernels &FlowKernels::scalar()
+{
+    return scalar_kernels;
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace Linux {
+
+/*
+  pixel kernels used by onboard optical flow. get() returns NEON or SSE2
+  versions when the CPU supports them and the scalar versions
+  otherwise. All versions give identical results.
+ */
+class FlowKernels {
+public:
+    const char *name;
+
+    // sum of absolute differences of two 8x8 windows, rows row_size apart
+    uint32_t (*sad_8x8)(const uint8_t *image1, const uint8_t *image2, uint32_t row_size);
+
+    // sums[i] = sum over rows of src[i], for width pixels of rows
+    // which are row_size apart. rows must be at most 257
+    void (*sum_rows)(const uint8_t *src, uint32_t row_size, uint32_t rows,
+                     uint32_t width, uint16_t *sums);
+
+    // copy the luma of count YUYV pixels
+    void (*yuyv_to_grey)(const uint8_t *src, uint32_t count, uint8_t *dst);
+
+    // fastest kernels this CPU supports
+    static const FlowKernels &get();
+
+    // portable kernels, for comparison
+    static const FlowKernels &scalar();
+};
+
+}
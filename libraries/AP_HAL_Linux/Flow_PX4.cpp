@@ -51,7 +51,9 @@ using namespace Linux;
 Flow_PX4::Flow_PX4(uint32_t width, uint32_t bytesperline,
                    uint32_t max_flow_pixel,
                    float bottom_flow_feature_threshold,
-                   float bottom_flow_value_threshold) :
+                   float bottom_flow_value_threshold,
+                   const FlowKernels &kernels) :
+    _kernels(kernels),
     _width(width),
     _bytesperline(bytesperline),
     _search_size(max_flow_pixel),
@@ -264,12 +266,23 @@ uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
             int8_t sumy = 0;
             int8_t ii, jj;
 
+            const uint8_t *block1 = image1 + j * _bytesperline + i;
+            const uint8_t *block2 = image2 + j * _bytesperline + i;
+
             for (jj = winmin; jj <= winmax; jj++) {
                 for (ii = winmin; ii <= winmax; ii++) {
-                    uint32_t temp_dist = compute_sad(image1, image2, i, j,
-                                                     i + ii, j + jj,
-                                                     (uint16_t)_bytesperline,
-                                                     2 * _search_size);
+                    uint32_t temp_dist;
+                    if (_search_size == 4) {
+                        /* the usual 8x8 window has a vectorized kernel */
+                        temp_dist = _kernels.sad_8x8(block1,
+                                                     block2 + jj * (int32_t)_bytesperline + ii,
+                                                     _bytesperline);
+                    } else {
+                        temp_dist = compute_sad(image1, image2, i, j,
+                                                i + ii, j + jj,
+                                                (uint16_t)_bytesperline,
+                                                2 * _search_size);
+                    }
                     if (temp_dist < dist) {
                         sumx = ii;
                         sumy = jj;
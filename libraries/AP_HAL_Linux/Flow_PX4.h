@@ -15,6 +15,7 @@
 #pragma once
 
 #include "AP_HAL_Linux.h"
+#include "Flow_Kernels.h"
 
 namespace Linux {
 
@@ -23,10 +24,12 @@ public:
     Flow_PX4(uint32_t width, uint32_t bytesperline,
              uint32_t max_flow_pixel,
              float bottom_flow_feature_threshold,
-             float bottom_flow_value_threshold);
+             float bottom_flow_value_threshold,
+             const FlowKernels &kernels = FlowKernels::get());
     uint8_t compute_flow(uint8_t *image1, uint8_t *image2, uint32_t delta_time,
                          float *pixel_flow_x, float *pixel_flow_y);
 private:
+    const FlowKernels &_kernels;
     uint32_t _width;
     uint32_t _search_size;
     uint32_t _bytesperline;
@@ -33,6 +33,8 @@
 #include "AP_HAL/utility/RingBuffer.h"
 
 #define OPTICAL_FLOW_ONBOARD_RTPRIO 11
+/* capture runs above flow computation so frames are never missed */
+#define OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO 12
 static const unsigned int OPTICAL_FLOW_GYRO_BUFFER_LEN = 400;
 
 extern const AP_HAL::HAL& hal;
@@ -46,10 +48,6 @@ void OpticalFlow_Onboard::init()
     uint32_t memtype = V4L2_MEMORY_MMAP;
     unsigned int nbufs = 0;
     int ret;
-    pthread_attr_t attr;
-    struct sched_param param = {
-        .sched_priority = OPTICAL_FLOW_ONBOARD_RTPRIO
-    };
 
     if (_initialized) {
         return;
@@ -151,25 +149,22 @@ void OpticalFlow_Onboard::init()
                          HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
                          HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
 
-    /* Create the thread that will be waiting for frames
-     * Initialize thread and mutex */
     ret = pthread_mutex_init(&_mutex, nullptr);
     if (ret != 0) {
         AP_HAL::panic("OpticalFlow_Onboard: failed to init mutex");
     }
 
-    ret = pthread_attr_init(&attr);
+    ret = pthread_mutex_init(&_frame_mutex, nullptr);
     if (ret != 0) {
-        AP_HAL::panic("OpticalFlow_Onboard: failed to init attr");
-    }
-    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-    pthread_attr_setschedparam(&attr, &param);
-    ret = pthread_create(&_thread, &attr, _read_thread, this);
-    if (ret != 0) {
-        AP_HAL::panic("OpticalFlow_Onboard: failed to create thread");
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init frame mutex");
     }
 
+    /* Capture and preprocessing of the next frame runs in one thread
+     * while flow is computed on the previous pair in another */
+    _start_thread(_thread, _read_thread, OPTICAL_FLOW_ONBOARD_RTPRIO);
+    _start_thread(_capture_thread, _capture_thread_main,
+                  OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO);
+
     _gyro_ring_buffer = NEW_NOTHROW ObjectBuffer<GyroSample>(OPTICAL_FLOW_GYRO_BUFFER_LEN);
     if (_gyro_ring_buffer != nullptr && _gyro_ring_buffer->get_size() == 0) {
         // allocation failed
@@ -243,6 +238,35 @@ void OpticalFlow_Onboard::push_gyro_bias(float gyro_bias_x, float gyro_bias_y)
     _gyro_bias.y = gyro_bias_y;
 }
 
+void OpticalFlow_Onboard::_start_thread(pthread_t &thread, void *(*fn)(void *), int priority)
+{
+    pthread_attr_t attr;
+    struct sched_param param = {
+        .sched_priority = priority
+    };
+    int ret;
+
+    ret = pthread_attr_init(&attr);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init attr");
+    }
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    ret = pthread_create(&thread, &attr, fn, this);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to create thread");
+    }
+}
+
+void *OpticalFlow_Onboard::_capture_thread_main(void *arg)
+{
+    OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
+
+    optflow_onboard->_run_capture();
+    return nullptr;
+}
+
 void *OpticalFlow_Onboard::_read_thread(void *arg)
 {
     OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
@@ -251,17 +275,18 @@ void *OpticalFlow_Onboard::_read_thread(void *arg)
     return nullptr;
 }
 
-void OpticalFlow_Onboard::_run_optflow()
+/*
+  capture frames and convert them to 8bpp at the flow resolution, in
+  place, then queue them for _run_optflow()
+ */
+void OpticalFlow_Onboard::_run_capture()
 {
-    GyroSample gyro_sample;
-    Vector2f flow_rate;
     VideoIn::Frame video_frame;
     uint32_t convert_buffer_size = 0, output_buffer_size = 0;
     uint32_t crop_left = 0, crop_top = 0;
     uint32_t shrink_scale = 0, shrink_width = 0, shrink_height = 0;
     uint32_t shrink_width_offset = 0, shrink_height_offset = 0;
     uint8_t *convert_buffer = nullptr, *output_buffer = nullptr;
-    uint8_t qual;
 
     if (_format == V4L2_PIX_FMT_YUYV) {
         if (_shrink_by_software || _crop_by_software) {
@@ -353,6 +378,53 @@ void OpticalFlow_Onboard::_run_optflow()
             memcpy(video_frame.data, output_buffer, output_buffer_size);
         }
 
+        /* hand the frame to the flow thread. If flow computation is
+         * behind the frame it has not taken yet is dropped, so flow is
+         * always computed on the newest frame */
+        pthread_mutex_lock(&_frame_mutex);
+        const bool drop_frame = _have_next_frame;
+        VideoIn::Frame dropped_frame = _next_frame;
+        _next_frame = video_frame;
+        _have_next_frame = true;
+        pthread_mutex_unlock(&_frame_mutex);
+
+        if (drop_frame) {
+            _videoin->put_frame(dropped_frame);
+        }
+        _frame_sem.signal();
+    }
+
+    if (convert_buffer) {
+        free(convert_buffer);
+    }
+
+    if (output_buffer) {
+        free(output_buffer);
+    }
+}
+
+/*
+  compute flow between consecutive preprocessed frames
+ */
+void OpticalFlow_Onboard::_run_optflow()
+{
+    GyroSample gyro_sample;
+    Vector2f flow_rate;
+    VideoIn::Frame video_frame;
+    uint8_t qual;
+
+    while (true) {
+        pthread_mutex_lock(&_frame_mutex);
+        const bool have_frame = _have_next_frame;
+        video_frame = _next_frame;
+        _have_next_frame = false;
+        pthread_mutex_unlock(&_frame_mutex);
+
+        if (!have_frame) {
+            _frame_sem.wait_blocking();
+            continue;
+        }
+
         /* if it is at least the second frame we receive
          * since we have to compare 2 frames */
         if (_last_video_frame.data == nullptr) {
@@ -415,13 +487,5 @@ void OpticalFlow_Onboard::_run_optflow()
         _last_video_frame = video_frame;
         _last_gyro_rate = gyro_sample.gyro;
     }
-
-    if (convert_buffer) {
-        free(convert_buffer);
-    }
-
-    if (output_buffer) {
-        free(output_buffer);
-    }
 }
 #endif
@@ -42,7 +42,10 @@ public:
     void push_gyro_bias(float gyro_bias_x, float gyro_bias_y) override;
 
 private:
+    void _start_thread(pthread_t &thread, void *(*fn)(void *), int priority);
+    void _run_capture();
     void _run_optflow();
+    static void *_capture_thread_main(void *arg);
     static void *_read_thread(void *arg);
     void _get_integrated_gyros(uint64_t timestamp, GyroSample &gyro);
     VideoIn* _videoin;
@@ -51,7 +54,13 @@ private:
     CameraSensor* _camerasensor;
     Flow_PX4* _flow;
     pthread_t _thread;
+    pthread_t _capture_thread;
     pthread_mutex_t _mutex;
+    // newest preprocessed frame waiting for flow computation
+    pthread_mutex_t _frame_mutex;
+    VideoIn::Frame _next_frame;
+    bool _have_next_frame;
+    HAL_BinarySemaphore _frame_sem;
     bool _initialized;
     bool _data_available;
     bool _crop_by_software;
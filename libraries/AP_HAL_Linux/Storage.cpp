@@ -141,7 +141,7 @@ void Storage::init()
         return;
     }
 
-    _dirty_mask = 0;
+    _cache.clear_dirty();
 
     dpath = hal.util->get_custom_storage_directory();
     if (!dpath) {
@@ -174,26 +174,6 @@ void Storage::init()
     _initialised = true;
 }
 
-/*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
- */
-void Storage::_mark_dirty(uint16_t loc, uint16_t length)
-{
-    if (length == 0) {
-        return;
-    }
-    uint16_t end = loc + length - 1;
-    for (uint8_t line=loc>>LINUX_STORAGE_LINE_SHIFT;
-         line <= end>>LINUX_STORAGE_LINE_SHIFT;
-         line++) {
-        _dirty_mask |= 1U << line;
-    }
-}
-
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
 {
     if (loc >= sizeof(_buffer)-(n-1)) {
@@ -210,61 +190,48 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         init();
-        memcpy(&_buffer[loc], src, n);
-        _mark_dirty(loc, n);
+        _cache.write(loc, src, n);
     }
 }
 
-void Storage::_timer_tick(void)
+/*
+  write a range of consecutive dirty lines to the storage file
+ */
+bool Storage::_write_range(uint16_t offset, uint16_t length)
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
-        return;
+    if (pwrite(_fd, &_buffer[offset], length, offset) != ssize_t(length)) {
+        // write error - likely EINTR
+        close(_fd);
+        _fd = -1;
+        return false;
     }
-
-    // write out the first dirty set of lines. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint8_t i, n;
-    for (i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask & (1<<i)) {
-            break;
-        }
+    if (_cache.empty() && fsync(_fd) != 0) {
+        close(_fd);
+        _fd = -1;
     }
-    if (i == LINUX_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
+    return true;
+}
+
+void Storage::_timer_tick(void)
+{
+    if (!_initialised || _cache.empty() || _fd == -1) {
         return;
     }
-    uint32_t write_mask = (1U<<i);
-    // see how many lines to write
-    for (n=1; (i+n) < LINUX_STORAGE_NUM_LINES &&
-             n < (LINUX_STORAGE_MAX_WRITE>>LINUX_STORAGE_LINE_SHIFT); n++) {
-        if (!(_dirty_mask & (1<<(n+i)))) {
-            break;
-        }
-        // mark that line clean
-        write_mask |= (1<<(n+i));
-    }
 
-    /*
-      write the lines. This also updates _dirty_mask. Note that
-      because this is a SCHED_FIFO thread it will not be preempted
-      by the main task except during blocking calls. This means we
-      don't need a semaphore around the _dirty_mask updates.
-     */
-    if (lseek(_fd, i<<LINUX_STORAGE_LINE_SHIFT, SEEK_SET) == (i<<LINUX_STORAGE_LINE_SHIFT)) {
-        _dirty_mask &= ~write_mask;
-        if (write(_fd, &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], n<<LINUX_STORAGE_LINE_SHIFT) != n<<LINUX_STORAGE_LINE_SHIFT) {
-            // write error - likely EINTR
-            _dirty_mask |= write_mask;
-            close(_fd);
-            _fd = -1;
-        }
-        if (_dirty_mask == 0) {
-            if (fsync(_fd) != 0) {
-                close(_fd);
-                _fd = -1;
-            }
-        }
+    // write out the first run of dirty lines. We limit the size to
+    // keep the latency of this call down
+    _cache.write_out(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), LINUX_STORAGE_MAX_WRITE);
+}
+
+/*
+  write out everything pending
+ */
+bool Storage::flush(void)
+{
+    if (!_initialised || _fd == -1) {
+        return _cache.empty();
     }
+    return _cache.flush(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), LINUX_STORAGE_MAX_WRITE);
 }
 
 /*
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/StorageWriteBack.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
-#define LINUX_STORAGE_MAX_WRITE 512
-#define LINUX_STORAGE_LINE_SHIFT 9
+#define LINUX_STORAGE_MAX_WRITE 4096
+#define LINUX_STORAGE_LINE_SHIFT 6
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
@@ -13,7 +14,7 @@ namespace Linux {
 class Storage : public AP_HAL::Storage
 {
 public:
-    Storage() : _fd(-1),_dirty_mask(0) { }
+    Storage() : _fd(-1) { }
 
     static Storage *from(AP_HAL::Storage *storage) {
         return static_cast<Storage*>(storage);
@@ -35,15 +36,16 @@ public:
     bool get_storage_ptr(void *&ptr, size_t &size) override;
 
     virtual void _timer_tick(void) override;
+    bool flush(void) override;
 
 protected:
-    void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
+    bool _write_range(uint16_t offset, uint16_t length);
 
     int _fd;
     volatile bool _initialised;
-    volatile uint32_t _dirty_mask;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+    StorageWriteBack<LINUX_STORAGE_SIZE, LINUX_STORAGE_LINE_SHIFT> _cache{_buffer};
 };
 
 }
@@ -91,6 +91,8 @@ protected:
     virtual int _read_fd(uint8_t *buf, uint16_t n);
 
     Linux::Semaphore _write_mutex;
+    // true between a successful _tx_reserve() and _tx_commit(), protected by _write_mutex
+    bool _tx_reserved = false;
 
     bool _discard_input() override;
     void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
@@ -98,6 +100,8 @@ protected:
     void _flush() override;
     uint32_t _available() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
+    uint8_t _tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    bool _tx_commit(uint32_t len) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override WARN_IF_UNUSED;
 };
 
@@ -18,7 +18,7 @@
  */
 
 #include <AP_HAL/AP_HAL.h>
-#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 #include "VideoIn.h"
 
 #include <errno.h>
@@ -37,6 +37,13 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <AP_Math/AP_Math.h>
+
+#include "Flow_Kernels.h"
+
+/* most columns shrink_8bpp() sums at once */
+#define SHRINK_MAX_CHUNK 256
+
 extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
@@ -249,42 +256,50 @@ void VideoIn::prepare_capture()
     }
 }
 
+/*
+  shrink by averaging fx by fy blocks. The fy rows of each output row
+  are summed first, then the sums are added in groups of fx
+ */
 void VideoIn::shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
                           uint32_t width, uint32_t height, uint32_t left,
                           uint32_t selection_width, uint32_t top,
                           uint32_t selection_height, uint32_t fx, uint32_t fy)
 {
-    uint32_t i, j, k, kk, px, block_x, block_y, block_position;
-    uint32_t out_width = selection_width / fx;
-    uint32_t out_height = selection_height / fy;
-    uint32_t width_per_fy = width * fy;
-    uint32_t fx_fy = fx * fy;
-    uint32_t width_sum, out_width_sum = 0;
-
-    /* selection offset */
-    block_y = top * width;
-    block_position = left + block_y;
-
-    for (i = 0; i < out_height; i++) {
-        block_x = left;
-        for (j = 0; j < out_width; j++) {
-            px = 0;
-
-            width_sum = 0;
-            for(k = 0; k < fy; k++) {
-                for(kk = 0; kk < fx; kk++) {
-                    px += buffer[block_position + kk + width_sum];
-                }
-                width_sum += width;
-            }
+    shrink_8bpp(buffer, new_buffer, width, height, left, selection_width,
+                top, selection_height, fx, fy, FlowKernels::get());
+}
 
-            new_buffer[j + out_width_sum] = px / (fx_fy);
+void VideoIn::shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
+                          uint32_t width, uint32_t height, uint32_t left,
+                          uint32_t selection_width, uint32_t top,
+                          uint32_t selection_height, uint32_t fx, uint32_t fy,
+                          const FlowKernels &kernels)
+{
+    if (fx == 0 || fx > SHRINK_MAX_CHUNK || fy == 0 || fy > UINT16_MAX / UINT8_MAX) {
+        return;
+    }
 
-            block_x += fx;
-            block_position = block_x + block_y;
+    const uint32_t out_width = selection_width / fx;
+    const uint32_t out_height = selection_height / fy;
+    const uint32_t fx_fy = fx * fy;
+    /* columns summed at a time, a whole number of blocks */
+    const uint32_t chunk_width = (SHRINK_MAX_CHUNK / fx) * fx;
+    uint16_t sums[SHRINK_MAX_CHUNK];
+
+    for (uint32_t i = 0; i < out_height; i++) {
+        const uint8_t *row = buffer + (top + i * fy) * width + left;
+        uint8_t *out = new_buffer + i * out_width;
+        for (uint32_t x = 0; x < out_width * fx; x += chunk_width) {
+            const uint32_t n = MIN(chunk_width, out_width * fx - x);
+            kernels.sum_rows(row + x, width, fy, n, sums);
+            for (uint32_t j = 0; j < n; j += fx) {
+                uint32_t px = 0;
+                for (uint32_t k = 0; k < fx; k++) {
+                    px += sums[j + k];
+                }
+                *out++ = px / fx_fy;
+            }
         }
-        block_y += width_per_fy;
-        out_width_sum += out_width;
     }
 }
 
@@ -292,29 +307,19 @@ void VideoIn::crop_8bpp(uint8_t *buffer, uint8_t *new_buffer,
                         uint32_t width, uint32_t left, uint32_t crop_width,
                         uint32_t top, uint32_t crop_height)
 {
-    uint32_t crop_x = left + crop_width;
-    uint32_t crop_y = top + crop_height;
-    uint32_t buffer_index = top * width;
-    uint32_t new_buffer_index = 0;
-
-    for (uint32_t j = top; j < crop_y; j++) {
-        for (uint32_t i = left; i < crop_x; i++) {
-            new_buffer[i - left + new_buffer_index] =  buffer[i + buffer_index];
-        }
-        buffer_index += width;
-        new_buffer_index += crop_width;
+    const uint8_t *src = buffer + top * width + left;
+
+    for (uint32_t j = 0; j < crop_height; j++) {
+        memcpy(new_buffer, src, crop_width);
+        src += width;
+        new_buffer += crop_width;
     }
 }
 
 void VideoIn::yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
                            uint8_t *new_buffer)
 {
-    uint32_t new_buffer_position = 0;
-
-    for (uint32_t i = 0; i < buffer_size; i += 2) {
-        new_buffer[new_buffer_position] = buffer[i];
-        new_buffer_position++;
-    }
+    FlowKernels::get().yuyv_to_grey(buffer, buffer_size / 2, new_buffer);
 }
 
 uint32_t VideoIn::_timeval_to_us(struct timeval& tv)
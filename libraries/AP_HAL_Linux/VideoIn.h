@@ -20,6 +20,8 @@
 
 namespace Linux {
 
+class FlowKernels;
+
 struct buffer {
     unsigned int size;
     void *mem;
@@ -58,6 +60,13 @@ public:
                             uint32_t selection_width, uint32_t top,
                             uint32_t selection_height, uint32_t fx, uint32_t fy);
 
+    // shrink_8bpp() using the given pixel kernels
+    static void shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
+                            uint32_t width, uint32_t height, uint32_t left,
+                            uint32_t selection_width, uint32_t top,
+                            uint32_t selection_height, uint32_t fx, uint32_t fy,
+                            const FlowKernels &kernels);
+
     static void crop_8bpp(uint8_t *buffer, uint8_t *new_buffer,
                           uint32_t width, uint32_t left,
                           uint32_t crop_width, uint32_t top,
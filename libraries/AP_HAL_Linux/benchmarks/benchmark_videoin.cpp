@@ -3,8 +3,29 @@
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP
 
+#include <AP_HAL_Linux/Flow_Kernels.h>
+#include <AP_HAL_Linux/Flow_PX4.h>
 #include <AP_HAL_Linux/VideoIn.h>
 
+/* kernels selected by the benchmark argument: 0 scalar, 1 best available */
+static const Linux::FlowKernels &kernels_for(int arg)
+{
+    return arg ? Linux::FlowKernels::get() : Linux::FlowKernels::scalar();
+}
+
+/* a textured test image, with the texture shifted by dx, dy */
+static void fill_image(uint8_t *image, uint32_t width, uint32_t height,
+                       int32_t dx, int32_t dy)
+{
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t u = x + dx + 1000;
+            const uint32_t v = y + dy + 1000;
+            image[y * width + x] = ((u * 73 + v * 151) ^ (u * v)) & 0xff;
+        }
+    }
+}
+
 static void BM_Crop8bpp(benchmark::State& state)
 {
     uint8_t *buffer, *new_buffer;
@@ -63,6 +84,109 @@ static void BM_YuyvToGrey(benchmark::State& state)
 }
 
 BENCHMARK(BM_YuyvToGrey)->Arg(64 * 64)->Arg(320 * 240)->Arg(640 * 480);
+
+/* the Bebop camera output, 320x240, shrunk by range_x to 64x64 with
+ * the kernels selected by range_y */
+static void BM_Shrink8bpp(benchmark::State& state)
+{
+    const uint32_t width = 320;
+    const uint32_t height = 240;
+    const uint32_t scale = state.range_x();
+    const uint32_t out = 64;
+    const Linux::FlowKernels &kernels = kernels_for(state.range_y());
+    uint8_t *buffer = (uint8_t *)calloc(1, width * height);
+    uint8_t *new_buffer = (uint8_t *)calloc(1, out * out);
+
+    if (!buffer || !new_buffer) {
+        fprintf(stderr, "error: couldn't malloc buffers\n");
+        free(buffer);
+        free(new_buffer);
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        Linux::VideoIn::shrink_8bpp(buffer, new_buffer, width, height,
+                                    (width - out * scale) / 2, out * scale,
+                                    (height - out * scale) / 2, out * scale,
+                                    scale, scale, kernels);
+    }
+
+    free(buffer);
+    free(new_buffer);
+}
+
+BENCHMARK(BM_Shrink8bpp)->ArgPair(3, 0)->ArgPair(3, 1)->ArgPair(2, 0)->ArgPair(2, 1);
+
+static void BM_Sad8x8(benchmark::State& state)
+{
+    const Linux::FlowKernels &kernels = kernels_for(state.range_x());
+    uint8_t image1[64 * 64], image2[64 * 64];
+    uint32_t sum = 0;
+
+    fill_image(image1, 64, 64, 0, 0);
+    fill_image(image2, 64, 64, 1, 2);
+
+    while (state.KeepRunning()) {
+        sum += kernels.sad_8x8(&image1[20 * 64 + 20], &image2[21 * 64 + 19], 64);
+        gbenchmark_escape(&sum);
+    }
+}
+
+BENCHMARK(BM_Sad8x8)->Arg(0)->Arg(1);
+
+/*
+  flow rate: shrink a camera frame and compute flow between it and
+  the previous one, as done for each frame by OpticalFlow_Onboard. Items per second is
+  the frame rate one core can sustain
+ */
+static void BM_FlowRate(benchmark::State& state)
+{
+    const uint32_t width = 320;
+    const uint32_t height = 240;
+    const uint32_t out = 64;
+    const uint32_t scale = 3;
+    Linux::Flow_PX4 flow(out, out, 4, 30, 5000, kernels_for(state.range_x()));
+    uint8_t *frames[2], *shrunk[2];
+
+    for (uint8_t i = 0; i < 2; i++) {
+        frames[i] = (uint8_t *)malloc(width * height);
+        shrunk[i] = (uint8_t *)malloc(out * out);
+        if (!frames[i] || !shrunk[i]) {
+            fprintf(stderr, "error: couldn't malloc buffers\n");
+            return;
+        }
+        fill_image(frames[i], width, height, i * 3, i * 6);
+    }
+
+    for (uint8_t i = 0; i < 2; i++) {
+        Linux::VideoIn::shrink_8bpp(frames[i], shrunk[i], width, height,
+                                    (width - out * scale) / 2, out * scale,
+                                    (height - out * scale) / 2, out * scale,
+                                    scale, scale);
+    }
+
+    while (state.KeepRunning()) {
+        float flow_x, flow_y;
+        /* each new frame is shrunk once */
+        Linux::VideoIn::shrink_8bpp(frames[1], shrunk[1], width, height,
+                                    (width - out * scale) / 2, out * scale,
+                                    (height - out * scale) / 2, out * scale,
+                                    scale, scale, kernels_for(state.range_x()));
+        uint8_t qual = flow.compute_flow(shrunk[0], shrunk[1], 33000,
+                                         &flow_x, &flow_y);
+        gbenchmark_escape(&qual);
+        gbenchmark_escape(&flow_x);
+        gbenchmark_escape(&flow_y);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    for (uint8_t i = 0; i < 2; i++) {
+        free(frames[i]);
+        free(shrunk[i]);
+    }
+}
+
+BENCHMARK(BM_FlowRate)->Arg(0)->Arg(1);
 #endif
 
 BENCHMARK_MAIN()
@@ -0,0 +1,138 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <AP_HAL_Linux/Flow_Kernels.h>
+#include <AP_HAL_Linux/VideoIn.h>
+
+using namespace Linux;
+
+/*
+  the kernels selected for this CPU must match the scalar ones. On a
+  CPU without SSE2 or NEON these are the scalar kernels themselves
+ */
+
+static void fill_random(uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = rand() & 0xff;
+    }
+}
+
+TEST(FlowKernels, sad_8x8)
+{
+    const FlowKernels &simd = FlowKernels::get();
+    const FlowKernels &scalar = FlowKernels::scalar();
+    uint8_t image1[64 * 64], image2[64 * 64];
+
+    srand(1);
+    for (uint8_t n = 0; n < 10; n++) {
+        fill_random(image1, sizeof(image1));
+        fill_random(image2, sizeof(image2));
+        for (uint32_t row_size : { 8U, 13U, 64U }) {
+            for (uint32_t ofs = 0; ofs < 9; ofs++) {
+                EXPECT_EQ(scalar.sad_8x8(&image1[ofs], &image2[ofs + 1], row_size),
+                          simd.sad_8x8(&image1[ofs], &image2[ofs + 1], row_size));
+            }
+        }
+    }
+
+    // the largest possible difference
+    memset(image1, 0, sizeof(image1));
+    memset(image2, 0xff, sizeof(image2));
+    EXPECT_EQ(64U * 255U, simd.sad_8x8(image1, image2, 64));
+}
+
+TEST(FlowKernels, sum_rows)
+{
+    const FlowKernels &simd = FlowKernels::get();
+    const FlowKernels &scalar = FlowKernels::scalar();
+    static uint8_t src[257 * 300];
+    uint16_t sums1[300], sums2[300];
+
+    srand(2);
+    fill_random(src, sizeof(src));
+    for (uint32_t rows : { 1U, 2U, 3U, 7U, 257U }) {
+        for (uint32_t width : { 1U, 7U, 8U, 15U, 16U, 17U, 64U, 255U, 256U }) {
+            scalar.sum_rows(&src[1], 300, rows, width, sums1);
+            simd.sum_rows(&src[1], 300, rows, width, sums2);
+            EXPECT_EQ(0, memcmp(sums1, sums2, width * sizeof(sums1[0])));
+        }
+    }
+
+    // 257 rows of 255 is the most a sum can hold
+    memset(src, 0xff, sizeof(src));
+    simd.sum_rows(src, 300, 257, 256, sums2);
+    for (uint32_t i = 0; i < 256; i++) {
+        EXPECT_EQ(UINT16_MAX, sums2[i]);
+    }
+}
+
+TEST(FlowKernels, yuyv_to_grey)
+{
+    const FlowKernels &simd = FlowKernels::get();
+    const FlowKernels &scalar = FlowKernels::scalar();
+    uint8_t src[2 * 100];
+    uint8_t grey1[100], grey2[100];
+
+    srand(3);
+    fill_random(src, sizeof(src));
+    for (uint32_t count : { 1U, 8U, 15U, 16U, 17U, 33U, 100U }) {
+        memset(grey1, 0, sizeof(grey1));
+        memset(grey2, 0, sizeof(grey2));
+        scalar.yuyv_to_grey(src, count, grey1);
+        simd.yuyv_to_grey(src, count, grey2);
+        EXPECT_EQ(0, memcmp(grey1, grey2, sizeof(grey1)));
+    }
+}
+
+/*
+  shrink must average each fx by fy block of the selection, including
+  the first block of each row, which used to be read from the end of
+  the block row above
+ */
+TEST(VideoIn, shrink_8bpp)
+{
+    const uint32_t width = 320;
+    const uint32_t height = 240;
+    static uint8_t image[width * height];
+    uint8_t out[2][80 * 80];
+
+    srand(4);
+    fill_random(image, sizeof(image));
+    for (uint32_t scale : { 1U, 2U, 3U, 4U }) {
+        const uint32_t size = 64 * scale > height ? height / scale * scale : 64 * scale;
+        const uint32_t left = (width - size) / 2;
+        const uint32_t top = (height - size) / 2;
+        const uint32_t out_size = size / scale;
+
+        VideoIn::shrink_8bpp(image, out[0], width, height, left, size,
+                             top, size, scale, scale, FlowKernels::scalar());
+        VideoIn::shrink_8bpp(image, out[1], width, height, left, size,
+                             top, size, scale, scale, FlowKernels::get());
+        EXPECT_EQ(0, memcmp(out[0], out[1], out_size * out_size));
+
+        for (uint32_t i = 0; i < out_size; i++) {
+            for (uint32_t j = 0; j < out_size; j++) {
+                uint32_t sum = 0;
+                for (uint32_t y = 0; y < scale; y++) {
+                    for (uint32_t x = 0; x < scale; x++) {
+                        sum += image[(top + i * scale + y) * width + left + j * scale + x];
+                    }
+                }
+                EXPECT_EQ(sum / (scale * scale), out[0][i * out_size + j]);
+            }
+        }
+    }
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+AP_GTEST_MAIN()
@@ -37,6 +37,7 @@
 #include <SITL/SIM_Webots.h>
 #include <SITL/SIM_Webots_Python.h>
 #include <SITL/SIM_JSON.h>
+#include <SITL/SIM_SharedMem.h>
 #include <SITL/SIM_Blimp.h>
 #include <SITL/SIM_NoVehicle.h>
 #include <SITL/SIM_StratoBlimp.h>
@@ -177,6 +178,9 @@ static const struct {
     { "webots-python",      WebotsPython::create },
     { "webots",             Webots::create },
     { "JSON",               JSON::create },
+#if AP_SIM_SHAREDMEM_ENABLED
+    { "shm",                SharedMem::create },
+#endif
     { "blimp",              Blimp::create },
     { "novehicle",          NoVehicle::create },
 #if AP_SIM_STRATOBLIMP_ENABLED
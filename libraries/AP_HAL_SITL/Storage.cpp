@@ -53,7 +53,7 @@ void Storage::_storage_open(void)
         return;
     }
 
-    _dirty_mask.clearall();
+    _cache.clear_dirty();
 
 #define HAL_RAMTRON_ALLOW_FALLBACK 0
 
@@ -119,26 +119,6 @@ void Storage::_storage_open(void)
 //    ::printf("No storage backend enabled");
 }
 
-/*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
-*/
-void Storage::_mark_dirty(uint16_t loc, uint16_t length)
-{
-    if (length == 0) {
-        return;
-    }
-    uint16_t end = loc + length - 1;
-    for (uint16_t line=loc>>STORAGE_LINE_SHIFT;
-         line <= end>>STORAGE_LINE_SHIFT;
-         line++) {
-        _dirty_mask.set(line);
-    }
-}
-
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
 {
     if (loc >= sizeof(_buffer)-(n-1)) {
@@ -155,86 +135,79 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
-        memcpy(&_buffer[loc], src, n);
-        _mark_dirty(loc, n);
+        _cache.write(loc, src, n);
     }
 }
 
-void Storage::_timer_tick(void)
+/*
+  write a range of consecutive dirty lines to the storage backend
+ */
+bool Storage::_write_range(uint16_t offset, uint16_t length)
 {
-    if (_initialisedType == StorageBackend::None) {
-        return;
-    }
-    if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
-        return;
-    }
-
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
-    }
-    if (i == STORAGE_NUM_LINES) {
-        // this shouldn't be possible
-        return;
-    }
-
 #if STORAGE_USE_FRAM
-        if (fram.write(STORAGE_LINE_SIZE*i, &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE)) {
-            _dirty_mask.clear(i);
-            return;
-        }
+    if (_initialisedType == StorageBackend::FRAM) {
+        return fram.write(offset, &_buffer[offset], length);
+    }
 #endif
 
 #if STORAGE_USE_POSIX
-    if (hal.get_storage_posix_enabled()) {
-        if (log_fd != -1) {
-            const off_t offset = STORAGE_LINE_SIZE*i;
-            if (lseek(log_fd, offset, SEEK_SET) != offset) {
-                return;
-            }
-            if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
-                return;
-            }
-            _dirty_mask.clear(i);
-            return;
-        }
+    if (_initialisedType == StorageBackend::SDCard) {
+        return log_fd != -1 &&
+            pwrite(log_fd, &_buffer[offset], length, offset) == ssize_t(length);
     }
 #endif
 
 #if STORAGE_USE_FLASH
-    if (hal.get_storage_flash_enabled()) {
-        // save to storage backend
-        _flash_write(i);
-        return;
+    if (_initialisedType == StorageBackend::Flash) {
+        return _flash.write(offset, length);
     }
 #endif
+
+    return false;
 }
 
+void Storage::_timer_tick(void)
+{
+    if (_initialisedType == StorageBackend::None) {
+        return;
+    }
+    if (_cache.empty()) {
+        _last_empty_ms = AP_HAL::millis();
 #if STORAGE_USE_FLASH
+        if (_initialisedType == StorageBackend::Flash) {
+            // use idle time to migrate data out of a full sector
+            WITH_SEMAPHORE(_cache.get_write_semaphore());
+            _flash.compact(STORAGE_MAX_WRITE);
+        }
+#endif
+        return;
+    }
+
+    // write out the first run of dirty lines. We limit the size to
+    // keep the latency of this call down
+    _cache.write_out(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), STORAGE_MAX_WRITE);
+}
 
 /*
-  load all data from flash
+  write out everything pending
  */
-void Storage::_flash_load(void)
+bool Storage::flush(void)
 {
-    if (!_flash.init()) {
-        AP_HAL::panic("unable to init flash storage");
+    if (_initialisedType == StorageBackend::None) {
+        return true;
     }
+    return _cache.flush(FUNCTOR_BIND_MEMBER(&Storage::_write_range, bool, uint16_t, uint16_t), STORAGE_MAX_WRITE);
 }
 
+#if STORAGE_USE_FLASH
+
 /*
-  write one storage line. This also updates _dirty_mask. 
-*/
-void Storage::_flash_write(uint16_t line)
+  load all data from flash
+ */
+void Storage::_flash_load(void)
 {
-    if (_flash.write(line*STORAGE_LINE_SIZE, STORAGE_LINE_SIZE)) {
-        // mark the line clean
-        _dirty_mask.clear(line);
+    if (!_flash.init()) {
+        AP_HAL::panic("unable to init flash storage");
     }
 }
 
@@ -400,3 +373,15 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     size = sizeof(_buffer);
     return true;
 }
+
+/*
+  report flash wear statistics
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+#if STORAGE_USE_FLASH
+    if (_initialisedType == StorageBackend::Flash) {
+        _flash.wear_info(str);
+    }
+#endif
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
-#include <AP_Common/Bitmask.h>
+#include <AP_HAL/utility/StorageWriteBack.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include <AP_FlashStorage/AP_FlashStorage.h>
 #include <AP_RAMTRON/AP_RAMTRON.h>
@@ -23,14 +23,19 @@
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (HAL_STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// largest write of consecutive dirty lines made in one go
+#define STORAGE_MAX_WRITE 512
+
 class HALSITL::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
     void read_block(void *dst, uint16_t src, size_t n) override;
     void write_block(uint16_t dst, const void* src, size_t n) override;
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    void storage_info(ExpandingString &str) override;
 
     void _timer_tick(void) override;
+    bool flush(void) override;
     bool healthy(void) override;
 
 private:
@@ -45,9 +50,9 @@ private:
     void _storage_create(void);
     void _storage_open(void);
     void _save_backup(void);
-    void _mark_dirty(uint16_t loc, uint16_t length);
+    bool _write_range(uint16_t offset, uint16_t length);
     uint8_t _buffer[HAL_STORAGE_SIZE] __attribute__((aligned(4)));
-    Bitmask<STORAGE_NUM_LINES> _dirty_mask;
+    StorageWriteBack<HAL_STORAGE_SIZE, STORAGE_LINE_SHIFT> _cache{_buffer};
 
     uint32_t _last_empty_ms;
 
@@ -68,7 +73,6 @@ private:
             FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool)};
 
     void _flash_load(void);
-    void _flash_write(uint16_t line);
 #endif
 
 #if STORAGE_USE_POSIX
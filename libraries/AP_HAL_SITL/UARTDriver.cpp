@@ -42,6 +42,7 @@
 #include "SITL_State.h"
 #if HAL_GCS_ENABLED
 #include <AP_HAL/utility/packetise.h>
+#include <AP_HAL/utility/Socket_native.h>
 #endif
 
 #include <AP_Vehicle/AP_Vehicle_Type.h>
@@ -54,6 +55,26 @@ using namespace HALSITL;
 
 bool UARTDriver::_console;
 
+// most datagrams moved by one system call on a UDP port
+static constexpr uint8_t UDP_BATCH_COUNT = 8;
+// largest UDP datagram we send, big enough for any MAVLink packet
+static constexpr uint16_t UDP_BATCH_MTU = 300;
+// most bytes read from a device in one tick, and the largest UDP
+// datagram we receive
+static constexpr uint16_t UART_MAX_READ = 10000;
+
+/*
+  datagrams from one batched UDP read. Each has a slot big enough for
+  the largest datagram, and is kept until it has all been moved to the
+  readbuffer
+ */
+struct HALSITL::UARTDriver::UDPBatch {
+    uint8_t buf[UDP_BATCH_COUNT][UART_MAX_READ];
+    SocketAPM_native::packet pkts[UDP_BATCH_COUNT];
+    uint8_t count;
+    uint8_t next;
+};
+
 /* UARTDriver method implementations */
 
 void UARTDriver::_begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
@@ -265,6 +286,12 @@ void UARTDriver::_flush(void)
 
 size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
 {
+    WITH_SEMAPHORE(_write_mutex);
+    if (_tx_reserved) {
+        // this thread holds a reservation which must be committed first
+        return 0;
+    }
+
     const auto _txspace = txspace();
     if (_txspace < size) {
         size = _txspace;
@@ -297,6 +324,45 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve space in the write buffer for the caller to write into
+  directly. The write mutex is held until _tx_commit(), and
+  _tx_reserved is only changed while holding it. Byte loss is not
+  simulated for data written in place
+ */
+uint8_t UARTDriver::_tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_write_mutex.take_nonblocking()) {
+        return 0;
+    }
+    if (_tx_reserved || txspace() < len) {
+        // the mutex is recursive, so this thread may already hold a reservation
+        _write_mutex.give();
+        return 0;
+    }
+    const uint8_t n_vec = _writebuffer.reserve(vec, len);
+    if (n_vec == 0) {
+        _write_mutex.give();
+        return 0;
+    }
+    _tx_reserved = true;
+    return n_vec;
+}
+
+bool UARTDriver::_tx_commit(uint32_t len)
+{
+    if (!_tx_reserved) {
+        return false;
+    }
+    _tx_reserved = false;
+    const bool ret = _writebuffer.commit(len);
+    _write_mutex.give();
+    if (ret && _unbuffered_writes) {
+        handle_writing_from_writebuffer_to_device();
+    }
+    return ret;
+}
+
     
 /*
   start a TCP connection for the serial port. If wait_for_connection
@@ -836,22 +902,44 @@ void UARTDriver::handle_writing_from_writebuffer_to_device()
     }
 #endif
     if (_packetise) {
-        uint16_t n = _writebuffer.available();
+        uint32_t n = _writebuffer.available();
         n = MIN(n, max_bytes);
-#if HAL_GCS_ENABLED
-        if (n > 0) {
-            n = mavlink_packetise(_writebuffer, n);
+        n = MIN(n, uint32_t(UDP_BATCH_COUNT * UDP_BATCH_MTU));
+        if (n == 0) {
+            return;
         }
+        uint8_t tmpbuf[n];
+        n = _writebuffer.peekbytes(tmpbuf, n);
+
+        // keep each MAVLink packet as a single UDP packet, sending
+        // as many packets as we have with one call
+        SocketAPM_native::packet pkts[UDP_BATCH_COUNT];
+        uint8_t count = 0;
+        uint32_t ofs = 0;
+        while (count < UDP_BATCH_COUNT && ofs < n) {
+            uint16_t len = n - ofs;
+#if HAL_GCS_ENABLED
+            len = mavlink_packetise(&tmpbuf[ofs], len);
 #endif
-        if (n > 0) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuffer.peekbytes(tmpbuf, n);
-            ssize_t ret = send(_fd, tmpbuf, n, MSG_DONTWAIT);
-            if (ret > 0) {
-                _writebuffer.advance(ret);
-                _tx_stats_bytes += ret;
+            if (len == 0) {
+                break;
             }
+            pkts[count].buf = &tmpbuf[ofs];
+            pkts[count].len = len;
+            ofs += len;
+            count++;
+        }
+        if (count == 0) {
+            return;
+        }
+        const int ret = SocketAPM_native::send_batch_fd(_fd, pkts, count);
+        uint32_t sent = 0;
+        for (int i=0; i<ret; i++) {
+            sent += pkts[i].len;
+        }
+        if (sent > 0) {
+            _writebuffer.advance(sent);
+            _tx_stats_bytes += sent;
         }
     } else {
         uint32_t navail;
@@ -890,7 +978,7 @@ void UARTDriver::handle_reading_from_device_to_readbuffer()
         return;
     }
 
-    uint32_t max_bytes = 10000;
+    uint32_t max_bytes = UART_MAX_READ;
 #if !defined(HAL_BUILD_AP_PERIPH)
     SITL::SIM *_sitl = AP::sitl();
     if (_sitl && _sitl->telem_baudlimit_enable) {
@@ -945,6 +1033,8 @@ void UARTDriver::handle_reading_from_device_to_readbuffer()
             _fd = -1;
             _connected = false;
         }
+    } else if (_is_udp && read_udp_batch(space)) {
+        // read several datagrams with one call
     } else if (_select_check(_fd)) {
         nread = recv(_fd, buf, space, MSG_DONTWAIT);
         if (nread <= 0 && !_is_udp) {
@@ -971,6 +1061,49 @@ void UARTDriver::handle_reading_from_device_to_readbuffer()
     }
 }
 
+/*
+  move up to space bytes of UDP datagrams to the readbuffer, reading
+  several datagrams with one call once all those from the last call
+  have been moved. Returns false if batching is not available
+ */
+bool UARTDriver::read_udp_batch(uint32_t space)
+{
+    if (_udp_batch == nullptr) {
+        _udp_batch = NEW_NOTHROW UDPBatch;
+        if (_udp_batch == nullptr) {
+            return false;
+        }
+    }
+    UDPBatch &batch = *_udp_batch;
+    if (batch.next == batch.count) {
+        for (uint8_t i=0; i<UDP_BATCH_COUNT; i++) {
+            batch.pkts[i].buf = batch.buf[i];
+            batch.pkts[i].len = UART_MAX_READ;
+        }
+        const int ret = SocketAPM_native::recv_batch_fd(_fd, batch.pkts, UDP_BATCH_COUNT);
+        batch.count = MAX(ret, 0);
+        batch.next = 0;
+    }
+    bool received = false;
+    while (batch.next < batch.count && space > 0) {
+        // a datagram is split over calls if there is not room for it
+        auto &pkt = batch.pkts[batch.next];
+        const uint32_t n = MIN(uint32_t(pkt.len), space);
+        _readbuffer.write(pkt.buf, n);
+        pkt.buf += n;
+        pkt.len -= n;
+        space -= n;
+        received = true;
+        if (pkt.len == 0) {
+            batch.next++;
+        }
+    }
+    if (received) {
+        _receive_timestamp = AP_HAL::micros64();
+    }
+    return true;
+}
+
 void UARTDriver::_timer_tick(void)
 {
     handle_writing_from_writebuffer_to_device();
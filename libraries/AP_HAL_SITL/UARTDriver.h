@@ -88,6 +88,11 @@ private:
     static bool _console;
     ByteBuffer _readbuffer{16384};
     ByteBuffer _writebuffer{16384};
+    // held while writing to _writebuffer, and from a successful
+    // _tx_reserve() until _tx_commit()
+    HAL_Semaphore _write_mutex;
+    // true between a successful _tx_reserve() and _tx_commit(), protected by _write_mutex
+    bool _tx_reserved = false;
 
     // default multicast IP and port
     const char *mcast_ip_default = "239.255.145.50";
@@ -142,6 +147,8 @@ private:
 protected:
     void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
     size_t _write(const uint8_t *buffer, size_t size) override;
+    uint8_t _tx_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    bool _tx_commit(uint32_t len) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override;
     uint32_t _available() override;
     void _end() override;
@@ -158,6 +165,11 @@ private:
     void handle_writing_from_writebuffer_to_device();
     void handle_reading_from_device_to_readbuffer();
 
+    // UDP datagrams waiting to be moved to the readbuffer
+    struct UDPBatch;
+    UDPBatch *_udp_batch = nullptr;
+    bool read_udp_batch(uint32_t space);
+
     // statistics
     uint32_t _tx_stats_bytes;
     uint32_t _rx_stats_bytes;
@@ -693,7 +693,6 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] = {
 AP_InertialSensor *AP_InertialSensor::_singleton = nullptr;
 
 AP_InertialSensor::AP_InertialSensor() :
-    _board_orientation(ROTATION_NONE),
     _log_raw_bit(-1)
 {
     if (_singleton) {
@@ -1688,8 +1687,8 @@ AP_InertialSensor::_init_gyro()
       we do the gyro calibration with no board rotation. This avoids
       having to rotate readings during the calibration
     */
-    enum Rotation saved_orientation = _board_orientation;
-    _board_orientation = ROTATION_NONE;
+    enum Rotation saved_orientation = board_orientation().get_rotation();
+    publish_board_orientation(ROTATION_NONE);
 
     // remove existing gyro offsets
     for (uint8_t k=0; k<num_gyros; k++) {
@@ -1806,7 +1805,7 @@ AP_InertialSensor::_init_gyro()
     }
 
     // restore orientation
-    _board_orientation = saved_orientation;
+    publish_board_orientation(saved_orientation);
 
     // record calibration complete
     _calibrating_gyro = false;
@@ -2446,6 +2445,20 @@ bool AP_InertialSensor::get_new_trim(Vector3f &trim_rad)
     return false;
 }
 
+/*
+  build the transform for a new board orientation in the transform not
+  in use and then switch to it, so that backends never rotate by a part
+  built transform. The old transform is only rebuilt on the next change,
+  so this must only be called from the main thread
+ */
+void AP_InertialSensor::publish_board_orientation(enum Rotation orientation)
+{
+    const RotationTransformf *current = _board_orientation.load(std::memory_order_relaxed);
+    RotationTransformf *next = &_board_orientation_transform[current == &_board_orientation_transform[0] ? 1 : 0];
+    next->set(orientation);
+    _board_orientation.store(next, std::memory_order_release);
+}
+
 /*
     Returns body fixed accelerometer level data averaged during accel calibration's first step
 */
@@ -2455,7 +2468,7 @@ bool AP_InertialSensor::get_fixed_mount_accel_cal_sample(uint8_t sample_num, Vec
         return false;
     }
     _accel_calibrator[_acc_body_aligned-1].get_sample_corrected(sample_num, ret);
-    ret.rotate(_board_orientation);
+    board_orientation().rotate(ret);
     return true;
 }
 
@@ -2480,7 +2493,7 @@ bool AP_InertialSensor::get_primary_accel_cal_sample_avg(uint8_t sample_num, Vec
     }
     avg /= count;
     ret = avg;
-    ret.rotate(_board_orientation);
+    board_orientation().rotate(ret);
     return true;
 }
 
@@ -2533,8 +2546,8 @@ MAV_RESULT AP_InertialSensor::simple_accel_cal()
       we do the accel calibration with no board rotation. This avoids
       having to rotate readings during the calibration
     */
-    enum Rotation saved_orientation = _board_orientation;
-    _board_orientation = ROTATION_NONE;
+    enum Rotation saved_orientation = board_orientation().get_rotation();
+    publish_board_orientation(ROTATION_NONE);
 
     // get the rotated gravity vector which will need to be applied to the offsets
     rotated_gravity.rotate_inverse(saved_orientation);
@@ -2619,7 +2632,7 @@ MAV_RESULT AP_InertialSensor::simple_accel_cal()
     }
 
     // restore orientation
-    _board_orientation = saved_orientation;
+    publish_board_orientation(saved_orientation);
 
     if (result == MAV_RESULT_ACCEPTED) {
         DEV_PRINTF("\nPASSED\n");
@@ -12,6 +12,7 @@
 #include <AP_HAL/AP_HAL_Boards.h>
 
 #include <stdint.h>
+#include <atomic>
 
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/utility/RingBuffer.h>
@@ -211,7 +212,9 @@ public:
 
     // set overall board orientation
     void set_board_orientation(enum Rotation orientation) {
-        _board_orientation = orientation;
+        if (orientation != board_orientation().get_rotation()) {
+            publish_board_orientation(orientation);
+        }
     }
 
     // return the selected loop rate at which samples are made avilable
@@ -645,12 +648,27 @@ private:
     // control enable of detected sensors
     AP_Int8     _enable_mask;
     
-    // board orientation from AHRS
-    enum Rotation _board_orientation;
+    // board orientation from AHRS. Backends rotate samples in their
+    // own threads by the transform _board_orientation points to, so a
+    // new orientation is built in the other transform and then
+    // published by switching the pointer. Two transforms are enough
+    // as long as a backend finishes a rotation before the transform it
+    // is using is rebuilt, which takes two orientation changes. Changes
+    // only come from the main thread, from AHRS_ORIENTATION once per
+    // loop at most and around the gyro and accel calibrations, so they
+    // are milliseconds apart against a rotation of well under a
+    // microsecond
+    RotationTransformf _board_orientation_transform[2];
+    std::atomic<const RotationTransformf*> _board_orientation{&_board_orientation_transform[0]};
+    const RotationTransformf &board_orientation() const {
+        return *_board_orientation.load(std::memory_order_acquire);
+    }
+    void publish_board_orientation(enum Rotation orientation);
 
-    // per-sensor orientation to allow for board type defaults at runtime
-    enum Rotation _gyro_orientation[INS_MAX_INSTANCES];
-    enum Rotation _accel_orientation[INS_MAX_INSTANCES];
+    // per-sensor orientation to allow for board type defaults at
+    // runtime, bound when the backend registers the sensor
+    RotationTransformf _gyro_orientation[INS_MAX_INSTANCES];
+    RotationTransformf _accel_orientation[INS_MAX_INSTANCES];
 
     // calibrated_ok/id_ok flags
     bool _gyro_cal_ok[INS_MAX_INSTANCES];
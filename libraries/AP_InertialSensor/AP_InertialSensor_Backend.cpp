@@ -100,7 +100,7 @@ void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vect
      */
 
     // rotate for sensor orientation
-    accel.rotate(_imu._accel_orientation[instance]);
+    _imu._accel_orientation[instance].rotate(accel);
 
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
     if (_imu.tcal_learning) {
@@ -131,13 +131,13 @@ void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vect
     }
 
     // rotate to body frame
-    accel.rotate(_imu._board_orientation);
+    _imu.board_orientation().rotate(accel);
 }
 
 void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) 
 {
     // rotate for sensor orientation
-    gyro.rotate(_imu._gyro_orientation[instance]);
+    _imu._gyro_orientation[instance].rotate(gyro);
 
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
     if (_imu.tcal_learning) {
@@ -156,7 +156,7 @@ void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vecto
         gyro -= _imu._gyro_offset(instance);
     }
 
-    gyro.rotate(_imu._board_orientation);
+    _imu.board_orientation().rotate(gyro);
 }
 
 /*
@@ -506,7 +506,7 @@ void AP_InertialSensor_Backend::_publish_accel(uint8_t instance, const Vector3f
 
         // remove rotation. Note that we don't need to remove offsets or scale factor as those
         // are not applied when calibrating
-        cal_sample.rotate_inverse(_imu._board_orientation);
+        _imu.board_orientation().rotate_inverse(cal_sample);
 
         _imu._accel_calibrator[instance].new_sample(cal_sample, _imu._delta_velocity_dt[instance]);
     }
@@ -682,7 +682,7 @@ void AP_InertialSensor_Backend::_notify_new_accel_sensor_rate_sample(uint8_t ins
 
     // get batch sampling in correct orientation
     Vector3f accel = _accel;
-    accel.rotate(_imu._accel_orientation[instance]);
+    _imu._accel_orientation[instance].rotate(accel);
 
     _imu.batchsampler.sample(instance, AP_InertialSensor::IMU_SENSOR_TYPE_ACCEL, AP_HAL::micros64(), accel);
 #endif
@@ -697,7 +697,7 @@ void AP_InertialSensor_Backend::_notify_new_gyro_sensor_rate_sample(uint8_t inst
 
     // get batch sampling in correct orientation
     Vector3f gyro = _gyro;
-    gyro.rotate(_imu._gyro_orientation[instance]);
+    _imu._gyro_orientation[instance].rotate(gyro);
 
     _imu.batchsampler.sample(instance, AP_InertialSensor::IMU_SENSOR_TYPE_GYRO, AP_HAL::micros64(), gyro);
 #endif
@@ -274,11 +274,11 @@ protected:
     uint16_t _last_gyro_filter_hz;
 
     void set_gyro_orientation(uint8_t instance, enum Rotation rotation) {
-        _imu._gyro_orientation[instance] = rotation;
+        _imu._gyro_orientation[instance].set(rotation);
     }
 
     void set_accel_orientation(uint8_t instance, enum Rotation rotation) {
-        _imu._accel_orientation[instance] = rotation;
+        _imu._accel_orientation[instance].set(rotation);
     }
 
     // increment clipping counted. Used by drivers that do decimation before supplying
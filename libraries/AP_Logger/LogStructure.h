@@ -636,6 +636,9 @@ struct PACKED log_Scripting {
     uint32_t run_time;
     int32_t total_mem;
     int32_t run_mem;
+    uint32_t instructions;
+    uint32_t alloc_bytes;
+    uint16_t late_ms;
 };
 
 struct PACKED log_MotBatt {
@@ -1159,6 +1162,9 @@ struct PACKED log_VER {
 // @Field: Runtime: run time
 // @Field: Total_mem: total memory usage of all scripts
 // @Field: Run_mem: run memory usage
+// @Field: Insns: virtual machine instructions run
+// @Field: Alloc: bytes allocated
+// @Field: Late: time the run started after it was requested
 
 // @LoggerMessage: VER
 // @Description: Ardupilot version
@@ -1303,7 +1309,7 @@ LOG_STRUCTURE_FROM_VISUALODOM \
       "FILE",   "NIBZ",       "FileName,Offset,Length,Data", "----", "----" }, \
 LOG_STRUCTURE_FROM_AIS \
     { LOG_SCRIPTING_MSG, sizeof(log_Scripting), \
-      "SCR",   "QNIii", "TimeUS,Name,Runtime,Total_mem,Run_mem", "s#sbb", "F-F--", true }, \
+      "SCR",   "QNIiiIIH", "TimeUS,Name,Runtime,Total_mem,Run_mem,Insns,Alloc,Late", "s#sbb-bs", "F-F----C", true }, \
     { LOG_VER_MSG, sizeof(log_VER), \
       "VER",   "QBHBBBBIZHBB", "TimeUS,BT,BST,Maj,Min,Pat,FWT,GH,FWS,APJ,BU,FV", "s-----------", "F-----------", false }, \
     { LOG_MOTBATT_MSG, sizeof(log_MotBatt), \
@@ -37,10 +37,18 @@ uint32_t MSP::msp_serial_send_frame(msp_port_t *msp, const uint8_t * hdr, uint32
         return 0;
     }
 
-    // Transmit frame
-    msp->uart->write(hdr, hdr_len);
-    msp->uart->write(data, data_len);
-    msp->uart->write(crc, crc_len);
+    // Transmit frame, each fragment is copied once straight into the uart's transmit buffer
+    const AP_HAL::UARTDriver::IoVec iov[] {
+        { hdr, hdr_len },
+        { data, data_len },
+        { crc, crc_len },
+    };
+    if (msp->uart->writev(iov, ARRAY_SIZE(iov)) == 0) {
+        // jumbo frame or the port is busy, write as much as the port will take
+        msp->uart->write(hdr, hdr_len);
+        msp->uart->write(data, data_len);
+        msp->uart->write(crc, crc_len);
+    }
 
     return total_frame_length;
 }
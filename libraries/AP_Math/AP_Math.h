@@ -14,6 +14,7 @@
 #include "polygon.h"
 #include "quaternion.h"
 #include "rotations.h"
+#include "rotation_transform.h"
 #include "vector2.h"
 #include "vector3.h"
 #include "spline5.h"
@@ -94,6 +94,15 @@ public:
     // time has reached the end of the sequence
     bool finished() const WARN_IF_UNUSED;
 
+    // return the position, velocity and acceleration vectors relative to the origin at a specified time along the path
+    void move_from_time_pos_vel_accel(float t, Vector3f &pos, Vector3f &vel, Vector3f &accel);
+
+    // time at the end of the sequence
+    float time_end() const WARN_IF_UNUSED;
+
+    // time left before sequence will complete
+    float get_time_remaining() const WARN_IF_UNUSED;
+
 private:
 
     // increment time and return the position, velocity and acceleration vectors relative to the origin
@@ -102,9 +111,6 @@ private:
     // increment time and return the position, velocity and acceleration vectors relative to the destination
     void move_to_pos_vel_accel(float dt, Vector3f &pos, Vector3f &vel, Vector3f &accel);
 
-    // return the position, velocity and acceleration vectors relative to the origin at a specified time along the path
-    void move_from_time_pos_vel_accel(float t, Vector3f &pos, Vector3f &vel, Vector3f &accel);
-
     // get desired maximum speed along track
     float get_speed_along_track() const WARN_IF_UNUSED { return vel_max; }
 
@@ -117,12 +123,6 @@ private:
     // return the current time elapsed
     float get_time_elapsed() const WARN_IF_UNUSED { return time; }
 
-    // time at the end of the sequence
-    float time_end() const WARN_IF_UNUSED;
-
-    // time left before sequence will complete
-    float get_time_remaining() const WARN_IF_UNUSED;
-
     // time when acceleration section of the sequence will complete
     float get_accel_finished_time() const WARN_IF_UNUSED;
 
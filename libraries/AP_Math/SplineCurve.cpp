@@ -27,6 +27,7 @@ extern const AP_HAL::HAL &hal;
 #define SPLINE_FACTOR           4.0f    // defines shape of curves.  larger numbers result in longer spline curves, lower numbers take a direct path
 #define TANGENTIAL_ACCEL_SCALER 0.5f    // the proportion of the maximum accel that can be used for tangential acceleration (aka in the direction of travel along the track)
 #define LATERAL_ACCEL_SCALER    0.5f    // the proportion of the maximum accel that can be used for lateral acceleration (aka crosstrack acceleration)
+#define TIME_REMAINING_SAMPLES  16      // number of points the remaining track is evaluated at when estimating the time remaining
 
 // limit the maximum speed along the track to that which will achieve a cornering (aka lateral) acceleration of LATERAL_SPEED_SCALER * acceleration limit
 
@@ -175,14 +176,8 @@ void SplineCurve::calc_dt_speed_max(float time, float distance_delta, float &spl
         spline_dt = distance_delta / spline_vel_length;
     }
 
-    // calculate acceleration normal to the direction of travel
-    const float spline_accel_tangent_length = spline_accel.dot(spline_vel_unit);
-    Vector3f spline_accel_norm = spline_accel - (spline_vel_unit * spline_accel_tangent_length);
-    const float spline_accel_norm_length = spline_accel_norm.length();
-
     // limit the maximum speed along the track to that which will achieve a cornering (aka lateral) acceleration of LATERAL_SPEED_SCALER * acceleration limit
     const float tangential_speed_max = kinematic_limit(spline_vel_unit, _speed_xy, _speed_up, _speed_down);
-    const float accel_norm_max = LATERAL_ACCEL_SCALER * kinematic_limit(spline_accel_norm, _accel_xy, _accel_z, _accel_z);
 
     // sanity check to avoid divide by zero
     if (is_zero(tangential_speed_max)) {
@@ -194,12 +189,7 @@ void SplineCurve::calc_dt_speed_max(float time, float distance_delta, float &spl
         return;
     }
 
-    if ((is_positive(accel_norm_max)) && is_positive(spline_accel_norm_length) && is_positive(spline_vel_length) &&
-         ((spline_accel_norm_length/accel_norm_max) > sq(spline_vel_length/tangential_speed_max))) {
-        speed_max = spline_vel_length / safe_sqrt(spline_accel_norm_length/accel_norm_max);
-    } else {
-        speed_max = tangential_speed_max;
-    }
+    speed_max = calc_corner_speed_max(spline_vel_unit, spline_vel_length, spline_accel, tangential_speed_max);
 
     // calculate accel max and sanity check
     accel_max = TANGENTIAL_ACCEL_SCALER * kinematic_limit(spline_vel_unit, _accel_xy, _accel_z, _accel_z);
@@ -215,6 +205,23 @@ void SplineCurve::calc_dt_speed_max(float time, float distance_delta, float &spl
     speed_max = MIN(speed_max, safe_sqrt(2.0f * accel_max * (dist + sq(_destination_speed_max) / (2.0f*accel_max))));
 }
 
+// calculate the maximum speed along the track that keeps the cornering (aka lateral) acceleration within LATERAL_ACCEL_SCALER * acceleration limit
+// spline_vel_unit, spline_vel_length and spline_accel are the unscaled spline derivatives at the point being checked
+float SplineCurve::calc_corner_speed_max(const Vector3f &spline_vel_unit, float spline_vel_length, const Vector3f &spline_accel, float tangential_speed_max) const
+{
+    // calculate acceleration normal to the direction of travel
+    const float spline_accel_tangent_length = spline_accel.dot(spline_vel_unit);
+    const Vector3f spline_accel_norm = spline_accel - (spline_vel_unit * spline_accel_tangent_length);
+    const float spline_accel_norm_length = spline_accel_norm.length();
+    const float accel_norm_max = LATERAL_ACCEL_SCALER * kinematic_limit(spline_accel_norm, _accel_xy, _accel_z, _accel_z);
+
+    if ((is_positive(accel_norm_max)) && is_positive(spline_accel_norm_length) && is_positive(spline_vel_length) &&
+         ((spline_accel_norm_length/accel_norm_max) > sq(spline_vel_length/tangential_speed_max))) {
+        return spline_vel_length / safe_sqrt(spline_accel_norm_length/accel_norm_max);
+    }
+    return tangential_speed_max;
+}
+
 // recalculate hermite_solution grid
 //     relies on _origin_vel, _destination_vel and _origin and _destination
 void SplineCurve::update_solution(const Vector3f &origin, const Vector3f &dest, const Vector3f &origin_vel, const Vector3f &dest_vel)
@@ -250,3 +257,79 @@ void SplineCurve::calc_target_pos_vel(float time, Vector3f &position, Vector3f &
     jerk = _hermite_solution[3] * 6.0f;
 }
 
+// calculate target positions, velocities and accelerations at each of num_samples spline times
+// the derivative coefficients are calculated once for the whole batch
+void SplineCurve::get_pos_vel_accel_at_times(const float *spline_times, uint16_t num_samples, Vector3f *position, Vector3f *velocity, Vector3f *acceleration) const
+{
+    const Vector3f vel_coef2 = _hermite_solution[2] * 2.0f;
+    const Vector3f vel_coef3 = _hermite_solution[3] * 3.0f;
+    const Vector3f accel_coef3 = _hermite_solution[3] * 6.0f;
+
+    for (uint16_t i = 0; i < num_samples; i++) {
+        const float time = spline_times[i];
+        const float time_sq = sq(time);
+        const float time_cubed = time_sq * time;
+
+        position[i] = _hermite_solution[0] + \
+                      _hermite_solution[1] * time + \
+                      _hermite_solution[2] * time_sq + \
+                      _hermite_solution[3] * time_cubed;
+
+        velocity[i] = _hermite_solution[1] + \
+                      vel_coef2 * time + \
+                      vel_coef3 * time_sq;
+
+        acceleration[i] = vel_coef2 + \
+                          accel_coef3 * time;
+    }
+}
+
+// estimate the time in seconds to travel from the current position to the destination
+// speed is the current target speed along the track in cm/s
+// the remaining track is evaluated at TIME_REMAINING_SAMPLES points and the speed along each interval is limited by the
+// same cornering, stopping and tangential acceleration limits used by advance_target_along_track
+float SplineCurve::get_time_remaining(float speed) const
+{
+    if (_reached_destination) {
+        return 0.0f;
+    }
+
+    float times[TIME_REMAINING_SAMPLES];
+    for (uint8_t i = 0; i < TIME_REMAINING_SAMPLES; i++) {
+        times[i] = _time + (1.0f - _time) * i / (TIME_REMAINING_SAMPLES - 1);
+    }
+    Vector3f pos[TIME_REMAINING_SAMPLES], vel[TIME_REMAINING_SAMPLES], accel[TIME_REMAINING_SAMPLES];
+    get_pos_vel_accel_at_times(times, TIME_REMAINING_SAMPLES, pos, vel, accel);
+
+    float time_remaining = 0.0f;
+    float speed_prev = fabsf(speed);
+    for (uint8_t i = 1; i < TIME_REMAINING_SAMPLES; i++) {
+        // direction of travel is defined by acceleration where the spline velocity is zero
+        const float spline_vel_length = vel[i].length();
+        Vector3f spline_vel_unit;
+        if (is_positive(spline_vel_length)) {
+            spline_vel_unit = vel[i] / spline_vel_length;
+        } else if (!accel[i].is_zero()) {
+            spline_vel_unit = accel[i].normalized();
+        }
+
+        const float tangential_speed_max = kinematic_limit(spline_vel_unit, _speed_xy, _speed_up, _speed_down);
+        const float accel_max = TANGENTIAL_ACCEL_SCALER * kinematic_limit(spline_vel_unit, _accel_xy, _accel_z, _accel_z);
+        const float distance_delta = (pos[i] - pos[i-1]).length();
+        float speed_max = 0.0f;
+        if (is_positive(tangential_speed_max)) {
+            speed_max = calc_corner_speed_max(spline_vel_unit, spline_vel_length, accel[i], tangential_speed_max);
+            const float dist = (_destination - pos[i]).length();
+            speed_max = MIN(speed_max, safe_sqrt(2.0f * accel_max * dist + sq(_destination_speed_max)));
+        }
+        // speed reachable by the end of the interval
+        speed_max = MIN(speed_max, safe_sqrt(sq(speed_prev) + 2.0f * accel_max * distance_delta));
+
+        const float speed_avg = 0.5f * (speed_max + speed_prev);
+        if (is_positive(speed_avg)) {
+            time_remaining += distance_delta / speed_avg;
+        }
+        speed_prev = speed_max;
+    }
+    return time_remaining;
+}
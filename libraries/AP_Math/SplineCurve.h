@@ -33,12 +33,25 @@ public:
     float get_destination_speed_max() const WARN_IF_UNUSED { return _destination_speed_max; }
     void set_destination_speed_max(float destination_speed_max) { _destination_speed_max = MIN(_destination_speed_max, destination_speed_max); }
 
+    // calculate target positions, velocities and accelerations at each of num_samples spline times
+    // spline times are values from 0 (origin) to 1 (destination)
+    // positions are offsets from EKF origin in NEU frame, velocities and accelerations are unscaled derivatives with respect to spline time
+    // relies on set_origin_and_destination having been called
+    void get_pos_vel_accel_at_times(const float *spline_times, uint16_t num_samples, Vector3f *position, Vector3f *velocity, Vector3f *acceleration) const;
+
+    // estimate the time in seconds to travel from the current position to the destination
+    // speed is the current target speed along the track in cm/s
+    float get_time_remaining(float speed) const WARN_IF_UNUSED;
+
 private:
 
     // calculate the spline delta time for a given delta distance
     // returns the spline position and velocity and maximum speed and acceleration the vehicle can travel without exceeding acceleration limits
     void calc_dt_speed_max(float time, float distance_delta, float &spline_dt, Vector3f &target_pos, Vector3f &spline_vel_unit, float &speed_max, float &accel_max);
 
+    // calculate the maximum speed along the track that keeps the cornering acceleration within limits
+    float calc_corner_speed_max(const Vector3f &spline_vel_unit, float spline_vel_length, const Vector3f &spline_accel, float tangential_speed_max) const;
+
     // recalculate hermite_spline_solution grid
     void update_solution(const Vector3f &origin, const Vector3f &dest, const Vector3f &origin_vel, const Vector3f &dest_vel);
 
@@ -0,0 +1,44 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  lean angle conversion as done by AC_PosControl before and after
+  replacing cos(pitch) with the 1/sqrt(1+tan^2) identity
+ */
+static void BM_AccelToLeanAnglesCos(benchmark::State& state)
+{
+    float accel_forward = -500.0f;
+    const float accel_right = 300.0f;
+
+    while (state.KeepRunning()) {
+        const float pitch = accel_to_angle(-accel_forward * 0.01) * 100;
+        const float cos_pitch = cosf(pitch * M_PI / 18000.0f);
+        float roll = accel_to_angle((accel_right * cos_pitch) * 0.01) * 100;
+        gbenchmark_escape(&roll);
+        accel_forward += 0.01f;
+    }
+}
+
+static void BM_AccelToLeanAnglesSqrt(benchmark::State& state)
+{
+    float accel_forward = -500.0f;
+    const float accel_right = 300.0f;
+
+    while (state.KeepRunning()) {
+        const float pitch_tan = -accel_forward * 0.01f / GRAVITY_MSS;
+        float pitch = degrees(atanf(pitch_tan)) * 100;
+        const float cos_pitch = 1.0f / sqrtf(1.0f + sq(pitch_tan));
+        float roll = accel_to_angle((accel_right * cos_pitch) * 0.01) * 100;
+        gbenchmark_escape(&pitch);
+        gbenchmark_escape(&roll);
+        accel_forward += 0.01f;
+    }
+}
+
+BENCHMARK(BM_AccelToLeanAnglesCos);
+BENCHMARK(BM_AccelToLeanAnglesSqrt);
+
+BENCHMARK_MAIN();
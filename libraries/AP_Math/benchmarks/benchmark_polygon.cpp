@@ -0,0 +1,111 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a closed star shaped fence of n points, in cm from the origin, with
+  vertices at pseudo-random distances so edges are irregular
+ */
+static Vector2f *make_fence(uint16_t n)
+{
+    Vector2f *V = new Vector2f[n];
+    uint32_t seed = 1;
+    for (uint16_t i=0; i<n-1; i++) {
+        seed = seed * 1103515245U + 12345U;
+        const float radius = 50000.0f * (0.5f + 0.5f * ((seed >> 16) & 0x7fff) / 32767.0f);
+        const float angle = i * M_2PI / (n-1);
+        V[i] = Vector2f(radius * cosf(angle), radius * sinf(angle));
+    }
+    V[n-1] = V[0];
+    return V;
+}
+
+// query points on a grid covering the fence and some space around it
+static Vector2f query_point(uint32_t i)
+{
+    return Vector2f(((i * 7919U) % 1201) * 100.0f - 60000.0f,
+                    ((i * 104729U) % 1201) * 100.0f - 60000.0f);
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    const uint16_t n = state.range(0);
+    Vector2f *V = make_fence(n);
+    uint32_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = Polygon_outside(query_point(i++), V, n);
+        gbenchmark_escape(&outside);
+    }
+    delete[] V;
+}
+
+static void BM_PolygonIndexOutside(benchmark::State& state)
+{
+    const uint16_t n = state.range(0);
+    Vector2f *V = make_fence(n);
+    PolygonIndex<float> index;
+    index.init(V, n);
+    uint32_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = index.outside(query_point(i++));
+        gbenchmark_escape(&outside);
+    }
+    delete[] V;
+}
+
+// 20m path segments, as tested by the path planner
+static void BM_PolygonIntersects(benchmark::State& state)
+{
+    const uint16_t n = state.range(0);
+    Vector2f *V = make_fence(n);
+    uint32_t i = 0;
+
+    while (state.KeepRunning()) {
+        const Vector2f p1 = query_point(i++);
+        Vector2f intersection;
+        bool intersects = Polygon_intersects(V, n, p1, p1 + Vector2f(1500, 1300), intersection);
+        gbenchmark_escape(&intersects);
+    }
+    delete[] V;
+}
+
+static void BM_PolygonIndexIntersects(benchmark::State& state)
+{
+    const uint16_t n = state.range(0);
+    Vector2f *V = make_fence(n);
+    PolygonIndex<float> index;
+    index.init(V, n);
+    uint32_t i = 0;
+
+    while (state.KeepRunning()) {
+        const Vector2f p1 = query_point(i++);
+        bool intersects = index.intersects(p1, p1 + Vector2f(1500, 1300));
+        gbenchmark_escape(&intersects);
+    }
+    delete[] V;
+}
+
+static void BM_PolygonIndexInit(benchmark::State& state)
+{
+    const uint16_t n = state.range(0);
+    Vector2f *V = make_fence(n);
+    PolygonIndex<float> index;
+
+    while (state.KeepRunning()) {
+        bool built = index.init(V, n);
+        gbenchmark_escape(&built);
+    }
+    delete[] V;
+}
+
+BENCHMARK(BM_PolygonOutside)->Arg(16)->Arg(100)->Arg(255)->Arg(1000);
+BENCHMARK(BM_PolygonIndexOutside)->Arg(16)->Arg(100)->Arg(255)->Arg(1000);
+BENCHMARK(BM_PolygonIntersects)->Arg(16)->Arg(100)->Arg(255)->Arg(1000);
+BENCHMARK(BM_PolygonIndexIntersects)->Arg(16)->Arg(100)->Arg(255)->Arg(1000);
+BENCHMARK(BM_PolygonIndexInit)->Arg(100)->Arg(255)->Arg(1000);
+
+BENCHMARK_MAIN();
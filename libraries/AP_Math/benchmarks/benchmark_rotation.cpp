@@ -0,0 +1,75 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_CustomRotations/AP_CustomRotations.h>
+
+AP_CustomRotations cust_rot;
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void BM_RotateEnum(benchmark::State& state)
+{
+    const enum Rotation r = (enum Rotation)state.range(0);
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        v.rotate(r);
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_RotateTransform(benchmark::State& state)
+{
+    const RotationTransformf t((enum Rotation)state.range(0));
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        t.rotate(v);
+        gbenchmark_escape(&v);
+    }
+}
+
+/*
+  a gyro and accel with their own orientations followed by the board
+  orientation, as for each sample of two IMUs
+ */
+static const enum Rotation imu_rotations[] = {
+    ROTATION_ROLL_180_YAW_90, ROTATION_NONE, ROTATION_PITCH_180, ROTATION_YAW_45,
+    ROTATION_ROLL_180_YAW_90, ROTATION_NONE, ROTATION_PITCH_180, ROTATION_YAW_45,
+    ROTATION_YAW_270, ROTATION_NONE, ROTATION_ROLL_90_PITCH_315, ROTATION_YAW_45,
+};
+
+static void BM_RotateEnumIMUs(benchmark::State& state)
+{
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        for (const auto r : imu_rotations) {
+            v.rotate(r);
+        }
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_RotateTransformIMUs(benchmark::State& state)
+{
+    RotationTransformf t[ARRAY_SIZE(imu_rotations)];
+    for (uint8_t i=0; i<ARRAY_SIZE(imu_rotations); i++) {
+        t[i].set(imu_rotations[i]);
+    }
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        for (const auto &ti : t) {
+            ti.rotate(v);
+        }
+        gbenchmark_escape(&v);
+    }
+}
+
+// none, right angle, 45 degree, other fixed and custom rotations
+BENCHMARK(BM_RotateEnum)->Arg(ROTATION_NONE)->Arg(ROTATION_ROLL_180_YAW_90)->Arg(ROTATION_ROLL_90_PITCH_180_YAW_90)->Arg(ROTATION_YAW_45)->Arg(ROTATION_ROLL_90_PITCH_68_YAW_293)->Arg(ROTATION_CUSTOM_1);
+BENCHMARK(BM_RotateTransform)->Arg(ROTATION_NONE)->Arg(ROTATION_ROLL_180_YAW_90)->Arg(ROTATION_ROLL_90_PITCH_180_YAW_90)->Arg(ROTATION_YAW_45)->Arg(ROTATION_ROLL_90_PITCH_68_YAW_293)->Arg(ROTATION_CUSTOM_1);
+BENCHMARK(BM_RotateEnumIMUs);
+BENCHMARK(BM_RotateTransformIMUs);
+
+BENCHMARK_MAIN();
@@ -36,6 +36,50 @@
  *  expect that to be very small over the distances involved in the
  *  fence boundary
  */
+/*
+  return true if a ray cast from P in the +x direction crosses the
+  edge from Vi to Vj, using the half-open rule on y so a ray through a
+  vertex counts exactly one of the edges meeting there
+ */
+template <typename T>
+static inline bool Polygon_edge_crossed(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - Vi.x;
+    const T dx2 = Vj.x - Vi.x;
+    const T dy1 = P.y - Vi.y;
+    const T dy2 = Vj.y - Vi.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        }
+        if (std::is_floating_point<T>::value) {
+            return dx1 * dy2 > dx2 * dy1;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 < m2) {
+        return true;
+    } else if (m1 > m2) {
+        return false;
+    }
+    if (std::is_floating_point<T>::value) {
+        return dx1 * dy2 < dx2 * dy1;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 template <typename T>
 bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
 {
@@ -54,52 +98,8 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (Polygon_edge_crossed(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -125,6 +125,27 @@ template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsig
 template bool Polygon_complete<float>(const Vector2f *V, unsigned n);
 
 
+/*
+  return true if the edge from v1 to v2 intersects the line from p1 to p2
+ */
+static inline bool Polygon_edge_intersects(const Vector2f &v1, const Vector2f &v2, const Vector2f &p1, const Vector2f &p2, Vector2f &intersection)
+{
+    // optimisations for common cases
+    if (v1.x > p1.x && v2.x > p1.x && v1.x > p2.x && v2.x > p2.x) {
+        return false;
+    }
+    if (v1.y > p1.y && v2.y > p1.y && v1.y > p2.y && v2.y > p2.y) {
+        return false;
+    }
+    if (v1.x < p1.x && v2.x < p1.x && v1.x < p2.x && v2.x < p2.x) {
+        return false;
+    }
+    if (v1.y < p1.y && v2.y < p1.y && v1.y < p2.y && v2.y < p2.y) {
+        return false;
+    }
+    return Vector2f::segment_intersection(v1,v2,p1,p2,intersection);
+}
+
 /*
   determine if the polygon of N verticies defined by points V is
   intersected by a line from point p1 to point p2
@@ -140,28 +161,13 @@ bool Polygon_intersects(const Vector2f *V, unsigned N, const Vector2f &p1, const
     }
 
     float intersect_dist_sq = FLT_MAX;
-    for (uint8_t i=0; i<N; i++) {
-        uint8_t j = i+1;
+    for (unsigned i=0; i<N; i++) {
+        unsigned j = i+1;
         if (j >= N) {
             j = 0;
         }
-        const Vector2f &v1 = V[i];
-        const Vector2f &v2 = V[j];
-        // optimisations for common cases
-        if (v1.x > p1.x && v2.x > p1.x && v1.x > p2.x && v2.x > p2.x) {
-            continue;
-        }
-        if (v1.y > p1.y && v2.y > p1.y && v1.y > p2.y && v2.y > p2.y) {
-            continue;
-        }
-        if (v1.x < p1.x && v2.x < p1.x && v1.x < p2.x && v2.x < p2.x) {
-            continue;
-        }
-        if (v1.y < p1.y && v2.y < p1.y && v1.y < p2.y && v2.y < p2.y) {
-            continue;
-        }
         Vector2f intersect_tmp;
-        if (Vector2f::segment_intersection(v1,v2,p1,p2,intersect_tmp)) {
+        if (Polygon_edge_intersects(V[i], V[j], p1, p2, intersect_tmp)) {
             float dist_sq = sq(intersect_tmp.x - p1.x) + sq(intersect_tmp.y - p1.y);
             if (dist_sq < intersect_dist_sq) {
                 intersect_dist_sq = dist_sq;
@@ -214,3 +220,196 @@ float Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector
     }
     return sqrtf(closest_sq);
 }
+
+/*
+  PolygonIndex: edges bucketed into horizontal bands
+ */
+
+// polygons with fewer edges than this are scanned directly
+#define POLYGON_INDEX_MIN_EDGES 16
+#define POLYGON_INDEX_MAX_BANDS 256
+// limit on the average number of bands an edge may be listed in
+#define POLYGON_INDEX_MAX_BANDS_PER_EDGE 8
+
+template <typename T>
+bool PolygonIndex<T>::init(const Vector2<T> *V, uint16_t n)
+{
+    clear();
+    if (V == nullptr || n < 3) {
+        return false;
+    }
+    _points = V;
+    _num_points = n;
+    _num_edges = Polygon_complete(V, n) ? n-1 : n;
+
+    // the bounding box also lets the full scan of a small polygon
+    // reject queries cheaply
+    _min = _max = V[0];
+    for (uint16_t i=1; i<_num_edges; i++) {
+        _min.x = MIN(_min.x, V[i].x);
+        _min.y = MIN(_min.y, V[i].y);
+        _max.x = MAX(_max.x, V[i].x);
+        _max.y = MAX(_max.y, V[i].y);
+    }
+
+    if (_num_edges < POLYGON_INDEX_MIN_EDGES) {
+        return false;
+    }
+
+    // aim for about one edge per band, using fewer bands if long
+    // edges would be listed in too many of them
+    uint32_t total;
+    _num_bands = MIN(_num_edges, POLYGON_INDEX_MAX_BANDS);
+    while (true) {
+        total = 0;
+        for (uint16_t i=0; i<_num_edges; i++) {
+            const uint16_t j = (i+1 < _num_edges) ? i+1 : 0;
+            total += band(MAX(V[i].y, V[j].y)) - band(MIN(V[i].y, V[j].y)) + 1;
+        }
+        if (_num_bands == 1 ||
+            (total <= uint32_t(_num_edges) * POLYGON_INDEX_MAX_BANDS_PER_EDGE && total <= UINT16_MAX)) {
+            break;
+        }
+        _num_bands /= 2;
+    }
+
+    _band_start = NEW_NOTHROW uint16_t[_num_bands+1];
+    _edges = NEW_NOTHROW uint16_t[total];
+    if (_band_start == nullptr || _edges == nullptr) {
+        clear();
+        // keep the points so queries fall back to a full scan
+        _points = V;
+        _num_points = n;
+        return false;
+    }
+
+    // count the edges in each band, then make _band_start[b+1] the
+    // end of band b and fill each band backwards from its end. That
+    // leaves _band_start[b+1] holding the start of band b
+    memset(_band_start, 0, sizeof(uint16_t)*(_num_bands+1));
+    for (uint16_t i=0; i<_num_edges; i++) {
+        const uint16_t j = (i+1 < _num_edges) ? i+1 : 0;
+        const uint16_t bmax = band(MAX(V[i].y, V[j].y));
+        for (uint16_t b=band(MIN(V[i].y, V[j].y)); b<=bmax; b++) {
+            _band_start[b+1]++;
+        }
+    }
+    for (uint16_t b=1; b<=_num_bands; b++) {
+        _band_start[b] += _band_start[b-1];
+    }
+    for (uint16_t i=0; i<_num_edges; i++) {
+        const uint16_t j = (i+1 < _num_edges) ? i+1 : 0;
+        const uint16_t bmax = band(MAX(V[i].y, V[j].y));
+        for (uint16_t b=band(MIN(V[i].y, V[j].y)); b<=bmax; b++) {
+            _edges[--_band_start[b+1]] = i;
+        }
+    }
+    for (uint16_t b=0; b<_num_bands; b++) {
+        _band_start[b] = _band_start[b+1];
+    }
+    _band_start[_num_bands] = total;
+
+    return true;
+}
+
+template <typename T>
+void PolygonIndex<T>::clear()
+{
+    delete[] _band_start;
+    delete[] _edges;
+    _band_start = nullptr;
+    _edges = nullptr;
+    _points = nullptr;
+    _num_points = 0;
+    _num_edges = 0;
+    _num_bands = 0;
+}
+
+/*
+  return the band holding y. This only needs to be monotonic in y, so
+  that an edge and a query covering the same y are always put in the
+  same band
+ */
+template <typename T>
+uint16_t PolygonIndex<T>::band(T y) const
+{
+    if (y <= _min.y) {
+        return 0;
+    }
+    if (y >= _max.y) {
+        return _num_bands - 1;
+    }
+    uint32_t b;
+    if (std::is_floating_point<T>::value) {
+        b = (float(y) - float(_min.y)) * _num_bands / (float(_max.y) - float(_min.y));
+    } else {
+        b = (int64_t(y) - int64_t(_min.y)) * _num_bands / (int64_t(_max.y) - int64_t(_min.y));
+    }
+    return MIN(b, _num_bands - 1U);
+}
+
+template <typename T>
+bool PolygonIndex<T>::outside(const Vector2<T> &P) const
+{
+    if (_points == nullptr) {
+        return true;
+    }
+    // a ray at a y outside the polygon crosses no edges. We don't
+    // reject on x so the result matches Polygon_outside() exactly
+    if (P.y < _min.y || P.y > _max.y) {
+        return true;
+    }
+    if (_band_start == nullptr) {
+        return Polygon_outside(P, _points, _num_points);
+    }
+    const uint16_t b = band(P.y);
+    bool outside = true;
+    for (uint16_t k=_band_start[b]; k<_band_start[b+1]; k++) {
+        const uint16_t i = _edges[k];
+        const uint16_t j = (i+1 < _num_edges) ? i+1 : 0;
+        if (Polygon_edge_crossed(P, _points[i], _points[j])) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+
+template <>
+bool PolygonIndex<float>::intersects(const Vector2f &p1, const Vector2f &p2) const
+{
+    if (_points == nullptr) {
+        return false;
+    }
+    const Vector2f seg_min { MIN(p1.x, p2.x), MIN(p1.y, p2.y) };
+    const Vector2f seg_max { MAX(p1.x, p2.x), MAX(p1.y, p2.y) };
+    if (seg_min.x > _max.x || seg_min.y > _max.y || seg_max.x < _min.x || seg_max.y < _min.y) {
+        return false;
+    }
+    if (_band_start == nullptr) {
+        Vector2f intersection;
+        return Polygon_intersects(_points, _num_points, p1, p2, intersection);
+    }
+    const uint16_t b0 = band(seg_min.y);
+    const uint16_t b1 = band(seg_max.y);
+    for (uint16_t b=b0; b<=b1; b++) {
+        for (uint16_t k=_band_start[b]; k<_band_start[b+1]; k++) {
+            const uint16_t i = _edges[k];
+            const uint16_t j = (i+1 < _num_edges) ? i+1 : 0;
+            const Vector2f &v1 = _points[i];
+            const Vector2f &v2 = _points[j];
+            // an edge spanning several of our bands is only tested in
+            // the first of them
+            if (MAX(band(MIN(v1.y, v2.y)), b0) != b) {
+                continue;
+            }
+            Vector2f intersection;
+            if (Polygon_edge_intersects(v1, v2, p1, p2, intersection)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template class PolygonIndex<int32_t>;
+template class PolygonIndex<float>;
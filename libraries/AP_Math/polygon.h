@@ -44,3 +44,56 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
   closed polygon V, defined by N points
  */
 float Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector2f &p);
+
+/*
+  PolygonIndex accelerates repeated point-in-polygon and segment
+  intersection queries against a polygon which does not change, such
+  as a loaded fence. The bounding box is split into horizontal bands
+  and each band lists the edges whose y extent overlaps it, so a query
+  only visits the edges of the bands it touches. Results are the same
+  as Polygon_outside() and Polygon_intersects().
+
+  The points are not copied and must outlive the index.
+ */
+template <typename T>
+class PolygonIndex {
+public:
+    PolygonIndex() {}
+    ~PolygonIndex() { clear(); }
+
+    CLASS_NO_COPY(PolygonIndex);
+
+    // build the index for polygon V of n points. Returns false if no
+    // bands were built, either because the polygon is too small to
+    // benefit or on allocation failure, in which case queries scan
+    // every edge
+    bool init(const Vector2<T> *V, uint16_t n);
+
+    // free the index
+    void clear();
+
+    // true if P is outside the polygon, as Polygon_outside()
+    bool outside(const Vector2<T> &P) const WARN_IF_UNUSED;
+
+    // true if the segment p1 to p2 crosses an edge, as
+    // Polygon_intersects(). Only available for float polygons
+    bool intersects(const Vector2<T> &p1, const Vector2<T> &p2) const WARN_IF_UNUSED;
+
+private:
+    // return the band containing y, clamped to the bounding box
+    uint16_t band(T y) const;
+
+    const Vector2<T> *_points = nullptr;
+    uint16_t _num_points = 0;
+    // number of edges, not counting a closing point
+    uint16_t _num_edges = 0;
+    Vector2<T> _min;
+    Vector2<T> _max;
+    uint16_t _num_bands = 0;
+    // edges in band b are _edges[_band_start[b]] to _edges[_band_start[b+1]-1]
+    uint16_t *_band_start = nullptr;
+    uint16_t *_edges = nullptr;
+};
+
+template <>
+bool PolygonIndex<float>::intersects(const Vector2f &p1, const Vector2f &p2) const;
@@ -0,0 +1,184 @@
+/*
+ * rotation_transform.cpp
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O2")
+
+#include "AP_Math.h"
+#include <AP_InternalError/AP_InternalError.h>
+#include <AP_CustomRotations/AP_CustomRotations.h>
+
+/*
+  source axis of each axis for rotations by multiples of 90 degrees,
+  1 to 3 for x to z, negative if the axis is negated. All zero for
+  rotations which are not a permutation of the axes
+ */
+static constexpr int8_t right_angle_axes[ROTATION_MAX][3] = {
+    {  1,  2,  3 },  // ROTATION_NONE
+    {  0,  0,  0 },  // ROTATION_YAW_45
+    { -2,  1,  3 },  // ROTATION_YAW_90
+    {  0,  0,  0 },  // ROTATION_YAW_135
+    { -1, -2,  3 },  // ROTATION_YAW_180
+    {  0,  0,  0 },  // ROTATION_YAW_225
+    {  2, -1,  3 },  // ROTATION_YAW_270
+    {  0,  0,  0 },  // ROTATION_YAW_315
+    {  1, -2, -3 },  // ROTATION_ROLL_180
+    {  0,  0,  0 },  // ROTATION_ROLL_180_YAW_45
+    {  2,  1, -3 },  // ROTATION_ROLL_180_YAW_90
+    {  0,  0,  0 },  // ROTATION_ROLL_180_YAW_135
+    { -1,  2, -3 },  // ROTATION_PITCH_180
+    {  0,  0,  0 },  // ROTATION_ROLL_180_YAW_225
+    { -2, -1, -3 },  // ROTATION_ROLL_180_YAW_270
+    {  0,  0,  0 },  // ROTATION_ROLL_180_YAW_315
+    {  1, -3,  2 },  // ROTATION_ROLL_90
+    {  0,  0,  0 },  // ROTATION_ROLL_90_YAW_45
+    {  3,  1,  2 },  // ROTATION_ROLL_90_YAW_90
+    {  0,  0,  0 },  // ROTATION_ROLL_90_YAW_135
+    {  1,  3, -2 },  // ROTATION_ROLL_270
+    {  0,  0,  0 },  // ROTATION_ROLL_270_YAW_45
+    { -3,  1, -2 },  // ROTATION_ROLL_270_YAW_90
+    {  0,  0,  0 },  // ROTATION_ROLL_270_YAW_135
+    {  3,  2, -1 },  // ROTATION_PITCH_90
+    { -3,  2,  1 },  // ROTATION_PITCH_270
+    { -2, -1, -3 },  // ROTATION_PITCH_180_YAW_90
+    {  2,  1, -3 },  // ROTATION_PITCH_180_YAW_270
+    {  2, -3, -1 },  // ROTATION_ROLL_90_PITCH_90
+    { -3, -2, -1 },  // ROTATION_ROLL_180_PITCH_90
+    { -2,  3, -1 },  // ROTATION_ROLL_270_PITCH_90
+    { -1, -3, -2 },  // ROTATION_ROLL_90_PITCH_180
+    { -1,  3,  2 },  // ROTATION_ROLL_270_PITCH_180
+    { -2, -3,  1 },  // ROTATION_ROLL_90_PITCH_270
+    {  3, -2,  1 },  // ROTATION_ROLL_180_PITCH_270
+    {  2,  3,  1 },  // ROTATION_ROLL_270_PITCH_270
+    {  3, -1, -2 },  // ROTATION_ROLL_90_PITCH_180_YAW_90
+    { -3, -1,  2 },  // ROTATION_ROLL_90_YAW_270
+    {  0,  0,  0 },  // ROTATION_ROLL_90_PITCH_68_YAW_293
+    {  0,  0,  0 },  // ROTATION_PITCH_315
+    {  0,  0,  0 },  // ROTATION_ROLL_90_PITCH_315
+    {  0,  0,  0 },  // ROTATION_PITCH_7
+    {  0,  0,  0 },  // ROTATION_ROLL_45
+    {  0,  0,  0 },  // ROTATION_ROLL_315
+};
+static_assert(ARRAY_SIZE(right_angle_axes) == ROTATION_MAX, "right_angle_axes must cover all rotations");
+
+#if AP_CUSTOMROTATIONS_ENABLED
+// custom rotation matrices are always float
+static void custom_mul(const Matrix3f &m, Vector3f &v)
+{
+    v = m * v;
+}
+
+static void custom_mul(const Matrix3f &m, Vector3d &v)
+{
+    v = (m * v.tofloat()).todouble();
+}
+
+static void custom_mul_transpose(const Matrix3f &m, Vector3f &v)
+{
+    v = m.mul_transpose(v);
+}
+
+static void custom_mul_transpose(const Matrix3f &m, Vector3d &v)
+{
+    v = m.mul_transpose(v.tofloat()).todouble();
+}
+#endif
+
+template <typename T>
+void RotationTransform<T>::set(enum Rotation rotation)
+{
+    _rotation = rotation;
+    _type = Type::NONE;
+
+    if (rotation == ROTATION_NONE) {
+        return;
+    }
+
+    if (rotation < ROTATION_MAX) {
+        const int8_t *axes = right_angle_axes[rotation];
+        if (axes[0] != 0) {
+            for (uint8_t i=0; i<3; i++) {
+                _axis[i] = abs(axes[i]) - 1;
+                _sign[i] = axes[i] > 0 ? 1 : -1;
+            }
+            _type = Type::PERMUTE;
+            return;
+        }
+
+        // build the matrix from the rotated axes so it gives the
+        // same result as Vector3::rotate()
+        Vector3<T> x_vec(1,0,0);
+        Vector3<T> y_vec(0,1,0);
+        Vector3<T> z_vec(0,0,1);
+        x_vec.rotate(rotation);
+        y_vec.rotate(rotation);
+        z_vec.rotate(rotation);
+        _matrix = Matrix3<T>(x_vec.x, y_vec.x, z_vec.x,
+                             x_vec.y, y_vec.y, z_vec.y,
+                             x_vec.z, y_vec.z, z_vec.z);
+        _type = Type::MATRIX;
+        return;
+    }
+
+#if AP_CUSTOMROTATIONS_ENABLED
+    if (rotation >= ROTATION_CUSTOM_1 && rotation < ROTATION_CUSTOM_END) {
+        _custom = AP::custom_rotations().get_matrix(rotation);
+        if (_custom != nullptr) {
+            _type = Type::CUSTOM;
+        }
+        return;
+    }
+#endif
+
+    // rotation invalid
+    INTERNAL_ERROR(AP_InternalError::error_t::bad_rotation);
+}
+
+template <typename T>
+void RotationTransform<T>::rotate_inverse(Vector3<T> &v) const
+{
+    switch (_type) {
+    case Type::NONE:
+        return;
+    case Type::PERMUTE: {
+        const Vector3<T> in = v;
+        for (uint8_t i=0; i<3; i++) {
+            v[_axis[i]] = _sign[i] * in[i];
+        }
+        return;
+    }
+    case Type::MATRIX:
+        v = _matrix.mul_transpose(v);
+        return;
+    case Type::CUSTOM:
+#if AP_CUSTOMROTATIONS_ENABLED
+        custom_mul_transpose(*_custom, v);
+#endif
+        return;
+    }
+}
+
+template <typename T>
+void RotationTransform<T>::rotate_custom(Vector3<T> &v) const
+{
+#if AP_CUSTOMROTATIONS_ENABLED
+    custom_mul(*_custom, v);
+#endif
+}
+
+// define for float and double
+template class RotationTransform<float>;
+template class RotationTransform<double>;
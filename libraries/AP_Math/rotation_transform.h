@@ -0,0 +1,100 @@
+/*
+ * rotation_transform.h
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "rotations.h"
+#include "vector3.h"
+#include "matrix3.h"
+
+/*
+  a standard or custom rotation bound once, for sensors which rotate
+  every sample by the same rotation. Rotations by multiples of 90
+  degrees are a signed permutation of the axes from a compile time
+  table, other rotations multiply by a matrix built when the rotation
+  is set and custom rotations use the matrix of the custom rotation,
+  so it follows changes to the custom rotation parameters
+ */
+template <typename T>
+class RotationTransform {
+public:
+    RotationTransform() {}
+    explicit RotationTransform(enum Rotation rotation) {
+        set(rotation);
+    }
+
+    // bind a rotation. An invalid rotation raises an internal error
+    // and then behaves as ROTATION_NONE
+    void set(enum Rotation rotation);
+
+    enum Rotation get_rotation() const { return _rotation; }
+
+    // rotate a vector, same as v.rotate(get_rotation())
+    void rotate(Vector3<T> &v) const {
+        switch (_type) {
+        case Type::NONE:
+            return;
+        case Type::PERMUTE: {
+            const Vector3<T> in = v;
+            v.x = _sign[0] * axis(in, _axis[0]);
+            v.y = _sign[1] * axis(in, _axis[1]);
+            v.z = _sign[2] * axis(in, _axis[2]);
+            return;
+        }
+        case Type::MATRIX:
+            v = _matrix * v;
+            return;
+        case Type::CUSTOM:
+            rotate_custom(v);
+            return;
+        }
+    }
+
+    // rotate a vector by the inverse rotation, same as
+    // v.rotate_inverse(get_rotation())
+    void rotate_inverse(Vector3<T> &v) const;
+
+private:
+    enum class Type : uint8_t {
+        NONE,
+        PERMUTE,
+        MATRIX,
+        CUSTOM,
+    } _type = Type::NONE;
+
+    enum Rotation _rotation = ROTATION_NONE;
+
+    // source axis and sign of each axis for PERMUTE
+    uint8_t _axis[3];
+    T _sign[3];
+
+    // rotation matrix for MATRIX
+    Matrix3<T> _matrix;
+
+    // matrix of the custom rotation for CUSTOM
+    const Matrix3f *_custom;
+
+    void rotate_custom(Vector3<T> &v) const;
+
+    // select rather than index the source axis, so the vector can
+    // stay in registers
+    static T axis(const Vector3<T> &v, uint8_t i) {
+        return i == 0 ? v.x : (i == 1 ? v.y : v.z);
+    }
+};
+
+typedef RotationTransform<float> RotationTransformf;
+typedef RotationTransform<double> RotationTransformd;
@@ -356,6 +356,97 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+/*
+  build a closed star shaped polygon of n points with a random radius
+  at each vertex, centred on the origin
+ */
+template <typename T>
+static void make_star_polygon(Vector2<T> *V, uint16_t n, float max_radius)
+{
+    for (uint16_t i=0; i<n-1; i++) {
+        const float angle = i * M_2PI / (n-1);
+        const float radius = max_radius * linear_interpolate(0.2f, 1.0f, rand() % 1000, 0, 1000);
+        V[i] = Vector2<T>(T(radius * cosf(angle)), T(radius * sinf(angle)));
+    }
+    V[n-1] = V[0];
+}
+
+template <typename T>
+static Vector2<T> random_point(float range)
+{
+    return Vector2<T>(T(range * ((rand() % 20001) - 10000) * 1.0e-4f),
+                      T(range * ((rand() % 20001) - 10000) * 1.0e-4f));
+}
+
+TEST(Polygon, index_outside)
+{
+    srand(1);
+    for (const uint16_t n : { 8, 50, 400, 2000 }) {
+        Vector2l *lla = new Vector2l[n];
+        Vector2f *cm = new Vector2f[n];
+        make_star_polygon(lla, n, 1.0e7f);
+        make_star_polygon(cm, n, 5.0e4f);
+        PolygonIndex<int32_t> index_lla;
+        PolygonIndex<float> index_cm;
+        EXPECT_EQ(index_lla.init(lla, n), n > 16);
+        EXPECT_EQ(index_cm.init(cm, n), n > 16);
+        for (uint32_t i=0; i<20000; i++) {
+            const Vector2l p_lla = random_point<int32_t>(1.2e7f);
+            EXPECT_EQ(Polygon_outside(p_lla, lla, n), index_lla.outside(p_lla));
+            const Vector2f p_cm = random_point<float>(6.0e4f);
+            EXPECT_EQ(Polygon_outside(p_cm, cm, n), index_cm.outside(p_cm));
+        }
+        // vertices and points level with them are the awkward cases
+        for (uint16_t i=0; i<n; i++) {
+            EXPECT_EQ(Polygon_outside(lla[i], lla, n), index_lla.outside(lla[i]));
+            const Vector2l level { lla[i].x - 10, lla[i].y };
+            EXPECT_EQ(Polygon_outside(level, lla, n), index_lla.outside(level));
+            EXPECT_EQ(Polygon_outside(cm[i], cm, n), index_cm.outside(cm[i]));
+        }
+        delete[] lla;
+        delete[] cm;
+    }
+}
+
+TEST(Polygon, index_intersects)
+{
+    srand(2);
+    for (const uint16_t n : { 8, 50, 400, 2000 }) {
+        Vector2f *cm = new Vector2f[n];
+        make_star_polygon(cm, n, 5.0e4f);
+        PolygonIndex<float> index;
+        EXPECT_EQ(index.init(cm, n), n > 16);
+        uint32_t crossings = 0;
+        for (uint32_t i=0; i<20000; i++) {
+            const Vector2f p1 = random_point<float>(6.0e4f);
+            // mostly short segments, as used by path planning, plus
+            // some spanning the whole polygon
+            const Vector2f p2 = (i % 10 == 0) ? random_point<float>(6.0e4f) : p1 + random_point<float>(2.0e3f);
+            Vector2f intersection;
+            const bool expected = Polygon_intersects(cm, n, p1, p2, intersection);
+            EXPECT_EQ(expected, index.intersects(p1, p2));
+            crossings += expected;
+        }
+        EXPECT_GT(crossings, 0U);
+        delete[] cm;
+    }
+}
+
+TEST(Polygon, index_empty)
+{
+    PolygonIndex<float> index;
+    EXPECT_TRUE(index.outside(Vector2f()));
+    EXPECT_FALSE(index.intersects(Vector2f(-1, -1), Vector2f(1, 1)));
+
+    Vector2f square[5];
+    memcpy(square, SIMPLE_boundary, sizeof(square));
+    EXPECT_FALSE(index.init(square, 5));
+    EXPECT_FALSE(index.outside(Vector2f()));
+    EXPECT_TRUE(index.intersects(Vector2f(0, 0), Vector2f(5, 0)));
+    index.clear();
+    EXPECT_TRUE(index.outside(Vector2f()));
+}
+
 AP_GTEST_MAIN()
 
 
@@ -138,6 +138,46 @@ TEST(RotationsTest, TestRotateMatrix)
     }
 }
 
+TEST(RotationsTest, TestRotationTransform)
+{
+    for (enum Rotation r = ROTATION_NONE;
+         r < ROTATION_MAX;
+         r = (enum Rotation)((uint8_t)r+1)) {
+        const RotationTransformf t(r);
+        EXPECT_EQ(t.get_rotation(), r);
+
+        Vector3f vec(1,2,3);
+        Vector3f vec2 = vec;
+        vec.rotate(r);
+        t.rotate(vec2);
+        EXPECT_LE((vec - vec2).length(), 1e-6);
+
+        vec.rotate_inverse(r);
+        t.rotate_inverse(vec2);
+        EXPECT_LE((vec - vec2).length(), 1e-6);
+
+        const RotationTransformd td(r);
+        Vector3d vecd(1,2,3);
+        Vector3d vecd2 = vecd;
+        vecd.rotate(r);
+        td.rotate(vecd2);
+        EXPECT_LE((vecd - vecd2).length(), 1e-12);
+    }
+
+    // custom rotations follow changes to the custom rotation
+    RotationTransformf t(ROTATION_CUSTOM_1);
+    AP::custom_rotations().set(ROTATION_CUSTOM_1, 10, 20, 30);
+    Vector3f vec(1,2,3);
+    Vector3f vec2 = vec;
+    vec.rotate(ROTATION_CUSTOM_1);
+    t.rotate(vec2);
+    EXPECT_LE((vec - vec2).length(), 1e-6);
+    vec.rotate_inverse(ROTATION_CUSTOM_1);
+    t.rotate_inverse(vec2);
+    EXPECT_LE((vec - vec2).length(), 1e-6);
+    EXPECT_LE((vec2 - Vector3f(1,2,3)).length(), 1e-5);
+}
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
 TEST(RotationsTest, TestFailedGetLinux)
 {
@@ -4,6 +4,14 @@
 #include <AP_Math/vector2.h>
 #include <AP_Math/vector3.h>
 #include <AP_Math/SCurve.h>
+#include <AP_Math/SplineCurve.h>
+
+static void expect_vector3f_near(const Vector3f &v1, const Vector3f &v2, float abs_error)
+{
+    EXPECT_NEAR(v1.x, v2.x, abs_error);
+    EXPECT_NEAR(v1.y, v2.y, abs_error);
+    EXPECT_NEAR(v1.z, v2.z, abs_error);
+}
 
 TEST(LinesScurve, test_calculate_path)
 {
@@ -17,6 +25,67 @@ TEST(LinesScurve, test_calculate_path)
     EXPECT_FLOAT_EQ(t6_out, 0.25000018);
 }
 
+TEST(LinesScurve, test_spline_batch_evaluation)
+{
+    SplineCurve spline;
+    spline.set_speed_accel(1000, 250, 150, 250, 100);
+    spline.set_origin_and_destination(Vector3f{0, 0, 0}, Vector3f{10000, 5000, 1000}, Vector3f{500, 0, 0}, Vector3f{0, 500, 0});
+
+    const uint16_t num_samples = 11;
+    float times[num_samples];
+    for (uint16_t i = 0; i < num_samples; i++) {
+        times[i] = i / float(num_samples - 1);
+    }
+    Vector3f pos[num_samples], vel[num_samples], accel[num_samples];
+    spline.get_pos_vel_accel_at_times(times, num_samples, pos, vel, accel);
+
+    // spline passes through origin and destination
+    expect_vector3f_near(pos[0], Vector3f(0, 0, 0), 1e-2);
+    expect_vector3f_near(pos[num_samples-1], Vector3f(10000, 5000, 1000), 1e-1);
+
+    // velocity and acceleration are the derivatives of the cubic position
+    for (uint16_t i = 1; i < num_samples; i++) {
+        const float dt = times[i] - times[i-1];
+        expect_vector3f_near(vel[i] - vel[i-1], (accel[i] + accel[i-1]) * 0.5f * dt, 1e-1);
+        expect_vector3f_near(pos[i] - pos[i-1], (vel[i] + vel[i-1]) * 0.5f * dt - (accel[i] - accel[i-1]) * (sq(dt) / 12.0f), 1e-1);
+    }
+}
+
+TEST(LinesScurve, test_spline_time_remaining)
+{
+    const struct {
+        Vector3f origin, destination, origin_vel, destination_vel;
+    } tracks[] {
+        {{0, 0, 0}, {10000, 5000, 1000}, {500, 0, 0}, {0, 500, 0}},
+        {{0, 0, 0}, {10000, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+        {{0, 0, 1000}, {5000, 5000, 1000}, {1000, 0, 0}, {0, 1000, 0}},
+        {{0, 0, 0}, {2000, 2000, 500}, {0, 1000, 0}, {1000, 0, 0}},
+    };
+    for (const auto &track : tracks) {
+        SplineCurve spline;
+        spline.set_speed_accel(1000, 250, 150, 250, 100);
+        spline.set_origin_and_destination(track.origin, track.destination, track.origin_vel, track.destination_vel);
+
+        // fly the track from the maximum speed at the origin, checking the estimate at the start and half way
+        Vector3f target_pos;
+        Vector3f target_vel = track.origin_vel.is_zero() ? Vector3f() : track.origin_vel.normalized() * spline.get_origin_speed_max();
+        const float estimate = spline.get_time_remaining(target_vel.length());
+        float estimate_half = 0.0f;
+        float time = 0.0f, time_half = 0.0f;
+        const float dt = 0.01f;
+        while (!spline.reached_destination() && time < 100.0f) {
+            spline.advance_target_along_track(dt, target_pos, target_vel);
+            time += dt;
+            if (is_zero(time_half) && time >= estimate * 0.5f) {
+                time_half = time;
+                estimate_half = spline.get_time_remaining(target_vel.length());
+            }
+        }
+        EXPECT_NEAR(estimate, time, time * 0.05f);
+        EXPECT_NEAR(estimate_half, time - time_half, time * 0.05f);
+        EXPECT_FLOAT_EQ(spline.get_time_remaining(target_vel.length()), 0.0f);
+    }
+}
 
 AP_GTEST_MAIN()
 int hal = 0; //weirdly the build will fail without this
@@ -80,4 +80,8 @@ struct ekf_timing {
     float delVelDT_min;
 };
 
+// number of yaw hypotheses run by the EKFGSF_yaw model bank. Only the
+// first five models are logged
+#ifndef N_MODELS_EKFGSF
 #define N_MODELS_EKFGSF 5U
+#endif
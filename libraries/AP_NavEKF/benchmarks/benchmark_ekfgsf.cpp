@@ -0,0 +1,36 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/EKFGSF_yaw.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static EKFGSF_yaw gsf;
+
+/*
+  run the EKFGSF_yaw model bank for a vehicle in a steady banked turn
+  at 400Hz, fusing GPS velocity at 5Hz, one IMU sample per iteration
+ */
+static void BM_EKFGSFUpdate(benchmark::State& state)
+{
+    const ftype dt = 0.0025;
+    const ftype V = 15;
+    const ftype r = 0.2;
+    const ftype phi = atanF(V * r / GRAVITY_MSS);
+    const Vector3F delAng { 0, r * sinF(phi) * dt, r * cosF(phi) * dt };
+    const Vector3F delVel { 0, 0, -norm(GRAVITY_MSS, V * r) * dt };
+    ftype yaw = 0;
+    uint32_t step = 0;
+
+    while (state.KeepRunning()) {
+        gsf.update(delAng, delVel, dt, dt, true, V);
+        yaw = wrap_PI(yaw + r * dt);
+        if (++step % 80 == 0) {
+            gsf.fuseVelData(Vector2F{V * cosF(yaw), V * sinF(yaw)}, 0.5);
+        }
+        gbenchmark_escape(&gsf);
+    }
+}
+
+BENCHMARK(BM_EKFGSFUpdate);
+
+BENCHMARK_MAIN();
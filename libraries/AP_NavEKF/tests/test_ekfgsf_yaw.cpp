@@ -0,0 +1,90 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_NavEKF/EKFGSF_yaw.cpp
+ */
+
+#include <AP_NavEKF/EKFGSF_yaw.h>
+
+#include <AP_HAL/AP_HAL.h>
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  simulated fixed wing flight at constant airspeed: straight and level
+  for 5 seconds, then a series of alternating banked turns. IMU data is
+  produced at 400Hz and GPS velocity at 5Hz
+ */
+class GSFFlight {
+public:
+    // advance one IMU sample, returns true if a GPS velocity is due
+    bool step(EKFGSF_yaw &gsf) {
+        const ftype r_target = i < 2000 ? 0 : ((i / 4000) % 2 ? 0.3 : -0.15);
+        r += constrain_ftype(r_target - r, -0.1 * dt, 0.1 * dt);
+        const ftype phi = atanF(V * r / GRAVITY_MSS);
+        const Vector3F delAng { phi - phi_prev, r * sinF(phi) * dt, r * cosF(phi) * dt };
+        const Vector3F delVel { 0, 0, -norm(GRAVITY_MSS, V * r) * dt };
+        phi_prev = phi;
+        yaw = wrap_PI(yaw + r * dt);
+        gsf.update(delAng, delVel, dt, dt, i > 400, V);
+        const bool gps_due = (i % 80) == 0 && i > 400;
+        i++;
+        return gps_due;
+    }
+    Vector2F vel() const { return Vector2F{V * cosF(yaw), V * sinF(yaw)}; }
+    ftype time() const { return i * dt; }
+
+    ftype yaw = 0.7;
+
+private:
+    const ftype dt = 0.0025;
+    const ftype V = 15;
+    ftype r = 0;
+    ftype phi_prev = 0;
+    uint32_t i = 0;
+};
+
+TEST(EKFGSF_yaw, Convergence)
+{
+    static EKFGSF_yaw gsf;
+    GSFFlight flight;
+    ftype yaw, yaw_variance, innov_length;
+
+    while (flight.time() < 60) {
+        if (!flight.step(gsf)) {
+            continue;
+        }
+        gsf.fuseVelData(flight.vel(), 0.5);
+        if (flight.time() < 15) {
+            continue;
+        }
+        // from 10 seconds after the first turn the yaw must be tracked
+        ASSERT_TRUE(gsf.getYawData(yaw, yaw_variance));
+        EXPECT_LT(fabsF(wrap_PI(yaw - flight.yaw)), radians(5));
+        EXPECT_LT(yaw_variance, sq(radians(10)));
+        ASSERT_TRUE(gsf.getVelInnovLength(innov_length));
+        EXPECT_LT(innov_length, 1);
+    }
+}
+
+// Replay depends upon identical inputs producing identical outputs
+TEST(EKFGSF_yaw, Repeatable)
+{
+    static EKFGSF_yaw gsf[2];
+    GSFFlight flight[2];
+    ftype yaw[2], yaw_variance[2];
+
+    while (flight[0].time() < 30) {
+        for (uint8_t j = 0; j < 2; j++) {
+            if (flight[j].step(gsf[j])) {
+                gsf[j].fuseVelData(flight[j].vel(), 0.5);
+            }
+        }
+        if (gsf[0].getYawData(yaw[0], yaw_variance[0])) {
+            ASSERT_TRUE(gsf[1].getYawData(yaw[1], yaw_variance[1]));
+            EXPECT_EQ(yaw[0], yaw[1]);
+            EXPECT_EQ(yaw_variance[0], yaw_variance[1]);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
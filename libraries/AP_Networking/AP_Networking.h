@@ -20,6 +20,7 @@ class AP_Networking_Backend;
 class AP_Networking_ChibiOS;
 
 class SocketAPM;
+class ExpandingString;
 
 class AP_Networking
 {
@@ -151,6 +152,11 @@ public:
      */
     bool sendfile(SocketAPM *sock, int fd);
 
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    // get I/O statistics for the network ports, for @SYS/netports.txt
+    void ports_info(ExpandingString &str);
+#endif
+
     static const struct AP_Param::GroupInfo var_info[];
 
     enum class OPTION {
@@ -240,9 +246,13 @@ private:
 
         bool send_receive(void);
 
+        // I/O statistics for @SYS/netports.txt
+        void port_info(ExpandingString &str);
+
     private:
         bool init_buffers(const uint32_t size_rx, const uint32_t size_tx);
         void thread_create(AP_HAL::MemberProc);
+        void connect_to_last_recv(void);
 
         uint32_t txspace() override;
         void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
@@ -270,6 +280,22 @@ private:
         bool close_on_recv_error;
 
         HAL_Semaphore sem;
+
+        // datagrams and the system calls used to move them, for
+        // checking how well batching is working
+        struct {
+            uint32_t rx_packets;
+            uint32_t rx_calls;
+            uint32_t tx_packets;
+            uint32_t tx_calls;
+        } io_stats;
+
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+        // buffers for AP_NETWORKING_PORT_BATCH_COUNT datagrams in each direction
+        uint8_t *batch_buf;
+        bool batch_init(void);
+        bool send_receive_batch(void);
+#endif
     };
 #endif // AP_NETWORKING_REGISTER_PORT_ENABLED
 
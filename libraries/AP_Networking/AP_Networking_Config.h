@@ -137,3 +137,17 @@
 #ifndef AP_NETWORKING_REGISTER_PORT_ENABLED
 #define AP_NETWORKING_REGISTER_PORT_ENABLED AP_NETWORKING_ENABLED && AP_SERIALMANAGER_REGISTER_ENABLED
 #endif
+
+/*
+  use batched datagram I/O for UDP ports, so several datagrams are
+  sent and received with one system call. Only worthwhile where
+  system calls are expensive, ie. Linux and SITL
+ */
+#ifndef AP_NETWORKING_PORT_BATCH_ENABLED
+#define AP_NETWORKING_PORT_BATCH_ENABLED (AP_NETWORKING_REGISTER_PORT_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL))
+#endif
+
+// maximum number of datagrams in each direction per send/receive cycle
+#ifndef AP_NETWORKING_PORT_BATCH_COUNT
+#define AP_NETWORKING_PORT_BATCH_COUNT 8
+#endif
@@ -13,6 +13,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_HAL/utility/packetise.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -28,6 +29,9 @@ extern const AP_HAL::HAL& hal;
 #define AP_NETWORKING_PORT_STACK_SIZE 1024
 #endif
 
+// largest datagram sent or received by a port
+#define AP_NETWORKING_PORT_MAX_DATAGRAM 300U
+
 const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
     // @Param: TYPE
     // @DisplayName: Port type
@@ -125,6 +129,11 @@ void AP_Networking::Port::udp_client_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+    // without the batch buffers we fall back to one datagram per call
+    batch_init();
+#endif
+
     thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_client_loop, void));
 }
 
@@ -143,6 +152,11 @@ void AP_Networking::Port::udp_server_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+    // without the batch buffers we fall back to one datagram per call
+    batch_init();
+#endif
+
     thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_server_loop, void));
 }
 
@@ -317,6 +331,11 @@ void AP_Networking::Port::tcp_client_loop(void)
  */
 bool AP_Networking::Port::send_receive(void)
 {
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+    if (batch_buf != nullptr) {
+        return send_receive_batch();
+    }
+#endif
 
     bool active = false;
     uint32_t space;
@@ -328,7 +347,7 @@ bool AP_Networking::Port::send_receive(void)
         space = readbuffer->space();
     }
     if (space > 0) {
-        const uint32_t n = MIN(300U, space);
+        const uint32_t n = MIN(AP_NETWORKING_PORT_MAX_DATAGRAM, space);
         uint8_t buf[n];
         const auto ret = sock->recv(buf, n, 0);
         if (close_on_recv_error && ret == 0) {
@@ -342,6 +361,8 @@ bool AP_Networking::Port::send_receive(void)
             readbuffer->write(buf, ret);
             active = true;
             have_received = true;
+            io_stats.rx_packets++;
+            io_stats.rx_calls++;
         }
     }
 
@@ -352,7 +373,7 @@ bool AP_Networking::Port::send_receive(void)
         {
             WITH_SEMAPHORE(sem);
             available = writebuffer->available();
-            available = MIN(300U, available);
+            available = MIN(AP_NETWORKING_PORT_MAX_DATAGRAM, available);
 #if HAL_GCS_ENABLED
             if (packetise) {
                 available = mavlink_packetise(*writebuffer, available);
@@ -374,22 +395,168 @@ bool AP_Networking::Port::send_receive(void)
                 WITH_SEMAPHORE(sem);
                 writebuffer->advance(ret);
                 active = true;
+                io_stats.tx_packets++;
+                io_stats.tx_calls++;
             }
         }
     } else {
-        if (type == NetworkPortType::UDP_SERVER && have_received) {
-            // connect the socket to the last receive address if we have one
-            char buf[16];
-            uint16_t last_port;
-            const char *last_addr = sock->last_recv_address(buf, sizeof(buf), last_port);
-            if (last_addr != nullptr && port != 0) {
-                connected = sock->connect(last_addr, last_port);
+        connect_to_last_recv();
+    }
+
+    return active;
+}
+
+/*
+  connect a UDP server socket to the last receive address if we have one
+ */
+void AP_Networking::Port::connect_to_last_recv(void)
+{
+    if (type == NetworkPortType::UDP_SERVER && have_received) {
+        char buf[16];
+        uint16_t last_port;
+        const char *last_addr = sock->last_recv_address(buf, sizeof(buf), last_port);
+        if (last_addr != nullptr && port != 0) {
+            connected = sock->connect(last_addr, last_port);
+        }
+    }
+}
+
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+/*
+  allocate buffers for batched UDP I/O
+ */
+bool AP_Networking::Port::batch_init(void)
+{
+    batch_buf = NEW_NOTHROW uint8_t[2 * AP_NETWORKING_PORT_BATCH_COUNT * AP_NETWORKING_PORT_MAX_DATAGRAM];
+    return batch_buf != nullptr;
+}
+
+/*
+  run one send/receive loop on a UDP port, moving up to
+  AP_NETWORKING_PORT_BATCH_COUNT datagrams in each direction with one
+  system call each way
+ */
+bool AP_Networking::Port::send_receive_batch(void)
+{
+    bool active = false;
+    SocketAPM::packet pkts[AP_NETWORKING_PORT_BATCH_COUNT];
+    uint8_t count = 0;
+
+    // handle incoming packets, offering only as many buffers as we
+    // have room for in the readbuffer
+    uint32_t space;
+    {
+        WITH_SEMAPHORE(sem);
+        space = readbuffer->space();
+    }
+    uint8_t *rxbuf = batch_buf;
+    while (count < AP_NETWORKING_PORT_BATCH_COUNT && space > 0) {
+        const uint16_t len = MIN(AP_NETWORKING_PORT_MAX_DATAGRAM, space);
+        pkts[count].buf = &rxbuf[count * AP_NETWORKING_PORT_MAX_DATAGRAM];
+        pkts[count].len = len;
+        space -= len;
+        count++;
+    }
+    if (count > 0) {
+        const int ret = sock->recv_batch(pkts, count);
+        if (ret > 0) {
+            WITH_SEMAPHORE(sem);
+            for (uint8_t i=0; i<ret; i++) {
+                readbuffer->write(pkts[i].buf, pkts[i].len);
             }
+            active = true;
+            have_received = true;
+            io_stats.rx_packets += ret;
+            io_stats.rx_calls++;
         }
     }
 
+    if (!connected) {
+        connect_to_last_recv();
+        return active;
+    }
+
+    // handle outgoing packets, splitting the pending bytes into
+    // datagrams on MAVLink packet boundaries if packetised
+    uint8_t *txbuf = &batch_buf[AP_NETWORKING_PORT_BATCH_COUNT * AP_NETWORKING_PORT_MAX_DATAGRAM];
+    uint32_t available;
+    {
+        WITH_SEMAPHORE(sem);
+        available = writebuffer->peekbytes(txbuf, AP_NETWORKING_PORT_BATCH_COUNT * AP_NETWORKING_PORT_MAX_DATAGRAM);
+    }
+    count = 0;
+    uint32_t ofs = 0;
+    while (count < AP_NETWORKING_PORT_BATCH_COUNT && ofs < available) {
+        uint16_t len = MIN(AP_NETWORKING_PORT_MAX_DATAGRAM, available - ofs);
+#if HAL_GCS_ENABLED
+        if (packetise) {
+            len = mavlink_packetise(&txbuf[ofs], len);
+        }
+#endif
+        if (len == 0) {
+            // waiting for the rest of a MAVLink packet
+            break;
+        }
+        pkts[count].buf = &txbuf[ofs];
+        pkts[count].len = len;
+        ofs += len;
+        count++;
+    }
+    if (count == 0) {
+        return active;
+    }
+    const int ret = sock->send_batch(pkts, count);
+    if (ret > 0) {
+        uint32_t sent = 0;
+        for (uint8_t i=0; i<ret; i++) {
+            sent += pkts[i].len;
+        }
+        WITH_SEMAPHORE(sem);
+        writebuffer->advance(sent);
+        active = true;
+        io_stats.tx_packets += ret;
+        io_stats.tx_calls++;
+    }
     return active;
 }
+#endif // AP_NETWORKING_PORT_BATCH_ENABLED
+
+/*
+  get I/O statistics for all network ports
+ */
+void AP_Networking::ports_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("NETPORTV1\n");
+    for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+        auto &p = ports[i];
+        if (p.sock == nullptr && p.listen_sock == nullptr) {
+            continue;
+        }
+        str.printf("NET_P%u ", unsigned(i+1));
+        p.port_info(str);
+    }
+}
+
+/*
+  get I/O statistics for this port. Only system calls which moved
+  data are counted, so the packets per call shows how well reads and
+  writes are being coalesced
+ */
+void AP_Networking::Port::port_info(ExpandingString &str)
+{
+    str.printf("RXPKT=%8u RX/CALL=%5.2f TXPKT=%8u TX/CALL=%5.2f %s\n",
+               unsigned(io_stats.rx_packets),
+               io_stats.rx_calls ? float(io_stats.rx_packets) / io_stats.rx_calls : 0.0f,
+               unsigned(io_stats.tx_packets),
+               io_stats.tx_calls ? float(io_stats.tx_packets) / io_stats.tx_calls : 0.0f,
+#if AP_NETWORKING_PORT_BATCH_ENABLED
+               batch_buf != nullptr ? "batched" : "unbatched"
+#else
+               "unbatched"
+#endif
+        );
+}
 
 /*
   available space in outgoing buffer
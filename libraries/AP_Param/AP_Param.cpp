@@ -1297,6 +1297,10 @@ void AP_Param::flush(void)
         hal.scheduler->delay(10);
         hal.scheduler->expect_delay_ms(0);
     }
+    // and wait for the storage driver to write them out
+    hal.scheduler->expect_delay_ms(1000);
+    hal.storage->flush();
+    hal.scheduler->expect_delay_ms(0);
 }
 
 // Load the variable from EEPROM, if supported
@@ -142,13 +142,20 @@ bool AP_Rally::find_nearest_rally_point(const Location &current_loc, RallyLocati
 {
     float min_dis = -1;
 
+    // the projection only pays for its setup with two or more rally points
+    const bool use_proj = _rally_point_total_count >= 2;
+    LocationProjection proj;
+    if (use_proj) {
+        proj.set_origin(current_loc);
+    }
+
     for (uint8_t i = 0; i < (uint8_t) _rally_point_total_count; i++) {
         RallyLocation next_rally;
         if (!get_rally_point_with_index(i, next_rally)) {
             continue;
         }
         Location rally_loc = rally_location_to_location(next_rally);
-        float dis = current_loc.get_distance(rally_loc);
+        float dis = use_proj ? proj.get_distance(rally_loc) : current_loc.get_distance(rally_loc);
 
         if (is_valid(rally_loc) && (dis < min_dis || min_dis < 0)) {
             min_dis = dis;
@@ -160,6 +160,22 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @RebootRequired: True
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
+
+    // @Param: CPU_SHARE
+    // @DisplayName: Scripting CPU share
+    // @Description: The share of scripting CPU time any one script can use on average while other scripts are waiting to run. A script which has used more than this is run after the waiting scripts which have not, so a single heavy script cannot delay the others. Scripts are never deferred when nothing else is waiting. The same share applies to every script, there is no per script setting. Zero disables this, running scripts strictly in the order they asked to be run.
+    // @Units: %
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("CPU_SHARE", 15, AP_Scripting, _cpu_share, 0),
+
+    // @Param: DEADLINE
+    // @DisplayName: Scripting deferral deadline
+    // @Description: The longest a script which has used more than SCR_CPU_SHARE can be deferred past the time it asked to be run. The same deadline applies to every script
+    // @Units: ms
+    // @Range: 0 10000
+    // @User: Advanced
+    AP_GROUPINFO("DEADLINE", 16, AP_Scripting, _deadline_ms, 1000),
     
     AP_GROUPEND
 };
@@ -259,17 +275,27 @@ void AP_Scripting::thread(void) {
         _restart = false;
         _init_failed = false;
 
-        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_options);
+        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_options,
+                                                   _cpu_share, _deadline_ms);
         if (lua == nullptr || !lua->heap_allocated()) {
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "Unable to allocate memory");
             _init_failed = true;
         } else {
+            {
+                WITH_SEMAPHORE(lua_sem);
+                _lua = lua;
+            }
+
             // run won't return while scripting is still active
             lua->run();
 
             // only reachable if the lua backend has died for any reason
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "stopped");
         }
+        {
+            WITH_SEMAPHORE(lua_sem);
+            _lua = nullptr;
+        }
         delete lua;
         lua = nullptr;
 
@@ -414,6 +440,15 @@ void AP_Scripting::restart_all()
     _stop = true;
 }
 
+// per script CPU and memory use, for @SYS/scripts.txt
+void AP_Scripting::scripts_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(lua_sem);
+    if (_lua != nullptr) {
+        _lua->scripts_info(str);
+    }
+}
+
 #if HAL_GCS_ENABLED
 void AP_Scripting::handle_message(const mavlink_message_t &msg, const mavlink_channel_t chan) {
     if (mavlink_data.rx_buffer == nullptr) {
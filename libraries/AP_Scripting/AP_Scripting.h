@@ -25,6 +25,7 @@
 #include <AP_HAL/I2CDevice.h>
 #include "AP_Scripting_CANSensor.h"
 #include <AP_Networking/AP_Networking_Config.h>
+#include <AP_Common/ExpandingString.h>
 
 #ifndef SCRIPTING_MAX_NUM_I2C_DEVICE
   #define SCRIPTING_MAX_NUM_I2C_DEVICE 4
@@ -75,6 +76,9 @@ public:
     
     void restart_all(void);
 
+    // per script CPU and memory use, for @SYS/scripts.txt
+    void scripts_info(ExpandingString &str);
+
    // User parameters for inputs into scripts 
    AP_Float _user[6];
 
@@ -170,6 +174,12 @@ private:
     AP_Int32 _required_running_checksum;
 
     AP_Enum<ThreadPriority> _thd_priority;
+    AP_Int8 _cpu_share;
+    AP_Int16 _deadline_ms;
+
+    // the running scripts, for scripts_info()
+    class lua_scripts *_lua;
+    HAL_Semaphore lua_sem;
 
     bool _thread_failed; // thread allocation failed
     bool _init_failed;  // true if memory allocation failed
@@ -2233,6 +2233,10 @@ function vehicle:has_ekf_failsafed() end
 ---@return number|nil
 function vehicle:get_pan_tilt_norm() end
 
+-- desc
+---@return number|nil
+function vehicle:get_wp_time_remaining_s() end
+
 -- desc
 ---@return number|nil
 function vehicle:get_wp_crosstrack_error_m() end
@@ -3223,8 +3227,9 @@ function ahrs:get_relative_position_NED_origin() end
 function ahrs:get_relative_position_NED_home() end
 
 -- Returns nil, or a Vector3f containing the current NED vehicle velocity in meters/second in north, east, and down components.
+---@param vel? Vector3f_ud -- optional Vector3f to fill in and return instead of allocating a new one
 ---@return Vector3f_ud|nil -- North, east, down velcoity in meters / second if available
-function ahrs:get_velocity_NED() end
+function ahrs:get_velocity_NED(vel) end
 
 -- Get current groundspeed vector in meter / second
 ---@return Vector2f_ud -- ground speed vector, North East, meters / second
@@ -3264,12 +3269,14 @@ function ahrs:get_home() end
 
 -- Returns nil or Location userdata that contains the vehicles current position.
 -- Note: This will only return a Location if the system considers the current estimate to be reasonable.
+---@param loc? Location_ud -- optional Location to fill in and return instead of allocating a new one
 ---@return Location_ud|nil -- current location if available
-function ahrs:get_location() end
+function ahrs:get_location(loc) end
 
 -- same as `get_location` will be removed
+---@param loc? Location_ud
 ---@return Location_ud|nil
-function ahrs:get_position() end
+function ahrs:get_position(loc) end
 
 -- Returns the current vehicle euler yaw angle in radians.
 ---@return number -- yaw angle in radians.
@@ -0,0 +1,56 @@
+--[[
+ micro-benchmark of the binding overhead of commonly polled methods,
+ comparing calls which allocate a new userdata for the result with
+ calls which fill in an existing userdata passed as the last argument
+
+ keep ITERATIONS low enough that a run fits in SCR_VM_I_COUNT
+--]]
+
+local MAV_SEVERITY_INFO = 6
+
+local ITERATIONS = 100
+local REPORT_MS = 5000
+
+local loc = Location()
+local vel = Vector3f()
+
+local totals = {}
+local runs = 0
+local last_report_ms = millis()
+
+-- time ITERATIONS calls of fn in microseconds
+local function time_us(fn)
+   local t0 = micros()
+   for _ = 1, ITERATIONS do
+      fn()
+   end
+   return (micros() - t0):toint()
+end
+
+local tests = {
+   { "get_location",       function() return ahrs:get_location() end },
+   { "get_location(loc)",  function() return ahrs:get_location(loc) end },
+   { "get_velocity",       function() return ahrs:get_velocity_NED() end },
+   { "get_velocity(vel)",  function() return ahrs:get_velocity_NED(vel) end },
+   { "get_pwm",            function() return rc:get_pwm(1) end },
+}
+
+function update()
+   for i = 1, #tests do
+      totals[i] = (totals[i] or 0) + time_us(tests[i][2])
+   end
+   runs = runs + 1
+
+   local now_ms = millis()
+   if now_ms - last_report_ms >= REPORT_MS then
+      last_report_ms = now_ms
+      for i = 1, #tests do
+         gcs:send_text(MAV_SEVERITY_INFO, string.format("%s: %.2fus/call", tests[i][1], totals[i] / (runs * ITERATIONS)))
+         totals[i] = 0
+      end
+      runs = 0
+   end
+   return update, 100
+end
+
+return update()
@@ -0,0 +1,50 @@
+/*
+  support functions for building luac on the host, used to precompile
+  scripts embedded in ROMFS. Built with LUA_32BITS to match the lua
+  configuration used on boards
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../lua/src/lua.h"
+#include "../../lua/src/lauxlib.h"
+
+static void *l_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+    (void)ud; (void)osize;
+    if (nsize == 0) {
+        free(ptr);
+        return NULL;
+    }
+    return realloc(ptr, nsize);
+}
+
+static int panic(lua_State *L)
+{
+    fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(L, -1));
+    return 0;
+}
+
+lua_State *luaL_newstate(void)
+{
+    lua_State *L = lua_newstate(l_alloc, NULL);
+    if (L != NULL) {
+        lua_atpanic(L, &panic);
+    }
+    return L;
+}
+
+int lua_get_current_ref(void)
+{
+    return 0;
+}
+
+const char *lua_get_modules_path(void)
+{
+    return "";
+}
+
+void lua_abort(void)
+{
+    abort();
+}
@@ -31,6 +31,7 @@ char keyword_manual[]              = "manual";
 char keyword_global[]              = "global";
 char keyword_creation[]            = "creation";
 char keyword_manual_operator[]     = "manual_operator";
+char keyword_fast[]                = "fast";
 
 // attributes (should include the leading ' )
 char keyword_attr_enum[]    = "'enum";
@@ -348,6 +349,7 @@ struct method {
   char *sanatized_name;  // sanatized name of the C++ singleton
   char *rename; // (optional) used for scripting access
   char *deprecate; // (optional) issue deprecateion warning string on first call
+  int fast; // (optional) hot method, allow userdata results to be written into existing userdata
   int line; // line declared on
   struct type return_type;
   struct argument * arguments;
@@ -808,6 +810,10 @@ void handle_method(struct userdata *node) {
       string_copy(&(method->dependency), dependency);
       return;
 
+    } else if (strcmp(token, keyword_fast) == 0) {
+      method->fast = TRUE;
+      return;
+
     }
     error(ERROR_USERDATA, "Method %s already exists for %s (declared on %d)", name, parent_name, method->line);
   }
@@ -1715,7 +1721,7 @@ void emit_field(const struct userdata_field *field, const char* object_name, con
       case TYPE_USERDATA:
           // userdatas must allocate a new container to return
           fprintf(source, "%snew_%s(L);\n", indent, field->type.data.ud.sanatized_name);
-          fprintf(source, "%s*check_%s(L, -1) = %s%s%s%s;\n", indent, field->type.data.ud.sanatized_name, object_name, object_access, field->name, index_string);
+          fprintf(source, "%s*static_cast<%s *>(lua_touserdata(L, -1)) = %s%s%s%s;\n", indent, field->type.data.ud.name, object_name, object_access, field->name, index_string);
         break;
       case TYPE_AP_OBJECT: // FIXME: collapse the identical cases here, and use the type string function
         error(ERROR_USERDATA, "AP_Object does not currently support access to userdata field's");
@@ -1798,8 +1804,25 @@ void emit_singleton_fields() {
   }
 }
 
+// emit a userdata result, written into the callers userdata if one was passed to a fast method
+void emit_userdata_result(const struct type *type, const char *value, const char *out, const char *tab) {
+  if (out != NULL) {
+    fprintf(source, "%sif (%s != nullptr) {\n", tab, out);
+    fprintf(source, "%s    *%s = %s;\n", tab, out, value);
+    fprintf(source, "%s    lua_pushvalue(L, %s_arg);\n", tab, out);
+    fprintf(source, "%s} else {\n", tab);
+    fprintf(source, "%s    new_%s(L);\n", tab, type->data.ud.sanatized_name);
+    fprintf(source, "%s    *static_cast<%s *>(lua_touserdata(L, -1)) = %s;\n", tab, type->data.ud.name, value);
+    fprintf(source, "%s}\n", tab);
+  } else {
+    // userdatas must allocate a new container to return
+    fprintf(source, "%snew_%s(L);\n", tab, type->data.ud.sanatized_name);
+    fprintf(source, "%s*static_cast<%s *>(lua_touserdata(L, -1)) = %s;\n", tab, type->data.ud.name, value);
+  }
+}
+
 // emit refences functions for a call, return the number of arduments added
-int emit_references(const struct argument *arg, const char * tab) {
+int emit_references(const struct argument *arg, const char * tab, int fast) {
   int arg_index = NULLABLE_ARG_COUNT_BASE + 2;
   int return_count = 0;
   while (arg != NULL) {
@@ -1827,11 +1850,14 @@ int emit_references(const struct argument *arg, const char * tab) {
         case TYPE_STRING:
           fprintf(source, "%slua_pushstring(L, data_%d);\n", tab, arg_index);
           break;
-        case TYPE_USERDATA:
-          // userdatas must allocate a new container to return
-          fprintf(source, "%snew_%s(L);\n", tab, arg->type.data.ud.sanatized_name);
-          fprintf(source, "%s*check_%s(L, -1) = data_%d;\n", tab, arg->type.data.ud.sanatized_name, arg_index);
+        case TYPE_USERDATA: {
+          char value[20];
+          char out[20];
+          sprintf(value, "data_%d", arg_index);
+          sprintf(out, "out_%d", arg_index);
+          emit_userdata_result(&(arg->type), value, fast ? out : NULL, tab);
           break;
+        }
         case TYPE_NONE:
           error(ERROR_INTERNAL, "Attempted to emit a nullable or reference  argument of type none");
           break;
@@ -1883,7 +1909,34 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
     }
     arg = arg->next;
   }
-  fprintf(source, "    binding_argcheck(L, %d);\n", arg_count);
+  const int input_count = arg_count;
+
+  // fast methods accept an optional trailing userdata for each userdata result to be written into
+  int reuse_count = 0;
+  if (method->fast) {
+    reuse_count += (method->return_type.type == TYPE_USERDATA) ? 1 : 0;
+    arg = method->arguments;
+    while (arg != NULL) {
+      if ((arg->type.flags & (TYPE_FLAGS_NULLABLE | TYPE_FLAGS_REFERNCE)) && (arg->type.type == TYPE_USERDATA)) {
+        reuse_count++;
+      }
+      arg = arg->next;
+    }
+  }
+
+  if (reuse_count > 0) {
+    fprintf(source, "    const bool reuse = lua_gettop(L) > %d;\n", input_count);
+    fprintf(source, "    if (lua_gettop(L) != (reuse ? %d : %d)) {\n", input_count + reuse_count, input_count);
+    fprintf(source, "        binding_argcheck(L, reuse ? %d : %d);\n", input_count + reuse_count, input_count);
+    fprintf(source, "    }\n");
+  } else if (method->fast) {
+    // only call out for the error
+    fprintf(source, "    if (lua_gettop(L) != %d) {\n", input_count);
+    fprintf(source, "        binding_argcheck(L, %d);\n", input_count);
+    fprintf(source, "    }\n");
+  } else {
+    fprintf(source, "    binding_argcheck(L, %d);\n", input_count);
+  }
 
   switch (data->ud_type) {
     case UD_USERDATA:
@@ -1917,6 +1970,27 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
     arg = arg->next;
   }
 
+  // check the userdata to be reused before taking any semaphore, as a failed check will not return
+  if (reuse_count > 0) {
+    int reuse_arg = input_count + 1;
+    if (method->return_type.type == TYPE_USERDATA) {
+      fprintf(source, "    const int out_data_arg = %d;\n", reuse_arg);
+      fprintf(source, "    %s *out_data = reuse ? check_%s(L, out_data_arg) : nullptr;\n", method->return_type.data.ud.name, method->return_type.data.ud.sanatized_name);
+      reuse_arg++;
+    }
+    arg = method->arguments;
+    int arg_index = NULLABLE_ARG_COUNT_BASE + 2;
+    while (arg != NULL) {
+      if ((arg->type.flags & (TYPE_FLAGS_NULLABLE | TYPE_FLAGS_REFERNCE)) && (arg->type.type == TYPE_USERDATA)) {
+        fprintf(source, "    const int out_%d_arg = %d;\n", arg_index, reuse_arg);
+        fprintf(source, "    %s *out_%d = reuse ? check_%s(L, out_%d_arg) : nullptr;\n", arg->type.data.ud.name, arg_index, arg->type.data.ud.sanatized_name, arg_index);
+        reuse_arg++;
+      }
+      arg_index++;
+      arg = arg->next;
+    }
+  }
+
   const char *ud_name = (data->flags & UD_FLAG_LITERAL)?data->name:"ud";
   const char *ud_access = (data->flags & UD_FLAG_REFERENCE)?".":"->";
 
@@ -2069,7 +2143,7 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
   if (method->flags & TYPE_FLAGS_REFERNCE) {
     arg = method->arguments;
     // number of arguments to return
-    return_count += emit_references(arg,"    ");
+    return_count += emit_references(arg,"    ", method->fast);
   }
 
   switch (method->return_type.type) {
@@ -2078,7 +2152,7 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
         fprintf(source, "    if (data) {\n");
         // we need to emit out nullable arguments, iterate the args again, creating and copying objects, while keeping a new count
         arg = method->arguments;
-        return_count = emit_references(arg,"        ");
+        return_count = emit_references(arg,"        ", method->fast);
         fprintf(source, "        return %d;\n", return_count);
         fprintf(source, "    }\n");
         fprintf(source, "    return 0;\n");
@@ -2105,9 +2179,7 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
       fprintf(source, "    lua_pushstring(L, data);\n");
       break;
     case TYPE_USERDATA:
-      // userdatas must allocate a new container to return
-      fprintf(source, "    new_%s(L);\n", method->return_type.data.ud.sanatized_name);
-      fprintf(source, "    *check_%s(L, -1) = data;\n", method->return_type.data.ud.sanatized_name);
+      emit_userdata_result(&(method->return_type), "data", method->fast ? "out_data" : NULL, "    ");
       break;
     case TYPE_AP_OBJECT:
       fprintf(source, "    if (data == NULL) {\n");
@@ -2193,7 +2265,7 @@ void emit_operators(struct userdata *data) {
     fprintf(source, "    %s *ud2 = check_%s(L, 2);\n", data->name, data->sanatized_name);
     // create a container for the result
     fprintf(source, "    new_%s(L);\n", data->sanatized_name);
-    fprintf(source, "    *check_%s(L, -1) = *ud %c *ud2;\n", data->sanatized_name, op_sym);
+    fprintf(source, "    *static_cast<%s *>(lua_touserdata(L, -1)) = *ud %c *ud2;\n", data->name, op_sym);
     // return the first pointer
     fprintf(source, "    return 1;\n");
     fprintf(source, "}\n\n");
@@ -2653,6 +2725,29 @@ void emit_docs_method(const char *name, const char *method_name, struct method *
     arg = arg->next;
   }
 
+  // optional userdata to write results into for fast methods
+  int optional_count = 0;
+  if (method->fast) {
+    if (method->return_type.type == TYPE_USERDATA) {
+      char *param_name = (char *)allocate(20);
+      sprintf(param_name, "---@param param%i?", count + optional_count);
+      emit_docs_param_type(method->return_type, param_name, "\n");
+      free(param_name);
+      optional_count++;
+    }
+    arg = method->arguments;
+    while (arg != NULL) {
+      if ((arg->type.type == TYPE_USERDATA) && (arg->type.flags & (TYPE_FLAGS_NULLABLE | TYPE_FLAGS_REFERNCE))) {
+        char *param_name = (char *)allocate(20);
+        sprintf(param_name, "---@param param%i?", count + optional_count);
+        emit_docs_param_type(arg->type, param_name, "\n");
+        free(param_name);
+        optional_count++;
+      }
+      arg = arg->next;
+    }
+  }
+
   // return type
   if ((method->flags & TYPE_FLAGS_NULLABLE) == 0) {
     emit_docs_return_type(method->return_type, FALSE);
@@ -2669,6 +2764,7 @@ void emit_docs_method(const char *name, const char *method_name, struct method *
 
   // function name
   fprintf(docs, "function %s:%s(", name, method_name);
+  count += optional_count;
   for (int i = 1; i < count; ++i) {
     fprintf(docs, "param%i", i);
     if (i < count-1) {
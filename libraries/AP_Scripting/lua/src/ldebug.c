@@ -108,6 +108,11 @@ LUA_API int lua_gethookcount (lua_State *L) {
 }
 
 
+LUA_API int lua_gethookcountleft (lua_State *L) {
+  return L->hookcount;
+}
+
+
 LUA_API int lua_getstack (lua_State *L, int level, lua_Debug *ar) {
   int status;
   CallInfo *ci;
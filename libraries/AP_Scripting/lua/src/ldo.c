@@ -777,9 +777,10 @@ static void f_parser (lua_State *L, void *ud) {
   struct SParser *p = cast(struct SParser *, ud);
   int c = zgetc(p->z);  /* read first character */
 #if LUA_SUPPORT_LOAD_BINARY
-  // support loading pre-compiled luac
+  // support loading pre-compiled luac, only when the caller
+  // explicitly asks for binary chunks
   if (c == LUA_SIGNATURE[0]) {
-    checkmode(L, p->mode, "binary");
+    checkmode(L, p->mode != NULL ? p->mode : "t", "binary");
     cl = luaU_undump(L, p->z, p->name);
   }
   else
@@ -79,8 +79,9 @@ static void DumpString (const TString *s, DumpState *D) {
     if (size < 0xFF)
       DumpByte(cast_int(size), D);
     else {
+      luaU_size dsize = cast(luaU_size, size);
       DumpByte(0xFF, D);
-      DumpVar(size, D);
+      DumpVar(dsize, D);
     }
     DumpVector(str, size - 1, D);  /* no need to save '\0' */
   }
@@ -187,7 +188,7 @@ static void DumpHeader (DumpState *D) {
   DumpByte(LUAC_FORMAT, D);
   DumpLiteral(LUAC_DATA, D);
   DumpByte(sizeof(int), D);
-  DumpByte(sizeof(size_t), D);
+  DumpByte(sizeof(luaU_size), D);
   DumpByte(sizeof(Instruction), D);
   DumpByte(sizeof(lua_Integer), D);
   DumpByte(sizeof(lua_Number), D);
@@ -43,8 +43,11 @@
 
 #endif
 
-// load posix compatibility functions
+// load posix compatibility functions, except in the host luac used to
+// precompile scripts at build time
+#if !defined(LUA_HOST_TOOL)
 #include <AP_Filesystem/posix_compat.h>
+#endif
 
 #define lua_writestring(s,l) printf("%s", s)
 #define lua_writestringerror(s,l) lua_writestring(s,l)
@@ -436,6 +436,8 @@ LUA_API void (lua_sethook) (lua_State *L, lua_Hook func, int mask, int count);
 LUA_API lua_Hook (lua_gethook) (lua_State *L);
 LUA_API int (lua_gethookmask) (lua_State *L);
 LUA_API int (lua_gethookcount) (lua_State *L);
+// instructions left before the count hook is next called
+LUA_API int (lua_gethookcountleft) (lua_State *L);
 
 
 struct lua_Debug {
@@ -12,7 +12,10 @@
 #include <stddef.h>
 
 /*
-  don't support binary load() by default
+  don't support binary load() by default. Builds configured with
+  --scripting-precompile enable it for the bytecode embedded in ROMFS,
+  binary chunks are only accepted when the loader explicitly gives a
+  mode containing 'b', so load() stays source only
  */
 #ifndef LUA_SUPPORT_LOAD_BINARY
 #define LUA_SUPPORT_LOAD_BINARY 0
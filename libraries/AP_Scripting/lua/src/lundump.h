@@ -22,6 +22,12 @@
 #define LUAC_VERSION	(MYINT(LUA_VERSION_MAJOR)*16+MYINT(LUA_VERSION_MINOR))
 #define LUAC_FORMAT	0	/* this is the official format */
 
+/*
+** long string lengths are dumped as 32 bits rather than size_t, so
+** chunks precompiled on a 64 bit host load on 32 bit boards
+*/
+typedef unsigned int luaU_size;
+
 /* load one chunk; from lundump.c */
 LUAI_FUNC LClosure* luaU_undump (lua_State* L, ZIO* Z, const char* name);
 
@@ -35,14 +35,18 @@ char *lua_scripts::error_msg_buf;
 HAL_Semaphore lua_scripts::error_msg_buf_sem;
 uint8_t lua_scripts::print_error_count;
 uint32_t lua_scripts::last_print_ms;
+uint32_t lua_scripts::alloc_count;
 
 uint32_t lua_scripts::loaded_checksum;
 uint32_t lua_scripts::running_checksum;
 HAL_Semaphore lua_scripts::crc_sem;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_options)
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_options,
+                         const AP_Int8 &cpu_share, const AP_Int16 &deadline_ms)
     : _vm_steps(vm_steps),
-      _debug_options(debug_options)
+      _debug_options(debug_options),
+      _cpu_share(cpu_share),
+      _deadline_ms(deadline_ms)
 {
     _heap.create(heap_size, 4);
 }
@@ -127,13 +131,16 @@ int lua_scripts::atpanic(lua_State *L) {
 }
 
 // helper for print and log of runtime stats
-void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem)
+void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem,
+                               uint32_t instructions, uint32_t alloc_bytes, uint32_t late_ms)
 {
     if ((_debug_options.get() & uint8_t(DebugLevel::RUNTIME_MSG)) != 0) {
-        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d",
+        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d Insns: %u Alloc: %u",
                                             (unsigned int)run_time,
                                             (int)total_mem,
-                                            (int)run_mem);
+                                            (int)run_mem,
+                                            (unsigned int)instructions,
+                                            (unsigned int)alloc_bytes);
     }
 #if HAL_LOGGING_ENABLED
     if ((_debug_options.get() & uint8_t(DebugLevel::LOG_RUNTIME)) != 0) {
@@ -143,7 +150,10 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
             name         : {},
             run_time     : run_time,
             total_mem    : total_mem,
-            run_mem      : run_mem
+            run_mem      : run_mem,
+            instructions : instructions,
+            alloc_bytes  : alloc_bytes,
+            late_ms      : uint16_t(MIN(late_ms, uint32_t(UINT16_MAX)))
         };
         const char * name_short = strrchr(name, '/');
         if ((strlen(name) > sizeof(pkt.name)) && (name_short != nullptr)) {
@@ -156,8 +166,36 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
 #endif // HAL_LOGGING_ENABLED
 }
 
+// return true if filename ends in the given extension
+static bool has_extension(const char *filename, const char *ext)
+{
+    const size_t len = strlen(filename);
+    const size_t ext_len = strlen(ext);
+    return len > ext_len && strcmp(&filename[len-ext_len], ext) == 0;
+}
+
+#define SCRIPTING_ROMFS_DIRECTORY "@ROMFS/scripts"
+
+#if LUA_SUPPORT_LOAD_BINARY
+// precompiled scripts are only trusted from ROMFS, the undump has no
+// verifier so bytecode from writable storage could corrupt memory
+static bool precompiled_allowed(const char *filename)
+{
+    return strncmp(filename, SCRIPTING_ROMFS_DIRECTORY "/", strlen(SCRIPTING_ROMFS_DIRECTORY "/")) == 0 &&
+           has_extension(filename, ".luac");
+}
+#endif
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // only precompiled scripts from ROMFS are loaded as bytecode,
+    // anything else must be source
+    const char *mode = "t";
+#if LUA_SUPPORT_LOAD_BINARY
+    if (precompiled_allowed(filename)) {
+        mode = "b";
+    }
+#endif
+    if (int error = luaL_loadfilex(L, filename, mode)) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Error: %s", lua_tostring(L, -1));
@@ -180,6 +218,7 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
 
     const int loadMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
     const uint32_t loadStart = AP_HAL::micros();
+    const uint32_t loadAlloc = alloc_count;
 
     script_info *new_script = (script_info *)_heap.allocate(sizeof(script_info));
     if (new_script == nullptr) {
@@ -196,11 +235,15 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     const uint32_t loadEnd = AP_HAL::micros();
     const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
 
-    update_stats(filename, loadEnd-loadStart, endMem, loadMem);
+    update_stats(filename, loadEnd-loadStart, endMem, loadMem, 0, alloc_count-loadAlloc, 0);
 
     new_script->name = filename;
     new_script->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);   // cache the reference
     new_script->next_run_ms = AP_HAL::millis64() - 1; // force the script to be stale
+    new_script->stats = {};
+    new_script->stats.load_ms = AP_HAL::millis();
+    new_script->budget_us = 0;
+    new_script->budget_update_us = AP_HAL::micros64();
 
     // Get checksum of file
     uint32_t crc = 0;
@@ -260,17 +303,20 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
         return;
     }
 
-    // load anything that ends in .lua
+    // load anything that ends in .lua, or .luac for precompiled scripts in ROMFS
     for (struct dirent *de=AP::FS().readdir(d); de; de=AP::FS().readdir(d)) {
-        uint8_t length = strlen(de->d_name);
-        if (length < 5) {
-            // not long enough
-            continue;
-        }
-
-        if (strncmp(&de->d_name[length-4], ".lua", 4)) {
+        bool precompiled = false;
+        if (!has_extension(de->d_name, ".lua")) {
+#if LUA_SUPPORT_LOAD_BINARY
+            if (strcmp(dirname, SCRIPTING_ROMFS_DIRECTORY) != 0 ||
+                !has_extension(de->d_name, ".luac")) {
+                continue;
+            }
+            precompiled = true;
+#else
             // doesn't end in .lua
             continue;
+#endif
         }
 
         // FIXME: because chunk name fetching is not working we are allocating and storing an extra string we shouldn't need to
@@ -281,6 +327,20 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
         }
         snprintf(filename, size, "%s/%s", dirname, de->d_name);
 
+        if (precompiled) {
+            // if the source is also present it is loaded instead, so a
+            // script being edited is not shadowed by a stale compile
+            const size_t len = strlen(filename);
+            filename[len-1] = 0;
+            struct stat st;
+            const bool have_source = AP::FS().stat(filename, &st) == 0;
+            filename[len-1] = 'c';
+            if (have_source) {
+                _heap.deallocate(filename);
+                continue;
+            }
+        }
+
         // we have something that looks like a lua file, attempt to load it
         script_info * script = load_script(L, filename);
         if (script == nullptr) {
@@ -298,28 +358,29 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
     AP::FS().closedir(d);
 }
 
-void lua_scripts::reset_loop_overtime(lua_State *L) {
+int32_t lua_scripts::reset_loop_overtime(lua_State *L) {
     overtime = false;
     // reset the hook to clear the counter
     const int32_t vm_steps = MAX(_vm_steps, 1000);
     lua_sethook(L, hook, LUA_MASKCOUNT, vm_steps);
+    return vm_steps;
 }
 
-void lua_scripts::run_next_script(lua_State *L) {
-    if (scripts == nullptr) {
+void lua_scripts::run_next_script(lua_State *L, script_info *script) {
+    if (script == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         AP_HAL::panic("Lua: Attempted to run a script without any scripts queued");
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         return;
     }
 
+    // the script stays in the list while it runs so it is still
+    // reported by scripts_info(), and is unlinked when rescheduled
     uint64_t start_time_ms = AP_HAL::millis64();
-    // strip the selected script out of the list
-    script_info *script = scripts;
-    scripts = script->next;
+    const uint32_t late_ms = start_time_ms > script->next_run_ms ? start_time_ms - script->next_run_ms : 0;
 
     // reset the hook to clear the counter
-    reset_loop_overtime(L);
+    const int32_t vm_steps = reset_loop_overtime(L);
 
     // store top of stack so we can calculate the number of return values
     int stack_top = lua_gettop(L);
@@ -328,7 +389,20 @@ void lua_scripts::run_next_script(lua_State *L) {
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
     AP::scripting()->set_current_ref(script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    const uint32_t startAlloc = alloc_count;
+    const uint32_t startUs = AP_HAL::micros();
+
+    const int status = lua_pcall(L, 0, LUA_MULTRET, 0);
+
+    const uint32_t runTime = AP_HAL::micros() - startUs;
+    const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    const uint32_t instructions = overtime ? vm_steps : vm_steps - lua_gethookcountleft(L);
+
+    account_run(script, runTime, instructions, alloc_count - startAlloc, late_ms);
+    update_stats(script->name, runTime, endMem, endMem - startMem, instructions, alloc_count - startAlloc, late_ms);
+
+    if (status) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s exceeded time limit", script->name);
@@ -362,6 +436,7 @@ void lua_scripts::run_next_script(lua_State *L) {
                     }
 
                     // types match the expectations, go ahead and reschedule
+                    unlink_script(script);
                     script->next_run_ms = start_time_ms + (uint64_t)luaL_checknumber(L, -1);
                     lua_pop(L, 1);
                     int old_ref = script->lua_ref;
@@ -382,12 +457,8 @@ void lua_scripts::run_next_script(lua_State *L) {
      }
 }
 
-void lua_scripts::remove_script(lua_State *L, script_info *script) {
-    if (script == nullptr) {
-        return;
-    }
-
-    // ensure that the script isn't in the loaded list for any reason
+void lua_scripts::unlink_script(script_info *script) {
+    WITH_SEMAPHORE(scripts_sem);
     if (scripts == nullptr) {
         // nothing to do, already not in the list
     } else if (scripts == script) {
@@ -400,6 +471,15 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
             }
         }
     }
+}
+
+void lua_scripts::remove_script(lua_State *L, script_info *script) {
+    if (script == nullptr) {
+        return;
+    }
+
+    // ensure that the script isn't in the loaded list for any reason
+    unlink_script(script);
 
     {
         // Remove from running checksum
@@ -423,6 +503,8 @@ void lua_scripts::reschedule_script(script_info *script) {
        return;
     }
 
+    WITH_SEMAPHORE(scripts_sem);
+
     script->next = nullptr;
     if (scripts == nullptr) {
         scripts = script;
@@ -450,11 +532,100 @@ void lua_scripts::reschedule_script(script_info *script) {
     previous->next = script;
 }
 
+/*
+  choose the script to run from those that are due. With SCR_CPU_SHARE
+  set a script which has used more than its share of CPU time is
+  passed over in favour of due scripts which have not, unless it is
+  already SCR_DEADLINE late. This stops one heavy script from
+  delaying the others, while still running it whenever nothing else
+  is waiting
+ */
+lua_scripts::script_info *lua_scripts::select_script(uint64_t now_us)
+{
+    const int8_t share = _cpu_share.get();
+    if (share <= 0 || share >= 100) {
+        return scripts;
+    }
+    const uint64_t now_ms = now_us / 1000;
+    const uint64_t deadline_ms = MAX(_deadline_ms.get(), 0);
+
+    WITH_SEMAPHORE(scripts_sem);
+    for (script_info *script = scripts; script != nullptr && script->next_run_ms <= now_ms; script = script->next) {
+        update_budget(script, now_us, share);
+        if (script->budget_us >= 0 || now_ms - script->next_run_ms >= deadline_ms) {
+            return script;
+        }
+        script->stats.deferred++;
+    }
+
+    // everything due is over its share, run the soonest
+    return scripts;
+}
+
+void lua_scripts::update_budget(script_info *script, uint64_t now_us, uint8_t share)
+{
+    const int64_t credit = (now_us - script->budget_update_us) * share / 100;
+    script->budget_update_us = now_us;
+    script->budget_us = constrain_int64(script->budget_us + credit,
+                                        -SCRIPT_BUDGET_WINDOW_US,
+                                        SCRIPT_BUDGET_WINDOW_US * share / 100);
+}
+
+void lua_scripts::account_run(script_info *script, uint32_t run_time_us, uint32_t instructions,
+                              uint32_t alloc_bytes, uint32_t late_ms)
+{
+    WITH_SEMAPHORE(scripts_sem);
+    auto &stats = script->stats;
+    stats.runs++;
+    stats.run_time_us += run_time_us;
+    stats.max_run_time_us = MAX(stats.max_run_time_us, run_time_us);
+    stats.instructions += instructions;
+    stats.alloc_bytes += alloc_bytes;
+    stats.max_late_ms = MAX(stats.max_late_ms, late_ms);
+    script->budget_us = MAX(int64_t(script->budget_us) - run_time_us, -SCRIPT_BUDGET_WINDOW_US);
+}
+
+/*
+  report per script CPU and memory use, for @SYS/scripts.txt
+ */
+void lua_scripts::scripts_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("ScriptsV1\n");
+    const uint32_t now_ms = AP_HAL::millis();
+    WITH_SEMAPHORE(scripts_sem);
+    for (const script_info *script = scripts; script != nullptr; script = script->next) {
+        const auto &stats = script->stats;
+        const char *name = strrchr(script->name, '/');
+        const float age_s = MAX(now_ms - stats.load_ms, 1U) * 0.001f;
+        str.printf("%-20s RUNS=%7u CPU=%9.1fms CPU%%=%5.2f AVG=%6uus MAX=%7uus KINSNS=%8u ALLOC=%7.2fkB/s LATE=%5ums DEFER=%5u\n",
+                   name != nullptr ? name+1 : script->name,
+                   unsigned(stats.runs),
+                   stats.run_time_us * 0.001f,
+                   stats.run_time_us * 1.0e-4f / age_s,
+                   unsigned(stats.runs ? stats.run_time_us / stats.runs : 0),
+                   unsigned(stats.max_run_time_us),
+                   unsigned(stats.instructions / 1000),
+                   stats.alloc_bytes * 0.001f / age_s,
+                   unsigned(stats.max_late_ms),
+                   unsigned(stats.deferred));
+    }
+}
+
 MultiHeap lua_scripts::_heap;
 
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
     (void)ud; /* not used */
-    return _heap.change_size(ptr, osize, nsize);
+    void *ret = _heap.change_size(ptr, osize, nsize);
+    if (ret != nullptr) {
+        // for new objects osize is the object type, not a size
+        if (ptr == nullptr) {
+            alloc_count += nsize;
+        } else if (nsize > osize) {
+            alloc_count += nsize - osize;
+        }
+    }
+    return ret;
 }
 
 void lua_scripts::run(void) {
@@ -510,7 +681,7 @@ void lua_scripts::run(void) {
     }
 #ifdef HAL_HAVE_AP_ROMFS_EMBEDDED_LUA
     if ((dir_disable & uint16_t(AP_Scripting::SCR_DIR::ROMFS)) == 0) {
-        load_all_scripts_in_dir(L, "@ROMFS/scripts");
+        load_all_scripts_in_dir(L, SCRIPTING_ROMFS_DIRECTORY);
         loaded = true;
     }
 #endif
@@ -545,32 +716,25 @@ void lua_scripts::run(void) {
             uint64_t now_ms = AP_HAL::millis64();
             if (now_ms < scripts->next_run_ms) {
                 hal.scheduler->delay(scripts->next_run_ms - now_ms);
+                now_ms = AP_HAL::millis64();
             }
 
+            script_info *script = select_script(AP_HAL::micros64());
+
             if ((_debug_options.get() & uint8_t(DebugLevel::RUNTIME_MSG)) != 0) {
-                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", scripts->name);
+                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", script->name);
             }
-            // copy name for logging, cant do it after as script reschedule moves the pointers
-            const char * script_name = scripts->name;
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             void *istate = hal.scheduler->disable_interrupts_save();
 #endif
 
-            const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-            const uint32_t loadEnd = AP_HAL::micros();
-
-            run_next_script(L);
-
-            const uint32_t runEnd = AP_HAL::micros();
-            const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+            run_next_script(L, script);
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             hal.scheduler->restore_interrupts(istate);
 #endif
 
-            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem);
-
 
             // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
             lua_gc(L, LUA_GCCOLLECT, 0);
@@ -27,14 +27,20 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_HAL/Semaphores.h>
 #include <AP_Common/MultiHeap.h>
+#include <AP_Common/ExpandingString.h>
 #include "lua_common_defs.h"
 
 #include "lua/src/lua.hpp"
 
+// scripts can bank at most one second's worth of their CPU share, and
+// owe at most one second of CPU time
+#define SCRIPT_BUDGET_WINDOW_US 1000000
+
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_options);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_options,
+                const AP_Int8 &cpu_share, const AP_Int16 &deadline_ms);
 
     ~lua_scripts();
 
@@ -46,6 +52,9 @@ public:
     // run scripts, does not return unless an error occured
     void run(void);
 
+    // report per script CPU and memory use
+    void scripts_info(ExpandingString &str);
+
     static bool overtime; // script exceeded it's execution slot, and we are bailing out
 
     enum class DebugLevel {
@@ -57,32 +66,62 @@ public:
         SAVE_CHECKSUM = 1U << 5,
     };
 
-private:
-
-    void create_sandbox(lua_State *L);
-
+protected:
+    // the scheduling is protected so it can be tested without running scripts
     typedef struct script_info {
        int lua_ref;          // reference to the loaded script object
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        uint32_t crc;         // crc32 checksum
        char *name;           // filename for the script // FIXME: This information should be available from Lua
+       struct {
+           uint64_t run_time_us;     // total time spent running
+           uint64_t instructions;    // total VM instructions run
+           uint64_t alloc_bytes;     // total bytes allocated
+           uint32_t runs;            // number of times run
+           uint32_t max_run_time_us; // longest single run
+           uint32_t max_late_ms;     // longest delay past the requested run time
+           uint32_t deferred;        // times passed over for using more than its CPU share
+           uint32_t load_ms;         // time the script was loaded
+       } stats;
+       int32_t budget_us;          // CPU time the script can use before being deferred
+       uint64_t budget_update_us;  // time budget_us was last credited
        script_info *next;
     } script_info;
 
+    // reschedule the script for execution. It is assumed the script is not in the list already
+    void reschedule_script(script_info *script);
+
+    // choose the script to run from those which are due
+    script_info *select_script(uint64_t now_us);
+
+    // credit a script with its share of the time since it was last credited
+    void update_budget(script_info *script, uint64_t now_us, uint8_t share);
+
+    // record the cost of one run of a script
+    void account_run(script_info *script, uint32_t run_time_us, uint32_t instructions,
+                     uint32_t alloc_bytes, uint32_t late_ms);
+
+    script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
+    // protects the script list and stats, which are read by scripts_info()
+    HAL_Semaphore scripts_sem;
+
+private:
+
+    void create_sandbox(lua_State *L);
+
     script_info *load_script(lua_State *L, char *filename);
 
-    void reset_loop_overtime(lua_State *L);
+    // reset the instruction count hook, returning the instruction budget
+    int32_t reset_loop_overtime(lua_State *L);
 
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
-    void run_next_script(lua_State *L);
+    void run_next_script(lua_State *L, script_info *script);
 
     void remove_script(lua_State *L, script_info *script);
 
-    // reschedule the script for execution. It is assumed the script is not in the list already
-    void reschedule_script(script_info *script);
-
-    script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
+    // remove the script from the list of scripts to be run, if it is in it
+    void unlink_script(script_info *script);
 
     // hook will be run when CPU time for a script is exceeded
     // it must be static to be passed to the C API
@@ -96,13 +135,18 @@ private:
 
     const AP_Int32 & _vm_steps;
     const AP_Int8 & _debug_options;
+    const AP_Int8 & _cpu_share;
+    const AP_Int16 & _deadline_ms;
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+    // total bytes allocated by scripts, wraps
+    static uint32_t alloc_count;
 
     static MultiHeap _heap;
 
     // helper for print and log of runtime stats
-    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
+    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem,
+                      uint32_t instructions, uint32_t alloc_bytes, uint32_t late_ms);
 
     // must be static for use in atpanic
     static void print_error(MAV_SEVERITY severity);
@@ -0,0 +1,137 @@
+#include <AP_gtest.h>
+
+#include <AP_Scripting/lua_scripts.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SCRIPTING_ENABLED
+
+// no scripts are loaded, so no heap is needed
+static AP_Int32 vm_steps;
+static AP_Int32 heap_size;
+static AP_Int8 debug_options;
+static AP_Int8 cpu_share;
+static AP_Int16 deadline_ms;
+
+// expose the scheduling of scripts without the lua VM
+class TestScripts : public lua_scripts {
+public:
+    TestScripts() : lua_scripts(vm_steps, heap_size, debug_options, cpu_share, deadline_ms) {
+        scripts = nullptr;
+    }
+    using lua_scripts::script_info;
+    using lua_scripts::reschedule_script;
+    using lua_scripts::select_script;
+    using lua_scripts::update_budget;
+    using lua_scripts::account_run;
+};
+
+typedef TestScripts::script_info script_info;
+
+static const uint64_t now_us = 10000000;
+
+// a script due at next_run_ms with its budget last credited now
+static script_info make_script(uint64_t next_run_ms, int32_t budget_us)
+{
+    script_info script {};
+    script.next_run_ms = next_run_ms;
+    script.budget_us = budget_us;
+    script.budget_update_us = now_us;
+    return script;
+}
+
+// a script over its share is passed over for one which is not, until it is past the deadline
+TEST(lua_scripts, deferral)
+{
+    TestScripts scripts;
+    cpu_share.set(20);
+    deadline_ms.set(100);
+
+    script_info heavy = make_script(9990, -50000);
+    script_info light = make_script(9995, 0);
+    script_info later = make_script(10500, 0);
+    scripts.reschedule_script(&later);
+    scripts.reschedule_script(&light);
+    scripts.reschedule_script(&heavy);
+
+    EXPECT_EQ(&light, scripts.select_script(now_us));
+    EXPECT_EQ(1U, heavy.stats.deferred);
+    EXPECT_EQ(0U, light.stats.deferred);
+
+    // 95ms late, and the 17ms credited since is not enough to pay back what it owes
+    EXPECT_EQ(&light, scripts.select_script(now_us + 85000));
+    EXPECT_EQ(-33000, heavy.budget_us);
+    EXPECT_EQ(2U, heavy.stats.deferred);
+
+    // past the deadline it is run despite being over its share
+    EXPECT_EQ(&heavy, scripts.select_script(now_us + 90000));
+    EXPECT_EQ(2U, heavy.stats.deferred);
+    EXPECT_EQ(0U, later.stats.deferred);
+}
+
+// with everything due over its share the soonest is run, and with no share nothing is deferred
+TEST(lua_scripts, all_over_share)
+{
+    TestScripts scripts;
+    cpu_share.set(20);
+    deadline_ms.set(1000);
+
+    script_info first = make_script(9990, -50000);
+    script_info second = make_script(9995, -50000);
+    scripts.reschedule_script(&second);
+    scripts.reschedule_script(&first);
+
+    EXPECT_EQ(&first, scripts.select_script(now_us));
+    EXPECT_EQ(1U, first.stats.deferred);
+    EXPECT_EQ(1U, second.stats.deferred);
+
+    cpu_share.set(0);
+    EXPECT_EQ(&first, scripts.select_script(now_us));
+    EXPECT_EQ(1U, first.stats.deferred);
+    EXPECT_EQ(1U, second.stats.deferred);
+}
+
+// scripts are credited their share of elapsed time and charged their run time, both limited to the window
+TEST(lua_scripts, share_accounting)
+{
+    TestScripts scripts;
+    script_info script = make_script(0, 0);
+
+    scripts.update_budget(&script, now_us + 100000, 50);
+    EXPECT_EQ(50000, script.budget_us);
+    EXPECT_EQ(now_us + 100000, script.budget_update_us);
+
+    scripts.account_run(&script, 80000, 0, 0, 0);
+    EXPECT_EQ(-30000, script.budget_us);
+
+    // at most one window's worth of the share is banked
+    scripts.update_budget(&script, now_us + 10000000, 50);
+    EXPECT_EQ(SCRIPT_BUDGET_WINDOW_US / 2, script.budget_us);
+
+    // and at most one window is owed
+    scripts.account_run(&script, 3 * SCRIPT_BUDGET_WINDOW_US, 0, 0, 0);
+    EXPECT_EQ(-SCRIPT_BUDGET_WINDOW_US, script.budget_us);
+}
+
+// the run statistics, including how late the script was run
+TEST(lua_scripts, late_counting)
+{
+    TestScripts scripts;
+    script_info script = make_script(0, 0);
+
+    scripts.account_run(&script, 1000, 100, 64, 5);
+    scripts.account_run(&script, 3000, 300, 0, 20);
+    scripts.account_run(&script, 2000, 200, 32, 3);
+
+    EXPECT_EQ(3U, script.stats.runs);
+    EXPECT_EQ(6000U, script.stats.run_time_us);
+    EXPECT_EQ(3000U, script.stats.max_run_time_us);
+    EXPECT_EQ(600U, script.stats.instructions);
+    EXPECT_EQ(96U, script.stats.alloc_bytes);
+    EXPECT_EQ(20U, script.stats.max_late_ms);
+    EXPECT_EQ(-6000, script.budget_us);
+}
+
+#endif  // AP_SCRIPTING_ENABLED
+
+AP_GTEST_MAIN()
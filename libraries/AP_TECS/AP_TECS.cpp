@@ -246,7 +246,7 @@ const AP_Param::GroupInfo AP_TECS::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Extra TECS options
     // @Description: This allows the enabling of special features in the speed/height controller.
-    // @Bitmask: 0:GliderOnly,1:AllowDescentSpeedup
+    // @Bitmask: 0:GliderOnly,1:AllowDescentSpeedup,2:LoopRateEstimator
     // @User: Advanced
     AP_GROUPINFO("OPTIONS", 28, AP_TECS, _options, 0),
 
@@ -332,6 +332,8 @@ void AP_TECS::update_50hz(void)
     }
     _update_50hz_last_usec = now;
 
+    _update_filter_gains();
+
     // Use inertial nav verical velocity and height if available
     Vector3f velned;
     if (_ahrs.get_velocity_NED(velned)) {
@@ -347,17 +349,16 @@ void AP_TECS::update_50hz(void)
         float hgt_ddot_mea = -(_ahrs.get_accel_ef().z + GRAVITY_MSS);
         // Perform filter calculation using backwards Euler integration
         // Coefficients selected to place all three filter poles at omega
-        float omega2 = _hgtCompFiltOmega*_hgtCompFiltOmega;
         float hgt_err = baro_alt - _height_filter.height;
-        float integ1_input = hgt_err * omega2 * _hgtCompFiltOmega;
+        float integ1_input = hgt_err * _filter_gains.hgt_k1;
 
         _height_filter.dd_height += integ1_input * DT;
 
-        float integ2_input = _height_filter.dd_height + hgt_ddot_mea + hgt_err * omega2 * 3.0f;
+        float integ2_input = _height_filter.dd_height + hgt_ddot_mea + hgt_err * _filter_gains.hgt_k2;
 
         _climb_rate += integ2_input * DT;
 
-        float integ3_input = _climb_rate + hgt_err * _hgtCompFiltOmega * 3.0f;
+        float integ3_input = _climb_rate + hgt_err * _filter_gains.hgt_k3;
         // If more than 1 second has elapsed since last update then reset the integrator state
         // to the measured height
         if (_flags.reset) {
@@ -371,25 +372,109 @@ void AP_TECS::update_50hz(void)
     _update_speed(DT);
 }
 
+/*
+  recalculate the complementary filter gains when the filter
+  frequencies have been changed
+ */
+void AP_TECS::_update_filter_gains(void)
+{
+    const float hgt_omega = _hgtCompFiltOmega;
+    const float spd_omega = _spdCompFiltOmega;
+    if (is_equal(hgt_omega, _filter_gains.hgt_omega) &&
+        is_equal(spd_omega, _filter_gains.spd_omega)) {
+        return;
+    }
+    _filter_gains.hgt_omega = hgt_omega;
+    _filter_gains.spd_omega = spd_omega;
+    _filter_gains.hgt_k1 = hgt_omega * hgt_omega * hgt_omega;
+    _filter_gains.hgt_k2 = hgt_omega * hgt_omega * 3.0f;
+    _filter_gains.hgt_k3 = hgt_omega * 3.0f;
+    _filter_gains.spd_k1 = spd_omega * spd_omega;
+    _filter_gains.spd_k2 = spd_omega * 1.4142f;
+}
+
 void AP_TECS::_update_speed(float DT)
 {
     // Update and average speed rate of change
 
+    // when the estimator runs at the loop rate the speed rate filters
+    // and airspeed limits are still updated at 50Hz, using the mean
+    // speed rate over each 50Hz interval, so their tuning is unchanged
+    bool update_50hz_states = true;
+
     // calculate a low pass filtered _vel_dot
     if (_flags.reset) {
         _vdot_filter.reset();
         _vel_dot_lpf = _vel_dot;
+        _vel_dot_sum = 0.0f;
+        _vel_dot_count = 0;
+        _vel_dot_dt = 0.0f;
     } else {
         // Get DCM
         const Matrix3f &rotMat = _ahrs.get_rotation_body_to_ned();
         // Calculate speed rate of change
         float temp = rotMat.c.x * GRAVITY_MSS + AP::ins().get_accel().x;
-        // take 5 point moving average
-        _vel_dot = _vdot_filter.apply(temp);
-        const float alpha = DT / (DT + timeConstant());
-        _vel_dot_lpf = _vel_dot_lpf * (1.0f - alpha) + _vel_dot * alpha;
+        float vdot_DT = DT;
+        if (run_estimator_at_loop_rate()) {
+            _vel_dot_sum += temp;
+            _vel_dot_count++;
+            _vel_dot_dt += DT;
+            // update on the sample closest to the end of the 50Hz interval
+            update_50hz_states = (_vel_dot_dt + 0.5f * DT) >= 0.02f;
+            if (update_50hz_states) {
+                temp = _vel_dot_sum / _vel_dot_count;
+                vdot_DT = _vel_dot_dt;
+                _vel_dot_sum = 0.0f;
+                _vel_dot_count = 0;
+                _vel_dot_dt = 0.0f;
+            }
+        }
+        if (update_50hz_states) {
+            // take 5 point moving average
+            _vel_dot = _vdot_filter.apply(temp);
+            const float alpha = vdot_DT / (vdot_DT + timeConstant());
+            _vel_dot_lpf = _vel_dot_lpf * (1.0f - alpha) + _vel_dot * alpha;
+        }
+    }
+
+    if (update_50hz_states) {
+        _update_TAS_limits();
+    }
+
+    // limit the airspeed to a minimum of 3 m/s
+    const float min_airspeed = 3.0;
+
+    const float EAS2TAS = _ahrs.get_EAS2TAS();
+
+    // Reset states of time since last update is too large
+    if (_flags.reset) {
+        _TAS_state = (_EAS * EAS2TAS);
+        _TAS_state = MAX(_TAS_state, min_airspeed);
+        _integDTAS_state = 0.0f;
+        return;
     }
 
+    // Implement a second order complementary filter to obtain a
+    // smoothed airspeed estimate
+    // airspeed estimate is held in _TAS_state
+    float aspdErr = (_EAS * EAS2TAS) - _TAS_state;
+    float integDTAS_input = aspdErr * _filter_gains.spd_k1;
+    // Prevent state from winding up
+    if (_TAS_state < 3.1f) {
+        integDTAS_input = MAX(integDTAS_input, 0.0f);
+    }
+    _integDTAS_state = _integDTAS_state + integDTAS_input * DT;
+    float TAS_input = _integDTAS_state + _vel_dot + aspdErr * _filter_gains.spd_k2;
+    _TAS_state = _TAS_state + TAS_input * DT;
+    _TAS_state = MAX(_TAS_state, min_airspeed);
+
+}
+
+/*
+  update the true airspeed demand and limits and the measured airspeed
+ */
+void AP_TECS::_update_TAS_limits(void)
+{
     bool use_airspeed = _use_synthetic_airspeed_once || _use_synthetic_airspeed.get() || _ahrs.using_airspeed_sensor();
 
     // Convert equivalent airspeeds to true airspeeds and harmonise limits
@@ -428,32 +513,6 @@ void AP_TECS::_update_speed(float DT)
         // If no airspeed available use average of min and max
         _EAS = constrain_float(aparm.airspeed_cruise.get(), (float)aparm.airspeed_min.get(), (float)aparm.airspeed_max.get());
     }
-
-    // limit the airspeed to a minimum of 3 m/s
-    const float min_airspeed = 3.0;
-
-    // Reset states of time since last update is too large
-    if (_flags.reset) {
-        _TAS_state = (_EAS * EAS2TAS);
-        _TAS_state = MAX(_TAS_state, min_airspeed);
-        _integDTAS_state = 0.0f;
-        return;
-    }
-
-    // Implement a second order complementary filter to obtain a
-    // smoothed airspeed estimate
-    // airspeed estimate is held in _TAS_state
-    float aspdErr = (_EAS * EAS2TAS) - _TAS_state;
-    float integDTAS_input = aspdErr * _spdCompFiltOmega * _spdCompFiltOmega;
-    // Prevent state from winding up
-    if (_TAS_state < 3.1f) {
-        integDTAS_input = MAX(integDTAS_input, 0.0f);
-    }
-    _integDTAS_state = _integDTAS_state + integDTAS_input * DT;
-    float TAS_input = _integDTAS_state + _vel_dot + aspdErr * _spdCompFiltOmega * 1.4142f;
-    _TAS_state = _TAS_state + TAS_input * DT;
-    _TAS_state = MAX(_TAS_state, min_airspeed);
-
 }
 
 void AP_TECS::_update_speed_demand(void)
@@ -40,9 +40,16 @@ public:
 
     // Update of the estimated height and height rate internal state
     // Update of the inertial speed rate internal state
-    // Should be called at 50Hz or greater
+    // Should be called at 50Hz or greater, or at the main loop rate
+    // when run_estimator_at_loop_rate() is true
     void update_50hz(void);
 
+    // true if the height and speed estimator should be run at the
+    // main loop rate rather than at 50Hz
+    bool run_estimator_at_loop_rate(void) const {
+        return (_options & OPTION_LOOP_RATE_ESTIMATOR) != 0;
+    }
+
     // Update the control loop calculations
     // Do not call slower than 10Hz or faster than 500Hz
     void update_pitch_throttle(int32_t hgt_dem_cm,
@@ -199,7 +206,8 @@ private:
 
     enum {
         OPTION_GLIDER_ONLY=(1<<0),
-        OPTION_DESCENT_SPEEDUP=(1<<1)
+        OPTION_DESCENT_SPEEDUP=(1<<1),
+        OPTION_LOOP_RATE_ESTIMATOR=(1<<2)
     };
 
     AP_Float _pitch_ff_v0;
@@ -236,6 +244,24 @@ private:
         float height;
     } _height_filter;
 
+    // complementary filter gains, recalculated only when
+    // TECS_HGT_OMEGA or TECS_SPD_OMEGA change
+    struct {
+        float hgt_omega;
+        float spd_omega;
+        float hgt_k1;   // omega^3
+        float hgt_k2;   // 3*omega^2
+        float hgt_k3;   // 3*omega
+        float spd_k1;   // omega^2
+        float spd_k2;   // sqrt(2)*omega
+    } _filter_gains;
+
+    // speed rate accumulated over the 50Hz interval when running the
+    // estimator at the loop rate
+    float _vel_dot_sum;
+    uint16_t _vel_dot_count;
+    float _vel_dot_dt;
+
     // Integrator state 4 - airspeed filter first derivative
     float _integDTAS_state;
 
@@ -440,6 +466,12 @@ private:
     // Update the airspeed internal state using a second order complementary filter
     void _update_speed(float DT);
 
+    // Update the true airspeed demand and limits and the measured airspeed
+    void _update_TAS_limits(void);
+
+    // Recalculate the complementary filter gains if the parameters have changed
+    void _update_filter_gains(void);
+
     // Update the demanded airspeed
     void _update_speed_demand(void);
 
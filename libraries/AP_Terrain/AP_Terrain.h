@@ -343,10 +343,18 @@ private:
     void check_disk_write(void);
     void io_timer(void);
     void open_file(void);
-    void seek_offset(void);
+    uint32_t block_offset(struct grid_block &block) const;
     uint32_t east_blocks(struct grid_block &block) const;
     void write_block(void);
     void read_block(void);
+    void check_read_block(int32_t ret, int32_t lat, int32_t lon);
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    void write_done(int32_t ret);
+    void fsync_done(int32_t ret);
+    void read_done(int32_t ret);
+#else
+    void seek_offset(void);
+#endif
 
     // check for missing data in squares surrounding loc:
     bool update_surrounding_tiles(const Location &loc);
@@ -394,6 +402,16 @@ private:
     volatile enum DiskIoState disk_io_state;
     union grid_io_block disk_block;
 
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    // disk_block is queued for the filesystem IO thread, which owns
+    // it until the request completes
+    volatile bool disk_io_queued;
+
+    // position of the block being read
+    int32_t disk_io_lat;
+    int32_t disk_io_lon;
+#endif
+
     // last time we asked for more grids
     uint32_t last_request_time_ms[MAVLINK_COMM_NUM_BUFFERS];
 
@@ -126,7 +126,11 @@ The IO timer context owns the data when disk_io_state is
 DiskIoWaitWrite or DiskIoWaitRead. The main thread owns the data when
 disk_io_state is DiskIoIdle, DiskIoDoneWrite or DiskIoDoneRead
 
-All file operations are done by the IO thread.
+All file operations are done by the IO thread. When the filesystem
+has an asynchronous IO queue the reads and writes of disk_block are
+queued to the filesystem IO thread instead, which owns the data while
+disk_io_queued is set and completes in read_done(), write_done() and
+fsync_done().
 *********************************************************/
 
 
@@ -232,14 +236,154 @@ uint32_t AP_Terrain::east_blocks(struct grid_block &block) const
 }
 
 /*
-  seek to the right offset for disk_block
+  work out the file offset of a block
  */
-void AP_Terrain::seek_offset(void)
+uint32_t AP_Terrain::block_offset(struct grid_block &block) const
 {
-    struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
     uint32_t blocknum = east_blocks(block) * block.grid_idx_x + block.grid_idx_y;
-    uint32_t file_offset = blocknum * sizeof(union grid_io_block);
+    return blocknum * sizeof(union grid_io_block);
+}
+
+/*
+  check the block read into disk_block, replacing it with an empty
+  block if it isn't the one asked for
+ */
+void AP_Terrain::check_read_block(int32_t ret, int32_t lat, int32_t lon)
+{
+    if (ret != sizeof(disk_block) || 
+        !TERRAIN_LATLON_EQUAL(disk_block.block.lat,lat) ||
+        !TERRAIN_LATLON_EQUAL(disk_block.block.lon,lon) ||
+        disk_block.block.bitmap == 0 ||
+        disk_block.block.spacing != grid_spacing ||
+        disk_block.block.version != TERRAIN_GRID_FORMAT_VERSION ||
+        disk_block.block.crc != get_block_crc(disk_block.block)) {
+#if TERRAIN_DEBUG
+        printf("read empty block at %ld %ld ret=%d (%ld %ld %u 0x%08lx) 0x%04x:0x%04x\n",
+               (long)lat,
+               (long)lon,
+               (int)ret,
+               (long)disk_block.block.lat,
+               (long)disk_block.block.lon,
+               (unsigned)disk_block.block.spacing,
+               (unsigned long)disk_block.block.bitmap,
+               (unsigned)disk_block.block.crc,
+               (unsigned)get_block_crc(disk_block.block));
+#endif
+        // a short read or bad data is not an IO failure, just a
+        // missing block on disk
+        memset(&disk_block, 0, sizeof(disk_block));
+        disk_block.block.lat = lat;
+        disk_block.block.lon = lon;
+        disk_block.block.bitmap = 0;
+    } else {
+#if TERRAIN_DEBUG
+        printf("read block at %ld %ld ret=%d mask=%07llx\n",
+               (long)lat,
+               (long)lon,
+               (int)ret,
+               (unsigned long long)disk_block.block.bitmap);
+#endif
+    }
+    disk_io_state = DiskIoDoneRead;
+}
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+/*
+  queue the write of disk_block on the filesystem IO thread
+ */
+void AP_Terrain::write_block(void)
+{
+    disk_block.block.crc = get_block_crc(disk_block.block);
+
+    // set first, as the write can complete before write() returns
+    disk_io_queued = true;
+    if (!AP::FS().async_io().write(fd, &disk_block, sizeof(disk_block), block_offset(disk_block.block),
+                                   AP_Filesystem_AsyncIO::Priority::TERRAIN,
+                                   FUNCTOR_BIND_MEMBER(&AP_Terrain::write_done, void, int32_t))) {
+        // queue full, try again on the next io_timer() call
+        disk_io_queued = false;
+    }
+}
+
+/*
+  called on the filesystem IO thread when the write of disk_block
+  has completed
+ */
+void AP_Terrain::write_done(int32_t ret)
+{
+    if (ret != sizeof(disk_block)) {
+#if TERRAIN_DEBUG
+        hal.console->printf("write failed - %s\n", strerror(errno));
+#endif
+        AP::FS().close(fd);
+        fd = -1;
+        io_failure = true;
+        disk_io_state = DiskIoDoneWrite;
+        disk_io_queued = false;
+        return;
+    }
+    if (!AP::FS().async_io().fsync(fd, AP_Filesystem_AsyncIO::Priority::TERRAIN,
+                                   FUNCTOR_BIND_MEMBER(&AP_Terrain::fsync_done, void, int32_t))) {
+        // the block still reaches the card when the file is closed
+        fsync_done(0);
+    }
+}
+
+void AP_Terrain::fsync_done(int32_t ret)
+{
+#if TERRAIN_DEBUG
+    printf("wrote block at %ld %ld mask=%07llx\n",
+           (long)disk_block.block.lat,
+           (long)disk_block.block.lon,
+           (unsigned long long)disk_block.block.bitmap);
+#endif
+    disk_io_state = DiskIoDoneWrite;
+    disk_io_queued = false;
+}
+
+/*
+  queue the read of disk_block on the filesystem IO thread
+ */
+void AP_Terrain::read_block(void)
+{
+    disk_io_lat = disk_block.block.lat;
+    disk_io_lon = disk_block.block.lon;
+
+    // set first, as the read can complete before read() returns
+    disk_io_queued = true;
+    if (!AP::FS().async_io().read(fd, &disk_block, sizeof(disk_block), block_offset(disk_block.block),
+                                  AP_Filesystem_AsyncIO::Priority::TERRAIN,
+                                  FUNCTOR_BIND_MEMBER(&AP_Terrain::read_done, void, int32_t))) {
+        // queue full, try again on the next io_timer() call
+        disk_io_queued = false;
+    }
+}
+
+/*
+  called on the filesystem IO thread when the read of disk_block has
+  completed
+ */
+void AP_Terrain::read_done(int32_t ret)
+{
+    if (ret < 0) {
+        // a failed seek or read is retried after the IO failure timeout
+        AP::FS().close(fd);
+        fd = -1;
+        io_failure = true;
+    } else {
+        check_read_block(ret, disk_io_lat, disk_io_lon);
+    }
+    disk_io_queued = false;
+}
+
+#else
+/*
+  seek to the right offset for disk_block
+ */
+void AP_Terrain::seek_offset(void)
+{
+    uint32_t file_offset = block_offset(disk_block.block);
     if (AP::FS().lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
@@ -297,42 +441,9 @@ void AP_Terrain::read_block(void)
     int32_t lon = disk_block.block.lon;
 
     ssize_t ret = AP::FS().read(fd, &disk_block, sizeof(disk_block));
-    if (ret != sizeof(disk_block) || 
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lat,lat) ||
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lon,lon) ||
-        disk_block.block.bitmap == 0 ||
-        disk_block.block.spacing != grid_spacing ||
-        disk_block.block.version != TERRAIN_GRID_FORMAT_VERSION ||
-        disk_block.block.crc != get_block_crc(disk_block.block)) {
-#if TERRAIN_DEBUG
-        printf("read empty block at %ld %ld ret=%d (%ld %ld %u 0x%08lx) 0x%04x:0x%04x\n",
-               (long)lat,
-               (long)lon,
-               (int)ret,
-               (long)disk_block.block.lat,
-               (long)disk_block.block.lon,
-               (unsigned)disk_block.block.spacing,
-               (unsigned long)disk_block.block.bitmap,
-               (unsigned)disk_block.block.crc,
-               (unsigned)get_block_crc(disk_block.block));
-#endif
-        // a short read or bad data is not an IO failure, just a
-        // missing block on disk
-        memset(&disk_block, 0, sizeof(disk_block));
-        disk_block.block.lat = lat;
-        disk_block.block.lon = lon;
-        disk_block.block.bitmap = 0;
-    } else {
-#if TERRAIN_DEBUG
-        printf("read block at %ld %ld ret=%d mask=%07llx\n",
-               (long)lat,
-               (long)lon,
-               (int)ret,
-               (unsigned long long)disk_block.block.bitmap);
-#endif
-    }
-    disk_io_state = DiskIoDoneRead;
+    check_read_block(ret, lat, lon);
 }
+#endif // AP_FILESYSTEM_ASYNC_IO_ENABLED
 
 /*
   timer called to do disk IO
@@ -351,6 +462,13 @@ void AP_Terrain::io_timer(void)
 
     update_reference_offset();
 
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    if (disk_io_queued) {
+        // the filesystem IO thread owns disk_block
+        return;
+    }
+#endif
+
     switch (disk_io_state) {
     case DiskIoIdle:
     case DiskIoDoneRead:
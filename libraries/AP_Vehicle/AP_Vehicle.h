@@ -272,6 +272,12 @@ public:
      */
     virtual bool get_wp_crosstrack_error_m(float &xtrack_error) const { return false; }
 
+    /*
+      get the estimated time to reach the current wp in seconds
+      return false if failed or n/a
+     */
+    virtual bool get_wp_time_remaining_s(float &time_s) const { return false; }
+
 #if HAL_WITH_FRSKY_TELEM_BIDIRECTIONAL
     AP_Frsky_Parameters frsky_parameters;
 #endif
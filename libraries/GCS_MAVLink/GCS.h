@@ -1010,6 +1010,17 @@ private:
         int16_t current_session;
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+        // read or write of fd queued on the filesystem IO thread
+        HAL_BinarySemaphore io_sem;
+        volatile bool io_pending;
+        int32_t io_result;
+        int io_errno;
+
+        // the next block of a burst read, read while the last is sent
+        uint8_t read_ahead[sizeof(pending_ftp::data)];
+#endif
     };
     static struct ftp_state ftp;
 
@@ -1022,6 +1033,13 @@ private:
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
     void ftp_push_replies(pending_ftp &reply);
+    int32_t ftp_read(void *buf, uint32_t count, uint32_t offset);
+    int32_t ftp_write(const void *buf, uint32_t count, uint32_t offset);
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    bool ftp_queue_io(bool writing, void *buf, uint32_t count, uint32_t offset);
+    void ftp_io_done(int32_t result);
+    int32_t ftp_wait_io(void);
+#endif
 #endif  // AP_MAVLINK_FTP_ENABLED
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
@@ -34,6 +34,9 @@ struct GCS_MAVLINK::ftp_state GCS_MAVLINK::ftp;
 // timeout for session inactivity
 #define FTP_SESSION_TIMEOUT 3000
 
+// time to wait for queued file IO before giving up on it
+#define FTP_IO_TIMEOUT_MS 1000
+
 bool GCS_MAVLINK::ftp_init(void) {
 
     // check if ftp is disabled for memory savings
@@ -167,6 +170,92 @@ void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
     }
 }
 
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+/*
+  queue a read or write of the open file on the filesystem IO thread,
+  to be waited for with ftp_wait_io()
+ */
+bool GCS_MAVLINK::ftp_queue_io(bool writing, void *buf, uint32_t count, uint32_t offset)
+{
+    auto &io = AP::FS().async_io();
+    const auto prio = AP_Filesystem_AsyncIO::Priority::FTP;
+    const auto cb = FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_io_done, void, int32_t);
+
+    // set first, as the request can complete before it is queued
+    ftp.io_pending = true;
+    const bool queued = writing ? io.write(ftp.fd, buf, count, offset, prio, cb) : io.read(ftp.fd, buf, count, offset, prio, cb);
+    if (!queued) {
+        ftp.io_pending = false;
+    }
+    return queued;
+}
+
+// called on the filesystem IO thread, which also has the errno of a failure
+void GCS_MAVLINK::ftp_io_done(int32_t result)
+{
+    ftp.io_result = result;
+    ftp.io_errno = errno;
+    ftp.io_pending = false;
+    ftp.io_sem.signal();
+}
+
+/*
+  wait for the queued read or write, returning its result. Higher
+  priority IO such as logging can hold it back, so give up rather than
+  leave the GCS without a reply, unless it has already started
+ */
+int32_t GCS_MAVLINK::ftp_wait_io(void)
+{
+    const uint32_t start_ms = AP_HAL::millis();
+    while (ftp.io_pending) {
+        IGNORE_RETURN(ftp.io_sem.wait(100000));
+        if (ftp.io_pending &&
+            AP_HAL::millis() - start_ms > FTP_IO_TIMEOUT_MS &&
+            AP::FS().async_io().cancel(ftp.fd) &&
+            ftp.io_pending) {
+            ftp.io_pending = false;
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+    if (ftp.io_result < 0) {
+        errno = ftp.io_errno;
+    }
+    return ftp.io_result;
+}
+#endif // AP_FILESYSTEM_ASYNC_IO_ENABLED
+
+/*
+  read from offset in the open file, through the filesystem IO queue
+  when there is one
+ */
+int32_t GCS_MAVLINK::ftp_read(void *buf, uint32_t count, uint32_t offset)
+{
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    if (ftp_queue_io(false, buf, count, offset)) {
+        return ftp_wait_io();
+    }
+#endif
+    if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().read(ftp.fd, buf, count);
+}
+
+// write at offset in the open file, as for ftp_read()
+int32_t GCS_MAVLINK::ftp_write(const void *buf, uint32_t count, uint32_t offset)
+{
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+    if (ftp_queue_io(true, (void *)buf, count, offset)) {
+        return ftp_wait_io();
+    }
+#endif
+    if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().write(ftp.fd, buf, count);
+}
+
 void GCS_MAVLINK::ftp_worker(void) {
     pending_ftp request;
     pending_ftp reply = {};
@@ -310,14 +399,8 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
                         // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
+                        const int32_t read_bytes = ftp_read(reply.data, MIN(sizeof(reply.data),request.size), request.offset);
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -382,14 +465,8 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
                         // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
+                        const int32_t write_bytes = ftp_write(request.data, request.size, request.offset);
                         if (write_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -479,11 +556,13 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
+#if !AP_FILESYSTEM_ASYNC_IO_ENABLED
                         // seek to requested offset
                         if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
+#endif
 
                         /*
                           calculate a burst delay so that FTP burst
@@ -505,9 +584,26 @@ void GCS_MAVLINK::ftp_worker(void) {
 
                         // this transfer size is enough for a full parameter file with max parameters
                         const uint32_t transfer_size = 500;
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+                        const uint16_t read_size = MIN(sizeof(reply.data), max_read);
+                        uint32_t read_offset = request.offset;
+                        bool read_ahead = false;
+#endif
                         for (uint32_t i = 0; (i < transfer_size); i++) {
                             // fill the buffer
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+                            int32_t read_bytes;
+                            if (read_ahead) {
+                                read_bytes = ftp_wait_io();
+                                if (read_bytes > 0) {
+                                    memcpy(reply.data, ftp.read_ahead, read_bytes);
+                                }
+                            } else {
+                                read_bytes = ftp_read(reply.data, read_size, read_offset);
+                            }
+#else
                             const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
+#endif
                             if (read_bytes == -1) {
                                 ftp_error(reply, FTP_ERROR::FailErrno);
                                 break;
@@ -528,6 +624,13 @@ void GCS_MAVLINK::ftp_worker(void) {
                             reply.burst_complete = (i == (transfer_size - 1));
                             reply.size = (uint8_t)read_bytes;
 
+#if AP_FILESYSTEM_ASYNC_IO_ENABLED
+                            // read the next block while this one is sent
+                            read_offset += read_bytes;
+                            read_ahead = read_bytes == read_size && i+1 < transfer_size &&
+                                         ftp_queue_io(false, ftp.read_ahead, read_size, read_offset);
+#endif
+
                             ftp_push_replies(reply);
 
                             if (read_bytes < max_read) {
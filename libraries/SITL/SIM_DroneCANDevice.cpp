@@ -19,6 +19,7 @@
 #if AP_TEST_DRONECAN_DRIVERS
 
 #include <canard/publisher.h>
+#include <canard/subscriber.h>
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_Baro/AP_Baro.h>
 #include <AP_Baro/AP_Baro_SITL.h>
@@ -29,6 +30,80 @@
 
 using namespace SITL;
 
+// table of user settable parameters
+const AP_Param::GroupInfo DroneCANDevice::var_info[] = {
+
+    // @Param: ESC
+    // @DisplayName: DroneCAN simulated ESC count
+    // @Description: Number of simulated ESCs which answer the vehicle's RawCommand with a Status message. The vehicle must have a CAN port and DroneCAN ESC outputs configured for commands to be seen
+    // @Range: 0 20
+    // @User: Advanced
+    AP_GROUPINFO("ESC", 0, DroneCANDevice, _esc_count, 0),
+
+    // @Param: ESC_HZ
+    // @DisplayName: DroneCAN simulated ESC telemetry rate
+    // @Description: Maximum rate at which the simulated ESCs send telemetry in response to commands, 0 to answer every command
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("ESC_HZ", 1, DroneCANDevice, _esc_rate_hz, 0),
+
+    // @Param: GPS_HZ
+    // @DisplayName: DroneCAN simulated GPS rate
+    // @Description: Rate of the simulated GPS Fix2 message, 0 to disable
+    // @Units: Hz
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("GPS_HZ", 2, DroneCANDevice, _gps_rate_hz, 0),
+
+    // @Param: MAG_HZ
+    // @DisplayName: DroneCAN simulated compass rate
+    // @Description: Rate of the simulated compass messages, 0 to disable
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("MAG_HZ", 3, DroneCANDevice, _mag_rate_hz, 100),
+
+    // @Param: ASP_HZ
+    // @DisplayName: DroneCAN simulated airspeed rate
+    // @Description: Rate of the simulated airspeed message, 0 to disable
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("ASP_HZ", 4, DroneCANDevice, _airspeed_rate_hz, 20),
+
+    // @Param: KBPS
+    // @DisplayName: DroneCAN simulated bus bitrate
+    // @Description: Bitrate used to calculate bus utilisation for the benchmark
+    // @Units: kbit/s
+    // @Range: 125 1000
+    // @User: Advanced
+    AP_GROUPINFO("KBPS", 5, DroneCANDevice, _bus_kbps, 1000),
+
+    // @Param: BENCH
+    // @DisplayName: DroneCAN benchmark report period
+    // @Description: If non-zero, report ESC command to telemetry latency percentiles and bus utilisation on the console at this period. Times are in simulation time and latencies are measured from when the vehicle queues a command to when it receives the last telemetry it caused
+    // @Units: s
+    // @Range: 0 60
+    // @User: Advanced
+    AP_GROUPINFO("BENCH", 6, DroneCANDevice, _bench_period_s, 0),
+
+    AP_GROUPEND
+};
+
+bool DroneCANDevice::should_send(uint64_t &last_us, uint16_t rate_hz)
+{
+    if (rate_hz == 0) {
+        return false;
+    }
+    const uint64_t now = AP_HAL::micros64();
+    if ((now - last_us) < 1000000U / rate_hz && last_us != 0) {
+        return false;
+    }
+    last_us = now;
+    return true;
+}
+
 void DroneCANDevice::update_baro() {
     const uint64_t now = AP_HAL::micros64();
     if (((now - _baro_last_update_us) < 10000) && (_baro_last_update_us != 0)) {
@@ -119,11 +194,9 @@ void DroneCANDevice::update_baro() {
 }
 
 void DroneCANDevice::update_airspeed() {
-    const uint32_t now = AP_HAL::micros64();
-    if ((now - _airspeed_last_update_us < 50000) && (_airspeed_last_update_us != 0)) {
+    if (!should_send(_airspeed_last_update_us, _airspeed_rate_hz)) {
         return;
     }
-    _airspeed_last_update_us = now;
     uavcan_equipment_air_data_RawAirData msg {};
     msg.differential_pressure = AP::sitl()->state.airspeed_raw_pressure[0];
 
@@ -162,12 +235,9 @@ void DroneCANDevice::_setup_eliptical_correcion(uint8_t i)
 
 void DroneCANDevice::update_compass() {
 
-    // Sampled at 100Hz
-    const uint32_t now = AP_HAL::micros64();
-    if ((now - _compass_last_update_us < 10000) && (_compass_last_update_us != 0)) {
+    if (!should_send(_compass_last_update_us, _mag_rate_hz)) {
         return;
     }
-    _compass_last_update_us = now;
 
     // calculate sensor noise and add to 'truth' field in body frame
     // units are milli-Gauss
@@ -223,12 +293,163 @@ void DroneCANDevice::update_rangefinder() {
     pub.broadcast(msg);
 }
 
+void DroneCANDevice::update_gps()
+{
+    if (!should_send(_gps_last_update_us, _gps_rate_hz)) {
+        return;
+    }
+    const auto &state = AP::sitl()->state;
+    static Canard::Publisher<uavcan_equipment_gnss_Fix2> pub{CanardInterface::get_test_iface()};
+    uavcan_equipment_gnss_Fix2 msg {};
+    msg.timestamp.usec = AP_HAL::micros64();
+    msg.gnss_time_standard = UAVCAN_EQUIPMENT_GNSS_FIX2_GNSS_TIME_STANDARD_NONE;
+    msg.latitude_deg_1e8 = int64_t(state.latitude * 1.0e8);
+    msg.longitude_deg_1e8 = int64_t(state.longitude * 1.0e8);
+    msg.height_msl_mm = int32_t(state.altitude * 1000);
+    msg.height_ellipsoid_mm = msg.height_msl_mm;
+    msg.ned_velocity[0] = state.speedN;
+    msg.ned_velocity[1] = state.speedE;
+    msg.ned_velocity[2] = state.speedD;
+    msg.sats_used = 12;
+    msg.status = UAVCAN_EQUIPMENT_GNSS_FIX2_STATUS_3D_FIX;
+    msg.mode = UAVCAN_EQUIPMENT_GNSS_FIX2_MODE_SINGLE;
+    msg.pdop = 1.2;
+    pub.broadcast(msg);
+}
+
+/*
+  answer a command with telemetry from each simulated ESC. This is
+  called from the DroneCAN thread as the command crosses the bus
+ */
+void DroneCANDevice::handle_esc_raw_command(DroneCANDevice *device, const CanardRxTransfer& transfer, const uavcan_equipment_esc_RawCommand& msg)
+{
+    if (device->_esc_count <= 0 || msg.cmd.len == 0) {
+        return;
+    }
+    const uint8_t num_escs = MIN(uint8_t(device->_esc_count.get()), msg.cmd.len);
+    if (device->_esc_rate_hz > 0 && !should_send(device->_esc_last_update_us, device->_esc_rate_hz)) {
+        return;
+    }
+
+    static Canard::Publisher<uavcan_equipment_esc_Status> pub{CanardInterface::get_test_iface()};
+    uint16_t queued = 0;
+    for (uint8_t i = 0; i < num_escs; i++) {
+        const float throttle = MAX(0, msg.cmd.data[i]) / float(UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_CMD_MAX);
+        uavcan_equipment_esc_Status status_msg {};
+        status_msg.voltage = 16.0;
+        status_msg.current = 20.0 * throttle;
+        status_msg.temperature = C_TO_KELVIN(40);
+        status_msg.rpm = int32_t(12000 * throttle);
+        status_msg.power_rating_pct = uint8_t(100 * throttle);
+        status_msg.esc_index = i;
+        if (pub.broadcast(status_msg)) {
+            queued++;
+        }
+    }
+
+    WITH_SEMAPHORE(device->_bench_sem);
+    device->_bench.commands++;
+    // only measure commands which find no telemetry in flight, so the
+    // last telemetry seen for them is their own
+    if (device->_status_in_flight == 0 && queued > 0) {
+        device->_latency_cmd_us = transfer.timestamp_usec;
+    }
+    device->_status_in_flight += queued;
+}
+
+/*
+  account for a frame crossing the simulated bus. This is called from
+  the DroneCAN thread
+ */
+void DroneCANDevice::bus_tap(const CanardCANFrame &frame, bool to_vehicle, uint64_t queued_us)
+{
+    WITH_SEMAPHORE(_bench_sem);
+    // nominal length of an extended frame, ignoring stuff bits
+    _bench.bits += 67 + 8 * frame.data_len;
+    _bench.frames++;
+
+    if (!to_vehicle || frame.data_len == 0 || _status_in_flight == 0) {
+        return;
+    }
+    // look for the last frame of each ESC status message transfer
+    const bool service = (frame.id & 0x80) != 0;
+    const uint16_t data_type_id = (frame.id >> 8) & 0xFFFF;
+    const bool end_of_transfer = (frame.data[frame.data_len-1] & 0x40) != 0;
+    if (service || data_type_id != UAVCAN_EQUIPMENT_ESC_STATUS_ID || !end_of_transfer) {
+        return;
+    }
+    _status_in_flight--;
+    if (_status_in_flight == 0 && _latency_cmd_us != 0) {
+        const uint32_t latency_us = queued_us - _latency_cmd_us;
+        _latency_cmd_us = 0;
+        _bench.samples++;
+        _bench.latency_max_us = MAX(_bench.latency_max_us, latency_us);
+        _bench.latency_hist[MIN(latency_us / LATENCY_BUCKET_US, LATENCY_BUCKETS-1U)]++;
+    }
+}
+
+void DroneCANDevice::update_benchmark()
+{
+    if (_bench_period_s <= 0) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_bench_last_report_ms == 0) {
+        // discard anything from before the benchmark was enabled
+        WITH_SEMAPHORE(_bench_sem);
+        memset(&_bench, 0, sizeof(_bench));
+        _bench_last_report_ms = now_ms;
+        return;
+    }
+    const uint32_t dt_ms = now_ms - _bench_last_report_ms;
+    if (dt_ms < uint32_t(_bench_period_s) * 1000U) {
+        return;
+    }
+    _bench_last_report_ms = now_ms;
+
+    BenchStats stats;
+    {
+        WITH_SEMAPHORE(_bench_sem);
+        stats = _bench;
+        memset(&_bench, 0, sizeof(_bench));
+    }
+
+    // upper edge of the bucket holding each percentile
+    const float percentiles[] { 0.5, 0.9, 0.99 };
+    uint32_t latency_us[ARRAY_SIZE(percentiles)] {};
+    uint8_t p = 0;
+    uint32_t count = 0;
+    for (uint16_t i = 0; i < LATENCY_BUCKETS && p < ARRAY_SIZE(percentiles); i++) {
+        count += stats.latency_hist[i];
+        while (p < ARRAY_SIZE(percentiles) && count > 0 && count >= percentiles[p] * stats.samples) {
+            latency_us[p++] = MIN((i + 1U) * LATENCY_BUCKET_US, stats.latency_max_us);
+        }
+    }
+
+    const float utilisation_pct = 100.0 * stats.bits / (_bus_kbps * float(dt_ms));
+    ::printf("DroneCAN: %u cmds %u samples latency p50=%u p90=%u p99=%u max=%uus bus %.1f%% %.0f frames/s\n",
+             unsigned(stats.commands), unsigned(stats.samples),
+             unsigned(latency_us[0]), unsigned(latency_us[1]), unsigned(latency_us[2]),
+             unsigned(stats.latency_max_us),
+             utilisation_pct, stats.frames * 1000.0 / dt_ms);
+}
+
 void DroneCANDevice::update()
 {
+    if (!_bus_tapped) {
+        CanardInterface::set_test_bus_tap(FUNCTOR_BIND_MEMBER(&DroneCANDevice::bus_tap, void, const CanardCANFrame &, bool, uint64_t));
+        _bus_tapped = true;
+    }
+    if (!_esc_subscribed && _esc_count > 0) {
+        _esc_subscribed = Canard::allocate_sub_arg_callback(this, &handle_esc_raw_command, CanardInterface::get_test_iface().get_index()) != nullptr;
+    }
+
     update_baro();
     update_airspeed();
     update_compass();
     update_rangefinder();
+    update_gps();
+    update_benchmark();
 }
 
 #endif // AP_TEST_DRONECAN_DRIVERS
@@ -24,12 +24,21 @@
 #include <AP_Math/vectorN.h>
 
 #if AP_TEST_DRONECAN_DRIVERS
+#include <AP_Param/AP_Param.h>
+#include <AP_DroneCAN/AP_Canard_iface.h>
+
 namespace SITL {
 
 class DroneCANDevice {
 public:
+    DroneCANDevice() {
+        AP_Param::setup_object_defaults(this, var_info);
+    }
+
     void update(void);
 
+    static const struct AP_Param::GroupInfo var_info[];
+
 private:
     // barometer delay buffer variables
     struct readings_baro {
@@ -54,6 +63,48 @@ private:
     Matrix3f _eliptical_corr;
     Vector3f _last_dia;
     Vector3f _last_odi;
+
+    // load generator
+    AP_Int8 _esc_count;
+    AP_Int16 _esc_rate_hz;
+    AP_Int16 _gps_rate_hz;
+    AP_Int16 _mag_rate_hz;
+    AP_Int16 _airspeed_rate_hz;
+    AP_Int16 _bus_kbps;
+    AP_Int8 _bench_period_s;
+
+    // true if the rate limited sensor last sent at last_us should send again
+    static bool should_send(uint64_t &last_us, uint16_t rate_hz);
+
+    void update_gps(void);
+    uint64_t _gps_last_update_us;
+
+    static void handle_esc_raw_command(DroneCANDevice *device, const CanardRxTransfer& transfer, const uavcan_equipment_esc_RawCommand& msg);
+    uint64_t _esc_last_update_us;
+    bool _esc_subscribed;
+
+    // latency and bus utilisation benchmark
+    void bus_tap(const CanardCANFrame &frame, bool to_vehicle, uint64_t queued_us);
+    void update_benchmark(void);
+    bool _bus_tapped;
+    uint32_t _bench_last_report_ms;
+
+    static const uint16_t LATENCY_BUCKET_US = 50;
+    static const uint16_t LATENCY_BUCKETS = 200;
+    struct BenchStats {
+        uint32_t frames;
+        uint64_t bits;
+        uint32_t commands;
+        uint32_t samples;
+        uint32_t latency_max_us;
+        // the last bucket also holds everything longer
+        uint32_t latency_hist[LATENCY_BUCKETS];
+    } _bench;
+    // ESC status transfers queued but not yet seen by the vehicle
+    uint16_t _status_in_flight;
+    // time the command being measured was queued by the vehicle
+    uint64_t _latency_cmd_us;
+    HAL_Semaphore _bench_sem;
 };
 
 }
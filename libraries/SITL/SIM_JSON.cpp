@@ -78,6 +78,21 @@ JSON::JSON(const char *frame_str) :
             }
         }
     }
+
+    bind_keytable();
+}
+
+/*
+    precompute the keytable string lengths and forget the key order
+    of any previous connection
+*/
+void JSON::bind_keytable(void)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        keytable_len[i].section_len = strlen(keytable[i].section);
+        keytable_len[i].key_len = strlen(keytable[i].key);
+    }
+    memset(key_order, -1, sizeof(key_order));
 }
 
 /*
@@ -135,96 +150,278 @@ void JSON::output_servos(const struct sitl_input &input)
 
 
 /*
-    very simple JSON parser for sensor data
+    find the keytable entry for a key at the given position in the
+    line, trying the entry seen at that position in the last line first
+*/
+int8_t JSON::find_key(uint8_t position, const char *section, uint8_t section_len, const char *key, uint8_t key_len)
+{
+    const int8_t expected = position < ARRAY_SIZE(key_order) ? key_order[position] : -1;
+    for (uint8_t n=0; n<=ARRAY_SIZE(keytable); n++) {
+        int8_t i;
+        if (n == 0) {
+            if (expected < 0) {
+                continue;
+            }
+            i = expected;
+        } else {
+            i = n-1;
+            if (i == expected) {
+                continue;
+            }
+        }
+        if (keytable_len[i].key_len != key_len ||
+            keytable_len[i].section_len != section_len ||
+            memcmp(keytable[i].key, key, key_len) != 0 ||
+            memcmp(keytable[i].section, section, section_len) != 0) {
+            continue;
+        }
+        if (position < ARRAY_SIZE(key_order)) {
+            key_order[position] = i;
+        }
+        return i;
+    }
+    return -1;
+}
+
+/*
+    parse a decimal number, returns pointer after the number or
+    nullptr on failure. Numbers of up to 15 significant digits without
+    an exponent are converted exactly with a single division, leaving
+    strtod for anything else
+*/
+static const char *parse_number(const char *p, double &v)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+    const char *start = p;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    const bool negative = *p == '-';
+    if (negative) {
+        p++;
+    }
+    uint64_t mantissa = 0;
+    uint8_t digits = 0;
+    uint8_t fraction_digits = 0;
+    bool fraction = false;
+    for (; ; p++) {
+        if (*p >= '0' && *p <= '9') {
+            // stop counting once past the digits we can convert
+            if (digits <= 15) {
+                mantissa = mantissa*10 + (*p - '0');
+                digits++;
+                if (fraction) {
+                    fraction_digits++;
+                }
+            }
+        } else if (*p == '.' && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+    if (digits == 0 || digits > 15 || *p == 'e' || *p == 'E') {
+        char *end;
+        v = strtod(start, &end);
+        return end == start ? nullptr : end;
+    }
+    v = mantissa / pow10[fraction_digits];
+    if (negative) {
+        v = -v;
+    }
+    return p;
+}
+
+/*
+    parse comma separated numbers in square brackets, returns pointer
+    after the closing bracket or nullptr on failure
+*/
+template <typename T>
+static const char *parse_array(const char *p, T *v, uint8_t n)
+{
+    if (*p++ != '[') {
+        return nullptr;
+    }
+    for (uint8_t i=0; i<n; i++) {
+        double d;
+        p = parse_number(p, d);
+        if (p == nullptr) {
+            return nullptr;
+        }
+        v[i] = d;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p++ != (i == n-1 ? ']' : ',')) {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+/*
+    parse the value of a keytable entry straight into its target,
+    returns pointer after the value or nullptr on failure
+*/
+const char *JSON::parse_value(const struct keytable &key, const char *p) const
+{
+    char *end = nullptr;
+    double d;
+    switch (key.type) {
+    case DATA_UINT64:
+        *((uint64_t *)key.ptr) = strtoull(p, &end, 10);
+        break;
+
+    case DATA_FLOAT:
+        p = parse_number(p, d);
+        if (p != nullptr) {
+            *((float *)key.ptr) = d;
+        }
+        return p;
+
+    case DATA_DOUBLE:
+        return parse_number(p, *((double *)key.ptr));
+
+    case DATA_VECTOR3F:
+        return parse_array(p, &(*(Vector3f *)key.ptr)[0], 3);
+
+    case DATA_VECTOR3D:
+        return parse_array(p, &(*(Vector3d *)key.ptr)[0], 3);
+
+    case QUATERNION:
+        return parse_array(p, &(*(Quaternion *)key.ptr)[0], 4);
+
+    case BOOLEAN:
+        if (strncmp(p, "true", 4) == 0) {
+            *((bool *)key.ptr) = true;
+            return p+4;
+        }
+        if (strncmp(p, "false", 5) == 0) {
+            *((bool *)key.ptr) = false;
+            return p+5;
+        }
+        *((bool *)key.ptr) = strtoull(p, &end, 10) != 0;
+        break;
+    }
+    return end == p ? nullptr : end;
+}
+
+/*
+    simple JSON parser for sensor data
     called with pointer to one row of sensor data, nul terminated
 
-    This parser does not do any syntax checking, and is not at all
-    general purpose
+    The line is tokenized in a single pass. Keys at the top level and
+    in one level of nested objects are matched against the keytable
+    and their values are parsed straight into state, anything else is
+    skipped. This parser does not do any syntax checking, and is not
+    at all general purpose
 */
 uint32_t JSON::parse_sensors(const char *json)
 {
     uint32_t received_bitmask = 0;
 
+    // object nesting depth and the name of the nested object we are in
+    uint8_t depth = 0;
+    const char *section = "";
+    uint8_t section_len = 0;
+
+    // position of the key in the line, used to predict the entry
+    uint8_t position = 0;
+
     //printf("%s\n", json);
-    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
-        struct keytable &key = keytable[i];
-
-        /* look for section header */
-        const char *p = strstr(json, key.section);
-        if (!p) {
-            // we don't have this sensor
-            if (key.required) {
-                printf("Failed to find %s\n", key.section);
-                return 0;
+    const char *p = json;
+    while (*p) {
+        switch (*p) {
+        case '{':
+            depth++;
+            p++;
+            continue;
+
+        case '}':
+            if (depth > 0) {
+                depth--;
             }
+            if (depth <= 1) {
+                section = "";
+                section_len = 0;
+            }
+            p++;
+            continue;
+
+        case '"':
+            break;
+
+        default:
+            p++;
             continue;
         }
-        p += strlen(key.section)+1;
 
-        // find key inside section
-        p = strstr(p, key.key);
-        if (!p) {
-            if (key.required) {
-                printf("Failed to find key %s/%s\n", key.section, key.key);
+        // find the end of the string
+        const char *str = ++p;
+        while (*p != '"') {
+            if (*p == 0) {
                 return 0;
             }
+            if (*p == '\\' && p[1] != 0) {
+                p++;
+            }
+            p++;
+        }
+        const size_t len = p - str;
+        p++;
+        if (len > UINT8_MAX) {
             continue;
         }
 
-        // record the keys that are found
-        received_bitmask |= 1U << i;
-
-        p += strlen(key.key)+2;
-        switch (key.type) {
-            case DATA_UINT64:
-                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
-                //printf("%s/%s = %lu\n", key.section, key.key, *((uint64_t *)key.ptr));
-                break;
-
-            case DATA_FLOAT:
-                *((float *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((float *)key.ptr));
-                break;
-
-            case DATA_DOUBLE:
-                *((double *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((double *)key.ptr));
-                break;
-
-            case DATA_VECTOR3F: {
-                Vector3f *v = (Vector3f *)key.ptr;
-                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
-            }
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p != ':') {
+            // a string value
+            continue;
+        }
+        p++;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
 
-            case DATA_VECTOR3D: {
-                Vector3d *v = (Vector3d *)key.ptr;
-                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
+        if (*p == '{') {
+            // keys inside this object are matched against this section
+            if (depth == 1) {
+                section = str;
+                section_len = len;
             }
+            continue;
+        }
 
-            case QUATERNION: {
-                Quaternion *v = static_cast<Quaternion*>(key.ptr);
-                if (sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4)) != 4) {
-                    printf("Failed to parse Vector4f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                break;
-            }
+        if (depth == 0 || depth > 2) {
+            continue;
+        }
+        const int8_t i = find_key(position++, section, depth == 2 ? section_len : 0, str, len);
+        if (i < 0) {
+            // not one of ours, the value is skipped by the tokenizer
+            continue;
+        }
+        const struct keytable &key = keytable[i];
+        const char *end = parse_value(key, p);
+        if (end == nullptr) {
+            printf("Failed to parse %s/%s\n", key.section, key.key);
+            continue;
+        }
+        p = end;
 
-            case BOOLEAN:
-                *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
-                //printf("%s/%s = %i\n", key.section, key.key, *((unit8_t *)key.ptr));
-                break;
+        // record the keys that are found
+        received_bitmask |= 1U << i;
+    }
 
+    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        const struct keytable &key = keytable[i];
+        if (key.required && (received_bitmask & (1U << i)) == 0) {
+            printf("Failed to find key %s/%s\n", key.section, key.key);
+            return 0;
         }
     }
 
@@ -361,6 +558,7 @@ void JSON::recv_fdm(const struct sitl_input &input)
         printf("Detected physics reset\n");
         deltat = 0;
         last_received_bitmask = 0;
+        bind_keytable();
     } else {
         deltat = state.timestamp_s - last_timestamp_s;
     }
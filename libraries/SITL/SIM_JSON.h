@@ -42,7 +42,7 @@ public:
     /*  Create and set in/out socket for JSON generic simulator */
     void set_interface_ports(const char* address, const int port_in, const int port_out) override;
 
-private:
+protected:
 
     struct servo_packet_16 {
         uint16_t magic = 18458; // constant magic value
@@ -72,6 +72,9 @@ private:
     void output_servos(const struct sitl_input &input);
     void recv_fdm(const struct sitl_input &input);
 
+    // parse one nul terminated line of sensor data into state,
+    // returns a bitmask of the keytable entries received or zero if
+    // a required entry is missing
     uint32_t parse_sensors(const char *json);
 
     // buffer for parsing pose data in JSON format
@@ -134,6 +137,21 @@ private:
         {"", "no_time_sync", &state.no_time_sync, BOOLEAN, false},
     };
 
+    // keytable string lengths, bound once in the constructor
+    struct {
+        uint8_t section_len;
+        uint8_t key_len;
+    } keytable_len[ARRAY_SIZE(keytable)];
+
+    // keytable index of each key in the order the physics sends
+    // them, learnt from the frames of the current connection so each
+    // key is usually matched with a single compare. -1 if not known
+    int8_t key_order[32];
+
+    void bind_keytable(void);
+    int8_t find_key(uint8_t position, const char *section, uint8_t section_len, const char *key, uint8_t key_len);
+    const char *parse_value(const struct keytable &key, const char *p) const;
+
     // Enum coresponding to the ordering of keys in the keytable.
     enum DataKey {
         TIMESTAMP   = 1U << 0,
@@ -0,0 +1,240 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+    Simulator connector for external physics using shared memory
+*/
+
+#include "SIM_SharedMem.h"
+
+#if AP_SIM_SHAREDMEM_ENABLED
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <SRV_Channel/SRV_Channel.h>
+
+// number of times to yield to the physics process before sleeping
+#define SHM_SPIN_COUNT 2000
+#define SHM_SLEEP_US 100
+// resend servos after this many sleeps without a reply
+#define SHM_RESEND_SLEEPS (1000000 / SHM_SLEEP_US)
+
+extern const AP_HAL::HAL& hal;
+
+using namespace SITL;
+
+SharedMem::SharedMem(const char *frame_str) :
+    Aircraft(frame_str)
+{
+    printf("Starting SITL: SharedMem\n");
+
+    const char *colon = strchr(frame_str, ':');
+    if (colon) {
+        strncpy(shm_name, colon+1, sizeof(shm_name)-1);
+    }
+}
+
+SharedMem::~SharedMem()
+{
+    if (region != nullptr) {
+        munmap(region, sizeof(*region));
+        shm_unlink(shm_name);
+    }
+}
+
+/*
+    create the shared memory region and initialise the header. The
+    magic is stored last so a waiting physics process never sees a
+    partially initialised region
+*/
+void SharedMem::open_region(void)
+{
+    if (shm_name[0] == 0) {
+        snprintf(shm_name, sizeof(shm_name), "/ardupilot_sitl_fdm_%u", unsigned(instance));
+    }
+    const int fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    if (fd == -1) {
+        AP_HAL::panic("Unable to open shared memory %s: %s", shm_name, strerror(errno));
+    }
+    if (ftruncate(fd, sizeof(*region)) != 0) {
+        AP_HAL::panic("Unable to size shared memory %s: %s", shm_name, strerror(errno));
+    }
+    void *p = mmap(nullptr, sizeof(*region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        AP_HAL::panic("Unable to map shared memory %s: %s", shm_name, strerror(errno));
+    }
+    region = (struct sim_shm_region *)p;
+
+    sim_shm_store_seq(&region->magic, 0);
+    memset(&region->servos, 0, sizeof(region->servos));
+    memset(&region->state, 0, sizeof(region->state));
+    region->version = SIM_SHM_VERSION;
+    region->size = sizeof(*region);
+    sim_shm_store_seq(&region->magic, SIM_SHM_MAGIC);
+
+    printf("SharedMem FDM interface on %s, version %u\n", shm_name, unsigned(SIM_SHM_VERSION));
+}
+
+/*
+    publish the servo outputs for the next frame
+*/
+void SharedMem::output_servos(const struct sitl_input &input)
+{
+    struct sim_shm_servo_frame &servos = region->servos;
+    servos.frame_rate = rate_hz;
+    servos.num_servos = SRV_Channels::have_32_channels() ? 32 : 16;
+    for (uint8_t i=0; i<SIM_SHM_MAX_SERVOS; i++) {
+        servos.pwm[i] = input.servos[i];
+    }
+
+    // a sequence number of zero means no frame
+    frame_counter++;
+    if (frame_counter == 0) {
+        frame_counter = 1;
+    }
+    sim_shm_store_seq(&servos.seq, frame_counter);
+}
+
+/*
+    wait for the physics process to answer the last servo frame and
+    copy the state out of the region. Returns false if the state was
+    not usable
+*/
+bool SharedMem::recv_fdm(const struct sitl_input &input)
+{
+    uint32_t spins = 0;
+    uint32_t sleeps = 0;
+    while (sim_shm_load_seq(&region->state.seq) != frame_counter) {
+        // the physics usually answers within microseconds, so
+        // yield to it before falling back to sleeping
+        if (spins < SHM_SPIN_COUNT) {
+            spins++;
+            sched_yield();
+            continue;
+        }
+        usleep(SHM_SLEEP_US);
+        if (++sleeps >= SHM_RESEND_SLEEPS) {
+            // republish the frame in case the physics restarted
+            sleeps = 0;
+            printf("No SharedMem state received on %s, resending servos\n", shm_name);
+            frame_counter--;
+            output_servos(input);
+        }
+    }
+
+    const struct sim_shm_state_frame &fdm = region->state;
+
+    accel_body = Vector3f(fdm.accel_body[0], fdm.accel_body[1], fdm.accel_body[2]);
+    gyro = Vector3f(fdm.gyro[0], fdm.gyro[1], fdm.gyro[2]);
+    velocity_ef = Vector3f(fdm.velocity[0], fdm.velocity[1], fdm.velocity[2]);
+    position = Vector3d(fdm.position[0], fdm.position[1], fdm.position[2]);
+    position.xy() += origin.get_distance_NE_double(home);
+    use_time_sync = (fdm.flags & SIM_SHM_FLAG_NO_TIME_SYNC) == 0;
+
+    const Quaternion quat { fdm.quaternion[0], fdm.quaternion[1], fdm.quaternion[2], fdm.quaternion[3] };
+    if (quat.is_zero()) {
+        printf("SharedMem state has no attitude\n");
+        return false;
+    }
+    quat.rotation_matrix(dcm);
+
+    if ((fdm.flags & SIM_SHM_FLAG_AIRSPEED) != 0) {
+        // received airspeed directly
+        airspeed = fdm.airspeed;
+        airspeed_pitot = fdm.airspeed;
+    } else {
+        // velocity relative to airmass in body frame
+        velocity_air_bf = dcm.transposed() * velocity_ef;
+
+        // airspeed
+        airspeed = velocity_air_bf.length();
+
+        // airspeed as seen by a fwd pitot tube (limited to 120m/s)
+        airspeed_pitot = constrain_float(velocity_air_bf * Vector3f(1.0f, 0.0f, 0.0f), 0.0f, 120.0f);
+
+        // airspeed fix for eas2tas
+        update_eas_airspeed();
+    }
+
+    // Convert from a meters from origin physics to a lat long alt
+    update_position();
+
+    // update range finder distances
+    for (uint8_t i=0; i<ARRAY_SIZE(fdm.rng); i++) {
+        if ((fdm.flags & (SIM_SHM_FLAG_RNG_1 << i)) != 0) {
+            rangefinder_m[i] = fdm.rng[i];
+        }
+    }
+
+    if ((fdm.flags & SIM_SHM_FLAG_WINDVANE) != 0) {
+        wind_vane_apparent.direction = fdm.windvane_direction;
+        wind_vane_apparent.speed = fdm.windvane_speed;
+    }
+
+    double deltat;
+    if (fdm.timestamp_s < last_timestamp_s || !have_frame) {
+        // Physics time has gone backwards, don't reset AP
+        if (have_frame) {
+            printf("Detected physics reset\n");
+        }
+        deltat = 0;
+    } else {
+        deltat = fdm.timestamp_s - last_timestamp_s;
+    }
+    time_now_us += deltat * 1.0e6;
+
+    if (is_positive(deltat) && deltat < 0.1) {
+        // time in us to hz
+        if (use_time_sync) {
+            adjust_frame_time(1.0 / deltat);
+        }
+        // match actual frame rate with desired speedup
+        time_advance();
+    }
+    last_timestamp_s = fdm.timestamp_s;
+    have_frame = true;
+
+    return true;
+}
+
+/*
+   update the simulation by one time step
+*/
+void SharedMem::update(const struct sitl_input &input)
+{
+    if (region == nullptr) {
+        open_region();
+    }
+
+    output_servos(input);
+
+    if (!recv_fdm(input)) {
+        return;
+    }
+
+    // as the model does not provide mag field we calculate it from position and attitude
+    update_mag_field_bf();
+
+    // allow for changes in physics step
+    adjust_frame_time(constrain_float(sitl->loop_rate_hz, rate_hz-1, rate_hz+1));
+}
+
+#endif  // AP_SIM_SHAREDMEM_ENABLED
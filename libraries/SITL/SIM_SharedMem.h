@@ -0,0 +1,64 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  simulator connector for external physics engines using a shared
+  memory region in place of UDP. See SIM_SharedMem_Frame.h for the
+  frame layout and handshake
+
+  usage: --model shm[:name], name defaults to /ardupilot_sitl_fdm_N
+  for instance N
+ */
+#pragma once
+
+#include "SIM_config.h"
+
+#if AP_SIM_SHAREDMEM_ENABLED
+
+#include "SIM_Aircraft.h"
+#include "SIM_SharedMem_Frame.h"
+
+namespace SITL {
+
+class SharedMem : public Aircraft {
+public:
+    SharedMem(const char *frame_str);
+    ~SharedMem();
+
+    /* update model by one time step */
+    void update(const struct sitl_input &input) override;
+
+    /* static object creator */
+    static Aircraft *create(const char *frame_str) {
+        return NEW_NOTHROW SharedMem(frame_str);
+    }
+
+private:
+    void open_region(void);
+    void output_servos(const struct sitl_input &input);
+    bool recv_fdm(const struct sitl_input &input);
+
+    // shared memory object name
+    char shm_name[32];
+
+    struct sim_shm_region *region;
+
+    uint32_t frame_counter;
+    double last_timestamp_s;
+    bool have_frame;
+};
+
+}
+
+#endif  // AP_SIM_SHAREDMEM_ENABLED
@@ -0,0 +1,100 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  binary frame layout of the shared memory FDM interface. This header
+  is plain C so external physics engines can include it directly.
+
+  ArduPilot creates the region and owns the servo frame, the physics
+  engine owns the state frame. Each side fills in its frame and then
+  publishes it by storing the sequence number with release semantics,
+  the other side waits for the sequence number with acquire
+  semantics. The handshake is lock step, so each frame is only ever
+  written while the other side is waiting for it:
+
+    ArduPilot: write servos, servos.seq = N
+    physics:   wait for servos.seq != last, step, write state, state.seq = servos.seq
+    ArduPilot: wait for state.seq == N
+
+  All values are little endian. Any change to the layout must bump
+  SIM_SHM_VERSION.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define SIM_SHM_MAGIC       0x4d485341U  // "ASHM"
+#define SIM_SHM_VERSION     1
+#define SIM_SHM_MAX_SERVOS  32
+
+// bits in sim_shm_state_frame.flags for optional fields
+#define SIM_SHM_FLAG_RNG_1          (1U<<0)  // rng[0..5] use bits 0 to 5
+#define SIM_SHM_FLAG_WINDVANE       (1U<<6)
+#define SIM_SHM_FLAG_AIRSPEED       (1U<<7)
+#define SIM_SHM_FLAG_NO_TIME_SYNC   (1U<<8)
+
+// servo outputs, written by ArduPilot
+struct sim_shm_servo_frame {
+    uint32_t seq;               // frame number, stored last
+    uint16_t frame_rate;        // Hz
+    uint16_t num_servos;
+    uint16_t pwm[SIM_SHM_MAX_SERVOS];
+};
+
+// vehicle state, written by the physics engine
+struct sim_shm_state_frame {
+    uint32_t seq;               // seq of the servo frame this answers, stored last
+    uint32_t flags;             // SIM_SHM_FLAG_*
+    double timestamp_s;         // physics time
+    double position[3];         // NED from origin, m
+    float gyro[3];              // body frame, rad/s
+    float accel_body[3];        // body frame, m/s/s
+    float velocity[3];          // NED, m/s
+    float quaternion[4];        // body to earth attitude, w x y z
+    float rng[6];               // rangefinder distances, m
+    float windvane_direction;   // apparent wind direction, rad
+    float windvane_speed;       // apparent wind speed, m/s
+    float airspeed;             // m/s
+};
+
+struct sim_shm_region {
+    uint32_t magic;             // SIM_SHM_MAGIC, stored last when created
+    uint16_t version;           // SIM_SHM_VERSION
+    uint16_t reserved;
+    uint32_t size;              // sizeof(struct sim_shm_region)
+    uint8_t pad0[52];
+    // each frame starts on its own cache line
+    struct sim_shm_servo_frame servos;
+    uint8_t pad1[56];
+    struct sim_shm_state_frame state;
+};
+
+#ifdef __cplusplus
+#define SIM_SHM_STATIC_ASSERT static_assert
+#else
+#define SIM_SHM_STATIC_ASSERT _Static_assert
+#endif
+SIM_SHM_STATIC_ASSERT(sizeof(struct sim_shm_servo_frame) == 72, "servo frame size");
+SIM_SHM_STATIC_ASSERT(sizeof(struct sim_shm_state_frame) == 128, "state frame size");
+SIM_SHM_STATIC_ASSERT(sizeof(struct sim_shm_region) == 320, "region size");
+
+static inline uint32_t sim_shm_load_seq(const uint32_t *seq)
+{
+    return __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+}
+
+static inline void sim_shm_store_seq(uint32_t *seq, uint32_t value)
+{
+    __atomic_store_n(seq, value, __ATOMIC_RELEASE);
+}
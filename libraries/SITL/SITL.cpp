@@ -454,6 +454,11 @@ const AP_Param::GroupInfo SIM::var_info3[] = {
     // @Path: ./SIM_IntelligentEnergy24.cpp
     AP_SUBGROUPINFO(ie24_sim, "IE24_", 32, SIM, IntelligentEnergy24),
 
+#if AP_TEST_DRONECAN_DRIVERS
+    // @Path: ./SIM_DroneCANDevice.cpp
+    AP_SUBGROUPINFO(dronecan_sim, "DCAN_", 38, SIM, DroneCANDevice),
+#endif
+
     // user settable barometer parameters
     AP_GROUPINFO("BARO_COUNT",    33, SIM,  baro_count, 2),
 
@@ -0,0 +1,151 @@
+#include <AP_gbenchmark.h>
+
+#include <SITL/SIM_JSON.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_SIM_JSON_ENABLED
+
+/*
+  sensor lines recorded from JSON physics backends, from the minimum
+  set of fields up to every optional field
+ */
+static const char *frames[] = {
+    // pybullet robot, required fields only
+    "{\"timestamp\":12.345000000000001,\"imu\":{\"gyro\":[0.0012,-0.0034,0.0101],\"accel_body\":[0.0213,-0.0112,-9.8066]},"
+    "\"position\":[1.2345678,-2.3456789,-0.0512],\"attitude\":[0.0011,-0.0023,1.5707],\"velocity\":[0.0102,-0.0203,0.0004]}",
+
+    // Webots style quadcopter with quaternion attitude and rangefinder
+    "{\"timestamp\":103.2185,\"imu\":{\"gyro\":[0.01233, -0.00451, 0.10021],\"accel_body\":[0.12311, 0.04512, -9.75621]},"
+    "\"position\":[12.56102, -4.21091, -10.01201],\"quaternion\":[0.99981, 0.00512, -0.01021, 0.01603],"
+    "\"velocity\":[1.02311, -0.21033, 0.00512],\"rng_1\":10.0512}",
+
+    // Gazebo style plane with every optional field
+    "{\"timestamp\":523.004,\"imu\":{\"gyro\":[0.11233,-0.02451,0.00021],\"accel_body\":[1.12311,0.24512,-10.25621]},"
+    "\"position\":[1512.56102,-304.21091,-120.01201],\"attitude\":[0.1512,0.0531,-2.1102],"
+    "\"quaternion\":[0.4981,0.0512,0.0321,-0.8647],\"velocity\":[-12.02311,-19.21033,-1.00512],"
+    "\"rng_1\":120.0512,\"rng_2\":119.912,\"rng_3\":0,\"rng_4\":0,\"rng_5\":0,\"rng_6\":0,"
+    "\"windvane\":{\"direction\":0.1523,\"speed\":22.512},\"airspeed\":22.1012,\"no_time_sync\":0}",
+};
+
+// expose the parser of the JSON backend
+class JSONBench : public SITL::JSON
+{
+public:
+    JSONBench() : JSON("json") {}
+
+    using JSON::parse_sensors;
+    uint32_t parse_sensors_strstr(const char *json);
+};
+
+/*
+  the strstr based parser parse_sensors() replaced, scanning the whole
+  line for each keytable entry
+ */
+uint32_t JSONBench::parse_sensors_strstr(const char *json)
+{
+    uint32_t received_bitmask = 0;
+
+    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        struct keytable &key = keytable[i];
+
+        const char *p = strstr(json, key.section);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        p += strlen(key.section)+1;
+
+        p = strstr(p, key.key);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+
+        received_bitmask |= 1U << i;
+
+        p += strlen(key.key)+2;
+        switch (key.type) {
+            case DATA_UINT64:
+                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
+                break;
+
+            case DATA_FLOAT:
+                *((float *)key.ptr) = atof(p);
+                break;
+
+            case DATA_DOUBLE:
+                *((double *)key.ptr) = atof(p);
+                break;
+
+            case DATA_VECTOR3F: {
+                Vector3f *v = (Vector3f *)key.ptr;
+                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case DATA_VECTOR3D: {
+                Vector3d *v = (Vector3d *)key.ptr;
+                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case QUATERNION: {
+                Quaternion *v = static_cast<Quaternion*>(key.ptr);
+                if (sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4)) != 4) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case BOOLEAN:
+                *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
+                break;
+        }
+    }
+
+    return received_bitmask;
+}
+
+static JSONBench *json;
+
+static void BM_JSONParseSensors(benchmark::State& state)
+{
+    if (json == nullptr) {
+        json = new JSONBench();
+    }
+    const char *frame = frames[state.range(0)];
+
+    while (state.KeepRunning()) {
+        uint32_t received = json->parse_sensors(frame);
+        gbenchmark_escape(&received);
+    }
+}
+
+static void BM_JSONParseSensorsStrstr(benchmark::State& state)
+{
+    if (json == nullptr) {
+        json = new JSONBench();
+    }
+    const char *frame = frames[state.range(0)];
+
+    while (state.KeepRunning()) {
+        uint32_t received = json->parse_sensors_strstr(frame);
+        gbenchmark_escape(&received);
+    }
+}
+
+BENCHMARK(BM_JSONParseSensors)->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK(BM_JSONParseSensorsStrstr)->Arg(0)->Arg(1)->Arg(2);
+
+#endif  // HAL_SIM_JSON_ENABLED
+
+BENCHMARK_MAIN();
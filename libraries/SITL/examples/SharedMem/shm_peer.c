@@ -0,0 +1,116 @@
+/*
+  reference physics peer for the SITL shared memory FDM interface
+
+  simulates a vehicle sitting level on the ground and reports the
+  round trip time per frame, measured from publishing a state frame to
+  receiving the next servo frame
+
+  build: gcc -O2 -o shm_peer shm_peer.c
+  usage: ./shm_peer [name]
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../../SIM_SharedMem_Frame.h"
+
+#define REPORT_FRAMES 10000
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+static struct sim_shm_region *open_region(const char *name)
+{
+    // wait for ArduPilot to create and initialise the region
+    while (1) {
+        const int fd = shm_open(name, O_RDWR, 0);
+        if (fd != -1) {
+            void *p = mmap(NULL, sizeof(struct sim_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p != MAP_FAILED) {
+                struct sim_shm_region *region = (struct sim_shm_region *)p;
+                while (sim_shm_load_seq(&region->magic) != SIM_SHM_MAGIC) {
+                    usleep(1000);
+                }
+                if (region->version != SIM_SHM_VERSION || region->size != sizeof(*region)) {
+                    printf("Incompatible region version %u size %u\n", region->version, region->size);
+                    return NULL;
+                }
+                return region;
+            }
+        }
+        usleep(100000);
+    }
+}
+
+int main(int argc, const char *argv[])
+{
+    const char *name = argc > 1 ? argv[1] : "/ardupilot_sitl_fdm_0";
+    printf("Waiting for %s\n", name);
+    struct sim_shm_region *region = open_region(name);
+    if (region == NULL) {
+        return 1;
+    }
+    printf("Connected\n");
+
+    uint32_t last_seq = 0;
+    double timestamp_s = 0;
+    double sent_s = 0;
+    double rtt_sum = 0;
+    double rtt_max = 0;
+    uint32_t rtt_count = 0;
+
+    while (1) {
+        uint32_t seq;
+        while ((seq = sim_shm_load_seq(&region->servos.seq)) == last_seq) {
+            sched_yield();
+        }
+        if (sent_s > 0) {
+            const double rtt = now_s() - sent_s;
+            rtt_sum += rtt;
+            if (rtt > rtt_max) {
+                rtt_max = rtt;
+            }
+            if (++rtt_count == REPORT_FRAMES) {
+                printf("round trip: mean %.1fus max %.1fus\n", 1.0e6 * rtt_sum / rtt_count, 1.0e6 * rtt_max);
+                rtt_sum = 0;
+                rtt_max = 0;
+                rtt_count = 0;
+            }
+        }
+        if (seq < last_seq) {
+            // ArduPilot restarted, restart the physics
+            timestamp_s = 0;
+        }
+        last_seq = seq;
+
+        const uint16_t rate_hz = region->servos.frame_rate > 0 ? region->servos.frame_rate : 1200;
+        timestamp_s += 1.0 / rate_hz;
+
+        struct sim_shm_state_frame *state = &region->state;
+        memset(state->gyro, 0, sizeof(state->gyro));
+        memset(state->velocity, 0, sizeof(state->velocity));
+        memset(state->position, 0, sizeof(state->position));
+        state->accel_body[0] = 0;
+        state->accel_body[1] = 0;
+        state->accel_body[2] = -9.80665f;
+        state->quaternion[0] = 1;
+        state->quaternion[1] = 0;
+        state->quaternion[2] = 0;
+        state->quaternion[3] = 0;
+        state->flags = 0;
+        state->timestamp_s = timestamp_s;
+
+        sent_s = now_s();
+        sim_shm_store_seq(&state->seq, seq);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+'''
+reference physics peer for the SITL shared memory FDM interface
+
+simulates a vehicle sitting level on the ground and reports the round
+trip time per frame. Python has no acquire/release atomics, this relies
+on the aligned 32 bit sequence stores being atomic and x86 ordering, use
+shm_peer.c where that matters
+
+usage: ./shm_peer.py [name]
+'''
+import mmap
+import os
+import struct
+import sys
+import time
+
+MAGIC = 0x4d485341
+VERSION = 1
+REGION_SIZE = 320
+SERVO_OFS = 64
+STATE_OFS = 192
+
+HEADER = struct.Struct('<IHHI')
+SERVOS = struct.Struct('<IHH32H')
+STATE_SEQ = struct.Struct('<I')
+# flags, timestamp, position, gyro, accel_body, velocity, quaternion, rng, windvane, airspeed
+STATE_BODY = struct.Struct('<I4d3f3f3f4f6f2ff')
+
+REPORT_FRAMES = 10000
+
+
+def open_region(name):
+    path = '/dev/shm/' + name.lstrip('/')
+    while not os.path.exists(path):
+        time.sleep(0.1)
+    fd = os.open(path, os.O_RDWR)
+    region = mmap.mmap(fd, REGION_SIZE)
+    os.close(fd)
+    while True:
+        magic, version, _, size = HEADER.unpack_from(region, 0)
+        if magic == MAGIC:
+            break
+        time.sleep(0.001)
+    if version != VERSION or size != REGION_SIZE:
+        raise RuntimeError('Incompatible region version %u size %u' % (version, size))
+    return region
+
+
+def main():
+    name = sys.argv[1] if len(sys.argv) > 1 else '/ardupilot_sitl_fdm_0'
+    print('Waiting for %s' % name)
+    region = open_region(name)
+    print('Connected')
+
+    last_seq = 0
+    timestamp = 0.0
+    sent = None
+    rtt = []
+    while True:
+        while True:
+            seq, frame_rate, _ = SERVOS.unpack_from(region, SERVO_OFS)[:3]
+            if seq != last_seq:
+                break
+            os.sched_yield()
+        if sent is not None:
+            rtt.append(time.perf_counter() - sent)
+            if len(rtt) == REPORT_FRAMES:
+                print('round trip: mean %.1fus max %.1fus' % (1e6 * sum(rtt) / len(rtt), 1e6 * max(rtt)))
+                rtt = []
+        if seq < last_seq:
+            # ArduPilot restarted, restart the physics
+            timestamp = 0.0
+        last_seq = seq
+
+        timestamp += 1.0 / (frame_rate or 1200)
+        STATE_BODY.pack_into(region, STATE_OFS + 4,
+                             0, timestamp,
+                             0, 0, 0,
+                             0, 0, 0,
+                             0, 0, -9.80665,
+                             0, 0, 0,
+                             1, 0, 0, 0,
+                             0, 0, 0, 0, 0, 0,
+                             0, 0, 0)
+        sent = time.perf_counter()
+        STATE_SEQ.pack_into(region, STATE_OFS, seq)
+
+
+if __name__ == '__main__':
+    main()
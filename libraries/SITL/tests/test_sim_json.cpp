@@ -0,0 +1,209 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_JSON.h>
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_SIM_JSON_ENABLED
+
+/*
+  the sensor lines recorded for the parser benchmark, plus a line
+  with exponents and over long numbers that need the strtod fallback
+ */
+static const char *frames[] = {
+    // pybullet robot, required fields only
+    "{\"timestamp\":12.345000000000001,\"imu\":{\"gyro\":[0.0012,-0.0034,0.0101],\"accel_body\":[0.0213,-0.0112,-9.8066]},"
+    "\"position\":[1.2345678,-2.3456789,-0.0512],\"attitude\":[0.0011,-0.0023,1.5707],\"velocity\":[0.0102,-0.0203,0.0004]}",
+
+    // Webots style quadcopter with quaternion attitude and rangefinder
+    "{\"timestamp\":103.2185,\"imu\":{\"gyro\":[0.01233, -0.00451, 0.10021],\"accel_body\":[0.12311, 0.04512, -9.75621]},"
+    "\"position\":[12.56102, -4.21091, -10.01201],\"quaternion\":[0.99981, 0.00512, -0.01021, 0.01603],"
+    "\"velocity\":[1.02311, -0.21033, 0.00512],\"rng_1\":10.0512}",
+
+    // Gazebo style plane with every optional field
+    "{\"timestamp\":523.004,\"imu\":{\"gyro\":[0.11233,-0.02451,0.00021],\"accel_body\":[1.12311,0.24512,-10.25621]},"
+    "\"position\":[1512.56102,-304.21091,-120.01201],\"attitude\":[0.1512,0.0531,-2.1102],"
+    "\"quaternion\":[0.4981,0.0512,0.0321,-0.8647],\"velocity\":[-12.02311,-19.21033,-1.00512],"
+    "\"rng_1\":120.0512,\"rng_2\":119.912,\"rng_3\":0,\"rng_4\":0,\"rng_5\":0,\"rng_6\":0,"
+    "\"windvane\":{\"direction\":0.1523,\"speed\":22.512},\"airspeed\":22.1012,\"no_time_sync\":0}",
+
+    // numpy style output with exponents and 17 significant digits
+    "{\"timestamp\":1.0250000000000001e3,\"imu\":{\"gyro\":[1.2e-3,-3.4E-03,0.10000000000000001],"
+    "\"accel_body\":[2.13e-2,-0.011200000000000000,-9.8066e+00]},"
+    "\"position\":[1.2345678901234567e3,-2.3456789e-1,-5.12E1],\"attitude\":[1.1e-3,-2.3e-3,1.5707963267948966],"
+    "\"velocity\":[1.02e1,-2.03E+01,4e-4],\"rng_2\":1.20000000000000001e2,\"airspeed\":2.21012e1,\"no_time_sync\":1}",
+};
+
+// expose the parser and state of the JSON backend
+class JSONTest : public SITL::JSON
+{
+public:
+    JSONTest() : JSON("json") {}
+
+    using JSON::parse_sensors;
+    uint32_t parse_sensors_strstr(const char *json);
+
+    typedef decltype(state) State;
+    State &get_state() { return state; }
+};
+
+/*
+  the strstr based parser parse_sensors() replaced, scanning the whole
+  line for each keytable entry
+ */
+uint32_t JSONTest::parse_sensors_strstr(const char *json)
+{
+    uint32_t received_bitmask = 0;
+
+    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        struct keytable &key = keytable[i];
+
+        const char *p = strstr(json, key.section);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        p += strlen(key.section)+1;
+
+        p = strstr(p, key.key);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+
+        received_bitmask |= 1U << i;
+
+        p += strlen(key.key)+2;
+        switch (key.type) {
+            case DATA_UINT64:
+                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
+                break;
+
+            case DATA_FLOAT:
+                *((float *)key.ptr) = atof(p);
+                break;
+
+            case DATA_DOUBLE:
+                *((double *)key.ptr) = atof(p);
+                break;
+
+            case DATA_VECTOR3F: {
+                Vector3f *v = (Vector3f *)key.ptr;
+                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case DATA_VECTOR3D: {
+                Vector3d *v = (Vector3d *)key.ptr;
+                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case QUATERNION: {
+                Quaternion *v = static_cast<Quaternion*>(key.ptr);
+                if (sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4)) != 4) {
+                    return received_bitmask;
+                }
+                break;
+            }
+
+            case BOOLEAN:
+                *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
+                break;
+        }
+    }
+
+    return received_bitmask;
+}
+
+static void expect_vector3f_eq(const Vector3f &a, const Vector3f &b)
+{
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.y, b.y);
+    EXPECT_EQ(a.z, b.z);
+}
+
+// every field of state must be identical, including those left untouched
+static void expect_state_eq(const JSONTest::State &a, const JSONTest::State &b)
+{
+    EXPECT_EQ(a.timestamp_s, b.timestamp_s);
+    expect_vector3f_eq(a.imu.gyro, b.imu.gyro);
+    expect_vector3f_eq(a.imu.accel_body, b.imu.accel_body);
+    EXPECT_EQ(a.position.x, b.position.x);
+    EXPECT_EQ(a.position.y, b.position.y);
+    EXPECT_EQ(a.position.z, b.position.z);
+    expect_vector3f_eq(a.attitude, b.attitude);
+    EXPECT_EQ(a.quaternion.q1, b.quaternion.q1);
+    EXPECT_EQ(a.quaternion.q2, b.quaternion.q2);
+    EXPECT_EQ(a.quaternion.q3, b.quaternion.q3);
+    EXPECT_EQ(a.quaternion.q4, b.quaternion.q4);
+    expect_vector3f_eq(a.velocity, b.velocity);
+    for (uint8_t i=0; i<ARRAY_SIZE(a.rng); i++) {
+        EXPECT_EQ(a.rng[i], b.rng[i]);
+    }
+    EXPECT_EQ(a.wind_vane_apparent.direction, b.wind_vane_apparent.direction);
+    EXPECT_EQ(a.wind_vane_apparent.speed, b.wind_vane_apparent.speed);
+    EXPECT_EQ(a.airspeed, b.airspeed);
+    EXPECT_EQ(a.no_time_sync, b.no_time_sync);
+}
+
+static JSONTest *json;
+
+// parse each frame with both parsers from the same starting state
+TEST(SIM_JSON, matches_strstr_parser)
+{
+    if (json == nullptr) {
+        json = new JSONTest();
+    }
+    for (uint8_t f=0; f<ARRAY_SIZE(frames); f++) {
+        // twice, so the second pass uses the learnt key order
+        for (uint8_t pass=0; pass<2; pass++) {
+            json->get_state() = JSONTest::State{};
+            const uint32_t expected_bitmask = json->parse_sensors_strstr(frames[f]);
+            const JSONTest::State expected = json->get_state();
+
+            json->get_state() = JSONTest::State{};
+            EXPECT_EQ(expected_bitmask, json->parse_sensors(frames[f]));
+            expect_state_eq(expected, json->get_state());
+        }
+    }
+}
+
+// the key order learnt from one frame must not break parsing another
+TEST(SIM_JSON, frame_layout_change)
+{
+    if (json == nullptr) {
+        json = new JSONTest();
+    }
+    for (uint8_t f=ARRAY_SIZE(frames); f>0; f--) {
+        json->get_state() = JSONTest::State{};
+        const uint32_t expected_bitmask = json->parse_sensors_strstr(frames[f-1]);
+        const JSONTest::State expected = json->get_state();
+
+        json->get_state() = JSONTest::State{};
+        EXPECT_EQ(expected_bitmask, json->parse_sensors(frames[f-1]));
+        expect_state_eq(expected, json->get_state());
+    }
+}
+
+// a line missing a required field is rejected by both parsers
+TEST(SIM_JSON, missing_required)
+{
+    if (json == nullptr) {
+        json = new JSONTest();
+    }
+    const char *line = "{\"timestamp\":1.5,\"imu\":{\"gyro\":[0,0,0],\"accel_body\":[0,0,-9.8]},\"position\":[0,0,0]}";
+    EXPECT_EQ(0U, json->parse_sensors_strstr(line));
+    EXPECT_EQ(0U, json->parse_sensors(line));
+}
+
+#endif  // HAL_SIM_JSON_ENABLED
+
+AP_GTEST_MAIN()